@@ -41,6 +41,7 @@ app = Flask(__name__)
 # ========== 共享状态 ==========
 app_state = {
     "devices": {},
+    "metrics": {},
     "results_deque": deque(maxlen=MAX_RESULTS),
     "stats": {
         "total": 0, "passed": 0, "failed": 0,
@@ -163,6 +164,13 @@ def api_devices():
         return jsonify(list(app_state["devices"].values()))
 
 
+@app.route("/api/metrics")
+def api_metrics():
+    """各设备最近一次上报的运行指标快照"""
+    with app_state["data_lock"]:
+        return jsonify(dict(app_state["metrics"]))
+
+
 @app.route("/api/results")
 def api_results():
     limit = request.args.get("limit", 50, type=int)
@@ -10,6 +10,7 @@ MQTT_CONFIG = {
         "results": "visiontool/results",
         "heartbeat": "visiontool/heartbeat",
         "commands": "visiontool/commands",
+        "metrics": "visiontool/metrics",
     },
     "qos": 1,
 }
@@ -10,6 +10,7 @@ from datetime import datetime
 
 from config import MQTT_CONFIG, DEVICE_TIMEOUT_SECONDS
 from db import db_upsert_device, db_insert_result, db_insert_heartbeat
+import report_codec
 
 import logging
 _log = logging.getLogger("dashboard").info
@@ -28,6 +29,7 @@ class MQTTHandler:
             topics = [
                 (MQTT_CONFIG["topics"]["results"], MQTT_CONFIG["qos"]),
                 (MQTT_CONFIG["topics"]["heartbeat"], MQTT_CONFIG["qos"]),
+                (MQTT_CONFIG["topics"]["metrics"], 0),
             ]
             client.subscribe(topics)
             self._broadcast_sse("mqtt_status", {"connected": True})
@@ -41,13 +43,19 @@ class MQTTHandler:
 
     def on_message(self, client, userdata, msg):
         try:
-            payload = json.loads(msg.payload.decode("utf-8"))
-        except json.JSONDecodeError:
+            if report_codec.is_cbor(msg.payload):
+                payload = report_codec.decode(msg.payload)
+            else:
+                payload = json.loads(msg.payload.decode("utf-8"))
+        except (ValueError, report_codec.cbor2.CBORDecodeError) as e:
+            _log(f"[MQTT] 无法解析消息 topic={msg.topic}: {e}")
             return
         if msg.topic == MQTT_CONFIG["topics"]["heartbeat"]:
             self._handle_heartbeat(payload)
         elif msg.topic == MQTT_CONFIG["topics"]["results"]:
             self._handle_result(payload)
+        elif msg.topic == MQTT_CONFIG["topics"]["metrics"]:
+            self._handle_metrics(payload)
 
     def _handle_heartbeat(self, payload):
         device_id = payload.get("deviceId", "unknown")
@@ -75,19 +83,71 @@ class MQTTHandler:
                             payload.get("ts", int(now * 1000)))
         self._broadcast_sse("heartbeat", {"deviceId": device_id})
 
+    def _handle_metrics(self, payload):
+        """运行指标只保留每台设备的最新快照，不落库"""
+        device_id = payload.get("deviceId", "unknown")
+        snapshot = {
+            "deviceId": device_id,
+            "ts": payload.get("ts", int(time.time() * 1000)),
+            "uptime": payload.get("uptime", 0),
+            "metrics": payload.get("metrics", []),
+        }
+        with self.s["data_lock"]:
+            self.s["metrics"][device_id] = snapshot
+        self._broadcast_sse("metrics", {"deviceId": device_id})
+
     def _handle_result(self, payload):
+        if payload.get("type") == "batch":
+            self._handle_batch(payload)
+            return
+
+        record = self._store_record(payload)
+        if record is None:
+            return
+        self._count_results(record["deviceId"], record["roiName"], record["dateTime"],
+                            1, 1 if record["passed"] else 0,
+                            last_result={"passed": record["passed"], "roiName": record["roiName"],
+                                         "dateTime": record["dateTime"]})
+
+    def _handle_batch(self, payload):
+        """聚合上报：reports 只作为明细记录，统计以 summary 为准（包含未发送明细的报告）"""
+        # 离线补发为至少一次投递，同一聚合消息可能重复到达，按 batchId 去重后才累加统计
+        if not self._mark_seen("batch:" + payload.get("batchId", "")):
+            return
+
+        device_id = payload.get("deviceId", "unknown")
+        dt_str = payload.get("dateTime", datetime.now().strftime("%Y-%m-%d %H:%M:%S"))
+
+        last_result = None
+        for report in payload.get("reports", []):
+            report.setdefault("deviceId", device_id)
+            record = self._store_record(report)
+            if record is not None:
+                last_result = {"passed": record["passed"], "roiName": record["roiName"],
+                               "dateTime": record["dateTime"]}
+
+        summary = payload.get("summary", {})
+        by_roi = summary.get("byRoi") or {"全图": summary}
+        for roi_name, counts in by_roi.items():
+            total = counts.get("total", 0)
+            if total <= 0:
+                continue
+            self._count_results(device_id, roi_name, dt_str, total, counts.get("passed", 0),
+                                last_result=last_result)
+
+        self._broadcast_sse("summary", {"deviceId": device_id, "summary": summary,
+                                        "windowStart": payload.get("windowStart"),
+                                        "windowEnd": payload.get("windowEnd")})
+
+    def _store_record(self, payload):
+        """保存单条报告明细（去重、入库、推送），返回记录；重复报告返回 None"""
         report_id = payload.get("reportId", "")
-        if report_id:
-            with self._recent_lock:
-                if report_id in self._recent_results:
-                    return
-                self._recent_results.add(report_id)
-                if len(self._recent_results) > 500:
-                    self._recent_results.clear()
+        if not self._mark_seen(report_id):
+            return None
 
         device_id = payload.get("deviceId", "unknown")
         passed = payload.get("passed", True)
-        roi_name = payload.get("roiName", "全图")
+        roi_name = payload.get("roiName") or "全图"
         image_name = payload.get("imageName", "")
         dt_str = payload.get("dateTime", datetime.now().strftime("%Y-%m-%d %H:%M:%S"))
 
@@ -121,6 +181,28 @@ class MQTTHandler:
 
         self.s["results_deque"].append(record)
 
+        try:
+            db_insert_result(record)
+        except Exception as e:
+            _log(f"[MQTT] db_insert_result FAILED: {e}")
+        self._broadcast_sse("result", record)
+        return record
+
+    def _mark_seen(self, key):
+        """记录消息ID，已出现过返回 False；空ID（旧版边缘端）不去重"""
+        if not key or key == "batch:":
+            return True
+        with self._recent_lock:
+            if key in self._recent_results:
+                return False
+            self._recent_results.add(key)
+            if len(self._recent_results) > 500:
+                self._recent_results.clear()
+        return True
+
+    def _count_results(self, device_id, roi_name, dt_str, total, passed, last_result=None):
+        """累加统计计数（单条报告 total=1，聚合消息按 summary 一次累加）"""
+        failed = total - passed
         today_str = datetime.now().strftime("%Y-%m-%d")
         is_today = dt_str.startswith(today_str)
 
@@ -137,25 +219,25 @@ class MQTTHandler:
                     "result_count": 0, "last_result": None,
                 }
 
-            stats["total"] += 1
+            stats["total"] += total
             stats["passed"] += passed
-            stats["failed"] += (0 if passed else 1)
+            stats["failed"] += failed
 
             if is_today:
-                stats["today"] += 1
+                stats["today"] += total
                 stats["today_passed"] += passed
-                stats["today_failed"] += (0 if passed else 1)
+                stats["today_failed"] += failed
 
             roi_stat = stats["by_roi"][roi_name]
-            roi_stat["total"] += 1
+            roi_stat["total"] += total
             roi_stat["passed"] += passed
-            roi_stat["failed"] += (0 if passed else 1)
+            roi_stat["failed"] += failed
 
             hour_key = datetime.now().strftime("%Y-%m-%d %H:00")
             hour_stat = stats["by_hour"][hour_key]
-            hour_stat["total"] += 1
+            hour_stat["total"] += total
             hour_stat["passed"] += passed
-            hour_stat["failed"] += (0 if passed else 1)
+            hour_stat["failed"] += failed
 
             if len(stats["by_hour"]) > 168:
                 sorted_hours = sorted(stats["by_hour"].keys())
@@ -163,15 +245,11 @@ class MQTTHandler:
                     del stats["by_hour"][old_hour]
 
             dev = devices[device_id]
-            dev["result_count"] = dev.get("result_count", 0) + 1
-            dev["last_result"] = {"passed": passed, "roiName": roi_name, "dateTime": dt_str}
+            dev["result_count"] = dev.get("result_count", 0) + total
+            if last_result is not None:
+                dev["last_result"] = last_result
 
         db_upsert_device(device_id, devices[device_id])
-        try:
-            db_insert_result(record)
-        except Exception as e:
-            _log(f"[MQTT] db_insert_result FAILED: {e}")
-        self._broadcast_sse("result", record)
 
     def check_device_timeout(self):
         while True:
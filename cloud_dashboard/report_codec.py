@@ -0,0 +1,121 @@
+"""
+边缘端 CBOR 上报解码（对应 C++ ReportCodec）
+
+消息以 CBOR 自描述标签 55799（D9 D9 F7）开头，顶层为整数键 map。
+解码后还原为与 JSON 上报相同的字段名，后续处理无需区分编码。
+"""
+
+from collections.abc import Mapping
+from datetime import datetime
+
+import cbor2
+
+CBOR_MAGIC = b"\xd9\xd9\xf7"
+SCHEMA_VERSION = 1
+
+# 字段编号，与 src/data/report_codec.cpp 中的 Key 保持一致
+_REPORT_KEYS = {
+    1: "reportId",
+    2: "imageId",
+    3: "imageName",
+    4: "roiId",
+    5: "roiName",
+    6: "timestamp",
+    7: "passed",
+    8: "failReason",
+    10: "totalItems",
+    11: "passedItems",
+    12: "failedItems",
+    13: "customFields",
+    14: "deviceId",
+}
+_KEY_VERSION = 0
+_KEY_ITEMS = 9
+_KEY_KIND = 16
+_KEY_WINDOW_START = 21
+_KEY_WINDOW_END = 22
+_KEY_SUMMARY = 23
+_KEY_REPORTS = 24
+_KEY_BATCH_ID = 25
+
+_KIND_BATCH = 1
+
+# DetectionType 序号 -> 名称（include/config/detection_type.h）
+_DETECTION_TYPES = [
+    "条码检测", "模板匹配", "直线检测", "Blob分析", "视频源",
+    "目标检测", "视频检测", "自定义Pipeline", "OCR识别",
+]
+
+
+def is_cbor(raw):
+    return raw[:3] == CBOR_MAGIC
+
+
+def _iso(ms):
+    return datetime.fromtimestamp(ms / 1000).isoformat(timespec="seconds")
+
+
+def _plain(value):
+    """cbor2 可能返回只读 map/tuple，转换为可 JSON 序列化的 dict/list"""
+    if isinstance(value, Mapping):
+        return {k: _plain(v) for k, v in value.items()}
+    if isinstance(value, (list, tuple)):
+        return [_plain(v) for v in value]
+    return value
+
+
+def _detection_type(value):
+    if isinstance(value, int) and 0 <= value < len(_DETECTION_TYPES):
+        return _DETECTION_TYPES[value]
+    return value if isinstance(value, str) else "未知类型"
+
+
+def _expand_report(obj):
+    report = {name: _plain(obj[key]) for key, name in _REPORT_KEYS.items() if key in obj}
+    if _KEY_ITEMS in obj:
+        report["itemResults"] = [
+            {"itemName": name, "detectionType": _detection_type(dtype),
+             "passed": passed, "failReason": reason}
+            for name, dtype, passed, reason in obj[_KEY_ITEMS]
+        ]
+    if "timestamp" in report:
+        report["dateTime"] = _iso(report["timestamp"])
+    return report
+
+
+def _expand_batch(obj):
+    total, passed, by_roi, fail_reasons = obj.get(_KEY_SUMMARY, [0, 0, {}, {}])
+    window_end = obj.get(_KEY_WINDOW_END, 0)
+    return {
+        "type": "batch",
+        "batchId": obj.get(_KEY_BATCH_ID, ""),
+        "deviceId": obj.get(14, "unknown"),
+        "windowStart": obj.get(_KEY_WINDOW_START, window_end),
+        "windowEnd": window_end,
+        "dateTime": _iso(window_end),
+        "summary": {
+            "total": total,
+            "passed": passed,
+            "failed": total - passed,
+            "passRate": passed / total if total > 0 else 1.0,
+            "byRoi": {roi: {"total": t, "passed": p, "failed": t - p}
+                      for roi, (t, p) in by_roi.items()},
+            "failReasons": _plain(fail_reasons),
+        },
+        "reports": [_expand_report(r) for r in obj.get(_KEY_REPORTS, [])],
+    }
+
+
+def decode(raw):
+    """解码 CBOR 上报为 JSON 等价的 dict；格式不支持时抛出 ValueError"""
+    value = cbor2.loads(raw)
+    if isinstance(value, cbor2.CBORTag):  # 未自动剥离自描述标签时
+        value = value.value
+    if not isinstance(value, Mapping):
+        raise ValueError("CBOR 上报顶层不是 map")
+    version = value.get(_KEY_VERSION)
+    if version != SCHEMA_VERSION:
+        raise ValueError(f"不支持的 CBOR 上报版本: {version}")
+    if value.get(_KEY_KIND) == _KIND_BATCH:
+        return _expand_batch(value)
+    return _expand_report(value)
@@ -0,0 +1,49 @@
+#ifndef BARCODE_LOCALIZER_H
+#define BARCODE_LOCALIZER_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+/**
+ * 条码候选窗口
+ */
+struct BarcodeCandidate
+{
+    cv::Rect rect;          // 原图坐标下的候选窗口（已外扩边距并裁剪到图像内）
+    double score = 0.0;     // 热度评分（窗口内平均梯度能量，越大越可能是条码）
+    bool linear = false;    // 梯度方向一致性高，疑似一维码
+};
+
+/**
+ * 条码快速定位器
+ *
+ * 在降采样图像上计算结构张量（梯度能量 + 方向一致性）热力图：
+ * - 一维码：梯度能量高且方向高度一致
+ * - 二维码（QR / DataMatrix）：梯度能量高，且两个方向都有边缘
+ * 热区经 Otsu 阈值、形态学闭运算连成块后作为候选窗口，
+ * 供 ZXing 只在小窗口内解码，避免在大面积空背景上做全图搜索。
+ */
+class BarcodeLocalizer
+{
+public:
+    struct Params
+    {
+        int maxSide = 640;              // 降采样后最长边（像素）
+        int maxCandidates = 8;          // 最多返回的候选数（按评分降序）
+        double minAreaRatio = 0.0005;   // 候选最小面积（占降采样图比例）
+        double marginRatio = 0.25;      // 候选窗口外扩比例（每侧）
+        int minMargin = 16;             // 候选窗口最小外扩（原图像素）
+    };
+
+    BarcodeLocalizer() = delete;
+
+    /**
+     * 定位条码候选窗口
+     * @param gray   8位灰度图（原分辨率）
+     * @param params 定位参数
+     * @return       候选窗口（原图坐标，按评分降序）
+     */
+    static std::vector<BarcodeCandidate> locate(const cv::Mat& gray, const Params& params);
+};
+
+#endif // BARCODE_LOCALIZER_H
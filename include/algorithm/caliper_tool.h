@@ -0,0 +1,53 @@
+#ifndef CALIPER_TOOL_H
+#define CALIPER_TOOL_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+#include "config/caliper_config.h"
+#include "data/caliper_result.h"
+
+/**
+ * 卡尺测量工具
+ *
+ * 沿测量路径布置 N 个卡尺，每个卡尺取一条垂直于路径的 1D 灰度剖面：
+ * 1. 所有卡尺的采样坐标一次性生成，只把覆盖区域转为浮点后用一次 remap 完成采样
+ * 2. 沿切向 projectionLength 行求平均（投影），得到 N×L 剖面矩阵
+ * 3. 对整个矩阵做一维高斯平滑 + 中心差分求导
+ * 4. 每条剖面取梯度极值，抛物线插值得到亚像素边缘位置
+ * 5. 边缘点做鲁棒直线/圆拟合（迭代剔除离群点）
+ *
+ * 计算量只与 N×L×投影宽度 有关，与整帧大小无关。
+ */
+class CaliperTool
+{
+public:
+    /// 单个卡尺的几何（图像坐标）
+    struct Caliper
+    {
+        cv::Point2f center;     // 卡尺中心（位于测量路径上）
+        cv::Point2f normal;     // 剖面方向（单位向量）
+        cv::Point2f tangent;    // 投影方向（单位向量）
+    };
+
+    CaliperTool() = delete;
+
+    /**
+     * 按配置在测量路径上布置卡尺
+     * @param start 直线起点 / 圆心
+     * @param end   直线终点 / 圆弧上一点
+     */
+    static std::vector<Caliper> layout(const cv::Point2f& start, const cv::Point2f& end,
+                                       const CaliperConfig& cfg);
+
+    /**
+     * 执行卡尺测量
+     * @param gray  8位灰度图
+     * @param start 直线起点 / 圆心
+     * @param end   直线终点 / 圆弧上一点
+     * @param cfg   卡尺参数
+     */
+    static CaliperResult measure(const cv::Mat& gray, const cv::Point2f& start, const cv::Point2f& end,
+                                 const CaliperConfig& cfg);
+};
+
+#endif // CALIPER_TOOL_H
@@ -5,6 +5,7 @@
 #include "config/display_config.h"
 #include "data/barcode_result.h"
 #include "data/ocr_region.h"
+#include "data/overlay_model.h"
 
 struct PipelineContext;
 
@@ -12,7 +13,9 @@ struct PipelineContext;
  * DisplayRenderer - Pipeline数据与显示渲染的分离层
  *
  * PipelineContext只存储数据，渲染逻辑集中在这里。
- * 根据指定的显示模式，从PipelineContext中提取或合成对应的显示图像。
+ * 根据指定的显示模式，从PipelineContext中提取对应的底图（render）
+ * 和矢量叠加层（overlayFor）。叠加类模式不再克隆并光栅化底图，
+ * 框/线/标签/Mask 由 ImageView 以 QGraphicsItem 绘制。
  */
 namespace DisplayRenderer {
 
@@ -24,6 +27,16 @@ namespace DisplayRenderer {
  */
 cv::Mat render(const PipelineContext& ctx, DisplayConfig::Mode mode);
 
+/**
+ * @brief 提取指定显示模式下应叠加在底图上的矢量图层
+ * @param ctx  Pipeline执行结果数据
+ * @param mode 显示模式
+ * @return     叠加层（非叠加类模式返回空模型）
+ */
+OverlayModel overlayFor(const PipelineContext& ctx, DisplayConfig::Mode mode);
+
+// ========== 光栅化叠加（旧的逐帧烧录方案，保留用于 benchmark 对比；实时显示请使用 overlayFor） ==========
+
 /**
  * @brief 将二值Mask叠加到原图上（Mask区域显示为绿色）
  * @param bgr   原图（BGR 3通道）
@@ -49,4 +62,11 @@ cv::Mat drawBarcodeOverlay(const cv::Mat& bgr, const QVector<BarcodeResult>& bar
  */
 cv::Mat drawOcrOverlay(const cv::Mat& bgr, const QVector<OcrRegion>& regions);
 
+/**
+ * 对比逐帧光栅化烧录（克隆底图 + Mask/条码/OCR 绘制）与提取矢量叠加层（overlayFor）的单帧耗时
+ * 使用合成的 Mask 与条码/OCR 结果；矢量方案不含 ImageView 的图元更新。
+ * OCR 烧录用 QPainter 绘字，需在 QGuiApplication 下调用
+ */
+void benchmark(const cv::Mat& bgr, int iterations = 20);
+
 } // namespace DisplayRenderer
@@ -18,9 +18,10 @@ public:
 
     cv::Mat convertColorSpace(const cv::Mat&src,const QString& mode);
 
-    cv::Mat executeAlgorithmQueue(const cv::Mat&src,const QVector<AlgorithmStep>&queue);
+    // tileSize > 0 时，连续的局部形态学步骤按块并行执行（见 TiledExecutor）
+    cv::Mat executeAlgorithmQueue(const cv::Mat&src,const QVector<AlgorithmStep>&queue,int tileSize = 0);
 
-    cv::Mat adjustParameter(const cv::Mat &src, int brightness, double contrast,double gamma,double sharpen);
+    cv::Mat adjustParameter(const cv::Mat &src, int brightness, double contrast,double gamma,double sharpen,int tileSize = 0);
 
     cv::Mat filterRGB(const cv::Mat& src,
                       int rLow, int rHigh,
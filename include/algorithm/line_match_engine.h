@@ -0,0 +1,62 @@
+#ifndef LINE_MATCH_ENGINE_H
+#define LINE_MATCH_ENGINE_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+#include <cstdint>
+#include "config/line_detect_config.h"
+
+/**
+ * 参考线匹配结果
+ */
+struct LineMatchResult
+{
+    std::vector<cv::Vec4f> lines;       // 检测到的直线（原图坐标）
+    std::vector<uint8_t> matched;       // 与 lines 一一对应：1=与参考线匹配
+    int matchedCount = 0;
+    cv::Rect searchRect;                // 实际处理区域的外接矩形（原图坐标）
+    double elapsedMs = 0.0;
+};
+
+/**
+ * 直线检测 / 参考线匹配引擎
+ *
+ * - 检测器（LSDDetector / BinaryDescriptor）按线程缓存复用，不再每帧创建
+ * - 参考线匹配只处理搜索带的外接矩形（可选旋转摆正成水平窄条），
+ *   Canny / HoughP / LSD 的开销与搜索带面积成正比，而不是整帧
+ * - 匹配结果以标记数组返回，绘制时无需再做 O(全部×匹配) 的比对
+ */
+class LineMatchEngine
+{
+public:
+    LineMatchEngine() = delete;
+
+    /**
+     * 在灰度图上检测直线（算法由 cfg.algorithm 选择）
+     * @param gray  8位灰度图
+     * @param cfg   直线检测参数
+     * @param lines 输出直线（追加，坐标相对于 gray）
+     */
+    static void detectLines(const cv::Mat& gray, const LineDetectConfig& cfg, std::vector<cv::Vec4f>& lines);
+
+    /**
+     * 参考线匹配：仅在参考线两侧 searchRegionWidth/2 的带状区域内检测并匹配
+     * @param gray 8位灰度图（原图）
+     * @param cfg  直线检测 + 参考线参数（调用方保证 referenceLineValid）
+     */
+    static LineMatchResult matchReference(const cv::Mat& gray, const LineDetectConfig& cfg);
+
+    /**
+     * 对比整帧掩膜方案与裁剪方案的耗时（输出 [BENCH] 日志）
+     */
+    static void benchmark(const cv::Mat& gray, const LineDetectConfig& cfg, int iterations = 20);
+
+private:
+    /// 整帧掩膜方案（旧实现，仅供 benchmark 对比）
+    static LineMatchResult matchReferenceFullFrame(const cv::Mat& gray, const LineDetectConfig& cfg);
+
+    /// 按参考线角度/距离容差填充 matched 标记
+    static void markMatched(LineMatchResult& result, const LineDetectConfig& cfg);
+};
+
+#endif // LINE_MATCH_ENGINE_H
@@ -7,7 +7,9 @@
 #include <QPainter>
 #include <QColor>
 #include <QPolygonF>
+#include <memory>
 #include "opencv2/opencv.hpp"
+#include "data/template_file.h"
 
 // 先定义TemplateParams
 struct TemplateParams
@@ -74,12 +76,14 @@ public:
     QString getStrategyName() const override { return "OpenCV TM"; }
     bool hasTemplate() const override { return m_hasTemplate; }
 
-    // 保存和加载模板（.tpl 单文件，内含图像+参数）
+    // 保存和加载模板（.tpl 单文件，内含图像+灰度匹配模型+参数，兼容读取旧版 YAML）
     bool saveTemplate(const QString& filePath) const;
     bool loadTemplate(const QString& filePath);
 
 private:
     cv::Mat m_templateImage;
+    cv::Mat m_templateGray;     // 预计算的灰度模板，匹配时不再逐次转换
+    std::shared_ptr<const TemplateFile::Mapping> m_templateMapping; // 模板图像引用的文件映射
     bool m_hasTemplate;
     int m_matchMethod;
 
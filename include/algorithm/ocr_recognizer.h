@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QString>
+#include <opencv2/core.hpp>
+#include <onnxruntime_cxx_api.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief PP-OCR 识别(rec)模型的批量推理封装
+ *
+ * RapidOCR 的 OcrLite 对每个文本框单独跑一次 rec 会话。文本框已知时（固定区域模式），
+ * 这里把同一帧的全部文本框缩放到高度 48、右侧补零到同一宽度，拼成 [N,3,48,W]
+ * 一次前向，再逐行做 CTC 贪心解码。预处理与 RapidOCR 的 CrnnNet 一致
+ * （BGR，(x - 127.5) / 127.5），同一模型和字典下识别结果相同。
+ */
+class OcrRecognizer
+{
+public:
+    struct Result
+    {
+        std::string text;   ///< UTF-8 文本
+        float score = 0.f;  ///< 各字符最大概率的均值，无字符时为 0
+    };
+
+    OcrRecognizer();
+    ~OcrRecognizer();
+
+    /**
+     * @brief 加载 rec 模型和字典
+     * @param modelPath ch_PP-OCRv4_rec_*.onnx
+     * @param keysPath ppocr_keys_v1.txt（每行一个字符）
+     * @param numThreads intra-op 线程数
+     */
+    bool loadModel(const QString& modelPath, const QString& keysPath, int numThreads = 4);
+
+    bool isLoaded() const { return loaded_; }
+
+    /**
+     * @brief 批量识别
+     * @param crops 文本行图像 (BGR)，空图对应空结果
+     * @return 与 crops 一一对应的识别结果
+     */
+    std::vector<Result> recognize(const std::vector<cv::Mat>& crops);
+
+private:
+    static constexpr int kInputHeight = 48;
+    static constexpr int kMaxInputWidth = 2048;
+
+    Ort::Env env_;
+    std::unique_ptr<Ort::Session> session_;
+    std::unique_ptr<Ort::SessionOptions> sessionOptions_;
+    std::string inputName_;
+    std::string outputName_;
+
+    std::vector<std::string> keys_;  ///< [0] 为 CTC blank，末尾追加空格
+    bool loaded_ = false;
+};
@@ -43,6 +43,9 @@ public:
     // 根据AlgorithmStep执行对应算法
     static cv::Mat execute(const cv::Mat& region, const AlgorithmStep& step);
 
+    // 步骤的邻域影响半径（像素，分块执行的 halo）；依赖整幅区域的步骤返回 -1
+    static int neighborhoodRadius(const AlgorithmStep& step);
+
     // ========== 形态学操作 ==========
 
     // 开运算（圆形核）
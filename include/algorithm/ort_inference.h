@@ -1,13 +1,20 @@
 #pragma once
 
 #include "dnn_inference.h"  // for DetectionResult
+#include "config/ort_cpu_config.h"
 #include <onnxruntime_cxx_api.h>
+#include <memory>
+
+struct OrtThreadAffinity;
 
 /**
  * @brief ONNX Runtime GPU 推理封装类
  *
  * 使用 ONNX Runtime + CUDA EP 实现 YOLO 目标检测 GPU 加速推理。
  * 与 DnnInference 提供兼容的接口，可无缝替换。
+ *
+ * 无 CUDA 时按 OrtCpuConfig 构建 CPU 会话：线程数取自 CpuTopology，intra-op 线程可绑定物理核，
+ * 优化后的图缓存到用户缓存目录的 ort_cache/。支持 FP32、FP16（含半精度输入输出）和 INT8（QDQ）模型。
  */
 class OrtInference
 {
@@ -23,6 +30,10 @@ public:
      */
     bool loadModel(const QString& modelPath, bool useGpu = true);
 
+    /** @brief 设置 CPU 执行配置（下次 loadModel 生效） */
+    void setCpuConfig(const OrtCpuConfig& config) { cpuConfig_ = config; }
+    const OrtCpuConfig& cpuConfig() const { return cpuConfig_; }
+
     /**
      * @brief 执行目标检测
      * @param input 输入图像 (BGR)
@@ -44,6 +55,9 @@ public:
     /** @brief 是否使用 GPU */
     bool isUsingGpu() const;
 
+    /** @brief 已加载模型的数值精度（识别结果，不会是 Auto） */
+    OrtModelPrecision modelPrecision() const { return precision_; }
+
     /** @brief 从文件加载类别名称 */
     bool loadClassNames(const QString& filePath);
 
@@ -60,7 +74,15 @@ private:
     /** @brief 当 .names 不存在时，尝试从上级目录的 parameter.json 读取类名和尺寸 */
     bool loadFromParameterJson(const QString& modelDir);
 
+    /** @brief 按 CPU 配置构建会话选项；cpuSession 为 false 时不绑核（CUDA 会话） */
+    std::unique_ptr<Ort::SessionOptions> makeSessionOptions(GraphOptimizationLevel level, bool cpuSession);
+
+    /** @brief 创建 CPU 会话：优先加载优化图缓存，否则加载原模型并写出缓存 */
+    void createCpuSession(const QString& modelPath);
+
     Ort::Env env_;
+    OrtCpuConfig cpuConfig_;
+    std::unique_ptr<OrtThreadAffinity> threadAffinity_;  // 须晚于 session_ 析构（线程回收时仍在使用）
     std::unique_ptr<Ort::Session> session_;
     std::unique_ptr<Ort::SessionOptions> sessionOptions_;
     Ort::AllocatorWithDefaultOptions allocator_;
@@ -68,6 +90,8 @@ private:
     std::vector<std::string> classNames_;
     bool loaded_ = false;
     bool usingGpu_ = false;
+    OrtModelPrecision precision_ = OrtModelPrecision::FP32;
+    bool halfInput_ = false;  // 输入张量为 float16（未保留 float32 输入输出的 FP16 模型）
     int modelImgWidth_ = 0;   // parameter.json 中的 img_scale[0]
     int modelImgHeight_ = 0;  // parameter.json 中的 img_scale[1]
 };
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "config/ort_cpu_config.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief 单个模型在图片目录上的精度/延迟统计
+ *
+ * 图片没有标注，精度以第一个模型（通常为 FP32 原模型）的检测结果为参考：
+ * 同类别且 IoU ≥ 0.5 视为一致，统计一致率与置信度偏差。
+ */
+struct OrtModelReport
+{
+    QString modelPath;
+    QString precision;          // 识别出的模型精度（fp32/fp16/int8）
+    double loadMs = 0;          // 会话创建耗时（首次加载含图优化与写缓存）
+    int images = 0;
+    double meanMs = 0;          // 单张检测耗时（含前后处理）
+    double p50Ms = 0;
+    double p95Ms = 0;
+    int detections = 0;
+    double precisionVsRef = 1;  // 与参考一致的检测 / 本模型检测数
+    double recallVsRef = 1;     // 与参考一致的检测 / 参考检测数
+    double meanIou = 1;         // 一致检测的平均 IoU
+    double meanConfDelta = 0;   // 一致检测的平均 |置信度差|
+};
+
+/**
+ * @brief 在本地图片目录上对比多个 ONNX 模型（FP32 / FP16 / INT8）的精度与 CPU 延迟
+ *
+ * 所有模型使用同一 OrtCpuConfig、强制 CPU 执行，逐张计时。
+ * 可通过命令行 `EdgeVision --compare-models <图片目录> <参考模型> <候选模型...>` 运行。
+ */
+class OrtModelComparison
+{
+public:
+    struct Options
+    {
+        float confThreshold = 0.5f;
+        float nmsThreshold = 0.4f;
+        int inputWidth = 640;
+        int inputHeight = 640;
+        int warmupRuns = 3;     // 计时前预热次数（不计入统计）
+        int maxImages = 200;    // 最多读取的图片数（0=不限）
+    };
+
+    OrtModelComparison() = delete;
+
+    /// models[0] 为参考模型；返回与 models 同序的报告（加载失败的模型 images 为 0）
+    static QVector<OrtModelReport> run(const QString& imageDir, const QStringList& models,
+                                       const OrtCpuConfig& cpuConfig, const Options& options);
+
+    static bool writeCsv(const QVector<OrtModelReport>& reports, const QString& path);
+};
@@ -0,0 +1,51 @@
+#ifndef TILED_EXECUTOR_H
+#define TILED_EXECUTOR_H
+
+#include <opencv2/core.hpp>
+#include <functional>
+#include <vector>
+
+/**
+ * 大图分块执行
+ *
+ * 邻域算子：每块按 halo 外扩后交给算子（以父图 ROI 的形式传入，OpenCV 滤波可直接读取块外像素），
+ * 只取回块核心区域写入输出。halo 不小于算子的累计影响半径时，核心区域与整帧处理逐像素一致；
+ * 图像边界处外扩被裁剪，边界外推方式与整帧相同。
+ *
+ * 连通域：各块独立标记，再沿块接缝用并查集合并跨块区域，区域数与统计量与整帧一致
+ * （标签编号顺序可能不同）。
+ *
+ * 所有块通过 cv::parallel_for_ 并行，块内 OpenCV 调用不再嵌套并行。
+ */
+class TiledExecutor
+{
+public:
+    /// 块内算子：输入为外扩后的块（父图 ROI），返回同尺寸结果
+    using TileOp = std::function<cv::Mat(const cv::Mat& tile)>;
+
+    TiledExecutor() = delete;
+
+    /// 按 tileSize 划分块（行优先，末行/末列可能较小）
+    static std::vector<cv::Rect> makeTiles(const cv::Size& size, int tileSize);
+
+    /**
+     * 分块执行邻域算子并拼接
+     * @param src 输入图像
+     * @param halo 算子累计影响半径（像素）
+     * @param tileSize 块边长（不含 halo）
+     * @param op 块内算子；返回尺寸与输入块不一致时回退整帧执行
+     */
+    static cv::Mat apply(const cv::Mat& src, int halo, int tileSize, const TileOp& op);
+
+    /**
+     * 分块连通域标记（语义同 cv::connectedComponentsWithStats，不输出质心）
+     * @param binary 8 位单通道，非零为前景
+     * @param labels 输出 CV_32S 标签图（0 为背景）
+     * @param stats 输出 N×5 CV_32S（CC_STAT_LEFT/TOP/WIDTH/HEIGHT/AREA）
+     * @return 标签数 N（含背景）
+     */
+    static int connectedComponents(const cv::Mat& binary, cv::Mat& labels, cv::Mat& stats,
+                                   int tileSize, int connectivity = 8);
+};
+
+#endif // TILED_EXECUTOR_H
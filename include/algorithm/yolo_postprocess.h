@@ -0,0 +1,53 @@
+#pragma once
+
+#include "dnn_inference.h"  // for DetectionResult
+#include <string>
+#include <vector>
+
+/**
+ * @brief YOLOv8 解码参数
+ *
+ * 模型坐标 → 原图坐标：x_img = (x_model - padX) * scaleX
+ * （OrtInference / DnnInference 均为 letterbox 输入：scale 为 1/r，pad 为填充偏移）
+ */
+struct YoloDecodeParams
+{
+    float confThreshold = 0.5f;
+    float nmsThreshold = 0.4f;
+    float scaleX = 1.0f;
+    float scaleY = 1.0f;
+    float padX = 0.0f;
+    float padY = 0.0f;
+    int imgWidth = 0;           // 原图尺寸，用于边界裁剪
+    int imgHeight = 0;
+    bool classAware = true;     // 按类别分别 NMS（不同类别的重叠框互不抑制）
+};
+
+/**
+ * @brief YOLOv8 输出后处理（OrtInference / DnnInference 共用）
+ *
+ * 输出布局 [1, 4+C, N]：每个类别的置信度在内存中是一整行连续的 N 个 float。
+ * 类别最大值按行逐元素取 max（cv::reduce，OpenCV 内部 SIMD），一次遍历得到全部锚点的最高分；
+ * 低于阈值的锚点直接丢弃，只有幸存锚点才回查类别下标和框坐标。
+ * NMS 对幸存框按分数排序后单次遍历，每个类别维护各自的保留列表。
+ */
+class YoloPostprocess
+{
+public:
+    YoloPostprocess() = delete;
+
+    /**
+     * @brief 解码 + NMS
+     * @param output 输出张量数据（[1, numAttributes, numDetections]，行主序连续）
+     * @param numAttributes 4 + 类别数
+     * @param numDetections 锚点数
+     * @param classNames 类别名（缺失时为 "class_N"）
+     * @return 按置信度降序的检测结果
+     */
+    static std::vector<DetectionResult> decode(const float* output, int numAttributes, int numDetections,
+                                               const YoloDecodeParams& params,
+                                               const std::vector<std::string>& classNames);
+
+    /// 对比逐锚点标量解码 + cv::dnn::NMSBoxes 与本实现在 640 / 1280 输入下的后处理耗时
+    static void benchmark(int iterations = 50);
+};
@@ -24,6 +24,16 @@ struct ZXingBarcodeResult
 class ZXingBarcodeReader
 {
 public:
+    /**
+     * 解码力度（候选窗口逐级升级，全图回退使用 setTry* 配置）
+     */
+    enum class Effort
+    {
+        Fast,       // 不旋转、不反色、不降采样、不 tryHarder
+        Normal,     // tryHarder + 旋转
+        Thorough    // 全部启用
+    };
+
     ZXingBarcodeReader();
     ~ZXingBarcodeReader();
 
@@ -34,6 +44,14 @@ public:
      */
     QVector<ZXingBarcodeResult> readBarcodes(const cv::Mat& image);
 
+    /**
+     * 以指定力度解码灰度图（线程安全：不修改读取器状态，可并行调用）
+     * @param gray   8位灰度图（可为ROI子图）
+     * @param effort 解码力度
+     * @return 识别结果（坐标相对于 gray）
+     */
+    QVector<ZXingBarcodeResult> decodeWithEffort(const cv::Mat& gray, Effort effort) const;
+
     /**
      * 设置要识别的条码格式
      * @param formats 格式列表，如 {"QRCode", "DataMatrix", "EAN-13"}
@@ -67,7 +85,9 @@ private:
     /**
      * 将OpenCV Mat转换为ZXing可识别的格式并识别
      */
-    QVector<ZXingBarcodeResult> decodeImage(const cv::Mat& gray);
+    QVector<ZXingBarcodeResult> decodeImage(const cv::Mat& gray,
+                                            bool tryHarder, bool tryRotate,
+                                            bool tryInvert, bool tryDownscale) const;
 };
 
 #endif // ZXING_BARCODE_READER_H
\ No newline at end of file
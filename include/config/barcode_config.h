@@ -29,11 +29,27 @@ struct BarcodeConfig
     int binarizationThreshold = 128;     // 二值化阈值
     int morphologySize = 3;              // 形态学核大小
 
+    // 候选定位参数（先定位再解码，解出少于 maxNumSymbols 个或一个都没有时回退全图）
+    bool enableLocalization = true;      // 是否启用候选窗口定位
+    int localizationMaxSide = 640;       // 定位热力图降采样最长边
+    int maxCandidates = 8;               // 最多解码的候选窗口数
+
+    // 视频跟踪参数（按ROI记住上次位置，先在旧位置附近小窗口验证）
+    bool enableTracking = false;         // 是否启用跨帧跟踪
+    int trackingFullSearchInterval = 30; // 每隔多少帧强制全图搜索一次（发现新码）
+    int trackingWindowMargin = 32;       // 验证窗口相对上次位置的外扩（像素）
+
     bool operator==(const BarcodeConfig& o) const {
         return enableBarcode == o.enableBarcode &&
                codeTypes == o.codeTypes &&
                maxNumSymbols == o.maxNumSymbols &&
-               returnQuality == o.returnQuality;
+               returnQuality == o.returnQuality &&
+               enableLocalization == o.enableLocalization &&
+               localizationMaxSide == o.localizationMaxSide &&
+               maxCandidates == o.maxCandidates &&
+               enableTracking == o.enableTracking &&
+               trackingFullSearchInterval == o.trackingFullSearchInterval &&
+               trackingWindowMargin == o.trackingWindowMargin;
     }
 
     QJsonObject toJson() const;
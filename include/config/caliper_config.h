@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QJsonObject>
+
+/**
+ * @brief 卡尺测量配置
+ *
+ * 测量路径复用"绘制参考线"工具（LineDetectConfig::referenceLineStart/End）：
+ * - 直线模式：参考线即测量基线，N 个卡尺沿基线均匀分布，剖面方向垂直于基线
+ * - 圆弧模式：参考线起点为圆心、终点为圆弧上一点，卡尺沿圆弧分布，剖面沿半径方向
+ */
+struct CaliperConfig
+{
+    // 测量路径
+    int shape = 0;                      // 0=直线, 1=圆弧
+    double arcSpanDeg = 360.0;          // 圆弧张角（度），从参考线方向起逆时针
+
+    // 卡尺采样
+    int caliperCount = 20;              // 卡尺数量 N
+    double searchLength = 40.0;         // 剖面长度（像素，沿法向）
+    double projectionLength = 8.0;      // 投影宽度（像素，沿切向求平均降噪）
+    double sigma = 1.0;                 // 剖面高斯平滑 σ（像素）
+
+    // 边缘提取
+    double minContrast = 15.0;          // 最小边缘幅值（灰度/像素）
+    int polarity = 0;                   // 0=任意, 1=暗→亮, 2=亮→暗（沿剖面正方向；边缘对时指第一条边）
+    int edgeMode = 0;                   // 0=单边缘, 1=边缘对（宽度/间隙）
+    double expectedWidth = 0.0;         // 边缘对期望宽度（像素，0=取幅值最强的一对）
+
+    // 鲁棒拟合
+    double outlierThreshold = 1.0;      // 离群点残差阈值（像素）
+    int fitIterations = 3;              // 剔除离群点后重拟合次数
+
+    // 标定与判定
+    double pixelSizeUm = 1.0;           // 像素当量（μm/像素）
+    double nominalUm = 0.0;             // 名义值（μm）
+    double toleranceUm = 0.0;           // 公差（μm，0=不判定）
+
+    QJsonObject toJson() const {
+        QJsonObject obj;
+        obj["shape"] = shape;
+        obj["arcSpanDeg"] = arcSpanDeg;
+        obj["caliperCount"] = caliperCount;
+        obj["searchLength"] = searchLength;
+        obj["projectionLength"] = projectionLength;
+        obj["sigma"] = sigma;
+        obj["minContrast"] = minContrast;
+        obj["polarity"] = polarity;
+        obj["edgeMode"] = edgeMode;
+        obj["expectedWidth"] = expectedWidth;
+        obj["outlierThreshold"] = outlierThreshold;
+        obj["fitIterations"] = fitIterations;
+        obj["pixelSizeUm"] = pixelSizeUm;
+        obj["nominalUm"] = nominalUm;
+        obj["toleranceUm"] = toleranceUm;
+        return obj;
+    }
+
+    void fromJson(const QJsonObject& obj) {
+        shape = obj["shape"].toInt(0);
+        arcSpanDeg = obj["arcSpanDeg"].toDouble(360.0);
+        caliperCount = obj["caliperCount"].toInt(20);
+        searchLength = obj["searchLength"].toDouble(40.0);
+        projectionLength = obj["projectionLength"].toDouble(8.0);
+        sigma = obj["sigma"].toDouble(1.0);
+        minContrast = obj["minContrast"].toDouble(15.0);
+        polarity = obj["polarity"].toInt(0);
+        edgeMode = obj["edgeMode"].toInt(0);
+        expectedWidth = obj["expectedWidth"].toDouble(0.0);
+        outlierThreshold = obj["outlierThreshold"].toDouble(1.0);
+        fitIterations = obj["fitIterations"].toInt(3);
+        pixelSizeUm = obj["pixelSizeUm"].toDouble(1.0);
+        nominalUm = obj["nominalUm"].toDouble(0.0);
+        toleranceUm = obj["toleranceUm"].toDouble(0.0);
+    }
+};
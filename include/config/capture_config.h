@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+
+/**
+ * @brief 常驻采集服务配置（MQTT capture 指令使用的相机）
+ *
+ * device 为纯数字时按相机索引打开，否则按路径/URL 打开（视频文件、/dev/videoN、RTSP 等）；
+ * 视频文件按其帧率节拍循环读取，可作为虚拟相机用于联调。
+ */
+struct CaptureConfig
+{
+    bool enabled = true;                ///< 是否常驻打开相机
+    QString device = "1";               ///< 相机索引或路径/URL
+    QString backend = "auto";           ///< auto / dshow / msmf / v4l2 / ffmpeg
+    int width = 0;                      ///< 请求分辨率，0=驱动默认
+    int height = 0;
+    int fps = 0;                        ///< 请求帧率，0=驱动默认
+    bool flipHorizontal = true;         ///< 左右翻转（USB 相机镜像安装）
+    int ringSize = 3;                   ///< 帧环大小（保留最近几帧）
+    int warmupFrames = 10;              ///< 打开后丢弃的帧数（等待自动曝光/白平衡收敛）
+    int reopenIntervalMs = 2000;        ///< 设备断开后的重开间隔
+    int freshFrameTimeoutMs = 0;        ///< >0 时等待触发之后采集的帧（最多等待该时长），0=直接取最新帧
+
+    QJsonObject toJson() const {
+        QJsonObject obj;
+        obj["enabled"] = enabled;
+        obj["device"] = device;
+        obj["backend"] = backend;
+        obj["width"] = width;
+        obj["height"] = height;
+        obj["fps"] = fps;
+        obj["flipHorizontal"] = flipHorizontal;
+        obj["ringSize"] = ringSize;
+        obj["warmupFrames"] = warmupFrames;
+        obj["reopenIntervalMs"] = reopenIntervalMs;
+        obj["freshFrameTimeoutMs"] = freshFrameTimeoutMs;
+        return obj;
+    }
+
+    void fromJson(const QJsonObject& obj) {
+        enabled = obj["enabled"].toBool(true);
+        device = obj["device"].toString("1");
+        backend = obj["backend"].toString("auto");
+        width = obj["width"].toInt(0);
+        height = obj["height"].toInt(0);
+        fps = obj["fps"].toInt(0);
+        flipHorizontal = obj["flipHorizontal"].toBool(true);
+        ringSize = qBound(2, obj["ringSize"].toInt(3), 16);
+        warmupFrames = qMax(0, obj["warmupFrames"].toInt(10));
+        reopenIntervalMs = qMax(100, obj["reopenIntervalMs"].toInt(2000));
+        freshFrameTimeoutMs = qMax(0, obj["freshFrameTimeoutMs"].toInt(0));
+    }
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QJsonObject>
+
+/**
+ * @brief 变化门控配置（实时视频）
+ *
+ * 传送带停止或静态场景时，相邻帧内容几乎相同，重复跑完整 Pipeline 没有意义。
+ * 启用后，新帧先缩成 gridSize 长边的灰度缩略图（每格为原图一块的均值），
+ * 与该 ROI 上次实际执行的帧逐格比较：变化格占比不足 minChangedRatio 时跳过执行，重发上次结果。
+ */
+struct ChangeGateConfig
+{
+    bool enabled = false;           // 是否启用（仅影响实时/连续提交，配置变化总会触发执行）
+    int gridSize = 32;              // 缩略图长边（格数），越大越能察觉小面积变化
+    int pixelThreshold = 8;         // 单格灰度均值差超过该值视为该格变化
+    double minChangedRatio = 0.002; // 变化格占比达到该值视为场景变化；0 表示任一格变化即执行
+    int maxSkipFrames = 300;        // 连续跳过帧数上限，到达后强制执行一次（0 不限）
+
+    bool operator==(const ChangeGateConfig& o) const {
+        return enabled == o.enabled &&
+               gridSize == o.gridSize &&
+               pixelThreshold == o.pixelThreshold &&
+               minChangedRatio == o.minChangedRatio &&
+               maxSkipFrames == o.maxSkipFrames;
+    }
+
+    QJsonObject toJson() const {
+        QJsonObject obj;
+        obj["enabled"] = enabled;
+        obj["gridSize"] = gridSize;
+        obj["pixelThreshold"] = pixelThreshold;
+        obj["minChangedRatio"] = minChangedRatio;
+        obj["maxSkipFrames"] = maxSkipFrames;
+        return obj;
+    }
+
+    void fromJson(const QJsonObject& obj) {
+        enabled = obj["enabled"].toBool(false);
+        gridSize = obj["gridSize"].toInt(32);
+        pixelThreshold = obj["pixelThreshold"].toInt(8);
+        minChangedRatio = obj["minChangedRatio"].toDouble(0.002);
+        maxSkipFrames = obj["maxSkipFrames"].toInt(300);
+    }
+};
@@ -10,6 +10,7 @@
 #include "shape_filter_types.h"
 #include "pipeline_config.h"
 #include "mqtt_config.h"
+#include "capture_config.h"
 #include "algorithm_step.h"
 
 struct AppConfig
@@ -24,6 +25,7 @@ struct AppConfig
     QMap<QString, QString> imageIdToFilePath; ///< imageId -> filePath 映射
     QVector<AlgorithmStep> algorithmQueue;  ///< 算法队列（独立于 PipelineConfig）
     MqttConfig mqttConfig;           ///< MQTT 配置
+    CaptureConfig captureConfig;     ///< 常驻采集服务配置（MQTT capture 指令）
 
     // 转换为 JSON
     QJsonObject toJson() const;
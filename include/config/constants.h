@@ -42,6 +42,9 @@ namespace AppConstants {
     /// 系统监控最小更新间隔
     constexpr int SYSTEM_MONITOR_MIN_INTERVAL_MS = 100;
 
+    /// 本地指标端点端口（仅监听 127.0.0.1，GET /metrics），0=不启动
+    constexpr int METRICS_HTTP_PORT = 9464;
+
     // ========== Pipeline渲染 ==========
     
     /// 遮罩叠加层默认透明度 (0.0 ~ 1.0)
@@ -31,6 +31,7 @@ struct LineDetectConfig
     double angleThreshold = 15.0;      // 角度容差（度）
     double distanceThreshold = 50.0;   // 距离容差（像素）
     int searchRegionWidth = 100;       // 搜索区域宽度（像素）
+    bool deskewSearchRegion = false;   // 搜索带旋转摆正为水平窄条后再检测（斜参考线时处理面积更小）
 
     QJsonObject toJson() const;
     void fromJson(const QJsonObject& obj);
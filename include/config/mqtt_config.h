@@ -33,17 +33,29 @@ struct MqttConfig
     bool reportOnStateChange = true;    ///< 仅状态变化时上报
     bool reportRegions = true;          ///< 是否上报区域详情
     bool reportBarcodes = true;         ///< 是否上报条码结果
+    int reportMaxBatch = 50;            ///< 单条聚合消息最多携带的报告数，达到即提前发送
+    QString payloadEncoding = "json";   ///< 上报编码: json / cbor（紧凑二进制，见 ReportCodec）
 
     // ==================== 边云协同配置 ====================
     QString heartbeatTopic = "visiontool/heartbeat";    ///< 心跳主题
     int heartbeatIntervalMs = 30000;                     ///< 心跳间隔 (ms)
     QString deviceId = clientId;                         ///< 设备标识
+    QString metricsTopic = "visiontool/metrics";        ///< 运行指标主题
+    int metricsIntervalMs = 15000;                       ///< 指标上报间隔 (ms), 0=不上报
+    QString responseTopic = "visiontool/responses";     ///< 指令执行结果主题（含触发到结果的耗时）
 
     // ==================== 重连配置 ====================
     bool autoReconnect = true;          ///< 自动重连
-    int reconnectIntervalMs = 5000;     ///< 重连间隔 (ms)
+    int reconnectIntervalMs = 5000;     ///< 首次重连间隔 (ms)，之后指数退避
+    int reconnectMaxIntervalMs = 60000; ///< 退避间隔上限 (ms)
     int maxReconnectAttempts = 10;      ///< 最大重连次数，0=无限重连
 
+    // ==================== 离线缓存 ====================
+    bool outboxEnabled = true;          ///< 断线期间上报写入磁盘，重连后按序补发
+    int outboxMaxMB = 256;              ///< 离线缓存上限 (MB)，超出时丢弃最旧的分段
+    int outboxFsyncIntervalMs = 1000;   ///< 刷盘间隔 (ms), 0=每条记录写入后立即刷盘
+    int outboxReplayRate = 50;          ///< 重连后补发速率 (条/秒)
+
     // ==================== JSON 序列化 ====================
 
     /**
@@ -81,6 +93,8 @@ struct MqttConfig
         reportObj["reportOnStateChange"] = reportOnStateChange;
         reportObj["reportRegions"] = reportRegions;
         reportObj["reportBarcodes"] = reportBarcodes;
+        reportObj["reportMaxBatch"] = reportMaxBatch;
+        reportObj["payloadEncoding"] = payloadEncoding;
         json["report"] = reportObj;
 
         // 边云协同配置
@@ -88,15 +102,27 @@ struct MqttConfig
         edgeObj["heartbeatTopic"] = heartbeatTopic;
         edgeObj["heartbeatIntervalMs"] = heartbeatIntervalMs;
         edgeObj["deviceId"] = deviceId;
+        edgeObj["metricsTopic"] = metricsTopic;
+        edgeObj["metricsIntervalMs"] = metricsIntervalMs;
+        edgeObj["responseTopic"] = responseTopic;
         json["edge"] = edgeObj;
 
         // 重连配置
         QJsonObject reconnectObj;
         reconnectObj["autoReconnect"] = autoReconnect;
         reconnectObj["reconnectIntervalMs"] = reconnectIntervalMs;
+        reconnectObj["reconnectMaxIntervalMs"] = reconnectMaxIntervalMs;
         reconnectObj["maxReconnectAttempts"] = maxReconnectAttempts;
         json["reconnect"] = reconnectObj;
 
+        // 离线缓存
+        QJsonObject outboxObj;
+        outboxObj["enabled"] = outboxEnabled;
+        outboxObj["maxMB"] = outboxMaxMB;
+        outboxObj["fsyncIntervalMs"] = outboxFsyncIntervalMs;
+        outboxObj["replayRate"] = outboxReplayRate;
+        json["outbox"] = outboxObj;
+
         return json;
     }
 
@@ -137,6 +163,8 @@ struct MqttConfig
             reportOnStateChange = reportObj["reportOnStateChange"].toBool(true);
             reportRegions = reportObj["reportRegions"].toBool(true);
             reportBarcodes = reportObj["reportBarcodes"].toBool(true);
+            reportMaxBatch = reportObj["reportMaxBatch"].toInt(50);
+            payloadEncoding = reportObj["payloadEncoding"].toString("json");
         }
 
         // 边云协同配置
@@ -145,6 +173,9 @@ struct MqttConfig
             heartbeatTopic = edgeObj["heartbeatTopic"].toString("visiontool/heartbeat");
             heartbeatIntervalMs = edgeObj["heartbeatIntervalMs"].toInt(30000);
             deviceId = edgeObj["deviceId"].toString(clientId);
+            metricsTopic = edgeObj["metricsTopic"].toString("visiontool/metrics");
+            metricsIntervalMs = edgeObj["metricsIntervalMs"].toInt(15000);
+            responseTopic = edgeObj["responseTopic"].toString("visiontool/responses");
         }
 
         // 重连配置
@@ -152,8 +183,18 @@ struct MqttConfig
             QJsonObject reconnectObj = json["reconnect"].toObject();
             autoReconnect = reconnectObj["autoReconnect"].toBool(true);
             reconnectIntervalMs = reconnectObj["reconnectIntervalMs"].toInt(5000);
+            reconnectMaxIntervalMs = reconnectObj["reconnectMaxIntervalMs"].toInt(60000);
             maxReconnectAttempts = reconnectObj["maxReconnectAttempts"].toInt(10);
         }
+
+        // 离线缓存
+        if (json.contains("outbox")) {
+            QJsonObject outboxObj = json["outbox"].toObject();
+            outboxEnabled = outboxObj["enabled"].toBool(true);
+            outboxMaxMB = outboxObj["maxMB"].toInt(256);
+            outboxFsyncIntervalMs = outboxObj["fsyncIntervalMs"].toInt(1000);
+            outboxReplayRate = outboxObj["replayRate"].toInt(50);
+        }
     }
 
     /**
@@ -205,6 +246,9 @@ struct MqttConfig
         if (reconnectIntervalMs < 1000) {
             return "重连间隔不能小于 1000ms";
         }
+        if (reconnectMaxIntervalMs < reconnectIntervalMs) {
+            return "最大重连间隔不能小于重连间隔";
+        }
         return QString();  // 有效
     }
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <QJsonObject>
 #include <QString>
+#include "config/ort_cpu_config.h"
 
 /**
  * @brief 目标检测配置参数
@@ -16,6 +17,7 @@ struct ObjectDetectionConfig {
     float nmsThreshold = 0.4f;              // 非极大值抑制阈值 (0.0 ~ 1.0)
     int inputWidth = 640;                    // 输入宽度
     int inputHeight = 640;                   // 输入高度
+    OrtCpuConfig ortCpu;                     // ONNX Runtime CPU 执行配置
 
     // 显示参数
     bool showLabels = true;                  // 是否显示标签
@@ -35,6 +37,7 @@ struct ObjectDetectionConfig {
         obj["nmsThreshold"] = static_cast<double>(nmsThreshold);
         obj["inputWidth"] = inputWidth;
         obj["inputHeight"] = inputHeight;
+        obj["ortCpu"] = ortCpu.toJson();
         obj["showLabels"] = showLabels;
         obj["showConfidence"] = showConfidence;
         obj["showBoundingBox"] = showBoundingBox;
@@ -50,6 +53,7 @@ struct ObjectDetectionConfig {
         nmsThreshold = static_cast<float>(obj["nmsThreshold"].toDouble(0.4));
         inputWidth = obj["inputWidth"].toInt(640);
         inputHeight = obj["inputHeight"].toInt(640);
+        ortCpu.fromJson(obj["ortCpu"].toObject());
         showLabels = obj["showLabels"].toBool(true);
         showConfidence = obj["showConfidence"].toBool(true);
         showBoundingBox = obj["showBoundingBox"].toBool(true);
@@ -1,7 +1,22 @@
 #pragma once
 
+#include <QJsonArray>
 #include <QJsonObject>
+#include <QRect>
 #include <QString>
+#include <QVector>
+
+/**
+ * @brief OCR 引擎模式
+ *
+ * Full：检测(det) + 方向分类(cls) + 识别(rec) 全流程，文字位置未知时使用
+ * FixedRegions：跳过检测和方向分类，只对 ROI 内预先标定的文字区域做批量识别
+ *              （喷码批号等位置固定的场景）
+ */
+enum class OcrEngineMode {
+    Full,
+    FixedRegions
+};
 
 /**
  * @brief OCR文字识别配置
@@ -12,14 +27,29 @@ struct OcrConfig
 {
     int maxSideLen = 960;                   // 图像最长边限制（缩放用）
     double confidenceThreshold = 0.3;       // 最小置信度阈值 (0~1)
-    bool doAngle = true;                    // 是否启用文字方向检测
+    bool doAngle = true;                    // 是否启用文字方向检测（仅 Full 模式）
+    bool mostAngle = true;                  // 方向按多数文本框投票统一（仅 Full 模式）
     int numThreads = 4;                     // 推理线程数
 
+    // 引擎模式
+    OcrEngineMode engineMode = OcrEngineMode::Full;
+    QVector<QRect> fixedRegions;            // 固定文字区域（OCR输入图坐标，即ROI内坐标）
+
+    // 结果缓存（按ROI、按文字区域的感知哈希，内容未变时跳过推理）
+    bool enableCache = false;               // 是否启用识别结果缓存
+    int cacheMaxDistance = 0;               // 哈希汉明距离阈值（≤ 视为同一内容，0~256；
+                                            // 默认 0 仅完全一致才复用：33x8 哈希较粗，批号/日期改一个字符可能只差几位）
+
     bool operator==(const OcrConfig& o) const {
         return maxSideLen == o.maxSideLen &&
                confidenceThreshold == o.confidenceThreshold &&
                doAngle == o.doAngle &&
-               numThreads == o.numThreads;
+               mostAngle == o.mostAngle &&
+               numThreads == o.numThreads &&
+               engineMode == o.engineMode &&
+               fixedRegions == o.fixedRegions &&
+               enableCache == o.enableCache &&
+               cacheMaxDistance == o.cacheMaxDistance;
     }
 
     QJsonObject toJson() const {
@@ -27,7 +57,16 @@ struct OcrConfig
         obj["maxSideLen"] = maxSideLen;
         obj["confidenceThreshold"] = confidenceThreshold;
         obj["doAngle"] = doAngle;
+        obj["mostAngle"] = mostAngle;
         obj["numThreads"] = numThreads;
+        obj["engineMode"] = engineMode == OcrEngineMode::FixedRegions ? "fixed" : "full";
+        QJsonArray regions;
+        for (const QRect& r : fixedRegions) {
+            regions.append(QJsonArray{r.x(), r.y(), r.width(), r.height()});
+        }
+        obj["fixedRegions"] = regions;
+        obj["enableCache"] = enableCache;
+        obj["cacheMaxDistance"] = cacheMaxDistance;
         return obj;
     }
 
@@ -35,6 +74,18 @@ struct OcrConfig
         maxSideLen = obj["maxSideLen"].toInt(960);
         confidenceThreshold = obj["confidenceThreshold"].toDouble(0.3);
         doAngle = obj["doAngle"].toBool(true);
+        mostAngle = obj["mostAngle"].toBool(true);
         numThreads = obj["numThreads"].toInt(4);
+        engineMode = obj["engineMode"].toString() == "fixed" ? OcrEngineMode::FixedRegions
+                                                             : OcrEngineMode::Full;
+        fixedRegions.clear();
+        for (const auto& v : obj["fixedRegions"].toArray()) {
+            const QJsonArray r = v.toArray();
+            if (r.size() != 4) continue;
+            QRect rect(r[0].toInt(), r[1].toInt(), r[2].toInt(), r[3].toInt());
+            if (rect.isValid()) fixedRegions.append(rect);
+        }
+        enableCache = obj["enableCache"].toBool(false);
+        cacheMaxDistance = obj["cacheMaxDistance"].toInt(0);
     }
 };
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+
+/// 模型数值精度（Auto：按输入张量类型与模型内容识别）
+enum class OrtModelPrecision { Auto, FP32, FP16, INT8 };
+
+/// ORT 并行方式
+enum class OrtParallelism {
+    IntraOp,    // 算子内并行、算子顺序执行（YOLO 这类单链网络的最佳选择）
+    InterOp     // 额外并行执行无依赖的分支（多分支网络）
+};
+
+/**
+ * @brief ONNX Runtime CPU 执行配置
+ *
+ * 无独显的产线工控机上 ORT 跑在 CPU EP，线程数、绑核与图优化直接决定推理延迟。
+ * 数值为 0 的线程数表示按 CpuTopology 自动推导。
+ */
+struct OrtCpuConfig
+{
+    int intraOpThreads = 0;         // 0=自动：性能核的物理核数
+    int interOpThreads = 0;         // 仅 InterOp 模式生效；0=自动（2）
+    OrtParallelism parallelism = OrtParallelism::IntraOp;
+    bool pinThreads = false;        // intra-op 线程各绑一个物理核，避免与超线程兄弟/小核互相迁移；
+                                    // 默认关闭：多个模型/进程同时推理时固定绑核会互相抢同一批核心
+    bool allowSpinning = false;     // 线程空闲时自旋等待：降低延迟但会占满核心，与 Pipeline 抢 CPU
+    int optimizationLevel = 3;      // 0=禁用 1=基础 2=扩展 3=全部（含布局变换）
+    bool cacheOptimizedModel = true; // 优化后的图保存到用户缓存目录的 ort_cache，下次加载跳过图优化
+    OrtModelPrecision precision = OrtModelPrecision::Auto;
+
+    bool operator==(const OrtCpuConfig& o) const {
+        return intraOpThreads == o.intraOpThreads &&
+               interOpThreads == o.interOpThreads &&
+               parallelism == o.parallelism &&
+               pinThreads == o.pinThreads &&
+               allowSpinning == o.allowSpinning &&
+               optimizationLevel == o.optimizationLevel &&
+               cacheOptimizedModel == o.cacheOptimizedModel &&
+               precision == o.precision;
+    }
+    bool operator!=(const OrtCpuConfig& o) const { return !(*this == o); }
+
+    static QString precisionName(OrtModelPrecision p) {
+        switch (p) {
+        case OrtModelPrecision::FP32: return "fp32";
+        case OrtModelPrecision::FP16: return "fp16";
+        case OrtModelPrecision::INT8: return "int8";
+        default: return "auto";
+        }
+    }
+
+    static OrtModelPrecision precisionFromName(const QString& name) {
+        if (name == "fp32") return OrtModelPrecision::FP32;
+        if (name == "fp16") return OrtModelPrecision::FP16;
+        if (name == "int8") return OrtModelPrecision::INT8;
+        return OrtModelPrecision::Auto;
+    }
+
+    QJsonObject toJson() const {
+        QJsonObject obj;
+        obj["intraOpThreads"] = intraOpThreads;
+        obj["interOpThreads"] = interOpThreads;
+        obj["parallelism"] = parallelism == OrtParallelism::InterOp ? "interOp" : "intraOp";
+        obj["pinThreads"] = pinThreads;
+        obj["allowSpinning"] = allowSpinning;
+        obj["optimizationLevel"] = optimizationLevel;
+        obj["cacheOptimizedModel"] = cacheOptimizedModel;
+        obj["precision"] = precisionName(precision);
+        return obj;
+    }
+
+    void fromJson(const QJsonObject& obj) {
+        intraOpThreads = obj["intraOpThreads"].toInt(0);
+        interOpThreads = obj["interOpThreads"].toInt(0);
+        parallelism = obj["parallelism"].toString() == "interOp" ? OrtParallelism::InterOp
+                                                                  : OrtParallelism::IntraOp;
+        pinThreads = obj["pinThreads"].toBool(false);
+        allowSpinning = obj["allowSpinning"].toBool(false);
+        optimizationLevel = qBound(0, obj["optimizationLevel"].toInt(3), 3);
+        cacheOptimizedModel = obj["cacheOptimizedModel"].toBool(true);
+        precision = precisionFromName(obj["precision"].toString());
+    }
+};
@@ -21,6 +21,9 @@
 #include "config/line_detect_config.h"
 #include "config/blob_judge_config.h"
 #include "config/barcode_config.h"
+#include "config/caliper_config.h"
+#include "config/tiling_config.h"
+#include "config/change_gate_config.h"
 
 // ====== 枚举类型（原 pipeline_types.h，合并于此）======
 
@@ -36,6 +39,7 @@ enum class StepType : int
     BarcodeRecognition,
     ImageFilter,        // 滤波去噪
     OcrRecognition,     // OCR文字识别
+    Caliper,            // 卡尺测量（亚像素边缘）
     Count               // 步骤总数
 };
 
@@ -52,6 +56,7 @@ inline const char* stepDisplayName(StepType type)
         case StepType::BarcodeRecognition: return "条码识别";
         case StepType::ImageFilter:        return "滤波去噪";
         case StepType::OcrRecognition:     return "文字识别";
+        case StepType::Caliper:            return "卡尺测量";
         default:                           return "未知步骤";
     }
 }
@@ -85,6 +90,9 @@ struct PipelineConfig
     ImageFilterConfig imageFilter; ///< 滤波去噪
     OcrConfig        ocr;          ///< OCR文字识别
     ObjectDetectionConfig objectDetection; ///< 目标检测配置
+    CaliperConfig    caliper;      ///< 卡尺测量（路径复用 lineDetect 参考线）
+    TilingConfig     tiling;       ///< 大图分块执行
+    ChangeGateConfig changeGate;   ///< 实时视频变化门控
 
     // ========== Pipeline步骤控制 ==========
     static constexpr int STEP_COUNT = static_cast<int>(StepType::Count);
@@ -98,10 +106,11 @@ struct PipelineConfig
         false,  // LineDetector
         false,  // BarcodeRecognition
         false,  // ImageFilter
-        false   // OcrRecognition
+        false,  // OcrRecognition
+        false   // Caliper
     };
 
-    std::array<int, STEP_COUNT> stepOrder = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    std::array<int, STEP_COUNT> stepOrder = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
 
     // ========== 扩展功能开关（不在 StepType 枚举中） ==========
     bool enableObjectDetection = false;  ///< Pipeline步骤：目标检测步骤是否启用（StepConfigWidget控制）
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QtGlobal>
+
+/**
+ * @brief 大图分块执行配置
+ *
+ * 线扫相机等 50~100MP 的整帧图像，单次滤波遍历整帧会占满单核并反复冲刷缓存。
+ * 超过像素阈值时，邻域类步骤（增强锐化、滤波去噪、算法队列形态学、形状筛选连通域）
+ * 按 tileSize 分块并行处理，块外扩 halo（由各步骤核半径决定）后拼接，结果与整帧一致。
+ */
+struct TilingConfig
+{
+    bool enabled = true;            // 是否允许分块（仍需超过像素阈值）
+    int minMegapixels = 16;         // 像素数（百万）达到该值才分块，小图整帧处理开销更低
+    int tileSize = 512;             // 分块边长（像素，不含 halo）；512x512 的 8 位块约 0.25~0.75MB，可驻留 L2
+
+    bool appliesTo(int width, int height) const {
+        return enabled && tileSize > 0 &&
+               qint64(width) * height >= qint64(minMegapixels) * 1000000;
+    }
+
+    bool operator==(const TilingConfig& o) const {
+        return enabled == o.enabled &&
+               minMegapixels == o.minMegapixels &&
+               tileSize == o.tileSize;
+    }
+
+    QJsonObject toJson() const {
+        QJsonObject obj;
+        obj["enabled"] = enabled;
+        obj["minMegapixels"] = minMegapixels;
+        obj["tileSize"] = tileSize;
+        return obj;
+    }
+
+    void fromJson(const QJsonObject& obj) {
+        enabled = obj["enabled"].toBool(true);
+        minMegapixels = obj["minMegapixels"].toInt(16);
+        tileSize = obj["tileSize"].toInt(512);
+    }
+};
@@ -3,6 +3,9 @@
 
 #include "pipeline.h"
 #include "zxing_barcode_reader.h"
+#include <QHash>
+#include <QMutex>
+#include <atomic>
 
 /**
  * 条码识别步骤类
@@ -16,12 +19,62 @@ public:
 
     void run(PipelineContext& ctx) override;
     StepType stepType() const override { return StepType::BarcodeRecognition; }
+    ContextFields reads() const override { return ContextField::ExtractedMask | ContextField::Enhanced; }
+    ContextFields writes() const override
+    {
+        return ContextField::Barcode | ContextField::overlay(OverlayGroup::Barcode);
+    }
+
+    /// 跟踪缓存统计（验证次数 / 命中次数）
+    struct TrackingStats
+    {
+        quint64 verifications = 0;
+        quint64 hits = 0;
+        double hitRate() const { return verifications > 0 ? double(hits) / verifications : 0.0; }
+    };
+    TrackingStats trackingStats() const { return {trackVerifications_.load(), trackHits_.load()}; }
+
+    /// 清除全部跟踪状态（图像源切换时调用）
+    void resetTracking();
 
 private:
     ZXingBarcodeReader reader_;
 
+    /// 单个ROI的跟踪状态
+    struct TrackState
+    {
+        QVector<ZXingBarcodeResult> codes;  // 上次识别结果（ROI图像坐标）
+        cv::Size frameSize;                 // 上次帧尺寸（尺寸变化视为换图，直接失效）
+        int framesSinceFullSearch = 0;      // 距上次全图搜索的帧数
+    };
+    QHash<QString, TrackState> tracks_;     // roiId -> 跟踪状态
+    mutable QMutex trackMutex_;             // 批量检测时多个ROI可能并发执行
+    std::atomic<quint64> trackVerifications_{0};
+    std::atomic<quint64> trackHits_{0};
+
+    /**
+     * 在上次位置附近的小窗口内重新解码，全部原码都验证通过才算命中
+     * @param out 命中时输出更新位置后的结果
+     * @return 是否命中（未命中/需要周期性全搜时返回 false）
+     */
+    bool verifyTracked(const QString& roiId, const cv::Mat& gray, const BarcodeConfig& cfg,
+                       QVector<ZXingBarcodeResult>& out);
+
+    /// 全图搜索后刷新跟踪状态
+    void updateTrack(const QString& roiId, const cv::Size& frameSize,
+                     const QVector<ZXingBarcodeResult>& codes);
+
+    /**
+     * 候选窗口解码：先定位再逐窗口并行解码（Fast → Normal → Thorough 逐级升级）
+     * @return 识别结果（原图坐标，已去重）；无候选解出时返回空
+     */
+    QVector<ZXingBarcodeResult> decodeCandidates(const cv::Mat& gray, const BarcodeConfig& cfg) const;
+
     bool is2DCode(const QString& codeType) const;
     QString convertBarcodeType(const QString& zxingType) const;
+
+    /// 将识别结果写入矢量叠加层（框 + "[类型] 数据" 标签）
+    void appendOverlay(OverlayModel& overlay, const BarcodeResult& result) const;
 };
 
 #endif // BARCODE_STEP_H
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "config/capture_config.h"
+
+/**
+ * @brief 常驻采集服务：相机保持打开，后台线程持续取帧，帧环中始终有最新一帧
+ *
+ * 远程 capture 指令直接取帧环中的最新帧，不再承担打开设备、驱动初始化和自动曝光收敛的开销，
+ * 也不阻塞 GUI 线程；最新帧的帧龄不超过一个帧周期。设备断开后按 reopenIntervalMs 自动重开。
+ *
+ * 帧环槽位的缓冲在消费者不再持有时复用，稳定运行后取帧不产生堆分配；
+ * 已交给消费者的帧不会被后续采集覆盖（cv::Mat 引用计数）。
+ */
+class CaptureService : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Frame
+    {
+        cv::Mat image;
+        quint64 sequence = 0;       ///< 打开设备以来的帧序号（从 1 开始）
+        qint64 capturedAt = 0;      ///< 采集完成时刻（steady_clock 计数）
+
+        bool empty() const { return image.empty(); }
+        /// 距 now（steady_clock 计数）的帧龄（ms）
+        double ageMs(qint64 now) const;
+    };
+
+    explicit CaptureService(QObject* parent = nullptr);
+    ~CaptureService() override;
+
+    /// 按配置启动采集线程（设备在后台线程打开，立即返回）；已在运行时先停止
+    void start(const CaptureConfig& config);
+    void stop();
+
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+    /// 设备已打开且预热完成
+    bool isReady() const { return m_ready.load(std::memory_order_acquire); }
+    const CaptureConfig& config() const { return m_config; }
+    /// 最近一秒的实际采集帧率
+    double fps() const { return m_fps.load(std::memory_order_relaxed); }
+
+    /// 最新一帧（尚无帧时 image 为空）
+    Frame latest() const;
+
+    /**
+     * @brief 等待采集时刻不早于 notBefore 的帧（阻塞调用线程，不要在 GUI 线程调用）
+     * @param notBefore steady_clock 计数（通常为指令触发时刻）
+     * @param timeoutMs 最长等待；超时或服务停止时返回最新帧
+     */
+    Frame frameAfter(qint64 notBefore, int timeoutMs) const;
+
+    /// steady_clock 当前计数（与 Frame::capturedAt 同一时基）
+    static qint64 now();
+
+signals:
+    /// 设备打开（预热完成）/断开，从采集线程发出
+    void deviceStateChanged(bool ready, const QString& device);
+
+private:
+    void run();
+    bool openDevice(cv::VideoCapture& capture, bool& isFile) const;
+    /// 可被 stop() 打断的等待；返回 false 表示已停止
+    bool sleepFor(int ms);
+
+    CaptureConfig m_config;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_ready{false};
+    std::atomic<double> m_fps{0.0};
+
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_frameCv;
+    std::condition_variable m_stopCv;
+    mutable int m_waiters = 0;          ///< 正在 frameAfter 中等待的线程数，stop() 等其归零
+    mutable std::condition_variable m_waitersCv;
+    std::vector<Frame> m_ring;          ///< 按 sequence % size 存放
+    quint64 m_sequence = 0;             ///< 最新一帧的序号，0 表示尚无帧
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include "config/change_gate_config.h"
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+
+/**
+ * 变化门控：判断实时帧相对该 ROI 上次执行的帧是否有足够变化
+ *
+ * 每帧只做一次 INTER_AREA 缩放（得到各块灰度均值）和一次缩略图 absdiff，
+ * 32 格长边下单帧耗时为微秒级。参考帧只在判定为"需要执行"时更新，
+ * 缓慢漂移会逐帧累积，最终超过阈值触发执行。
+ */
+class ChangeGate
+{
+public:
+    struct Stats
+    {
+        quint64 processed = 0;
+        quint64 skipped = 0;
+    };
+
+    /**
+     * 判断该 key 的新帧是否需要执行；需要时把它记为新的参考帧
+     * @param configFingerprint 配置指纹，与上次执行时不同则必定执行
+     */
+    bool shouldProcess(const QString& key, const cv::Mat& frame, const ChangeGateConfig& cfg,
+                       size_t configFingerprint);
+
+    /// 清除该 key 的参考帧（请求被丢弃或执行失败时调用，下一帧必定执行）
+    void invalidate(const QString& key);
+    void reset();
+
+    Stats stats() const { return {m_processed.load(), m_skipped.load()}; }
+
+private:
+    struct State
+    {
+        cv::Mat reference;          // 上次执行帧的缩略图
+        size_t configFingerprint = 0;
+        int skippedInRow = 0;
+    };
+
+    static cv::Mat thumbnail(const cv::Mat& frame, int gridSize);
+    void count(bool processed);
+
+    QHash<QString, State> m_states;
+    mutable QMutex m_mutex;
+    std::atomic<quint64> m_processed{0};
+    std::atomic<quint64> m_skipped{0};
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spdlog/sinks/sink.h"
+
+/**
+ * 异步日志 sink：无锁 MPSC 环形队列 + 后台写出线程
+ *
+ * 调用线程只把消息文本拷贝进预分配的槽位（槽内字符串复用容量，稳定后不再分配），
+ * 格式化、写文件和会话缓存都在后台线程完成，热路径不再持有 spdlog 的 sink 互斥锁。
+ * 队列满时直接丢弃并计数，不阻塞调用线程；丢弃数由后台线程定期写入日志。
+ *
+ * 队列为 Vyukov 有界队列：每个槽位带序号，生产者 CAS 领取写位置，
+ * 单消费者按序号判断槽位是否写完。
+ *
+ * stop() 之后（程序退出阶段）退化为同步写出，保证析构期间的日志不丢失。
+ */
+class LogRingSink : public spdlog::sinks::sink
+{
+public:
+    /// @param sinks 实际写出的 sink（在后台线程调用）
+    /// @param capacity 队列槽位数，向上取整为 2 的幂
+    explicit LogRingSink(std::vector<spdlog::sink_ptr> sinks, size_t capacity = 8192);
+    ~LogRingSink() override;
+
+    void log(const spdlog::details::log_msg& msg) override;
+
+    /// 等待队列中已有的消息写出后刷新下游 sink（最多等待约 1 秒）
+    void flush() override;
+
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override;
+
+    /// 写完剩余消息并停止后台线程，之后的日志同步写出
+    void stop();
+
+    /// 因队列满被丢弃的消息总数
+    uint64_t droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq{0};
+        spdlog::log_clock::time_point time;
+        spdlog::level::level_enum level = spdlog::level::info;
+        size_t threadId = 0;
+        std::string loggerName;
+        std::string payload;
+    };
+
+    bool tryPush(const spdlog::details::log_msg& msg);
+    bool drainOnce();
+    void writeDownstream(const spdlog::details::log_msg& msg);
+    void reportDropped();
+    void run();
+
+    std::vector<spdlog::sink_ptr> m_sinks;
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask = 0;
+
+    alignas(64) std::atomic<size_t> m_enqueuePos{0};
+    alignas(64) std::atomic<size_t> m_dequeuePos{0};    ///< 仅后台线程写
+    alignas(64) std::atomic<uint64_t> m_dropped{0};
+    uint64_t m_reportedDropped = 0;
+
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_sleeping{false};
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::mutex m_directMutex;                           ///< stop() 后同步写出
+    std::thread m_worker;
+};
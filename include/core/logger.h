@@ -2,7 +2,11 @@
 #define LOGGER_H
 
 #include <QString>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <format>
+#include <limits>
 
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/qt_sinks.h"
@@ -23,9 +27,29 @@ struct std::formatter<QString> : std::formatter<std::string> {
 // spdlog-based logging setup (replaces old Logger singleton)
 // ============================================================
 
-// Initialize spdlog with rotating file sink + qt_color_sink (UI)
+// Sync:  sinks are written on the calling thread (under spdlog's sink mutex)
+// Async: calling thread only copies the message into a lock-free ring
+//        (LogRingSink); formatting and file I/O happen on a background thread.
+//        When the ring is full, messages are dropped and counted.
+enum class LogMode { Sync, Async };
+
+// Initialize spdlog with rotating file sink + session buffer (UI)
 // Call once at startup, after QApplication exists
-void setupLogging(QTextEdit* uiTextEdit, const QString& logDir);
+void setupLogging(QTextEdit* uiTextEdit, const QString& logDir, LogMode mode = LogMode::Async);
+
+// Drain the async queue and stop its thread; later messages are written synchronously.
+// Call before exiting the application
+void shutdownLogging();
+
+// Messages dropped so far (async queue full + session buffer evictions)
+struct LogDropStats {
+    uint64_t queueDropped = 0;
+    uint64_t sessionEvicted = 0;
+};
+LogDropStats logDropStats();
+
+// Measure per-call logging cost of the sync and async paths (results logged with [BENCH])
+void benchmarkLogging(int iterations = 5000);
 
 // Set UI sink log level (controls what appears in LogPage)
 void setUILogLevel(spdlog::level::level_enum level);
@@ -46,4 +70,54 @@ void flushLogs();
 // Convenience: clear UI text edit
 void clearLogUi();
 
+// ============================================================
+// Hot-path helpers
+// ============================================================
+
+// Debug logging inside pipeline steps / per-frame code.
+// Compiled out by default (arguments are not evaluated);
+// configure with -DEDGEVISION_STEP_DEBUG_LOG=ON to keep it.
+#ifdef EDGEVISION_STEP_DEBUG_LOG
+#define STEP_LOG_DEBUG(...) spdlog::debug(__VA_ARGS__)
+#else
+#define STEP_LOG_DEBUG(...) ((void)0)
+#endif
+
+// Per-call-site rate limiter: at most one message per interval,
+// the number of suppressed messages is reported with the next one
+class LogRateLimiter {
+public:
+    explicit LogRateLimiter(int intervalMs) : m_intervalMs(intervalMs) {}
+
+    bool allow(int& suppressed) {
+        const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t last = m_lastMs.load(std::memory_order_relaxed);
+        if ((last != kNever && now - last < m_intervalMs)
+            || !m_lastMs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            m_suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    static constexpr int64_t kNever = std::numeric_limits<int64_t>::min();
+    const int m_intervalMs;
+    std::atomic<int64_t> m_lastMs{kNever};
+    std::atomic<int> m_suppressed{0};
+};
+
+#define LOG_THROTTLED(level, intervalMs, ...)                                          \
+    do {                                                                               \
+        static LogRateLimiter logLimiter_(intervalMs);                                 \
+        int logSuppressed_ = 0;                                                        \
+        if (spdlog::should_log(level) && logLimiter_.allow(logSuppressed_)) {          \
+            spdlog::log(level, __VA_ARGS__);                                           \
+            if (logSuppressed_ > 0)                                                    \
+                spdlog::log(level, "  (同一位置另有 {} 条日志被限流)", logSuppressed_); \
+        }                                                                              \
+    } while (0)
+
 #endif // LOGGER_H
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Pipeline 中间图像的按线程缓冲池
+ *
+ * 以 cv::MatAllocator 的形式安装为 OpenCV 默认分配器：只有处于 MatArena::Scope 内的线程
+ * （Pipeline 执行各步骤时）分配的大块图像缓冲才走缓冲池，其余分配原样交给 OpenCV 标准分配器。
+ *
+ * 每个 Pipeline 执行线程独占一个池，按字节数精确复用（同尺寸同类型的 Mat 字节数相同）。
+ * 缓冲在引用计数归零时回到分配它的池：无论在哪个线程释放（UI 线程丢弃上一帧结果、
+ * 下一帧覆盖 ROI 缓存），都不会再交还给堆。所有池共享一个保留上限，超出时淘汰全局最久未用的缓冲。
+ * 工作线程退出时池保留给下一个新线程，稳定运行后图像缓冲不再产生堆分配。
+ * OpenCV parallel_for_ 的工作线程不建池（线程数随核数增长，块内中间结果尺寸各异，复用率低）。
+ */
+class MatArena
+{
+public:
+    /// 小于该字节数的缓冲直接走标准分配器（堆分配器本身对小块足够快）
+    static constexpr size_t kMinPooledBytes = 16 * 1024;
+    /// 所有池空闲缓冲的保留上限（约为数帧 1080p 中间结果）
+    static constexpr size_t kMaxBytes = size_t(64) * 1024 * 1024;
+
+    /// 线程在作用域内分配的图像缓冲走本线程的池（可嵌套）
+    class Scope
+    {
+    public:
+        Scope();
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /// 安装为 OpenCV 默认分配器（幂等，首次创建 PipelineManager 时调用）
+    static void install();
+    /// 释放所有池的空闲缓冲（图像源/方案切换、程序退出时调用）
+    static void trimAll();
+
+private:
+    friend class MatArenaAllocator;
+
+    struct Block
+    {
+        size_t size = 0;
+        uchar* data = nullptr;
+        uint64_t lastUse = 0;
+    };
+
+    MatArena();
+
+    /// 取出同字节数的空闲缓冲，没有则返回 nullptr
+    uchar* take(size_t size);
+    /// 归还缓冲；所有池合计超出上限时淘汰全局最久未用的
+    void give(size_t size, uchar* data);
+    void trim();
+    /// 最久未用缓冲的时间戳，池为空返回 UINT64_MAX
+    uint64_t oldestUse();
+    /// 淘汰最久未用的缓冲
+    void evictOldest();
+    /// 淘汰全局最久未用的缓冲，直到所有池合计回到上限内
+    static void enforceBudget();
+
+    /// 当前线程的池（在作用域外返回 nullptr）
+    static MatArena* current();
+
+    std::mutex m_mutex;
+    std::vector<Block> m_free;
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+using MetricLabels = QList<QPair<QString, QString>>;
+
+/// 单调递增计数器（热路径只做一次 relaxed fetch_add）
+class MetricCounter
+{
+public:
+    void inc(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+/// 瞬时值（队列深度、帧率、CPU 占用等）
+class MetricGauge
+{
+public:
+    void set(double v) { m_value.store(v, std::memory_order_relaxed); }
+    void add(double delta);
+    double value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> m_value{0.0};
+};
+
+/// 固定分桶直方图，桶边界注册时确定，observe() 无锁
+class MetricHistogram
+{
+public:
+    explicit MetricHistogram(std::vector<double> bounds);
+
+    void observe(double v);
+
+    const std::vector<double>& bounds() const { return m_bounds; }
+    /// 各桶计数（非累计），最后一个为 +Inf 桶
+    std::vector<uint64_t> bucketCounts() const;
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    double sum() const { return m_sum.load(std::memory_order_relaxed); }
+    /// 按桶内线性插值估算分位数，无样本时返回 0
+    double quantile(double q) const;
+
+private:
+    std::vector<double> m_bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_buckets;
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<double> m_sum{0.0};
+};
+
+/**
+ * 进程内指标注册表
+ *
+ * 注册（counter/gauge/histogram）加锁查找或创建，返回的引用在进程生命周期内有效；
+ * 调用点应缓存引用（函数内 static），热路径上只剩原子操作。
+ *
+ * 输出：
+ * - renderPrometheus()：Prometheus 文本格式 0.0.4，供 MetricsHttpServer 的 /metrics
+ * - toJson()：紧凑 JSON 快照，供 MQTT 指标主题上报云端
+ *
+ * 滚动吞吐：trackRate() 把计数器在最近窗口内的每秒增量写入一个 gauge，
+ * 由 sampleRates() 周期采样（SystemMonitor 每秒调用）。
+ */
+class MetricsRegistry
+{
+public:
+    static MetricsRegistry& instance();
+
+    /// 默认耗时分桶（ms）
+    static const std::vector<double>& latencyBucketsMs();
+
+    MetricCounter& counter(const QString& name, const QString& help, const MetricLabels& labels = {});
+    MetricGauge& gauge(const QString& name, const QString& help, const MetricLabels& labels = {});
+    MetricHistogram& histogram(const QString& name, const QString& help, const MetricLabels& labels = {},
+                               const std::vector<double>& bounds = latencyBucketsMs());
+
+    /// 登记滚动速率：target = source 在最近 windowSec 秒内的平均每秒增量
+    void trackRate(const MetricCounter& source, MetricGauge& target, int windowSec = 10);
+
+    /// 采样所有滚动速率，需周期调用（建议 1 秒）
+    void sampleRates();
+
+    QByteArray renderPrometheus() const;
+    QJsonObject toJson() const;
+
+private:
+    MetricsRegistry();
+
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Series {
+        MetricLabels labels;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+
+    struct Family {
+        QString name;
+        QString help;
+        Type type;
+        std::vector<std::unique_ptr<Series>> series;
+    };
+
+    struct RateTracker {
+        const MetricCounter* source;
+        MetricGauge* target;
+        qint64 windowMs;
+        std::deque<std::pair<qint64, uint64_t>> samples;   ///< (采样时刻 ms, 计数值)
+    };
+
+    Series& findOrCreate(const QString& name, const QString& help, Type type, const MetricLabels& labels);
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Family>> m_families;        ///< 按注册顺序输出
+    std::vector<RateTracker> m_rates;
+    QElapsedTimer m_clock;
+};
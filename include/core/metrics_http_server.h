@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QObject>
+#include <QHostAddress>
+
+class QTcpServer;
+class QTcpSocket;
+
+/**
+ * 本地指标 HTTP 端点
+ *
+ * - GET /metrics       Prometheus 文本格式（MetricsRegistry::renderPrometheus）
+ * - GET /metrics.json  JSON 快照（与 MQTT 指标主题内容相同）
+ *
+ * 只实现抓取所需的最小 HTTP/1.0 子集：读取请求行后一次性响应并关闭连接。
+ * 默认仅监听回环地址，远程采集请经由本机的 Prometheus/代理转发。
+ */
+class MetricsHttpServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsHttpServer(QObject* parent = nullptr);
+    ~MetricsHttpServer() override;
+
+    /// 开始监听，失败时记录日志并返回 false
+    bool start(quint16 port, const QHostAddress& address = QHostAddress::LocalHost);
+    void stop();
+
+    bool isListening() const;
+    quint16 port() const;
+
+private slots:
+    void onNewConnection();
+
+private:
+    void handleRequest(QTcpSocket* socket);
+
+    QTcpServer* m_server = nullptr;
+};
@@ -5,6 +5,8 @@
 #include <QTimer>
 #include <memory>
 #include <atomic>
+#include <functional>
+#include <mutex>
 #include <mqtt/async_client.h>
 #include "config/mqtt_config.h"
 
@@ -13,27 +15,48 @@
  * 
  * 基于 Paho MQTT C++ 库封装，提供 Qt 信号槽接口。
  * 通过 Qt 事件循环处理消息回调，保证线程安全。
+ *
+ * 连接管理完全异步：connect()/disconnect() 只发起请求立即返回，
+ * 结果由 Paho 动作监听器转发回 Qt 线程推进状态机；
+ * 连接失败或丢失后按指数退避（带随机抖动）重连，Broker 不可用时不阻塞调用线程。
+ *
+ * Paho 线程中的回调不直接捕获 this，而是持有共享的存活标记（Liveness）：
+ * 回调持锁确认对象仍存活后再投递到 Qt 线程，析构时持锁清除标记，之后到达的回调直接丢弃。
  */
 class MqttClient : public QObject
 {
     Q_OBJECT
 
 public:
+    /// 连接状态
+    enum class State
+    {
+        Disconnected,   ///< 未连接（空闲）
+        Connecting,     ///< 连接请求进行中
+        Connected,      ///< 已连接
+        Disconnecting,  ///< 断开请求进行中
+        Backoff         ///< 等待下一次重连
+    };
+
     explicit MqttClient(const MqttConfig& config, QObject* parent = nullptr);
     ~MqttClient();
 
-    /// 连接到 Broker
+    /// 连接到 Broker（异步，结果通过 connected / connectionError 通知）
     void connect();
 
-    /// 断开连接
+    /// 断开连接（异步，完成后发出 disconnected）
     void disconnect();
 
     /// 发布消息
     /// @param topic 发布主题
-    /// @param payload 消息内容
+    /// @param payload 消息内容（原样发送的字节，JSON 为 UTF-8 文本）
     /// @param qos QoS 等级 (0/1/2)
     /// @param retained 是否保留消息
-    void publish(const QString& topic, const QString& payload, int qos = 1, bool retained = false);
+    void publish(const QString& topic, const QByteArray& payload, int qos = 1, bool retained = false);
+
+    /// 发布消息并跟踪投递结果，完成（或失败）后发出 publishCompleted(tag, ok)
+    /// @param tag 调用方自定义的消息标识
+    void publishTracked(const QString& topic, const QByteArray& payload, int qos, quint64 tag);
 
     /// 订阅主题
     /// @param topic 订阅主题
@@ -49,6 +72,9 @@ public:
     /// 是否已连接
     bool isConnected() const { return m_connected; }
 
+    /// 当前连接状态
+    State state() const { return m_state; }
+
     /// 获取当前配置
     const MqttConfig& config() const { return m_config; }
 
@@ -70,21 +96,62 @@ signals:
 
     /// 重连尝试
     /// @param attempt 当前尝试次数
-    void reconnectAttempt(int attempt);
+    /// @param delayMs 本次尝试前的退避等待时间
+    void reconnectAttempt(int attempt, int delayMs);
+
+    /// publishTracked 的投递结果（QoS 0 为写入网络，QoS 1/2 为收到 Broker 确认）
+    void publishCompleted(quint64 tag, bool ok);
 
 private:
+    /// 根据目标状态（m_wantConnected）推进状态机
+    void advance();
+
+    /// 创建 Paho 客户端并设置回调
+    void createClient();
+
     /// 设置 Paho 回调
     void setupCallbacks();
 
-    /// 启动自动重连
-    void startReconnect();
+    /// 发起异步连接 / 断开
+    void startConnect();
+    void startDisconnect();
+
+    /// 异步操作结果（已转发到 Qt 线程）
+    void onConnectFinished(quint64 generation, bool ok, const QString& error);
+    void onDisconnectFinished(quint64 generation);
+    void onConnectionLost(const QString& cause);
+
+    /// 安排下一次重连（指数退避 + 抖动）
+    void scheduleReconnect();
 
     /// 停止自动重连
     void stopReconnect();
 
+    void setState(State state);
+
+    /// 发布失败时（所在线程）排队发出 publishCompleted，与 Paho 确认一样异步到达
+    void notifyDelivery(quint64 tag, bool ok);
+
+    /// Paho 回调与析构之间共享的存活标记
+    struct Liveness
+    {
+        std::mutex mutex;
+        bool alive = true;
+    };
+
+    /// 从 Paho 回调线程把 fn 投递到 self 所在线程执行；self 已析构（或正在析构）时丢弃
+    static void post(const std::shared_ptr<Liveness>& liveness, MqttClient* self, std::function<void()> fn);
+
+    std::shared_ptr<Liveness> m_liveness = std::make_shared<Liveness>();
+
     MqttConfig m_config;
     std::unique_ptr<mqtt::async_client> m_client;
+    mqtt::token_ptr m_pendingToken;     ///< 进行中的连接/断开请求（析构时等待其结束）
     std::atomic<bool> m_connected{false};
+    State m_state = State::Disconnected;
+    bool m_wantConnected = false;       ///< 调用方期望的连接状态
+    bool m_recreateClient = false;      ///< 配置变更，断开后重建客户端
+    quint64 m_generation = 0;           ///< 每次发起连接/断开递增，丢弃过期的回调
     int m_reconnectCount = 0;
     QTimer m_reconnectTimer;
 };
\ No newline at end of file
@@ -4,16 +4,22 @@
 #include <QTimer>
 #include <QElapsedTimer>
 #include <QJsonObject>
+#include <QThread>
 #include "core/mqtt_client.h"
 #include "data/detection_result_report.h"
 
+class MqttReportPublisher;
+class MqttOutbox;
+
 /**
  * MQTT 边云协同管理器
  *
- * 三个核心功能：
- * 1. 检测结果上报 — 检测完成后自动通过 MQTT 发送检测报告
- * 2. 云端指令执行 — 订阅云端下发的控制指令并转发为信号
+ * 核心功能：
+ * 1. 检测结果上报 — 检测完成后交给后台上报管线（聚合/限频/裁剪）再通过 MQTT 发送
+ * 2. 云端指令执行 — 订阅云端下发的控制指令并转发为信号，执行结果发布到 responseTopic；
+ *    record_start / record_stop 直接控制 SessionRecorder，收到的指令在录制期间一并写入会话文件
  * 3. 心跳保活 — 定时发送心跳表示设备在线
+ * 4. 运行指标 — 定时发送 MetricsRegistry 快照（帧率、队列深度、各步骤耗时等）
  */
 class MqttManager : public QObject
 {
@@ -40,22 +46,32 @@ public:
 
     // ==================== 功能1: 结果上报 ====================
 
-    /// 发布检测结果报告
+    /// 提交检测结果报告（立即返回，序列化与聚合在后台线程完成）
     void publishResult(const DetectionResultReport& report);
 
     /// 发布任意 JSON 消息到指定主题
     void publishJson(const QString& topic, const QJsonObject& json);
 
+    /// 发布指令执行结果到 responseTopic（fields 合并进消息体）
+    void publishCommandResponse(const QString& cmd, const QString& commandId, const QJsonObject& fields);
+
     // ==================== 功能3: 心跳控制 ====================
 
     void startHeartbeat();
     void stopHeartbeat();
 
+    // ==================== 功能4: 运行指标 ====================
+
+    void startMetrics();
+    void stopMetrics();
+
 signals:
     // ==================== 功能2: 云端指令信号 ====================
 
     /// 采集指令：立即执行一次检测
-    void captureRequested();
+    /// @param commandId 指令中的 id 字段（原样带回响应，可为空）
+    /// @param triggeredAt 收到指令的时刻（steady_clock 计数），用于计算触发到结果的耗时
+    void captureRequested(const QString& commandId, qint64 triggeredAt);
 
     /// 开始批量检测
     void startDetectionRequested();
@@ -75,12 +91,17 @@ private slots:
     void onMqttConnected();
     void onMqttMessageReceived(const QString& topic, const QString& payload);
     void onSendHeartbeat();
+    void onSendMetrics();
 
 private:
     void parseCommand(const QJsonObject& json);
 
     MqttClient* m_client = nullptr;
+    QThread m_reportThread;                             ///< 上报管线线程
+    MqttReportPublisher* m_reportPublisher = nullptr;   ///< 归属 m_reportThread
+    MqttOutbox* m_outbox = nullptr;                     ///< 离线发件箱，归属 m_reportThread
     QTimer m_heartbeatTimer;
+    QTimer m_metricsTimer;
     QElapsedTimer m_uptimeTimer;
     bool m_initialized = false;
 };
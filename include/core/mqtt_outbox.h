@@ -0,0 +1,120 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <memory>
+#include "config/mqtt_config.h"
+
+class QFile;
+class QTimer;
+
+/**
+ * MQTT 离线发件箱（运行在上报线程）
+ *
+ * 断线期间的上报消息追加写入磁盘分段日志，重连后按序限速补发，
+ * 收到投递确认后推进确认位置，整段确认完毕的分段文件直接删除。
+ *
+ * 目录结构：
+ *   mqtt_outbox/
+ *   ├── 00000000000000000001.seg   // 分段日志，文件名为段内首条序号
+ *   ├── ...
+ *   └── cursor                     // 已确认的最大连续序号
+ *
+ * 记录格式（小端序）：
+ *   u32 bodyLen | u16 crc16(body) | u16 保留 | body
+ *   body = u64 seq | u8 qos | u16 topicLen | topic(UTF-8) | payload（原始字节，JSON 或 CBOR）
+ * 启动时校验每条记录，截断末尾写了一半的记录。
+ *
+ * 投递语义为至少一次：失败或断线时从已确认位置重发，云端按 reportId / batchId 去重。
+ * 在线且无积压时消息直接发送，投递失败、断线或退出时仍未确认的消息再写入日志。
+ * 补发的 tag 带重发代数，rewind() 之前发出的消息迟到的确认直接忽略。
+ */
+class MqttOutbox : public QObject
+{
+    Q_OBJECT
+
+public:
+    MqttOutbox(const MqttConfig& config, const QString& directory, QObject* parent = nullptr);
+    ~MqttOutbox();
+
+    /// 打开目录、恢复未确认的记录（需在所属线程调用）
+    void open();
+
+    /// 提交一条待发布消息
+    void submit(const QString& topic, const QByteArray& payload, int qos);
+
+    /// 连接状态变化（连接后开始补发）
+    void setConnected(bool connected);
+
+    /// 投递结果（来自 MqttClient::publishCompleted）
+    void onPublishCompleted(quint64 tag, bool ok);
+
+signals:
+    /// 请求发送消息，tag 需原样带回 onPublishCompleted
+    void sendRequested(const QString& topic, const QByteArray& payload, int qos, quint64 tag);
+
+private:
+    struct Record {
+        quint64 seq = 0;
+        int qos = 0;
+        QString topic;
+        QByteArray payload;
+    };
+
+    struct Segment {
+        QString path;
+        quint64 firstSeq = 0;
+        quint64 lastSeq = 0;
+        qint64 size = 0;
+    };
+
+    bool hasBacklog() const { return m_ackedSeq + 1 < m_nextSeq; }
+
+    bool appendRecord(Record record);
+    bool openWriteSegment(quint64 firstSeq);
+    void closeWriteSegment();
+    void syncWriteSegment();
+    bool scanSegment(Segment& segment);
+    bool readNext(Record& out);
+    void rewind();
+    quint64 replayTag(quint64 seq) const;
+    /// 直发中未确认的消息按发送顺序写入日志
+    void spillDirect();
+    void pump();
+    void advanceAck();
+    void compact();
+    /// 容量上限（字节，outboxMaxMB）
+    qint64 quotaBytes() const;
+    void enforceQuota();
+    void persistCursor();
+    void onSyncTimer();
+
+    MqttConfig m_config;
+    QString m_dir;
+
+    QList<Segment> m_segments;
+    std::unique_ptr<QFile> m_writeFile;     ///< 当前追加分段（m_segments 最后一个）
+    std::unique_ptr<QFile> m_readFile;      ///< 补发读取位置
+    int m_readSegment = 0;
+    qint64 m_readOffset = 0;
+
+    quint64 m_nextSeq = 1;                  ///< 下一条记录序号
+    quint64 m_ackedSeq = 0;                 ///< 已确认的最大连续序号
+    quint64 m_sentSeq = 0;                  ///< 已交给客户端的最大序号
+    QSet<quint64> m_ackedAhead;             ///< 乱序到达、尚未连续的确认
+    int m_inflight = 0;
+    quint32 m_generation = 0;               ///< 重发代数，每次 rewind() 加一
+
+    QHash<quint64, Record> m_direct;        ///< 直发中的消息（失败后写入日志）
+    quint64 m_directCounter = 0;
+
+    bool m_connected = false;
+    bool m_unsynced = false;
+    bool m_cursorDirty = false;
+    QTimer* m_pumpTimer = nullptr;
+    QTimer* m_syncTimer = nullptr;
+};
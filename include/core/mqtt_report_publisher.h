@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include <QByteArray>
+#include "config/mqtt_config.h"
+#include "data/detection_result_report.h"
+#include "data/report_codec.h"
+
+class QTimer;
+
+/**
+ * 检测结果上报管线（运行在独立线程）
+ *
+ * 按 MqttConfig 的上报策略处理检测报告，只把最终要发送的消息交回 MqttManager：
+ * - reportIntervalMs = 0 且 reportOnStateChange = false：逐条上报（原有单报告格式）
+ * - 其余情况按时间窗口聚合，每个窗口发送一条 "batch" 消息：
+ *   summary 为窗口内全部报告的计数/通过率/按 ROI 统计/失败原因，
+ *   reports 为需要明细的报告（reportOnStateChange 时只保留状态变化的报告）
+ * - reportIntervalMs = 0 且 reportOnStateChange = true：状态变化时立即发送，
+ *   未变化的报告只计入统计，每秒汇总一次
+ * - reportRegions / reportBarcodes 关闭时裁剪检测项明细
+ * - 明细数达到 reportMaxBatch 时提前发送，避免单条消息过大
+ * - 消息按 payloadEncoding 编码为 JSON 或 CBOR（ReportCodec）
+ */
+class MqttReportPublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MqttReportPublisher(const MqttConfig& config, QObject* parent = nullptr);
+
+    /// 提交报告（任意线程调用，排队到工作线程处理）
+    void submit(const DetectionResultReport& report);
+
+    /// 发送当前窗口内尚未发送的数据（任意线程调用；wait 为 true 时阻塞到工作线程发送完，不可在工作线程调用）
+    void requestFlush(bool wait = false);
+
+signals:
+    /// 需要发布的消息（在工作线程发出，由 MqttManager 在其线程内发布）
+    void payloadReady(const QString& topic, const QByteArray& payload, int qos);
+
+private:
+    struct RoiCounter {
+        int total = 0;
+        int passed = 0;
+    };
+
+    void handleReport(const DetectionResultReport& report);
+    void flush();
+    void ensureTimer();
+    DetectionResultReport trimReport(const DetectionResultReport& report) const;
+    void emitPayload();
+
+    MqttConfig m_config;
+    ReportCodec::Format m_format = ReportCodec::Format::Json;
+    QByteArray m_buffer;    ///< 编码缓冲区（复用容量）
+    QTimer* m_flushTimer = nullptr;
+
+    // 当前窗口
+    qint64 m_windowStartMs = 0;
+    int m_total = 0;
+    int m_passed = 0;
+    QMap<QString, RoiCounter> m_byRoi;
+    QMap<QString, int> m_failReasons;
+    QVector<DetectionResultReport> m_pending;
+
+    /// ROI -> 上一次判定结果（用于状态变化检测）
+    QHash<QString, bool> m_lastState;
+};
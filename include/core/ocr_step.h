@@ -2,12 +2,25 @@
 
 #include "pipeline.h"
 #include "data/ocr_region.h"
+#include <QHash>
+#include <QMutex>
+#include <QRect>
 #include <QString>
 #include <QVector>
+#include <array>
+#include <atomic>
 #include <memory>
 
 class OcrLite;
+class OcrRecognizer;
 
+/**
+ * OCR 识别步骤
+ *
+ * Full 模式走 RapidOCR 全流程（det + cls + rec）；FixedRegions 模式跳过 det/cls，
+ * 把 ROI 内标定的全部文字区域交给 OcrRecognizer 一次批量识别。
+ * 启用缓存时按 ROI 记住各文字区域的感知哈希和识别结果，内容未变的区域直接复用。
+ */
 class StepOcrRecognition : public IPipelineStep
 {
 public:
@@ -15,10 +28,74 @@ public:
     ~StepOcrRecognition() override;
     void run(PipelineContext& ctx) override;
     StepType stepType() const override { return StepType::OcrRecognition; }
+    ContextFields reads() const override
+    {
+        return ContextField::OcrInputImage | ContextField::FilteredImage | ContextField::Enhanced;
+    }
+    ContextFields writes() const override { return ContextField::Ocr | ContextField::overlay(OverlayGroup::Ocr); }
+
+    /// 缓存统计（查找次数 / 命中次数，按文字区域计）
+    struct CacheStats
+    {
+        quint64 lookups = 0;
+        quint64 hits = 0;
+        double hitRate() const { return lookups > 0 ? double(hits) / lookups : 0.0; }
+    };
+    CacheStats cacheStats() const { return {m_cacheLookups.load(), m_cacheHits.load()}; }
+
+    /// 清除全部缓存（图像源切换时调用）
+    void resetCache();
+
+    /**
+     * 对比各模式单帧耗时：Full(det+cls+rec) / Full 跳过 cls / 固定区域批量识别 / 固定区域缓存命中
+     * 未配置固定区域时以 Full 模式检出的文本框作为固定区域
+     */
+    void benchmark(const cv::Mat& image, const OcrConfig& cfg, int iterations = 20);
 
 private:
-    void initRapidOcr();
+    /// 256 位差值哈希（33x8 灰度缩略图，横向相邻比较），对文字行的字符变化足够敏感
+    using TextHash = std::array<quint64, 4>;
+
+    struct TextBox
+    {
+        QRect rect;             // OCR输入图坐标
+        QString text;
+        float confidence = 0.f;
+        TextHash hash{};
+    };
+
+    /// 单个ROI的缓存
+    struct CacheSlot
+    {
+        cv::Size frameSize;     // 尺寸变化视为换图，直接失效
+        TextHash frameHash{};   // 整图哈希（Full 模式防止新文字出现在旧文本框之外）
+        QVector<TextBox> boxes;
+    };
+
+    /// 线程数（OcrConfig::numThreads）在首次初始化时生效
+    void initRapidOcr(int numThreads);
+    bool initRecognizer(int numThreads);
+
+    /// Full 模式：RapidOCR det + cls(可选) + rec
+    QVector<TextBox> detectFull(const cv::Mat& src, const OcrConfig& cfg);
+    /// FixedRegions 模式：批量识别固定区域，缓存命中的区域跳过推理
+    QVector<TextBox> recognizeFixed(const QString& roiId, const cv::Mat& src, const OcrConfig& cfg,
+                                    bool useCache, int& cachedCount, int& inferredCount);
+    /// Full 模式缓存：整图及上次每个文本框的哈希都在阈值内时复用上次结果
+    bool lookupFull(const QString& roiId, const cv::Mat& src, const OcrConfig& cfg, QVector<TextBox>& out);
+    void storeFull(const QString& roiId, const cv::Mat& src, const QVector<TextBox>& boxes);
+
+    static TextHash textHash(const cv::Mat& region);
+    static int hammingDistance(const TextHash& a, const TextHash& b);
+    void countLookups(quint64 lookups, quint64 hits);
 
     std::unique_ptr<OcrLite> m_ocr;
+    std::unique_ptr<OcrRecognizer> m_recognizer;
     bool m_initialized = false;
+    bool m_recognizerTried = false;
+
+    QHash<QString, CacheSlot> m_cache;      // roiId -> 缓存
+    mutable QMutex m_cacheMutex;            // 批量检测时多个ROI可能并发执行
+    std::atomic<quint64> m_cacheLookups{0};
+    std::atomic<quint64> m_cacheHits{0};
 };
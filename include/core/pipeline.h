@@ -1,5 +1,6 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include <cstdint>
 #include <QVector>
 #include <QVariantMap>
 #include <QJsonObject>
@@ -8,7 +9,9 @@
 #include <QRectF>
 #include "config/pipeline_config.h"
 #include "data/barcode_result.h"
+#include "data/caliper_result.h"
 #include "data/ocr_region.h"
+#include "data/overlay_model.h"
 #include "region_feature.h"
 #include "display_config.h"
 
@@ -28,6 +31,7 @@ struct PipelineContext
     // ========== 输入（execute时设置）==========
     const PipelineConfig* config = nullptr;  ///< 配置指针（指向调用方传入的config副本）
     cv::Mat srcBgr;                          ///< 原图(3通道)，即ROI裁剪后的图像
+    QString roiId;                           ///< 所属ROI（跨帧状态如条码跟踪按此分槽，空=当前视图）
 
     // ========== 图像处理流水线（各步骤按顺序填充）==========
     cv::Mat channelImg;      ///< 颜色通道输出（StepColorChannel）
@@ -49,6 +53,9 @@ struct PipelineContext
     int matchedLineCount = 0;    ///< 匹配的参考线数
     int totalLineCount = 0;      ///< 检测到的总直线数
 
+    // 卡尺测量
+    CaliperResult caliper;       ///< 卡尺测量结果（仅当Caliper步骤启用时有效）
+
     // 条码识别
     QVector<BarcodeResult> barcodeResults;  ///< 条码识别结果（仅当Barcode步骤启用时有效）
     QString barcodeStatus;
@@ -67,18 +74,68 @@ struct PipelineContext
 
     // ========== 可视化输出 ==========
     cv::Mat visualBase;       ///< 当前Tab应显示的图像
+    OverlayModel overlay;     ///< 矢量叠加层（框/线/标签），由 ImageView 绘制在底图之上，不写入像素
 
     // ========== 状态 ==========
     bool pass = true;         ///< Pipeline是否执行成功（非检测判定）
     QString reason;           ///< 状态/调试信息
 };
 
+/**
+ * PipelineContext 字段集合（位掩码）
+ *
+ * 步骤用它声明读写集，Pipeline 据此把步骤顺序编译成依赖图。
+ * 输入字段（config/srcBgr/roiId）对步骤只读，不在此列；
+ * reason 不参与依赖，最终取按步骤顺序最后一个修改它的步骤的值。
+ */
+using ContextFields = uint32_t;
+
+namespace ContextField {
+enum : ContextFields {
+    None            = 0,
+    ChannelImg      = 1u << 0,
+    Enhanced        = 1u << 1,
+    FilteredImage   = 1u << 2,
+    OcrInputImage   = 1u << 3,
+    FilterMask      = 1u << 4,
+    ExtractedMask   = 1u << 5,
+    Regions         = 1u << 6,    ///< regionCount / regionFeatures
+    LineResult      = 1u << 7,    ///< lineDetectImage / matchedLineCount / totalLineCount
+    Caliper         = 1u << 8,
+    Barcode         = 1u << 9,    ///< barcodeResults / barcodeStatus
+    Ocr             = 1u << 10,   ///< ocrText / ocrRegions
+    ObjectDetection = 1u << 11,
+    VisualBase      = 1u << 12,
+    Pass            = 1u << 13,
+    OverlayBase     = 1u << 16,   ///< 叠加层按分组占位：OverlayBase << OverlayGroup
+    All             = 0xFFFFFFFFu
+};
+
+/// 叠加层中某一分组对应的字段位
+constexpr ContextFields overlay(OverlayGroup group)
+{
+    return OverlayBase << static_cast<int>(group);
+}
+} // namespace ContextField
+
 class IPipelineStep
 {
 public:
     virtual ~IPipelineStep()=default;
     virtual void run(PipelineContext& ctx)=0;
     virtual StepType stepType() const=0;
+
+    /**
+     * 读写集声明（ContextField 位掩码）
+     *
+     * 互不依赖的步骤会在各自的上下文副本上并发执行，因此：
+     * - reads() 必须覆盖 run() 读取的全部非输入字段
+     * - writes() 必须覆盖 run() 可能修改的全部字段（含叠加层分组）
+     * - 不得原地改写从前序步骤继承来的图像数据（cv::Mat 副本共享像素）
+     * 默认全集：与前后所有步骤串行，未声明的步骤行为不变。
+     */
+    virtual ContextFields reads() const { return ContextField::All; }
+    virtual ContextFields writes() const { return ContextField::All; }
 };
 
 
@@ -113,9 +170,14 @@ public:
     // 获取指定索引的步骤（非const版本）
     IPipelineStep* getStep(int index);
     
-    // 执行所有步骤
+    // 执行所有步骤：按读写集编译依赖图，无关分支并发执行
     void run(PipelineContext& ctx);
 
+    // 单次执行的最大并发分支数（含调用线程），1 = 严格按顺序串行
+    void setMaxParallelBranches(int n);
+    int maxParallelBranches() const { return maxParallelBranches_; }
+
 private:
     std::vector<std::unique_ptr<IPipelineStep>> steps_;
+    int maxParallelBranches_;
 };
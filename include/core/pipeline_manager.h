@@ -36,7 +36,7 @@ public:
 
     /// 获取配置的可变引用（UI线程直接读写，替代大量 trivial setter）
     [[deprecated("使用 updateConfig() 替代")]]
-    PipelineConfig& mutableConfig() { return m_config; }
+    PipelineConfig& mutableConfig() { touchConfig(); return m_config; }
 
     /// 获取配置的常量引用
     const PipelineConfig& config() const override { return m_config; }
@@ -48,13 +48,18 @@ public:
     void setConfig(const PipelineConfig& config) override {
         m_config = config;
         m_algorithmQueue = config.algorithmQueue;
+        touchConfig();
     }
 
     /// 批量修改配置（推荐方式）
     void updateConfig(std::function<void(PipelineConfig&)> updater) override {
         updater(m_config);
+        touchConfig();
     }
 
+    /// 配置修订号：每次修改当前配置递增（调度器据此缓存变化门控的配置指纹）
+    quint64 configRevision() const { return m_configRevision.loadAcquire(); }
+
     // ========== 步骤控制 ==========
 
     /// 启用/禁用指定步骤（调用后需 rebuildPipeline 生效）
@@ -77,9 +82,10 @@ public:
     // ========== Pipeline执行 ==========
 
     // 执行Pipeline处理（可在后台线程调用）
-    // 输入：BGR图像 + 配置（步骤通过 ctx.config 读取）
+    // 输入：BGR图像 + 配置（步骤通过 ctx.config 读取）+ 所属ROI（用于跨帧跟踪）
     // 返回：处理结果上下文
-    PipelineContext execute(const cv::Mat& inputImage, const PipelineConfig& config);
+    PipelineContext execute(const cv::Mat& inputImage, const PipelineConfig& config,
+                            const QString& roiId = {});
 
     // 获取最后一次执行的上下文（线程安全，返回拷贝）
     PipelineContext getLastContext() const override {
@@ -97,11 +103,17 @@ public:
     // 快速重新渲染上次Pipeline结果
     cv::Mat getLastDisplayWithMode(DisplayConfig::Mode mode) const;
 
+    /// 上次Pipeline结果在指定显示模式下的矢量叠加层
+    OverlayModel getLastOverlayWithMode(DisplayConfig::Mode mode) const;
+
     bool hasLastResult() const;
 
     /// 清除上次Pipeline结果（图片切换时调用，防止旧结果污染新图片显示）
     void clearLastResult();
 
+    /// 清除步骤的跨帧状态（条码跟踪、OCR 结果缓存）并释放图像缓冲池，图像源切换时调用，避免沿用上一个源的识别结果
+    void resetSourceState();
+
     // ========== per-ROI缓存 ===========
 
     /// 将Pipeline结果存入指定ROI的缓存
@@ -116,6 +128,9 @@ public:
     /// 获取指定ROI的缓存渲染图像
     cv::Mat getCachedDisplay(const QString& roiId, DisplayConfig::Mode mode) const;
 
+    /// 获取指定ROI缓存结果的矢量叠加层
+    OverlayModel getCachedOverlay(const QString& roiId, DisplayConfig::Mode mode) const;
+
     /// 清除指定ROI的缓存
     void clearCachedResult(const QString& roiId);
 
@@ -145,6 +160,7 @@ signals:
 
 private:
     void initPipeline();
+    void touchConfig() { m_configRevision.fetchAndAddRelease(1); }
 
 private:
     // 互斥锁：保护 m_lastContext（UI线程读取，execute写入）
@@ -152,6 +168,7 @@ private:
 
     // 配置（仅在UI线程读写，不需要锁保护）
     PipelineConfig m_config;
+    QAtomicInteger<quint64> m_configRevision{0};
 
     // 原子标志：后台Pipeline是否正在运行（仅用于reset安全）
     QAtomicInt m_pipelineRunning{0};
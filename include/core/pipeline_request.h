@@ -2,6 +2,7 @@
 
 #include <opencv2/core.hpp>
 #include "config/pipeline_config.h"
+#include "data/frame_view.h"
 #include <QAtomicInt>
 #include <QString>
 #include <chrono>
@@ -13,82 +14,61 @@
  * 1. 一旦创建就不能修改，确保线程安全
  * 2. 包含执行所需的所有信息
  * 3. 唯一标识符用于去重和取消
+ *
+ * 图像以 FrameView 持有：拷贝请求、快照、跨线程传递都只增加引用计数，不拷贝像素。
+ * roiId 透传给 PipelineManager::execute()，跨帧状态（条码跟踪等）按它分槽。
  */
 class PipelineRequest
 {
 public:
-    PipelineRequest(const cv::Mat& image, const PipelineConfig& config, int priority = 0, const QString& caller = {})
-        : m_image(image.clone())
+    PipelineRequest(const FrameView& frame, const PipelineConfig& config, int priority = 0, const QString& caller = {},
+                    const QString& roiId = {})
+        : m_frame(frame)
         , m_config(config)
         , m_priority(priority)
         , m_timestamp(std::chrono::steady_clock::now().time_since_epoch().count())
         , m_id(s_nextId.fetchAndAddOrdered(1))
         , m_caller(caller)
+        , m_roiId(roiId)
     {
     }
 
-    // 移动构造和赋值
-    PipelineRequest(PipelineRequest&&) = default;
-    PipelineRequest& operator=(PipelineRequest&&) = default;
-
-    // 拷贝构造和赋值（深拷贝图像）
-    PipelineRequest(const PipelineRequest& other)
-        : m_image(other.m_image.clone())
-        , m_config(other.m_config)
-        , m_priority(other.m_priority)
-        , m_timestamp(other.m_timestamp)
-        , m_id(other.m_id)
-        , m_caller(other.m_caller)
-    {
-    }
-    
-    PipelineRequest& operator=(const PipelineRequest& other)
+    PipelineRequest(const cv::Mat& image, const PipelineConfig& config, int priority = 0, const QString& caller = {},
+                    const QString& roiId = {})
+        : PipelineRequest(FrameView(image), config, priority, caller, roiId)
     {
-        if (this != &other) {
-            m_image = other.m_image.clone();
-            m_config = other.m_config;
-            m_priority = other.m_priority;
-            m_timestamp = other.m_timestamp;
-            m_id = other.m_id;
-            m_caller = other.m_caller;
-        }
-        return *this;
     }
 
+    // 拷贝/移动：图像视图共享缓冲
+    PipelineRequest(const PipelineRequest&) = default;
+    PipelineRequest& operator=(const PipelineRequest&) = default;
+    PipelineRequest(PipelineRequest&&) = default;
+    PipelineRequest& operator=(PipelineRequest&&) = default;
+
     // 只读访问
-    const cv::Mat& image() const { return m_image; }
+    const cv::Mat& image() const { return m_frame.mat(); }
+    const FrameView& frame() const { return m_frame; }
     const PipelineConfig& config() const { return m_config; }
     int priority() const { return m_priority; }
-    qint64 timestamp() const { return m_timestamp; }
+    qint64 timestamp() const { return m_timestamp; }   ///< 提交时刻（steady_clock 计数）
     qint64 id() const { return m_id; }
     const QString& caller() const { return m_caller; }
+    const QString& roiId() const { return m_roiId; }   ///< 所属ROI（空=当前视图）
 
-    // 创建快照（深拷贝图像，保留 ID 和 caller）
+    // 创建快照（共享图像视图，保留 ID、caller 和提交时间戳，供计算帧龄）
     PipelineRequest snapshot() const
     {
-        PipelineRequest req(m_image, m_config, m_priority, m_caller);
-        req.m_id = m_id;  // 保留原始 ID
-        return req;
+        return PipelineRequest(*this);
     }
 
 private:
-    // 带 ID 的构造（仅用于 snapshot）
-    PipelineRequest(const cv::Mat& image, const PipelineConfig& config, int priority, const QString& caller, qint64 id)
-        : m_image(image.clone())
-        , m_config(config)
-        , m_priority(priority)
-        , m_timestamp(std::chrono::steady_clock::now().time_since_epoch().count())
-        , m_id(id)
-        , m_caller(caller)
-    {
-    }
-
-    cv::Mat m_image;
+    FrameView m_frame;
     PipelineConfig m_config;
     int m_priority;
     qint64 m_timestamp;
     qint64 m_id;
     QString m_caller;
+    QString m_roiId;
 
     // 全局ID生成器
     static QAtomicInt s_nextId;
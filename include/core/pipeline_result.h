@@ -3,6 +3,7 @@
 #include "pipeline_request.h"
 #include "pipeline.h"
 #include <QString>
+#include <chrono>
 
 /**
  * Pipeline结果 - 不可变值对象
@@ -32,6 +33,12 @@ public:
     bool isSuccess() const { return m_success; }
     QString errorMessage() const { return m_errorMessage; }
     qint64 requestId() const { return m_request.id(); }
+    /// 帧龄：请求提交到执行完成（ms），含排队等待
+    double frameAgeMs() const
+    {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::duration(m_completedAt - m_request.timestamp())).count();
+    }
 
 private:
     PipelineResult(PipelineRequest request, PipelineContext context, 
@@ -41,6 +48,7 @@ private:
         , m_success(success)
         , m_errorMessage(std::move(error))
         , m_elapsedMs(elapsedMs)
+        , m_completedAt(std::chrono::steady_clock::now().time_since_epoch().count())
     {
     }
 
@@ -49,4 +57,5 @@ private:
     bool m_success;
     QString m_errorMessage;
     double m_elapsedMs;
+    qint64 m_completedAt;
 };
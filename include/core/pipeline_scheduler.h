@@ -9,6 +9,9 @@
 #include <QAtomicInt>
 #include "pipeline_request.h"
 #include "pipeline_result.h"
+#include "change_gate.h"
+#include <QHash>
+#include <unordered_map>
 
 class PipelineManager;
 
@@ -20,9 +23,11 @@ class PipelineManager;
  * 2. 消抖合并：短时间内多个请求只执行最后一个
  * 3. 去重过滤：相同配置的请求不重复执行
  * 4. 优先级队列：高优先级请求优先执行
+ * 5. 流式槽：实时视频每个来源只保留最新一帧，空闲即派发
  * 
  * 数据流：
  *   submit() → 队列 → 消抖 → 去重 → 线程池执行 → finished信号
+ *   submitLatest() → 变化门控 → 流式槽（新帧覆盖旧帧） → 立即执行 → finished信号
  */
 class PipelineScheduler : public QObject
 {
@@ -40,9 +45,17 @@ public:
      * @param config Pipeline配置
      * @param priority 优先级（数值越大优先级越高）
      * @param caller 调用者标识（用于日志追踪）
+     * @param roiId 所属ROI（跨帧跟踪按此分槽，空=当前视图）
      * @return 请求ID，可用于取消
      */
-    qint64 submit(const cv::Mat& image, const PipelineConfig& config, int priority = 0, const QString& caller = {});
+    qint64 submit(const cv::Mat& image, const PipelineConfig& config, int priority = 0, const QString& caller = {},
+                  const QString& roiId = {});
+
+    /**
+     * 提交pipeline执行请求（帧视图，ROI 不拷贝像素）
+     */
+    qint64 submit(const FrameView& frame, const PipelineConfig& config, int priority = 0, const QString& caller = {},
+                  const QString& roiId = {});
 
     /**
      * 提交pipeline执行请求（使用PipelineRequest对象）
@@ -50,7 +63,30 @@ public:
     qint64 submit(PipelineRequest request);
 
     /**
-     * 取消指定请求
+     * 流式提交（实时视频）：每个 source 只保留一个待处理槽，新帧覆盖尚未开始执行的旧帧；
+     * 不经过消抖，工作线程空闲时立即派发，完成时 PipelineResult::frameAgeMs() 给出帧龄。
+     * 相机到结果的延迟因此不超过两次 Pipeline 耗时，与帧率无关。
+     *
+     * config.changeGate 启用时先经变化门控：相对该 source 上次执行的帧无明显变化且配置未变则不执行，
+     * 直接重发上次结果（该 source 仍有请求等待或执行、或结果尚未返回时丢弃本帧）。
+     * config 须为 PipelineManager 当前配置的快照：配置指纹按 configRevision() 缓存
+     * @param source 帧来源（通常为 图片ID/ROI ID），同时作为门控状态键
+     * @param roiId 所属ROI（跨帧跟踪按此分槽）
+     * @return 请求ID；被门控跳过时返回 -1
+     */
+    qint64 submitLatest(const QString& source, const FrameView& frame, const PipelineConfig& config,
+                        const QString& caller = {}, const QString& roiId = {});
+
+    /// 清除门控参考帧及缓存结果（图像源切换时调用）
+    void resetChangeGate();
+    ChangeGate::Stats changeGateStats() const { return m_changeGate.stats(); }
+    /// source 尚未返回结果的流式请求（等待或执行中），没有则返回 -1
+    qint64 pendingStreamRequest(const QString& source) const { return m_streamSources.key(source, -1); }
+    /// source 最近一次成功的流式结果（门控跳过时重发的结果），没有则返回 nullptr
+    const PipelineResult* lastStreamResult(const QString& source) const;
+
+    /**
+     * 取消指定请求（普通队列或流式槽中尚未开始执行的请求）
      */
     void cancel(qint64 requestId);
 
@@ -67,6 +103,7 @@ public:
      * 默认：100ms
      */
     void setDebounceMs(int ms);
+    int debounceMs() const { return m_debounceMs; }
 
     /**
      * 设置最大队列长度
@@ -117,6 +154,10 @@ private:
     void processNext();
     void executeRequest(const PipelineRequest& request);
     void emitQueueChanged();
+    /// 变化门控判定；无变化时重发该 source 的上次结果并返回 false
+    bool passChangeGate(const QString& source, const FrameView& frame, const PipelineConfig& config);
+    /// 流式请求未执行（被取消/失败）时清除其参考帧，避免后续相同帧被误判为无变化
+    void forgetStreamRequest(qint64 requestId);
 
     PipelineManager* m_pipeline;
 
@@ -135,6 +176,19 @@ private:
     QAtomicInt m_lastSubmittedId{0};
     QAtomicInt m_lastExecutedId{0};
 
+    // 流式槽：每个 source 一个待处理请求，按到达顺序轮转派发（受 m_queueMutex 保护）
+    std::unordered_map<QString, PipelineRequest> m_streamSlots;
+    QStringList m_streamOrder;
+    bool m_lastWasStream = false;
+
+    // 流式请求ID -> source；变化门控及各 source 上次成功结果
+    QHash<qint64, QString> m_streamSources;
+    ChangeGate m_changeGate;
+    quint64 m_gateRevision = 0;         // m_gateFingerprint 对应的配置修订号
+    size_t m_gateFingerprint = 0;
+    bool m_gateFingerprintValid = false;
+    std::unordered_map<QString, PipelineResult> m_lastStreamResults;
+
     // 当前执行的任务
     QFutureWatcher<PipelineResult>* m_watcher = nullptr;
 };
@@ -10,6 +10,8 @@ class StepColorChannel:public IPipelineStep
 public:
     void run(PipelineContext &ctx) override;
     StepType stepType() const override { return StepType::ColorChannel; }
+    ContextFields reads() const override { return ContextField::None; }
+    ContextFields writes() const override { return ContextField::ChannelImg | ContextField::VisualBase; }
 };
 
 // 2) 增强参数
@@ -20,6 +22,8 @@ public:
 
     void run(PipelineContext& ctx) override;
     StepType stepType() const override { return StepType::Enhance; }
+    ContextFields reads() const override { return ContextField::ChannelImg; }
+    ContextFields writes() const override { return ContextField::Enhanced | ContextField::VisualBase; }
 private:
     ImageProcessor* proc_ = nullptr;
 };
@@ -31,6 +35,8 @@ public:
     StepFilter(ImageProcessor* proc) : m_processor(proc) {}
     void run(PipelineContext& ctx) override;
     StepType stepType() const override { return StepType::Filter; }
+    ContextFields reads() const override { return ContextField::Enhanced; }
+    ContextFields writes() const override { return ContextField::FilterMask; }
 private:
     ImageProcessor* m_processor = nullptr;
 };
@@ -44,6 +50,8 @@ public:
 
     void run(PipelineContext& ctx) override;
     StepType stepType() const override { return StepType::AlgorithmQueue; }
+    ContextFields reads() const override { return ContextField::FilterMask | ContextField::Enhanced; }
+    ContextFields writes() const override { return ContextField::ExtractedMask; }
 private:
     ImageProcessor* m_processor = nullptr;
     const QVector<AlgorithmStep>* m_algorithmQueue = nullptr;
@@ -55,6 +63,8 @@ class StepShapeFilter : public IPipelineStep
 public:
     void run(PipelineContext& ctx) override;
     StepType stepType() const override { return StepType::ShapeFilter; }
+    ContextFields reads() const override { return ContextField::FilterMask; }
+    ContextFields writes() const override { return ContextField::Regions | ContextField::ExtractedMask; }
 private:
     cv::Mat applyFilter(const cv::Mat& regions, const ShapeFilterConfig& config);
 
@@ -69,15 +79,31 @@ class StepLineDetector : public IPipelineStep
 public:
     void run(PipelineContext& ctx) override;
     StepType stepType() const override { return StepType::LineDetector; }
+    ContextFields reads() const override { return ContextField::VisualBase; }
+    ContextFields writes() const override { return ContextField::LineResult | ContextField::overlay(OverlayGroup::Line); }
 private:
     void runLineDetect(PipelineContext& ctx);
     void runReferenceLineMatch(PipelineContext& ctx);
 };
 
+// 卡尺测量（路径复用参考线，沿法向取剖面做亚像素边缘 + 鲁棒拟合）
+class StepCaliper : public IPipelineStep
+{
+public:
+    void run(PipelineContext& ctx) override;
+    StepType stepType() const override { return StepType::Caliper; }
+    ContextFields reads() const override { return ContextField::VisualBase; }
+    ContextFields writes() const override { return ContextField::Caliper | ContextField::overlay(OverlayGroup::Caliper); }
+private:
+    void appendOverlay(PipelineContext& ctx, const cv::Point2f& start, const cv::Point2f& end) const;
+};
+
 // 滤波去噪
 class StepImageFilter : public IPipelineStep
 {
 public:
     void run(PipelineContext& ctx) override;
     StepType stepType() const override { return StepType::ImageFilter; }
+    ContextFields reads() const override { return ContextField::Enhanced | ContextField::ChannelImg; }
+    ContextFields writes() const override { return ContextField::FilteredImage | ContextField::Enhanced; }
 };
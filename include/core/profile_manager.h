@@ -8,6 +8,8 @@
 
 class RoiManager;
 class PipelineManager;
+class QFileSystemWatcher;
+class QTimer;
 
 /**
  * @brief 检测方案管理器
@@ -17,6 +19,12 @@ class PipelineManager;
  * 2. 管理已保存的方案列表（浏览、加载、删除）
  * 3. 管理方案中的模板库（保存模板、加载模板）
  * 4. 方案的持久化存储
+ *
+ * 启动时只建立轻量目录（名称、ROI/模板数量、缩略图、修改时间），
+ * 目录缓存到用户缓存目录（不在被监视的 profiles 目录内，写缓存不会触发重新扫描），
+ * profile.json 未变化的方案不再解析；
+ * 完整方案在查看/应用时才加载，模板图像在应用或取用时才加载。
+ * 文件监视器发现方案目录变化后增量刷新对应条目。
  */
 class ProfileManager : public QObject
 {
@@ -45,14 +53,15 @@ public:
         QDateTime updatedAt;
         int roiCount;
         int templateCount;
+        QString thumbnailPath;  ///< 缩略图绝对路径（不存在时为空）
     };
     QList<ProfileSummary> getProfileList() const;
 
     /// 删除方案
     bool deleteProfile(const QString& profileId);
 
-    /// 获取方案详情
-    InspectionProfile getProfile(const QString& profileId) const;
+    /// 获取方案详情（未加载时从磁盘加载并缓存）
+    InspectionProfile getProfile(const QString& profileId);
 
     // ==================== 模板管理 ====================
 
@@ -70,8 +79,8 @@ public:
                                  QVector<QPointF>& outPolygonPoints,
                                  int& outMatchMethod);
 
-    /// 获取方案中所有模板名称
-    QStringList getTemplateNames(const QString& profileId) const;
+    /// 获取方案中所有模板名称（未加载时从磁盘加载并缓存）
+    QStringList getTemplateNames(const QString& profileId);
 
     /// 从方案中移除模板
     bool removeTemplateFromProfile(const QString& profileId,
@@ -97,9 +106,35 @@ signals:
     void templateRemoved(const QString& profileId, const QString& templateName);
 
 private:
-    /// 扫描方案目录，构建内存缓存
+    /// 方案目录条目
+    struct CatalogEntry {
+        ProfileSummary summary;
+        QString dirName;        ///< 方案子目录名
+        qint64 mtimeMs = 0;     ///< profile.json 修改时间
+        qint64 fileSize = 0;    ///< profile.json 大小
+    };
+
+    /// 扫描方案目录，增量更新目录（只重新解析有变化的 profile.json）
     void scanProfiles();
 
+    /// 读取子目录的 profile.json 摘要，失败返回 false
+    bool readCatalogEntry(const QString& dirName, CatalogEntry& entry) const;
+
+    /// 目录缓存文件读写
+    QString catalogCachePath() const;
+    void loadCatalogCache();
+    void saveCatalogCache() const;
+
+    /// 获取完整方案（按需从磁盘加载，不含模板图像）
+    InspectionProfile* ensureLoaded(const QString& profileId);
+
+    /// 保存方案到磁盘并同步目录条目
+    bool persistProfile(InspectionProfile& profile);
+
+    /// 文件监视
+    void updateWatchedPaths();
+    void scheduleRefresh();
+
     /// 检查方案目录是否存在
     void ensureProfilesDir() const;
 
@@ -107,6 +142,12 @@ private:
     PipelineManager* m_pipelineManager;
     QString m_activeProfileId;  ///< 当前活跃的方案ID
 
-    /// 内存缓存：profileId -> InspectionProfile
-    QMap<QString, InspectionProfile> m_profiles;
+    /// 轻量目录：profileId -> 摘要
+    QMap<QString, CatalogEntry> m_catalog;
+
+    /// 已加载的完整方案：profileId -> InspectionProfile
+    QMap<QString, InspectionProfile> m_loaded;
+
+    QFileSystemWatcher* m_watcher;
+    QTimer* m_refreshTimer;     ///< 合并短时间内的多次文件变化
 };
\ No newline at end of file
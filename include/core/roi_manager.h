@@ -7,6 +7,7 @@
 #include <QVector>
 #include "config/roi_config.h"
 #include "data/inspection_profile.h"
+#include "data/frame_view.h"
 
 // 前向声明
 class ImageView;
@@ -66,6 +67,11 @@ public:
      */
     cv::Mat getCurrentImage() const;
 
+    /**
+     * @brief 获取当前帧视图（源图 + 激活ROI矩形，不拷贝像素）
+     */
+    FrameView getCurrentFrame() const;
+
     /**
      * @brief 设置ROI区域并激活（单ROI模式兼容）
      *        如果该矩形对应的ROI已存在则激活它，否则创建新ROI并激活
@@ -163,4 +169,5 @@ public:
 private:
     QString generateDefaultRoiName();
     QString generateDefaultImageName();
+    void updateImageMemoryMetric() const;   ///< 已加载图像占用写入 edgevision_subsystem_bytes
 };
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "config/pipeline_config.h"
+#include "config/roi_config.h"
+#include "data/frame_view.h"
+#include "data/session_file.h"
+
+/**
+ * @brief 检测会话录制器：把生产运行的 Pipeline 输入和外部指令写入一个 .evs 文件
+ *
+ * 录制点：MainWindow 提交（实时视频/交互/capture 指令）、AutoDetectionController 的逐 ROI 检测、
+ * MqttManager 收到的指令。录制的帧可由 SessionReplayer 按原始节奏或全速回放。
+ *
+ * 调用方只做配置序列化与去重（配置按内容、图像按源图缓冲），图像压缩和写文件在后台 "record" 线程完成；
+ * 待压缩帧超过 maxPendingFrames 时丢弃新帧并计数，录制不会拖慢 Pipeline 提交。
+ * 文件大小或时长达到上限时 record 线程自行结束录制（写入结束标记并关闭文件）。
+ * 所有接口线程安全；未录制时 isRecording() 只是一次原子读取。
+ */
+class SessionRecorder
+{
+public:
+    /// 帧的提交方式（回放时按同样的方式提交给调度器）
+    enum class Origin
+    {
+        Live,           ///< 实时视频：submitLatest 流式槽
+        Interactive,    ///< 界面刷新 / capture 指令：submit
+        Batch           ///< 自动检测逐 ROI 执行
+    };
+
+    struct Options
+    {
+        QString imageFormat = "jpg";    ///< jpg（有损，体积小）/ png（无损，回放结果逐像素一致）
+        int jpegQuality = 90;
+        int maxPendingFrames = 16;      ///< 待压缩帧上限，超出丢帧
+        qint64 maxBytes = 0;            ///< 文件大小上限（字节），0 不限制
+        int maxDurationSec = 0;         ///< 录制时长上限（秒），0 不限制
+    };
+
+    static SessionRecorder& instance();
+
+    /// 开始录制到 path（已在录制时先停止）
+    bool start(const QString& path, const Options& options = {});
+    /**
+     * @brief 停止录制：丢弃尚未压缩的图像及引用它们的帧（计入丢弃数），
+     *        等待 record 线程写完已就绪的记录、结束标记并关闭文件；至多等待一帧图像压缩
+     */
+    void stop();
+
+    bool isRecording() const { return m_recording.load(std::memory_order_acquire); }
+    QString path() const;
+
+    /**
+     * @brief 记录一次 Pipeline 输入
+     * @param source 帧来源（图片ID/ROI ID），实时视频回放时作为流式槽键
+     * @param frame 输入帧视图（源图整幅压缩存储，ROI 矩形单独记录）
+     * @param roi 所属 ROI 配置快照（可为空）
+     */
+    void recordFrame(Origin origin, const QString& source, const FrameView& frame,
+                     const PipelineConfig& config, const RoiConfig* roi = nullptr);
+
+    /// 记录一条外部指令
+    void recordCommand(const QJsonObject& command);
+
+    static QString originName(Origin origin);
+    static Origin originFromName(const QString& name);
+
+    /// 默认录制路径：<应用数据目录>/sessions/session_<时间>.evs（程序目录可能不可写）
+    static QString defaultPath();
+
+private:
+    SessionRecorder() = default;
+    ~SessionRecorder();
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    struct Job
+    {
+        int type = 0;           ///< SessionFile::RecordType
+        qint64 timeNs = 0;
+        QByteArray payload;     ///< 已编码的 CBOR 负载（Image 记录为空）
+        cv::Mat image;          ///< Image 记录待压缩的源图
+        int imageId = 0;        ///< Image：图像编号；Frame：引用的图像编号
+    };
+
+    void run();
+    /// 丢弃队列中尚未压缩的图像及引用它们的帧。调用方持有 m_mutex
+    void discardPendingImagesLocked();
+    /// 文件大小或时长是否达到上限（由 record 线程调用），reason 返回说明
+    bool limitReached(QString* reason) const;
+    qint64 elapsedNs() const;
+    /// encoded 为配置快照的 CBOR；首次出现时排入 Config 记录。调用方持有 m_mutex
+    int configIdLocked(const QByteArray& encoded, qint64 timeNs);
+    void enqueueLocked(Job&& job);
+
+    Options m_options;
+    QString m_path;
+    SessionFile::Writer m_writer;           ///< 录制期间仅由 record 线程写入
+    std::thread m_thread;
+    std::atomic<bool> m_recording{false};
+    qint64 m_startNs = 0;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_jobs;
+    int m_pendingImages = 0;
+    bool m_stopping = false;
+
+    // 去重状态（受 m_mutex 保护）
+    QHash<QByteArray, int> m_configIds;     ///< 配置内容 SHA-1 -> 编号
+    cv::Mat m_lastSource;                   ///< 最近写入的源图（持有引用，缓冲不会被复用）
+    int m_lastImageId = 0;
+    int m_nextImageId = 1;
+    int m_frames = 0;
+    int m_commands = 0;
+    int m_dropped = 0;
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <opencv2/core.hpp>
+#include "config/pipeline_config.h"
+#include "core/session_recorder.h"
+#include "data/session_file.h"
+
+class PipelineManager;
+class PipelineResult;
+
+/**
+ * @brief 会话回放：把 .evs 录制文件中的帧重新送入 PipelineManager 的调度器
+ *
+ * Original：按录制时的时间间隔提交，提交方式与生产一致（实时视频走 submitLatest 流式槽，
+ *           其余走 submit），可复现生产时的丢帧、门控和排队行为。
+ * Fast：    前一帧结果返回后立即提交下一帧（统一走 submit，回放期间消抖置 0），
+ *           测量 Pipeline 在真实产线流量上的极限吞吐。
+ *
+ * 录制的指令按时间点通过 commandReplayed 发出，由调用方决定是否执行；
+ * 录制文件中的 RoiConfig 快照只用于离线查看（检测项等），重新执行只需要 PipelineConfig。
+ * 下一帧的图像在当前帧执行期间后台解码，解码不计入 Pipeline 耗时。
+ * 所有接口在 GUI 线程调用。
+ */
+class SessionReplayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Pace
+    {
+        Original,
+        Fast
+    };
+
+    struct Report
+    {
+        int frames = 0;             ///< 录制帧数
+        int submitted = 0;          ///< 提交给调度器的请求数
+        int completed = 0;
+        int failed = 0;
+        int skipped = 0;            ///< 未执行：变化门控跳过 / 流式槽中被新帧覆盖
+        int commands = 0;
+        double wallMs = 0;          ///< 回放总耗时
+        double throughputFps = 0;   ///< completed / wallMs
+        double meanMs = 0;          ///< Pipeline 执行耗时
+        double p50Ms = 0;
+        double p95Ms = 0;
+        double latencyP50Ms = 0;    ///< 提交到结果返回（含排队）
+        double latencyP95Ms = 0;
+        double maxLagMs = 0;        ///< Original：实际提交时刻落后录制时刻的最大值
+
+        QJsonObject toJson() const;
+    };
+
+    explicit SessionReplayer(PipelineManager* pipeline, QObject* parent = nullptr);
+    ~SessionReplayer() override;
+
+    /// 读取录制文件（配置与帧索引常驻内存，图像按需读取解码）
+    bool open(const QString& path);
+
+    void start(Pace pace);
+    void stop();
+
+    bool isRunning() const { return m_running; }
+    int frameCount() const { return m_frameCount; }
+    /// 录制时长（ms）
+    double durationMs() const;
+    const Report& report() const { return m_report; }
+
+signals:
+    void commandReplayed(const QJsonObject& command);
+    void progress(int framesDone, int frameCount);
+    void replayFinished(const SessionReplayer::Report& report);
+
+private:
+    struct Event
+    {
+        SessionFile::RecordType type = SessionFile::RecordType::Frame;
+        qint64 timeNs = 0;
+        int record = 0;             ///< Command：记录索引
+        int imageId = 0;            ///< Frame
+        int configId = 0;
+        cv::Rect roi;
+        SessionRecorder::Origin origin = SessionRecorder::Origin::Interactive;
+        QString source;
+        QString roiId;              ///< 所属 ROI（提交时随请求带出，结果按 ROI 归属）
+    };
+
+    void step();
+    void dispatchFrame(const Event& event);
+    void onPipelineFinished(const PipelineResult& result);
+    void checkDrained();
+    void finish();
+
+    cv::Mat imageFor(int imageId);
+    /// 后台解码 index 之后第一帧的图像
+    void prefetchAfter(int index);
+
+    PipelineManager* m_pipeline;
+    SessionFile::Reader m_reader;
+    QVector<Event> m_events;
+    QHash<int, PipelineConfig> m_configs;   ///< 配置快照编号 -> PipelineConfig
+    QHash<int, int> m_imageRecords;     ///< imageId -> 记录索引
+    int m_frameCount = 0;
+
+    Pace m_pace = Pace::Original;
+    bool m_running = false;
+    int m_next = 0;
+    int m_appliedConfigId = 0;
+    int m_savedDebounceMs = -1;
+    qint64 m_waitingId = -1;            ///< Fast：等待结果的请求
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+    QTimer m_drainTimer;
+
+    int m_cachedImageId = 0;
+    cv::Mat m_cachedImage;
+    int m_prefetchId = 0;
+    QFuture<cv::Mat> m_prefetch;
+
+    QHash<qint64, qint64> m_inflight;   ///< requestId -> 提交时刻（回放时钟 ns）
+    std::vector<double> m_pipelineMs;
+    std::vector<double> m_latencyMs;
+    Report m_report;
+};
@@ -62,6 +62,8 @@ public:
 signals:
     void frameReady(const cv::Mat& frame);
     void playbackStateChanged(PlaybackState state);
+    /// 即将打开相机（设备被独占之前发出，占用同一设备的其他采集方须在此释放）
+    void aboutToOpenCamera(int cameraIndex);
     void videoOpened(const QString& source);
     void videoClosed();
     void errorOccurred(const QString& error);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QVector>
+#include <QPointF>
+#include <QString>
+
+/**
+ * 卡尺边缘点（亚像素）
+ */
+struct CaliperEdgePoint
+{
+    QPointF pos;            // 图像坐标（亚像素）
+    double amplitude = 0.0; // 带符号梯度幅值（正=暗→亮）
+    int caliper = -1;       // 所属卡尺序号
+    bool inlier = true;     // 鲁棒拟合后是否为内点
+};
+
+/**
+ * 卡尺测量结果
+ */
+struct CaliperResult
+{
+    bool valid = false;                     // 是否得到有效测量
+    int shape = 0;                          // 0=直线, 1=圆弧
+
+    QVector<CaliperEdgePoint> edges;        // 单边缘 / 边缘对的第一条边
+    QVector<CaliperEdgePoint> secondEdges;  // 边缘对的第二条边
+    QVector<double> widthsPx;               // 每个卡尺的边缘对宽度（像素，仅内点）
+
+    // 拟合几何（第一条边）
+    QPointF linePoint;                      // 直线上一点
+    QPointF lineDir;                        // 直线单位方向
+    QPointF circleCenter;
+    double circleRadius = 0.0;
+    double fitRmsPx = 0.0;                  // 内点残差均方根（像素）
+    int inlierCount = 0;
+
+    // 测量值（已乘像素当量）
+    // 直线单边缘=相对参考线的偏移；圆弧单边缘=直径；边缘对=平均宽度
+    double measuredUm = 0.0;
+    double stdDevUm = 0.0;                  // 单帧内各卡尺的离散度（重复性参考）
+
+    bool pass = true;
+    QString message;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+/**
+ * @brief 不可变帧视图：源图缓冲（引用计数共享）+ ROI 矩形
+ *
+ * mat() 返回源图的子 Mat 视图，不拷贝像素；多个 ROI、调度请求、后台线程可共享同一缓冲。
+ * 约定视图只读：Pipeline 步骤把结果写入新的输出 Mat，需要原地修改时先 materialize()。
+ * 源图在视图存活期间不会被释放（cv::Mat 引用计数），持有方替换图像时只替换 Mat 头，不改写像素。
+ */
+class FrameView
+{
+public:
+    FrameView() = default;
+
+    /// 包装整幅图像（共享缓冲，不拷贝）
+    explicit FrameView(const cv::Mat& source)
+        : m_source(source)
+        , m_roi(0, 0, source.cols, source.rows)
+        , m_view(source)
+    {
+    }
+
+    /// 源图上的 ROI 视图；roi 会被裁剪到图像范围内，裁剪后为空时退化为整图
+    FrameView(const cv::Mat& source, const cv::Rect& roi)
+        : m_source(source)
+    {
+        const cv::Rect clipped = roi & cv::Rect(0, 0, source.cols, source.rows);
+        m_roi = clipped.empty() ? cv::Rect(0, 0, source.cols, source.rows) : clipped;
+        m_view = source.empty() ? cv::Mat() : source(m_roi);
+    }
+
+    /// 在当前视图内再裁剪（rect 为当前视图坐标）；与视图无交集时返回当前视图
+    FrameView crop(const cv::Rect& rect) const
+    {
+        const cv::Rect abs = (rect + m_roi.tl()) & m_roi;
+        return abs.empty() ? *this : FrameView(m_source, abs);
+    }
+
+    bool empty() const { return m_view.empty(); }
+    cv::Size size() const { return m_view.size(); }
+    int type() const { return m_view.type(); }
+
+    /// 只读视图（与源图共享像素）
+    const cv::Mat& mat() const { return m_view; }
+    /// 视图在源图中的位置
+    const cv::Rect& roi() const { return m_roi; }
+    const cv::Mat& source() const { return m_source; }
+    /// 是否只覆盖源图的一部分
+    bool isSubView() const { return !m_source.empty() && m_roi.size() != m_source.size(); }
+
+    /// 拷贝出独立、连续的像素缓冲（仅在确需写入时调用）
+    cv::Mat materialize() const { return m_view.clone(); }
+
+private:
+    cv::Mat m_source;
+    cv::Rect m_roi;
+    cv::Mat m_view;
+};
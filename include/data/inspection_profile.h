@@ -9,21 +9,23 @@
 #include <opencv2/core.hpp>
 #include "config/roi_config.h"
 #include "algorithm/match_strategy.h"
+#include "data/template_file.h"
 
 /**
  * @brief 方案中保存的模板条目
  *
  * 按名称保存模板图像和参数，方便跨图片复用。
  * 存储路径结构：
- *   profiles/<profileName>/templates/<templateName>.png
- *   profiles/<profileName>/templates/<templateName>.json
+ *   profiles/<profileName>/templates/<templateName>.tpl（二进制，兼容读取旧版 YAML）
  */
 struct TemplateEntry
 {
     QString templateName;        ///< 模板名称（如"螺丝A"、"标签B"）
     QString templateFilePath;    ///< 模板文件相对路径（相对于方案目录）
     cv::Mat templateImage;       ///< 模板图像（运行时加载，不序列化到 JSON）
+    cv::Mat templateGray;        ///< 预计算的灰度匹配模型
     TemplateParams params;       ///< 模板匹配参数
+    std::shared_ptr<const TemplateFile::Mapping> mapping; ///< 非空时图像直接引用映射的模板文件
 
     TemplateEntry() : params() {
         params.matchMethod = 5; // TM_CCOEFF_NORMED 默认值
@@ -73,8 +75,7 @@ struct RoiTemplate
  *   ├── profile.json          // 方案配置
  *   ├── thumbnail.png         // 方案缩略图（可选）
  *   └── templates/            // 模板库
- *       ├── 螺丝A.png
- *       ├── 螺丝A.json
+ *       ├── 螺丝A.tpl
  *       └── ...
  */
 struct InspectionProfile
@@ -108,6 +109,7 @@ struct InspectionProfile
 
     // 文件系统操作
     bool saveToDirectory(const QString& profilesDir);
-    bool loadFromDirectory(const QString& profileDir);
+    /// @param loadTemplates false 时只解析 profile.json，模板在使用时再按需加载
+    bool loadFromDirectory(const QString& profileDir, bool loadTemplates = true);
     cv::Mat generateThumbnail(const cv::Mat& fullImage, int thumbWidth = 120) const;
 };
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <QVector>
+#include <QRectF>
+#include <QPointF>
+#include <QString>
+#include <QColor>
+#include <opencv2/core.hpp>
+
+/**
+ * 叠加层分组
+ *
+ * 同一组的图元在 ImageView 中挂在同一个 QGraphicsItemGroup 下，
+ * 可整体显示/隐藏，切换时不需要重新渲染底图。
+ */
+enum class OverlayGroup : int
+{
+    Barcode = 0,        // 条码识别框 + 标签
+    Ocr,                // OCR文字框 + 标签
+    Line,               // 直线检测 / 参考线
+    Mask,               // 二值Mask着色层
+    ObjectDetection,    // 目标检测框 + 标签
+    Caliper,            // 卡尺框 / 亚像素边缘点 / 拟合几何
+    Count
+};
+
+/// 矩形框
+struct OverlayBox
+{
+    OverlayGroup group = OverlayGroup::Barcode;
+    QRectF rect;                    // 图像坐标
+    QColor color = QColor(0, 255, 0);
+    double penWidth = 2.0;          // 屏幕像素（cosmetic pen，不随缩放变粗）
+};
+
+/// 折线 / 线段（两点即线段）
+struct OverlayPolyline
+{
+    OverlayGroup group = OverlayGroup::Line;
+    QVector<QPointF> points;        // 图像坐标
+    bool closed = false;            // 是否首尾相连
+    QColor color = QColor(0, 255, 0);
+    double penWidth = 1.0;
+};
+
+/// 文字标签（anchor 为标签左下角，背景框自动包围文字）
+struct OverlayLabel
+{
+    OverlayGroup group = OverlayGroup::Barcode;
+    QPointF anchor;
+    QString text;
+    QColor textColor = QColor(255, 255, 255);
+    QColor background = QColor(0, 0, 0);
+};
+
+/// Mask着色层：非零像素以 color 显示，零像素透明
+struct OverlayMaskLayer
+{
+    OverlayGroup group = OverlayGroup::Mask;
+    cv::Mat mask;                   // CV_8UC1，与底图同尺寸（共享数据，不拷贝）
+    QColor color = QColor(0, 255, 0);
+};
+
+/**
+ * 保留式叠加层模型
+ *
+ * Pipeline步骤只描述"画什么"（框/线/标签/Mask），不再把结果光栅化进像素；
+ * 由 ImageView 以 QGraphicsItem 的形式叠加在未修改的底图之上。
+ * 所有成员都是隐式共享容器，PipelineContext 拷贝时开销很小。
+ */
+struct OverlayModel
+{
+    QVector<OverlayBox> boxes;
+    QVector<OverlayPolyline> polylines;
+    QVector<OverlayLabel> labels;
+    QVector<OverlayMaskLayer> masks;
+
+    bool isEmpty() const
+    {
+        return boxes.isEmpty() && polylines.isEmpty() && labels.isEmpty() && masks.isEmpty();
+    }
+
+    void clear()
+    {
+        boxes.clear();
+        polylines.clear();
+        labels.clear();
+        masks.clear();
+    }
+
+    /// 移除指定分组的全部图元（步骤重复执行时先清掉自己上次的输出）
+    void removeGroup(OverlayGroup group)
+    {
+        auto byGroup = [group](const auto& item) { return item.group == group; };
+        boxes.removeIf(byGroup);
+        polylines.removeIf(byGroup);
+        labels.removeIf(byGroup);
+        masks.removeIf(byGroup);
+    }
+
+    /// 提取指定分组的图元
+    OverlayModel filtered(OverlayGroup group) const
+    {
+        OverlayModel out;
+        for (const auto& b : boxes)     if (b.group == group) out.boxes.append(b);
+        for (const auto& p : polylines) if (p.group == group) out.polylines.append(p);
+        for (const auto& l : labels)    if (l.group == group) out.labels.append(l);
+        for (const auto& m : masks)     if (m.group == group) out.masks.append(m);
+        return out;
+    }
+
+    void append(const OverlayModel& other)
+    {
+        boxes += other.boxes;
+        polylines += other.polylines;
+        labels += other.labels;
+        masks += other.masks;
+    }
+
+    // ========== 便捷构造 ==========
+
+    void addBox(OverlayGroup group, const QRectF& rect, const QColor& color, double penWidth = 2.0)
+    {
+        boxes.append({group, rect, color, penWidth});
+    }
+
+    void addLine(OverlayGroup group, const QPointF& p1, const QPointF& p2, const QColor& color, double penWidth = 1.0)
+    {
+        polylines.append({group, {p1, p2}, false, color, penWidth});
+    }
+
+    void addLabel(OverlayGroup group, const QPointF& anchor, const QString& text,
+                  const QColor& textColor = QColor(255, 255, 255),
+                  const QColor& background = QColor(0, 0, 0))
+    {
+        labels.append({group, anchor, text, textColor, background});
+    }
+
+    void addMask(OverlayGroup group, const cv::Mat& mask, const QColor& color)
+    {
+        masks.append({group, mask, color});
+    }
+};
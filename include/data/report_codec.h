@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include "data/detection_result_report.h"
+
+/**
+ * 检测报告上报编码
+ *
+ * Json：与 DetectionResultReport::toJson 一致的文本格式（默认，兼容旧云端）
+ * Cbor：紧凑二进制格式，直接写入可复用的字节缓冲区，不经过 QJsonObject
+ *   - 以 CBOR 自描述标签 55799（D9 D9 F7）开头，接收端据此区分 JSON/CBOR；
+ *     当前连接为 MQTT 3.1.1，没有 v5 的 content-type/user property 可用
+ *   - 顶层为整数键 map，键 0 为 schema 版本，字段编号见 report_codec.cpp
+ *   - 检测类型用 DetectionType 序号代替中文名称
+ *   - 解码见 cloud_dashboard/report_codec.py（由 mqtt_handler.py 调用）
+ */
+class ReportCodec
+{
+public:
+    enum class Format
+    {
+        Json,
+        Cbor
+    };
+
+    /// 聚合窗口统计（MqttReportPublisher 的 batch 消息）
+    struct BatchSummary
+    {
+        QString batchId;                            ///< 聚合消息唯一ID（离线补发重复时云端按此去重）
+        qint64 windowStart = 0;
+        qint64 windowEnd = 0;
+        int total = 0;
+        int passed = 0;
+        QMap<QString, QPair<int, int>> byRoi;       ///< ROI -> (total, passed)
+        QList<QPair<QString, int>> failReasons;     ///< 按次数降序
+    };
+
+    ReportCodec() = delete;
+
+    static Format formatFromString(const QString& name);
+
+    /// 编码单条报告到 out（out 先清空，保留已分配容量）
+    static void encodeReport(const DetectionResultReport& report, const QString& deviceId,
+                             bool includeItems, Format format, QByteArray& out);
+
+    /// 编码聚合消息到 out
+    static void encodeBatch(const BatchSummary& summary, const QVector<DetectionResultReport>& reports,
+                            const QString& deviceId, bool includeItems, Format format, QByteArray& out);
+
+    /// 对比 JSON 与 CBOR 的消息大小和编码耗时
+    static void benchmark(const DetectionResultReport& sample, int iterations = 1000);
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QByteArray>
+#include <QCborMap>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+class QFile;
+
+/**
+ * @brief 检测会话录制文件（.evs）
+ *
+ * 只追加的顺序容器（小端序）：
+ *   FileHeader(16B) | Record*
+ *   Record = RecordHeader(16B：类型、负载长度、相对会话开始的时刻 ns) | 负载（CBOR map）
+ *
+ * 记录类型：
+ *   Meta     会话信息（开始时间、主机、图像编码）
+ *   Config   PipelineConfig 快照及所属 RoiConfig，按内容去重后编号
+ *   Image    压缩图像（jpg/png），同一源图缓冲只写一次；按写入顺序从 1 编号，Frame 按编号引用
+ *   Frame    一次 Pipeline 输入：Image/Config 编号 + ROI 矩形 + 来源 + 提交方式
+ *   Command  外部指令（MQTT 指令 JSON）
+ *   End      正常结束标记
+ *
+ * 记录头定长，建索引时只读记录头、跳过负载；进程异常退出时末尾不完整的记录在读取时丢弃，
+ * 之前的记录仍可回放。
+ */
+class SessionFile
+{
+public:
+    enum class RecordType : quint32
+    {
+        Meta = 1,
+        Config = 2,
+        Image = 3,
+        Frame = 4,
+        Command = 5,
+        End = 6
+    };
+
+    struct RecordInfo
+    {
+        RecordType type = RecordType::Meta;
+        qint64 timeNs = 0;      ///< 相对会话开始的时刻
+        qint64 offset = 0;      ///< 负载在文件中的偏移
+        quint32 size = 0;       ///< 负载字节数
+    };
+
+    /// 顺序写入（单线程使用）
+    class Writer
+    {
+    public:
+        Writer();
+        ~Writer();
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        bool open(const QString& path);
+        bool isOpen() const;
+        bool append(RecordType type, qint64 timeNs, const QByteArray& payload);
+        void close();
+
+        qint64 bytesWritten() const { return m_bytes; }
+
+    private:
+        std::unique_ptr<QFile> m_file;
+        qint64 m_bytes = 0;
+    };
+
+    /// 建立记录索引后按需读取负载
+    class Reader
+    {
+    public:
+        Reader();
+        ~Reader();
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        bool open(const QString& path);
+        void close();
+
+        const QVector<RecordInfo>& records() const { return m_records; }
+        /// 是否以 End 记录正常结束（false 表示录制进程异常退出，文件被截断）
+        bool isComplete() const { return m_complete; }
+
+        QByteArray payload(const RecordInfo& record);
+        /// 负载开头至多 maxBytes 字节（只解析前置小字段时避免读入整幅图像）
+        QByteArray payloadHead(const RecordInfo& record, qint64 maxBytes);
+        QCborMap map(const RecordInfo& record);
+
+    private:
+        std::unique_ptr<QFile> m_file;
+        QVector<RecordInfo> m_records;
+        bool m_complete = false;
+    };
+
+    SessionFile() = delete;
+
+    static constexpr const char* kSuffix = "evs";
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QPointF>
+#include <memory>
+#include <opencv2/core.hpp>
+
+class QFile;
+
+/**
+ * @brief 模板文件读写（.tpl）
+ *
+ * 二进制容器格式（小端序）：
+ *   Header(64B) | 多边形顶点(double x,y) | 平面表 | 平面数据(64B 对齐)
+ * 平面包括原始模板图像和预计算的灰度匹配模型；
+ * Raw 编码的平面行连续存放，加载时直接内存映射，cv::Mat 头指向映射内存，
+ * 不做解析和拷贝（页面按需调入）；Png 编码用于导出体积更小的无损文件。
+ *
+ * 旧版 YAML 文本格式（cv::FileStorage）仍可读取，按文件头魔数自动识别，
+ * 读取时不改写文件，显式保存时才写为二进制格式。
+ * Windows 下已映射的文件不能被替换：覆盖保存前调用方须释放指向目标文件的映射。
+ */
+class TemplateFile
+{
+public:
+    enum class Compression
+    {
+        Raw,    ///< 原始像素，可内存映射
+        Png     ///< 无损 PNG 压缩，加载时解码
+    };
+
+    /// 内存映射句柄：持有期间映射有效，映射内存为写时复制
+    class Mapping
+    {
+    public:
+        explicit Mapping(const QString& path);
+        ~Mapping();
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+
+        bool isValid() const { return m_data != nullptr; }
+        const uchar* data() const { return m_data; }
+        qint64 size() const { return m_size; }
+        const QString& path() const { return m_path; }
+        /// 是否为 filePath 的映射（按绝对路径比较）
+        bool maps(const QString& filePath) const;
+        bool contains(const void* ptr) const {
+            auto p = static_cast<const uchar*>(ptr);
+            return m_data && p >= m_data && p < m_data + m_size;
+        }
+
+    private:
+        QString m_path;
+        std::unique_ptr<QFile> m_file;
+        uchar* m_data = nullptr;
+        qint64 m_size = 0;
+    };
+
+    struct Content
+    {
+        cv::Mat image;                          ///< 模板图像（原始通道数）
+        cv::Mat gray;                           ///< 预计算的灰度匹配模型
+        int matchMethod = 5;                    ///< TM_CCOEFF_NORMED
+        QVector<QPointF> polygonPoints;
+        std::shared_ptr<const Mapping> mapping; ///< 非空时 image/gray 引用映射内存
+        bool legacyYaml = false;                ///< 从旧版 YAML 读取
+    };
+
+    TemplateFile() = delete;
+
+    /// 文件头是否为二进制模板格式
+    static bool isBinary(const QString& filePath);
+
+    /// 读取模板（二进制内存映射 / 旧版 YAML）
+    static bool load(const QString& filePath, Content& out);
+
+    /// 写出二进制模板（先写临时文件再替换，不破坏已有映射）
+    static bool save(const QString& filePath, const Content& content,
+                     Compression compression = Compression::Raw);
+
+    /// 生成灰度匹配模型
+    static cv::Mat makeGray(const cv::Mat& image);
+
+    /// 对比 YAML 与二进制格式的保存/加载耗时和文件大小
+    static void benchmark(const cv::Mat& image, const QString& workDir, int iterations = 20);
+
+private:
+    static bool loadBinary(const QString& filePath, Content& out);
+    static bool loadYaml(const QString& filePath, Content& out);
+    static bool saveYaml(const QString& filePath, const Content& content);
+};
@@ -12,8 +12,10 @@
 #include <QMouseEvent>
 #include <QMenu>
 
+#include <array>
 #include <opencv2/opencv.hpp>
 #include "roi_manager.h"
+#include "data/overlay_model.h"
 
 // ROI 把手类型
 enum RoiHandle
@@ -47,6 +49,10 @@ public:
     void setImage(const QImage &img);
     /// 只更新图像内容，保持当前缩放比例不变（用于ROI切换等不需要重置zoom的场景）
     void setImageKeepZoom(const QImage &img);
+    /// 直接显示 cv::Mat；若与当前显示的是同一块像素数据（同一 Mat 快照），
+    /// 跳过 QImage/QPixmap 转换，只清空叠加层（显示模式切换时复用底图）
+    /// @note mat 须视为不可变快照，原地改写像素后请传入新的 Mat
+    void setImageMat(const cv::Mat &mat, bool keepZoom = false);
     void setRoiMode(bool enable);
     void clearRoi();
     void finishRoiMode();
@@ -82,6 +88,17 @@ public:
     // 右键上下文菜单
     void showContextMenu(const QPoint& viewportPos);
 
+    // ========== 矢量叠加层 ==========
+
+    /// 替换当前叠加层（框/线/标签/Mask），底图像素不变
+    /// 注意：setImage/setImageKeepZoom 会清空叠加层，需在其后调用
+    void setOverlay(const OverlayModel& overlay);
+    void clearOverlay();
+
+    /// 按分组显示/隐藏叠加层（仅切换可见性，不重建图元）
+    void setOverlayGroupVisible(OverlayGroup group, bool visible);
+    bool isOverlayGroupVisible(OverlayGroup group) const;
+
 
 signals:
     void pixelInfoChanged(int x, int y, const QColor &rgb, int gray);
@@ -135,6 +152,9 @@ private:
     double m_scaleFactor = 1.0;
     bool m_zoomEnabled = true;
 
+    // 当前底图对应的 Mat（持有引用，保证数据指针在比较期间不被复用）
+    cv::Mat m_displayedMat;
+
     // ROI 状态
     RoiState m_roiState = RoiState::None;
     QPointF m_roiStartPosImg;                   // 起点：图像坐标
@@ -163,6 +183,12 @@ private:
     QGraphicsLineItem *m_referenceLineItem = nullptr;
     QGraphicsLineItem *m_refLinePreviewItem = nullptr;  // 预览线
     QGraphicsTextItem *m_refLineHintItem = nullptr;     // 提示文字
+
+    // 矢量叠加层：每个分组一个 QGraphicsItemGroup，挂在 m_pixmapItem 上
+    static constexpr int OVERLAY_GROUP_COUNT = static_cast<int>(OverlayGroup::Count);
+    std::array<QGraphicsItemGroup*, OVERLAY_GROUP_COUNT> m_overlayGroups{};
+    std::array<bool, OVERLAY_GROUP_COUNT> m_overlayVisible = {true, true, true, true, true, true};
+    QGraphicsItemGroup* overlayGroup(OverlayGroup group);
 };
 
 #endif // IMAGE_VIEW_H
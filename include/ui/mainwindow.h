@@ -22,6 +22,7 @@
 class QLabel;
 class ImageView;
 class SystemMonitor;
+class MetricsHttpServer;
 class FileManager;
 class CloudDashboardManager;
 class DisplayModeManager;
@@ -35,6 +36,7 @@ class ConfigController;
 class AutoDetectionController;
 class PipelineResultHandler;
 class ProfileManager;
+class CaptureService;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -118,12 +120,25 @@ private:
     /// 加载指定图片的Pipeline配置到PipelineManager（复用模式：loadImagePipelineConfig + setConfig + rebuildPipeline）
     void applyImagePipelineConfig(const QString& imageId);
 
+    /// MQTT capture 指令：取帧并提交检测，结果返回后发布响应
+    void handleCaptureCommand(const QString& commandId, qint64 triggeredAt);
+    /// 把取得的帧提交检测（frame 为空时回复错误）
+    void submitCaptureFrame(const QString& commandId, qint64 triggeredAt, const cv::Mat& frame,
+                            const QString& source, double frameAgeMs);
+    /// 为已有结果的采集指令发布响应（含触发到结果的耗时）
+    void completePendingCaptures(const PipelineResult& result);
+    /// 回复超时仍无结果的采集指令（请求被取消/覆盖）
+    void sweepPendingCaptures();
+    /// 实时视频流式槽的 source 键（当前图片ID/ROI ID）
+    QString liveStreamSource() const;
+
     Ui::MainWindow *ui;
     ImageView *m_view = nullptr;
 
     PipelineManager* m_pipelineManager = nullptr;
     RoiManager m_roiManager;
     SystemMonitor* m_systemMonitor = nullptr;
+    MetricsHttpServer* m_metricsServer = nullptr;
     FileManager* m_fileManager = nullptr;
 
     bool m_isDestroying = false;
@@ -135,6 +150,7 @@ private:
     enum class PipelineMode { Config, Execute };
     PipelineMode m_pipelineMode = PipelineMode::Config;
     bool m_needRefresh = false;
+    bool m_videoPlaying = false;    ///< 实时视频播放中（启用变化门控）
 
     // Controller对象
     RoiUiController* m_roiUiController = nullptr;
@@ -154,6 +170,23 @@ private:
     // MQTT 边云协同管理器
     MqttManager* m_mqttManager = nullptr;
 
+    // 常驻采集服务（MQTT capture 指令取帧）
+    CaptureService* m_captureService = nullptr;
+    /// 已提交检测、等待结果的采集指令
+    struct PendingCapture {
+        QString commandId;
+        qint64 triggeredAt = 0;     ///< 收到指令的时刻（steady_clock 计数）
+        qint64 requestId = -1;      ///< 对应的 Pipeline 请求
+        double acquireMs = 0;       ///< 触发到取得图像
+        double frameAgeMs = 0;      ///< 取得图像时该帧的帧龄
+        QString source;             ///< 图像来源：capture / video
+    };
+    QVector<PendingCapture> m_pendingCaptures;
+    QTimer* m_captureSweepTimer = nullptr;
+    /// 发布单条采集指令的响应；reused 表示画面无变化、复用了上次结果
+    void publishCaptureResponse(const PendingCapture& pending, const PipelineResult& result, bool reused);
+    qint64 m_lastSubmittedRequestId = -1;   ///< processAndDisplay 最近提交的请求
+
     // 云平台看板管理器
     CloudDashboardManager* m_cloudDashboardManager = nullptr;
 
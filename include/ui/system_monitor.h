@@ -2,13 +2,39 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QThreadPool>
+#include <QFutureWatcher>
 #include <QLabel>
 #include <QStatusBar>
+#include <QHash>
+#include <QSet>
+#include <QVector>
 
 #ifdef Q_OS_WIN
 #include <pdh.h>
 #endif
 
+/// 单个线程池的资源占用（线程归属见 ThreadTag）
+struct ThreadPoolUsage
+{
+    QString pool;               ///< main / scheduler / batch / ort / ocr / capture / mqtt / log / monitor / qt_pool / other
+    int threads = 0;
+    double cpuPercent = 0.0;    ///< 占整机 CPU 的百分比，与整机 CPU 占用率同一口径
+};
+
+/// 本进程的资源占用
+struct ProcessUsage
+{
+    double cpuPercent = 0.0;    ///< 占整机 CPU 的百分比
+    double rssMB = 0.0;         ///< 常驻内存（Windows 为工作集）
+    double pssMB = 0.0;         ///< 按比例分摊共享页后的内存（Windows 为私有提交）
+    int threadCount = 0;
+    double heapInUseMB = 0.0;   ///< C 运行时堆已分配（glibc mallinfo2 / Windows 进程堆）
+    double cvAllocMB = 0.0;     ///< OpenCV 分配器当前占用（cv::Mat 数据等）
+    double cvAllocPeakMB = 0.0;
+    QVector<ThreadPoolUsage> pools;
+};
+
 /**
  * @brief 系统资源监控类
  *
@@ -16,10 +42,15 @@
  * 1. 实时监控 CPU 占用率
  * 2. 实时监控内存使用情况
  * 3. 自动更新到指定的 QLabel 控件
+ * 4. 本进程 CPU/RSS/PSS、按线程池归类的线程 CPU、堆与 OpenCV 分配器统计
+ * 5. 同步到 MetricsRegistry，并每次更新时推进滚动速率采样
  *
  * 设计思路：
- * - 使用 QTimer 定时查询系统信息（默认1秒更新一次）
+ * - 使用 QTimer 定时查询系统信息（默认1秒更新一次）；采样（线程快照、/proc 遍历）在专属
+ *   "monitor" 线程执行，GUI 线程只刷新标签、写指标和发信号，上一次采样未完成时跳过本周期
  * - 跨平台实现：Windows 使用 PDH，Linux 使用 /proc 文件系统
+ * - 进程级：Linux 读 /proc/self/stat、/proc/self/task/*、smaps_rollup；
+ *   Windows 用 GetProcessTimes、Toolhelp 线程快照、GetProcessMemoryInfo
  * - 通过信号槽机制更新 UI，保证线程安全
  */
 class SystemMonitor : public QObject
@@ -94,6 +125,11 @@ public:
      */
     double getTotalMemoryMB() const { return m_totalMemoryMB; }
 
+    /**
+     * @brief 获取本进程资源占用（含线程池明细）
+     */
+    const ProcessUsage& getProcessUsage() const { return m_process; }
+
 signals:
     /**
      * @brief CPU 使用率更新信号
@@ -109,13 +145,34 @@ signals:
      */
     void memoryUsageUpdated(double usedMB, double totalMB, double usagePercent);
 
+    /**
+     * @brief 本进程资源占用更新信号
+     */
+    void processUsageUpdated(const ProcessUsage& usage);
+
 private slots:
     /**
-     * @brief 定时器触发的更新槽函数
+     * @brief 定时器触发的更新槽函数（发起后台采样）
      */
     void updateSystemInfo();
 
 private:
+    /// 一次后台采样的结果
+    struct Sample
+    {
+        double cpuUsage = 0.0;
+        double memoryUsage = 0.0;
+        double usedMemoryMB = 0.0;
+        double totalMemoryMB = 0.0;
+        ProcessUsage process;
+    };
+
+    /// 采样线程执行：平台相关状态（上次 CPU 时间等）只在采样线程读写
+    Sample collectSample();
+
+    /// GUI 线程应用采样结果：更新 UI、指标并发送信号
+    void applySample(const Sample& sample);
+
     // ========== 平台相关实现 ==========
 
     /**
@@ -132,6 +189,18 @@ private:
      */
     double getMemoryUsage(double& usedMB, double& totalMB);
 
+    /**
+     * @brief 采集本进程资源占用（平台相关）
+     *
+     * 须在 getCpuUsage() 之后调用：Linux 下进程/线程 CPU 以同一周期的整机 jiffies 为分母
+     */
+    void sampleProcessUsage(ProcessUsage& usage);
+
+    /**
+     * @brief 填充与平台无关的部分（OpenCV 分配器）并写入指标
+     */
+    void publishProcessMetrics();
+
     /**
      * @brief 初始化平台相关资源
      */
@@ -149,23 +218,34 @@ private:
 
     // ========== 定时器 ==========
     QTimer* m_updateTimer;    // 更新定时器
+    QThreadPool m_samplePool;                 // 采样线程（单线程，采样串行执行）
+    QFutureWatcher<Sample>* m_sampleWatcher;  // 进行中的采样
 
     // ========== 缓存数据 ==========
     double m_cpuUsage;        // 当前 CPU 占用率
     double m_memoryUsage;     // 当前内存使用率
     double m_usedMemoryMB;    // 已使用内存（MB）
     double m_totalMemoryMB;   // 总内存（MB）
+    ProcessUsage m_process;   // 本进程资源占用
+    QSet<QString> m_knownPools;   // 出现过的线程池（消失后指标归零）
 
     // ========== 平台相关数据（Windows） ==========
 #ifdef Q_OS_WIN
     PDH_HQUERY m_pdhQuery = nullptr;
     PDH_HCOUNTER m_pdhCpuCounter = nullptr;
     bool m_pdhInitialized = false;
+    unsigned long long m_lastProcessTime = 0;   // 上次进程 CPU 时间（100ns）
+    unsigned long long m_lastWallTime = 0;      // 上次采样墙钟时间（100ns）
+    QHash<unsigned long, unsigned long long> m_lastThreadTimes;   // 线程 ID -> 上次 CPU 时间
+    unsigned long m_mainThreadId = 0;
 #endif
 
     // ========== 平台相关数据（Linux） ==========
 #ifdef Q_OS_LINUX
     unsigned long long m_lastTotalTime;   // 上次总 CPU 时间
     unsigned long long m_lastIdleTime;    // 上次空闲时间
+    unsigned long long m_lastTotalDelta = 0;    // 最近一个周期的整机 jiffies 增量
+    unsigned long long m_lastProcessTicks = 0;  // 上次进程 utime+stime
+    QHash<qint64, unsigned long long> m_lastThreadTicks;   // tid -> 上次 utime+stime
 #endif
 };
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * @brief CPU 核心拓扑（只读快照，首次访问时探测）
+ *
+ * 推理线程数按物理核而非逻辑核计算：同一物理核上的两个超线程共享 FMA 单元，
+ * 卷积这类计算密集型算子开满逻辑核反而因争用变慢。混合架构（大小核）只计性能核。
+ * Windows 通过 GetLogicalProcessorInformationEx、Linux 通过 sysfs 读取，
+ * 失败时退化为 hardware_concurrency 且视为无超线程。
+ */
+struct CpuTopology
+{
+    int logicalCores = 1;
+    int physicalCores = 1;
+    int performanceCores = 1;       // 非混合架构等于 physicalCores
+    bool hybrid = false;            // 存在多种效率等级的核心（大小核）
+    /// 每个物理核选一个逻辑处理器编号，性能核在前；用于线程绑核
+    std::vector<int> primaryLogical;
+
+    static const CpuTopology& current();
+
+    /// 把当前线程绑定到指定逻辑处理器（Windows 仅支持第 0 处理器组）
+    static bool pinCurrentThread(int logicalCpu);
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QString>
+#include <string>
+
+/**
+ * @namespace ThreadTag
+ * @brief 线程池归属标记，供 SystemMonitor 按线程池统计 CPU
+ *
+ * 通过操作系统线程名（"ev-<pool>"）标记线程归属：Linux 可从 /proc/self/task/<tid>/comm
+ * 读回，Windows 通过 GetThreadDescription 读回，不需要额外的全局表。
+ * Linux 线程名最长 15 字节，pool 名应保持简短（scheduler/batch/ort/ocr/capture/record/log）。
+ */
+namespace ThreadTag {
+
+/// 把当前线程标记为 pool；同一线程重复标记同一 pool 只做一次比较（只用于专属线程/线程池）
+void setCurrent(const char* pool);
+
+/**
+ * @brief 作用域内把当前线程标记为 pool，析构时恢复原线程名
+ *
+ * 用于在共享线程池（QThreadPool::globalInstance）上执行的任务：setCurrent 会永久改名，
+ * 线程归还线程池后其它任务的 CPU 也会被计入该 pool。
+ */
+class Scope
+{
+public:
+    explicit Scope(const char* pool);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    std::string m_savedTag;     ///< setCurrent 的缓存标记
+    std::string m_savedName;    ///< 原操作系统线程名（UTF-8）
+    bool m_restore = false;
+};
+
+/// 由线程名推断线程池；未标记的线程按已知命名归类，其余为 "other"
+QString poolOf(const QString& threadName, bool isMainThread);
+
+/**
+ * @brief 作用域内临时改名当前线程，使其间创建的第三方线程继承该标记
+ *
+ * 用于无法注入线程创建回调的库（OcrLite 内部的推理会话、OpenCV 采集后端）。
+ * Linux 新线程继承创建者的线程名，因此有效；Windows 不继承，这些线程归为 "other"。
+ */
+class ScopedSpawn
+{
+public:
+    explicit ScopedSpawn(const char* pool);
+    ~ScopedSpawn();
+
+    ScopedSpawn(const ScopedSpawn&) = delete;
+    ScopedSpawn& operator=(const ScopedSpawn&) = delete;
+
+private:
+    char m_saved[16] = {};
+    bool m_restore = false;
+};
+
+} // namespace ThreadTag
@@ -6,12 +6,17 @@
 #include "core/i_pipeline_access.h"
 #include "widgets/i_tab_interfaces.h"
 
+class QComboBox;
+class QSpinBox;
+class QDoubleSpinBox;
+class QLabel;
+
 namespace Ui
 {
 class LineTabForm;
 }
 
-class LineDetectTabWidget : public QWidget, public ISignalConnectable, public IResultUpdatable
+class LineDetectTabWidget : public QWidget, public ISignalConnectable, public IResultUpdatable, public IConfigurableTab
 {
     Q_OBJECT
 
@@ -24,6 +29,10 @@ public:
     // IResultUpdatable 接口实现
     void updateFromPipeline(const PipelineContext& ctx) override;
 
+    // IConfigurableTab 接口实现（卡尺参数；直线参数由检测项经 setLineConfig 恢复）
+    void saveToConfig(PipelineConfig& config) const override;
+    void loadFromConfig(const PipelineConfig& config) override;
+
     void connectSignals(const SignalContext& ctx,
                         std::function<void()> onExecutePipeline,
                         std::function<void()> onConfigSaved = nullptr) override;
@@ -41,6 +50,25 @@ private:
     LineDetectState getLineState() const;
     void setLineState(const LineDetectState& state);
 
+    // ========== 卡尺测量（代码创建，测量路径复用参考线） ==========
+    QComboBox* m_caliperShapeCombo = nullptr;
+    QComboBox* m_caliperModeCombo = nullptr;
+    QComboBox* m_caliperPolarityCombo = nullptr;
+    QSpinBox* m_caliperCountSpin = nullptr;
+    QDoubleSpinBox* m_caliperSearchSpin = nullptr;
+    QDoubleSpinBox* m_caliperProjectionSpin = nullptr;
+    QDoubleSpinBox* m_caliperContrastSpin = nullptr;
+    QDoubleSpinBox* m_caliperPixelSizeSpin = nullptr;
+    QDoubleSpinBox* m_caliperNominalSpin = nullptr;
+    QDoubleSpinBox* m_caliperToleranceSpin = nullptr;
+    QLabel* m_caliperResultLabel = nullptr;
+
+    void setupCaliperGroup();
+    void onCaliperParamChanged();
+    /// 配置 -> 卡尺控件（阻断信号，不回写配置）
+    void setCaliperConfig(const CaliperConfig& config);
+    void writeCaliperConfig(CaliperConfig& config) const;
+
 private slots:
     void onLineAlgorithmChanged(int index);
     void onLineThresholdChanged(int value);
@@ -8,6 +8,7 @@
 #include <QPushButton>
 #include <QLineEdit>
 #include <QCheckBox>
+#include <QSpinBox>
 #include "core/i_pipeline_access.h"
 #include "widgets/i_tab_interfaces.h"
 
@@ -41,15 +42,26 @@ private slots:
 private:
     void setupUI();
     void syncConfigToPipeline();
+    /// 引擎参数控件 -> OcrConfig
+    void writeOcrConfig(OcrConfig& cfg) const;
+    /// OcrConfig -> 引擎参数控件（不触发同步）
+    void setOcrConfig(const OcrConfig& cfg);
+    void updateEngineControls();
     void clearResults();
     void updateRegionsTable(const QVector<OcrRegion>& regions);
 
     IPipelineAccess* m_pipeline;
 
     bool m_manualOcrTrigger = false;
+    QVector<OcrRegion> m_lastRegions;   // 最近一次识别区域（"采用识别区域"的来源）
 
     // UI 控件 - 配置部分
     QComboBox* m_pageModeCombo;
+    QComboBox* m_engineModeCombo;
+    QLineEdit* m_fixedRegionsEdit;
+    QPushButton* m_useRegionsBtn;
+    QCheckBox* m_enableCacheCheck;
+    QSpinBox* m_cacheDistanceSpin;
     QLineEdit* m_expectedTextLineEdit;
     QCheckBox* m_matchExactCheckBox;
     QPushButton* m_recognizeBtn;
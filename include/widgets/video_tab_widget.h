@@ -11,7 +11,10 @@ namespace Ui {
 class VideoTabWidget;
 }
 
-class VideoTabWidget : public QWidget, public ISignalConnectable
+class PipelineManager;
+struct ChangeGateConfig;
+
+class VideoTabWidget : public QWidget, public ISignalConnectable, public IConfigurableTab
 {
     Q_OBJECT
 
@@ -26,6 +29,10 @@ public:
                         std::function<void()> onExecutePipeline,
                         std::function<void()> onConfigSaved = nullptr) override;
 
+    // IConfigurableTab 接口实现（变化门控参数随 ROI 保存）
+    void saveToConfig(PipelineConfig& config) const override;
+    void loadFromConfig(const PipelineConfig& config) override;
+
 signals:
     void videoFrameReady(const cv::Mat& frame);
     void videoSourceChanged(const QString& source);
@@ -50,8 +57,12 @@ private:
     void updateUIState();
     void updateCameraList();
     void updateProgress();
+    void writeChangeGateConfig(ChangeGateConfig& cfg) const;
+    void setChangeGateConfig(const ChangeGateConfig& cfg);
+    void syncChangeGateToPipeline();
 
     Ui::VideoTabWidget* m_ui;
+    PipelineManager* m_pipelineManager = nullptr;
     VideoManager* m_videoManager;
     QVector<QString> m_cameraList;
     bool m_isUpdatingProgress;
@@ -0,0 +1,128 @@
+﻿#include "barcode_localizer.h"
+#include "logger.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+
+namespace {
+
+/// 梯度均方根低于此值视为无纹理背景（Sobel 3x3，8位输入）
+constexpr double MIN_GRADIENT_RMS = 40.0;
+
+/// 方向一致性高于此值认为是一维码（平行条纹）
+constexpr double LINEAR_COHERENCE = 0.6;
+
+} // anonymous namespace
+
+std::vector<BarcodeCandidate> BarcodeLocalizer::locate(const cv::Mat& gray, const Params& params)
+{
+    std::vector<BarcodeCandidate> candidates;
+    if (gray.empty() || gray.type() != CV_8UC1) return candidates;
+
+    try {
+        // 1. 降采样：热力图只需要定位精度，不需要解码精度
+        const int longSide = std::max(gray.cols, gray.rows);
+        const double scale = (params.maxSide > 0 && longSide > params.maxSide)
+                                 ? static_cast<double>(params.maxSide) / longSide
+                                 : 1.0;
+        cv::Mat small;
+        if (scale < 1.0)
+            cv::resize(gray, small, cv::Size(), scale, scale, cv::INTER_AREA);
+        else
+            small = gray;
+
+        // 2. 结构张量 J = [Jxx Jxy; Jxy Jyy]（窗口内平均）
+        cv::Mat gx, gy;
+        cv::Sobel(small, gx, CV_32F, 1, 0, 3);
+        cv::Sobel(small, gy, CV_32F, 0, 1, 3);
+
+        const int win = std::max(5, std::min(small.cols, small.rows) / 40) | 1;
+        const cv::Size ksize(win, win);
+
+        cv::Mat jxx, jyy, jxy;
+        cv::multiply(gx, gx, jxx);
+        cv::multiply(gy, gy, jyy);
+        cv::multiply(gx, gy, jxy);
+        cv::boxFilter(jxx, jxx, CV_32F, ksize);
+        cv::boxFilter(jyy, jyy, CV_32F, ksize);
+        cv::boxFilter(jxy, jxy, CV_32F, ksize);
+
+        // 能量 = 梯度均方根；一致性 = (λ1-λ2)/(λ1+λ2)
+        cv::Mat energy = jxx + jyy;
+        cv::Mat heat;
+        cv::sqrt(energy, heat);
+
+        double maxHeat = 0;
+        cv::minMaxLoc(heat, nullptr, &maxHeat);
+        if (maxHeat < MIN_GRADIENT_RMS) {
+            spdlog::debug("[BarcodeLocalizer] 无纹理区域 (max rms={:.1f})", maxHeat);
+            return candidates;
+        }
+
+        cv::Mat coherence;
+        cv::Mat diff = jxx - jyy;
+        cv::Mat twoJxy = jxy * 2.0;
+        cv::magnitude(diff, twoJxy, coherence);
+        cv::divide(coherence, energy + 1e-6, coherence);
+
+        // 3. 热区二值化：Otsu + 绝对下限，闭运算把条/模块连成整块
+        cv::Mat heat8;
+        heat.convertTo(heat8, CV_8U, 255.0 / maxHeat);
+        cv::Mat hot;
+        double otsu = cv::threshold(heat8, hot, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        double floor8 = MIN_GRADIENT_RMS * 255.0 / maxHeat;
+        if (otsu < floor8) {
+            cv::threshold(heat8, hot, floor8, 255, cv::THRESH_BINARY);
+        }
+        cv::morphologyEx(hot, hot, cv::MORPH_CLOSE,
+                         cv::getStructuringElement(cv::MORPH_RECT, ksize));
+        cv::morphologyEx(hot, hot, cv::MORPH_OPEN,
+                         cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3)));
+
+        // 4. 连通块 → 候选窗口
+        cv::Mat labels, stats, centroids;
+        int n = cv::connectedComponentsWithStats(hot, labels, stats, centroids, 8, CV_32S);
+
+        const double minArea = params.minAreaRatio * small.cols * small.rows;
+        const cv::Rect imageRect(0, 0, gray.cols, gray.rows);
+
+        for (int i = 1; i < n; ++i) {
+            int area = stats.at<int>(i, cv::CC_STAT_AREA);
+            if (area < minArea) continue;
+
+            cv::Rect r(stats.at<int>(i, cv::CC_STAT_LEFT),
+                       stats.at<int>(i, cv::CC_STAT_TOP),
+                       stats.at<int>(i, cv::CC_STAT_WIDTH),
+                       stats.at<int>(i, cv::CC_STAT_HEIGHT));
+
+            cv::Mat compMask = (labels(r) == i);
+            BarcodeCandidate cand;
+            cand.score = cv::mean(heat(r), compMask)[0];
+            cand.linear = cv::mean(coherence(r), compMask)[0] > LINEAR_COHERENCE;
+
+            // 映射回原图并外扩（ZXing 需要静区）
+            double x = r.x / scale, y = r.y / scale;
+            double w = r.width / scale, h = r.height / scale;
+            double margin = std::max<double>(params.minMargin, params.marginRatio * std::max(w, h));
+            cv::Rect full(cvFloor(x - margin), cvFloor(y - margin),
+                          cvCeil(w + 2 * margin), cvCeil(h + 2 * margin));
+            cand.rect = full & imageRect;
+            if (cand.rect.empty()) continue;
+
+            candidates.push_back(cand);
+        }
+
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const BarcodeCandidate& a, const BarcodeCandidate& b) { return a.score > b.score; });
+        if (params.maxCandidates > 0 && static_cast<int>(candidates.size()) > params.maxCandidates) {
+            candidates.resize(params.maxCandidates);
+        }
+
+        spdlog::debug("[BarcodeLocalizer] {}x{} → {}x{}, 候选 {} 个",
+                      gray.cols, gray.rows, small.cols, small.rows, candidates.size());
+    } catch (const cv::Exception& ex) {
+        spdlog::error("BarcodeLocalizer OpenCV错误: {}", ex.what());
+        candidates.clear();
+    }
+
+    return candidates;
+}
@@ -0,0 +1,381 @@
+﻿#include "caliper_tool.h"
+#include "logger.h"
+#include "utils/benchmark.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+
+namespace {
+
+/// 剖面上的梯度极值（亚像素位置，单位：采样点）
+struct Peak
+{
+    float pos = 0.f;
+    float amp = 0.f;
+};
+
+bool matchPolarity(float amp, int polarity)
+{
+    if (polarity == 1) return amp > 0;
+    if (polarity == 2) return amp < 0;
+    return true;
+}
+
+/// 提取一条导数剖面上的全部极值，抛物线插值到亚像素
+std::vector<Peak> findPeaks(const float* d, int len, double minContrast)
+{
+    std::vector<Peak> peaks;
+    for (int k = 1; k < len - 1; ++k) {
+        const float a = d[k];
+        if (std::abs(a) < minContrast) continue;
+
+        bool isPeak = a > 0 ? (a >= d[k - 1] && a > d[k + 1])
+                            : (a <= d[k - 1] && a < d[k + 1]);
+        if (!isPeak) continue;
+
+        float denom = d[k - 1] - 2.f * a + d[k + 1];
+        float offset = std::abs(denom) > 1e-6f ? 0.5f * (d[k - 1] - d[k + 1]) / denom : 0.f;
+        offset = std::clamp(offset, -0.5f, 0.5f);
+        peaks.push_back({k + offset, a});
+    }
+    return peaks;
+}
+
+double median(std::vector<double> v)
+{
+    if (v.empty()) return 0.0;
+    auto mid = v.begin() + v.size() / 2;
+    std::nth_element(v.begin(), mid, v.end());
+    return *mid;
+}
+
+/**
+ * 迭代剔除离群点的通用拟合框架
+ * 前几轮阈值取 max(配置阈值, 3×MAD估计σ)，最后一轮收紧到配置阈值，
+ * 避免初始拟合被离群点带偏时一次性剔除过多内点。
+ */
+bool robustFit(QVector<CaliperEdgePoint>& pts, const CaliperConfig& cfg, int minPoints,
+               const std::function<bool(const std::vector<cv::Point2f>&)>& fit,
+               const std::function<double(const cv::Point2f&)>& residual,
+               double& rms, int& inlierCount)
+{
+    std::vector<cv::Point2f> used;
+    for (const auto& e : pts) used.push_back(cv::Point2f(e.pos.x(), e.pos.y()));
+    if (static_cast<int>(used.size()) < minPoints || !fit(used)) return false;
+
+    const int iterations = std::max(1, cfg.fitIterations);
+    for (int iter = 0; iter < iterations; ++iter) {
+        std::vector<double> res;
+        res.reserve(pts.size());
+        for (const auto& e : pts) res.push_back(residual(cv::Point2f(e.pos.x(), e.pos.y())));
+
+        double thr = cfg.outlierThreshold;
+        if (iter + 1 < iterations) thr = std::max(thr, 3.0 * 1.4826 * median(res));
+
+        used.clear();
+        for (int i = 0; i < pts.size(); ++i) {
+            pts[i].inlier = res[i] <= thr;
+            if (pts[i].inlier) used.push_back(cv::Point2f(pts[i].pos.x(), pts[i].pos.y()));
+        }
+        if (static_cast<int>(used.size()) < minPoints || !fit(used)) return false;
+    }
+
+    double sum2 = 0.0;
+    inlierCount = 0;
+    for (auto& e : pts) {
+        double r = residual(cv::Point2f(e.pos.x(), e.pos.y()));
+        e.inlier = r <= cfg.outlierThreshold;
+        if (e.inlier) {
+            sum2 += r * r;
+            ++inlierCount;
+        }
+    }
+    rms = inlierCount > 0 ? std::sqrt(sum2 / inlierCount) : 0.0;
+    return inlierCount >= minPoints;
+}
+
+/// 代数圆拟合（Kåsa），先去均值改善条件数
+bool fitCircleAlgebraic(const std::vector<cv::Point2f>& pts, cv::Point2f& center, double& radius)
+{
+    const int n = static_cast<int>(pts.size());
+    if (n < 3) return false;
+
+    cv::Point2d mean(0, 0);
+    for (const auto& p : pts) mean += cv::Point2d(p.x, p.y);
+    mean *= 1.0 / n;
+
+    cv::Mat A(n, 3, CV_64F), b(n, 1, CV_64F);
+    for (int i = 0; i < n; ++i) {
+        double x = pts[i].x - mean.x, y = pts[i].y - mean.y;
+        A.at<double>(i, 0) = x;
+        A.at<double>(i, 1) = y;
+        A.at<double>(i, 2) = 1.0;
+        b.at<double>(i, 0) = -(x * x + y * y);
+    }
+
+    cv::Mat sol;
+    if (!cv::solve(A, b, sol, cv::DECOMP_SVD)) return false;
+
+    double cx = -sol.at<double>(0) / 2.0;
+    double cy = -sol.at<double>(1) / 2.0;
+    double r2 = cx * cx + cy * cy - sol.at<double>(2);
+    if (r2 <= 0) return false;
+
+    center = cv::Point2f(static_cast<float>(cx + mean.x), static_cast<float>(cy + mean.y));
+    radius = std::sqrt(r2);
+    return true;
+}
+
+} // anonymous namespace
+
+std::vector<CaliperTool::Caliper> CaliperTool::layout(const cv::Point2f& start, const cv::Point2f& end,
+                                                      const CaliperConfig& cfg)
+{
+    std::vector<Caliper> calipers;
+    const cv::Point2f d = end - start;
+    const float len = static_cast<float>(cv::norm(d));
+    if (len < 1e-3f) return calipers;
+
+    const int n = std::max(1, cfg.caliperCount);
+    calipers.reserve(n);
+
+    if (cfg.shape == 1) {
+        // 圆弧：start=圆心，|d|=半径，从参考线方向起逆时针张 arcSpanDeg
+        const double theta0 = std::atan2(d.y, d.x);
+        const double span = std::clamp(cfg.arcSpanDeg, 1.0, 360.0) * CV_PI / 180.0;
+        for (int i = 0; i < n; ++i) {
+            double theta = theta0 + span * (i + 0.5) / n;
+            cv::Point2f r(static_cast<float>(std::cos(theta)), static_cast<float>(std::sin(theta)));
+            calipers.push_back({start + r * len, r, cv::Point2f(-r.y, r.x)});
+        }
+    } else {
+        const cv::Point2f u = d * (1.0f / len);
+        const cv::Point2f normal(-u.y, u.x);
+        for (int i = 0; i < n; ++i) {
+            calipers.push_back({start + d * ((i + 0.5f) / n), normal, u});
+        }
+    }
+    return calipers;
+}
+
+CaliperResult CaliperTool::measure(const cv::Mat& gray, const cv::Point2f& start, const cv::Point2f& end,
+                                   const CaliperConfig& cfg)
+{
+    CaliperResult result;
+    result.shape = cfg.shape;
+
+    if (gray.empty() || gray.type() != CV_8UC1) {
+        result.message = "卡尺: 输入需为8位灰度图";
+        return result;
+    }
+
+    const std::vector<Caliper> calipers = layout(start, end, cfg);
+    if (calipers.empty()) {
+        result.message = "卡尺: 测量路径无效";
+        return result;
+    }
+
+    BenchmarkTimer t("Caliper::measure");
+
+    try {
+        const int N = static_cast<int>(calipers.size());
+        const int L = std::max(5, cvRound(cfg.searchLength));
+        const int P = std::max(1, cvRound(cfg.projectionLength));
+        const float halfL = (L - 1) * 0.5f;
+        const float halfP = (P - 1) * 0.5f;
+
+        // 1. 生成全部采样坐标：第 i*P+p 行 = 第 i 个卡尺的第 p 条投影线
+        cv::Mat mapX(N * P, L, CV_32F), mapY(N * P, L, CV_32F);
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+        for (int i = 0; i < N; ++i) {
+            const Caliper& c = calipers[i];
+            for (int p = 0; p < P; ++p) {
+                cv::Point2f base = c.center + c.tangent * (p - halfP) - c.normal * halfL;
+                float* mx = mapX.ptr<float>(i * P + p);
+                float* my = mapY.ptr<float>(i * P + p);
+                for (int k = 0; k < L; ++k) {
+                    mx[k] = base.x + c.normal.x * k;
+                    my[k] = base.y + c.normal.y * k;
+                }
+                minX = std::min({minX, mx[0], mx[L - 1]});
+                maxX = std::max({maxX, mx[0], mx[L - 1]});
+                minY = std::min({minY, my[0], my[L - 1]});
+                maxY = std::max({maxY, my[0], my[L - 1]});
+            }
+        }
+
+        // 2. 只把采样覆盖区域转为浮点，一次 remap 完成全部双线性采样
+        const cv::Rect imageRect(0, 0, gray.cols, gray.rows);
+        cv::Rect bbox(cvFloor(minX) - 1, cvFloor(minY) - 1,
+                      cvCeil(maxX) - cvFloor(minX) + 3, cvCeil(maxY) - cvFloor(minY) + 3);
+        bbox &= imageRect;
+        if (bbox.empty()) {
+            result.message = "卡尺: 测量路径超出图像";
+            return result;
+        }
+        mapX -= bbox.x;
+        mapY -= bbox.y;
+
+        cv::Mat patch;
+        gray(bbox).convertTo(patch, CV_32F);
+        cv::Mat samples;
+        cv::remap(patch, samples, mapX, mapY, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+
+        // 3. 投影：每个卡尺 P 行平均 → N×L 剖面
+        cv::Mat profiles(N, L, CV_32F);
+        for (int i = 0; i < N; ++i) {
+            cv::Mat row = profiles.row(i);
+            cv::reduce(samples.rowRange(i * P, (i + 1) * P), row, 0, cv::REDUCE_AVG);
+        }
+
+        // 4. 整个矩阵一次性平滑 + 求导（中心差分，正值=沿法向由暗变亮）
+        if (cfg.sigma > 0) {
+            int ksize = 2 * static_cast<int>(std::ceil(3.0 * cfg.sigma)) + 1;
+            cv::Mat gauss = cv::getGaussianKernel(ksize, cfg.sigma, CV_32F);
+            cv::sepFilter2D(profiles, profiles, CV_32F, gauss, cv::Mat::ones(1, 1, CV_32F),
+                            cv::Point(-1, -1), 0, cv::BORDER_REPLICATE);
+        }
+        cv::Mat deriv;
+        cv::filter2D(profiles, deriv, CV_32F, cv::Matx13f(-0.5f, 0.f, 0.5f),
+                     cv::Point(-1, -1), 0, cv::BORDER_REPLICATE);
+
+        // 5. 每条剖面取边缘（亚像素）
+        auto toImage = [&](const Caliper& c, float pos) {
+            cv::Point2f p = c.center + c.normal * (pos - halfL);
+            return QPointF(p.x, p.y);
+        };
+
+        QVector<double> widths;
+        for (int i = 0; i < N; ++i) {
+            std::vector<Peak> peaks = findPeaks(deriv.ptr<float>(i), L, cfg.minContrast);
+
+            if (cfg.edgeMode == 1) {
+                // 边缘对：第一条边满足极性，第二条边极性相反且位于其后
+                double bestScore = -1.0;
+                const Peak* bestA = nullptr;
+                const Peak* bestB = nullptr;
+                for (const auto& a : peaks) {
+                    if (!matchPolarity(a.amp, cfg.polarity)) continue;
+                    for (const auto& b : peaks) {
+                        if (b.pos <= a.pos || (a.amp > 0) == (b.amp > 0)) continue;
+                        double score = std::abs(a.amp) + std::abs(b.amp);
+                        if (cfg.expectedWidth > 0)
+                            score /= 1.0 + std::abs((b.pos - a.pos) - cfg.expectedWidth);
+                        if (score > bestScore) {
+                            bestScore = score;
+                            bestA = &a;
+                            bestB = &b;
+                        }
+                    }
+                }
+                if (bestA && bestB) {
+                    result.edges.append({toImage(calipers[i], bestA->pos), bestA->amp, i, true});
+                    result.secondEdges.append({toImage(calipers[i], bestB->pos), bestB->amp, i, true});
+                    widths.append(bestB->pos - bestA->pos);
+                }
+            } else {
+                const Peak* best = nullptr;
+                for (const auto& pk : peaks) {
+                    if (!matchPolarity(pk.amp, cfg.polarity)) continue;
+                    if (!best || std::abs(pk.amp) > std::abs(best->amp)) best = &pk;
+                }
+                if (best) {
+                    result.edges.append({toImage(calipers[i], best->pos), best->amp, i, true});
+                }
+            }
+        }
+
+        // 6. 鲁棒拟合（第一条边）
+        bool fitted = false;
+        if (cfg.shape == 1) {
+            cv::Point2f center;
+            double radius = 0.0;
+            fitted = robustFit(result.edges, cfg, 3,
+                [&](const std::vector<cv::Point2f>& pts) { return fitCircleAlgebraic(pts, center, radius); },
+                [&](const cv::Point2f& p) { return std::abs(cv::norm(p - center) - radius); },
+                result.fitRmsPx, result.inlierCount);
+            result.circleCenter = QPointF(center.x, center.y);
+            result.circleRadius = radius;
+        } else {
+            cv::Vec4f line;
+            fitted = robustFit(result.edges, cfg, 2,
+                [&](const std::vector<cv::Point2f>& pts) {
+                    cv::fitLine(pts, line, pts.size() > 4 ? cv::DIST_HUBER : cv::DIST_L2, 0, 0.01, 0.01);
+                    return true;
+                },
+                [&](const cv::Point2f& p) {
+                    return static_cast<double>(std::abs((p.x - line[2]) * line[1] - (p.y - line[3]) * line[0]));
+                },
+                result.fitRmsPx, result.inlierCount);
+            result.linePoint = QPointF(line[2], line[3]);
+            result.lineDir = QPointF(line[0], line[1]);
+        }
+
+        // 7. 测量值
+        const double px = cfg.pixelSizeUm;
+        if (cfg.edgeMode == 1) {
+            std::vector<double> w(widths.begin(), widths.end());
+            double med = median(w);
+            double sum = 0.0, sum2 = 0.0;
+            for (int i = 0; i < widths.size(); ++i) {
+                bool ok = std::abs(widths[i] - med) <= cfg.outlierThreshold;
+                result.edges[i].inlier = result.edges[i].inlier && ok;
+                result.secondEdges[i].inlier = ok;
+                if (!ok) continue;
+                result.widthsPx.append(widths[i]);
+                sum += widths[i];
+                sum2 += widths[i] * widths[i];
+            }
+            const int n = result.widthsPx.size();
+            if (n > 0) {
+                double mean = sum / n;
+                result.measuredUm = mean * px;
+                result.stdDevUm = std::sqrt(std::max(0.0, sum2 / n - mean * mean)) * px;
+                result.valid = true;
+            }
+        } else if (fitted) {
+            if (cfg.shape == 1) {
+                result.measuredUm = 2.0 * result.circleRadius * px;
+            } else {
+                // 拟合直线相对参考线中点的法向偏移
+                cv::Point2f mid = (start + end) * 0.5f;
+                cv::Point2f dir(result.lineDir.x(), result.lineDir.y());
+                cv::Point2f p0(result.linePoint.x(), result.linePoint.y());
+                cv::Point2f q = p0 + dir * (mid - p0).dot(dir);
+                result.measuredUm = (q - mid).dot(calipers.front().normal) * px;
+            }
+            result.stdDevUm = result.fitRmsPx * px;
+            result.valid = true;
+        }
+
+        // 8. 判定
+        if (!result.valid) {
+            result.pass = false;
+            result.message = QString("卡尺: 有效边缘不足 (%1/%2)").arg(result.edges.size()).arg(N);
+        } else {
+            if (cfg.toleranceUm > 0)
+                result.pass = std::abs(result.measuredUm - cfg.nominalUm) <= cfg.toleranceUm;
+
+            const char* what = cfg.edgeMode == 1 ? "宽度" : (cfg.shape == 1 ? "直径" : "偏移");
+            result.message = QString("卡尺%1: %2 μm (σ=%3 μm, RMS=%4 px, 内点 %5/%6)%7")
+                                 .arg(what)
+                                 .arg(result.measuredUm, 0, 'f', 2)
+                                 .arg(result.stdDevUm, 0, 'f', 2)
+                                 .arg(result.fitRmsPx, 0, 'f', 3)
+                                 .arg(result.inlierCount)
+                                 .arg(N)
+                                 .arg(cfg.toleranceUm > 0 ? (result.pass ? " OK" : " NG") : "");
+        }
+
+        spdlog::debug("[Caliper] {} (采样区域 {}x{})", result.message.toStdString(), bbox.width, bbox.height);
+    } catch (const cv::Exception& ex) {
+        spdlog::error("Caliper OpenCV错误: {}", ex.what());
+        result.valid = false;
+        result.pass = false;
+        result.message = "卡尺测量失败";
+    }
+
+    return result;
+}
@@ -132,7 +132,10 @@ DetectionItemResult DetectionEvaluator::evaluateLine(
         LineDetectConfig lineConfig;
     lineConfig.fromJson(detItem.config);
 
-    if (ctx.matchedLineCount == 0 && ctx.totalLineCount == 0) {
+    if (!ctx.caliper.pass) {
+        result.passed = false;
+        result.failReason = ctx.caliper.message;
+    } else if (ctx.matchedLineCount == 0 && ctx.totalLineCount == 0 && !ctx.caliper.valid) {
         result.passed = false;
         result.failReason = "未检测到直线";
     }
@@ -2,6 +2,7 @@
 #include "pipeline.h"
 #include "algorithm/opencv_algorithm.h"
 #include "logger.h"
+#include "utils/benchmark.h"
 #include <QImage>
 #include <QPainter>
 #include <QFont>
@@ -17,6 +18,20 @@ cv::Mat ensureBgr(const cv::Mat& img)
     return bgr;
 }
 
+/// 将Mask规整为与底图同尺寸的单通道8位图层；无法叠加时返回空
+cv::Mat toMaskLayer(const cv::Mat& mask, const cv::Size& baseSize)
+{
+    if (mask.empty() || mask.size() != baseSize) return cv::Mat();
+    if (mask.type() == CV_8UC1) return mask;
+
+    cv::Mat m;
+    if (mask.channels() == 3)
+        cv::cvtColor(mask, m, cv::COLOR_BGR2GRAY);
+    else
+        mask.convertTo(m, CV_8U);
+    return m;
+}
+
 } // anonymous namespace
 
 namespace DisplayRenderer {
@@ -55,10 +70,7 @@ cv::Mat render(const PipelineContext& ctx, DisplayConfig::Mode mode)
             return ensureBgr(ctx.visualBase);
 
         case Mode::MaskOverlay:
-            if (!ctx.extractedMask.empty())
-                return overlayMaskOnImage(ensureBgr(ctx.visualBase), ctx.extractedMask);
-            if (!ctx.filterMask.empty())
-                return overlayMaskOnImage(ensureBgr(ctx.visualBase), ctx.filterMask);
+            // Mask 由 overlayFor() 作为着色层叠加，底图保持不变
             return ensureBgr(ctx.visualBase);
 
         case Mode::Processed:
@@ -75,25 +87,8 @@ cv::Mat render(const PipelineContext& ctx, DisplayConfig::Mode mode)
             return ensureBgr(ctx.visualBase);
 
         case Mode::BarcodeOverlay:
-            {
-                cv::Mat base = ensureBgr(ctx.visualBase);
-                if (!base.empty()) {
-                    if (!ctx.barcodeResults.isEmpty())
-                        return drawBarcodeOverlay(base, ctx.barcodeResults);
-                    return base;
-                }
-            }
-            return ensureBgr(ctx.visualBase);
-
         case Mode::OcrOverlay:
-            {
-                cv::Mat base = ensureBgr(ctx.visualBase);
-                if (!base.empty()) {
-                    if (!ctx.ocrRegions.isEmpty())
-                        return drawOcrOverlay(base, ctx.ocrRegions);
-                    return base;
-                }
-            }
+            // 识别框/标签由 overlayFor() 提供
             return ensureBgr(ctx.visualBase);
 
         case Mode::MaskOnly:
@@ -108,16 +103,6 @@ cv::Mat render(const PipelineContext& ctx, DisplayConfig::Mode mode)
             return ensureBgr(ctx.visualBase);
 
         case Mode::ProcessedOverlay:
-            if (!ctx.extractedMask.empty()) {
-                cv::Mat overlayMask;
-                if (ctx.extractedMask.channels() == 1)
-                    overlayMask = ctx.extractedMask;
-                else
-                    cv::cvtColor(ctx.extractedMask, overlayMask, cv::COLOR_BGR2GRAY);
-                cv::Mat base = ensureBgr(ctx.visualBase);
-                if (!base.empty())
-                    return overlayMaskOnImage(base, overlayMask);
-            }
             return ensureBgr(ctx.visualBase);
 
         default:
@@ -137,6 +122,55 @@ spdlog::error(QString("DisplayRenderer渲染异常: %1").arg(e.what()));
 }
 
 
+OverlayModel overlayFor(const PipelineContext& ctx, DisplayConfig::Mode mode)
+{
+    using Mode = DisplayConfig::Mode;
+
+    OverlayModel overlay;
+    try {
+        switch (mode)
+        {
+        case Mode::MaskOverlay:
+            {
+                cv::Mat mask = !ctx.extractedMask.empty() ? ctx.extractedMask : ctx.filterMask;
+                cv::Mat m = toMaskLayer(mask, ctx.visualBase.size());
+                if (!m.empty())
+                    overlay.addMask(OverlayGroup::Mask, m, QColor(0, 255, 0));
+            }
+            break;
+
+        case Mode::ProcessedOverlay:
+            {
+                cv::Mat m = toMaskLayer(ctx.extractedMask, ctx.visualBase.size());
+                if (!m.empty())
+                    overlay.addMask(OverlayGroup::Mask, m, QColor(0, 255, 0));
+            }
+            break;
+
+        case Mode::LineDetect:
+            overlay = ctx.overlay.filtered(OverlayGroup::Line);
+            overlay.append(ctx.overlay.filtered(OverlayGroup::Caliper));
+            break;
+
+        case Mode::BarcodeOverlay:
+            overlay = ctx.overlay.filtered(OverlayGroup::Barcode);
+            break;
+
+        case Mode::OcrOverlay:
+            overlay = ctx.overlay.filtered(OverlayGroup::Ocr);
+            break;
+
+        default:
+            break;
+        }
+    } catch (const cv::Exception& ex) {
+        spdlog::error("DisplayRenderer叠加层错误: {}", ex.what());
+        overlay.clear();
+    }
+    return overlay;
+}
+
+
 cv::Mat overlayMaskOnImage(const cv::Mat& bgr, const cv::Mat& mask, float alpha)
 {
     Q_UNUSED(alpha); // 当前使用固定绿色叠加，alpha保留为后续扩展
@@ -297,5 +331,67 @@ spdlog::error(QString("drawOcrOverlay错误: %1").arg(ex.what()));
     }
 }
 
+void benchmark(const cv::Mat& bgr, int iterations)
+{
+    if (bgr.empty() || iterations <= 0) return;
+
+    try {
+        const cv::Mat base = ensureBgr(bgr);
+        cv::Mat gray, mask;
+        cv::cvtColor(base, gray, cv::COLOR_BGR2GRAY);
+        cv::threshold(gray, mask, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+
+        // 3x3 网格中各放一个条码和一行文字，矢量叠加层按步骤的输出方式描述同样的结果
+        QVector<BarcodeResult> barcodes;
+        QVector<OcrRegion> regions;
+        PipelineContext ctx;
+        ctx.visualBase = base;
+        ctx.extractedMask = mask;
+        const double cellW = base.cols / 3.0;
+        const double cellH = base.rows / 3.0;
+        for (int i = 0; i < 9; ++i) {
+            const double x = (i % 3) * cellW + cellW * 0.1;
+            const double y = (i / 3) * cellH + cellH * 0.1;
+
+            BarcodeResult bc;
+            bc.type = "QR Code";
+            bc.data = QString("SN%1").arg(100000 + i);
+            bc.location = QRectF(x, y, cellW * 0.5, cellH * 0.4);
+            bc.quality = 90;
+            barcodes.append(bc);
+            ctx.overlay.addBox(OverlayGroup::Barcode, bc.location, QColor(0, 255, 0));
+            ctx.overlay.addLabel(OverlayGroup::Barcode, bc.location.topLeft(),
+                                 QString("[%1] %2").arg(bc.type, bc.data));
+
+            OcrRegion region;
+            region.x = static_cast<int>(x);
+            region.y = static_cast<int>(y + cellH * 0.5);
+            region.width = static_cast<int>(cellW * 0.7);
+            region.height = static_cast<int>(cellH * 0.2);
+            region.text = QString("LOT%1 2026-10-18").arg(i);
+            region.confidence = 0.95;
+            regions.append(region);
+            const QRectF rect(region.x, region.y, region.width, region.height);
+            ctx.overlay.addBox(OverlayGroup::Ocr, rect, QColor(0, 255, 0));
+            ctx.overlay.addLabel(OverlayGroup::Ocr, rect.topLeft(), region.text);
+        }
+
+        spdlog::info("[BENCH] Overlay 图像 {}x{}, 条码 {} 个, OCR {} 个",
+                     base.cols, base.rows, barcodes.size(), regions.size());
+        benchmarkAvg("Overlay::burnIn", iterations, [&] {
+            overlayMaskOnImage(base, mask);
+            drawBarcodeOverlay(base, barcodes);
+            drawOcrOverlay(base, regions);
+        });
+        benchmarkAvg("Overlay::vector", iterations, [&] {
+            overlayFor(ctx, DisplayConfig::Mode::MaskOverlay);
+            overlayFor(ctx, DisplayConfig::Mode::BarcodeOverlay);
+            overlayFor(ctx, DisplayConfig::Mode::OcrOverlay);
+        });
+    } catch (const cv::Exception& ex) {
+        spdlog::error("DisplayRenderer benchmark OpenCV错误: {}", ex.what());
+    }
+}
+
 } // namespace DisplayRenderer
 
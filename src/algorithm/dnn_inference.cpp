@@ -1,8 +1,11 @@
 #include "dnn_inference.h"
+#include "yolo_postprocess.h"
 #include <QFileInfo>
 #include <QFile>
 #include <QDir>
 #include <spdlog/spdlog.h>
+#include <chrono>
+#include "core/metrics.h"
 
 bool DnnInference::loadModel(const QString& modelPath, const QString& configPath, bool useGpu)
 {
@@ -147,8 +150,13 @@ std::vector<DetectionResult> DnnInference::detect(const cv::Mat& input,
             return results;
         }
 
+        static MetricHistogram& forwardLatency = MetricsRegistry::instance().histogram(
+            "edgevision_inference_duration_ms", "模型前向推理耗时（ms，不含前后处理）", {{"backend", "opencv_dnn"}});
+        const auto forwardStart = std::chrono::steady_clock::now();
         std::vector<cv::Mat> outputs;
         net_.forward(outputs, outputNames);
+        forwardLatency.observe(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - forwardStart).count());
 
         // YOLOv8 输出格式: [1, num_classes+4, num_detections]
         // 即每一列是一个检测结果，前4行是 x,y,w,h，后面是各类别置信度
@@ -161,87 +169,20 @@ std::vector<DetectionResult> DnnInference::detect(const cv::Mat& input,
         int numDetections = output.size[2];   // 检测数量
         int numAttributes = output.size[1];   // 4 + num_classes
 
-        // 重塑为 2D: [num_detections, num_attributes]
-        cv::Mat flatOutput = output.reshape(1, numAttributes);
-
-        float invR = 1.0f / r;
-
-        // 解析每个检测结果
-        for (int i = 0; i < numDetections; ++i)
-        {
-            // 获取该检测的所有属性（列数据）
-            cv::Mat detCol = flatOutput.col(i);
-
-            float cx = detCol.at<float>(0);
-            float cy = detCol.at<float>(1);
-            float w  = detCol.at<float>(2);
-            float h  = detCol.at<float>(3);
-
-            // 找到最大置信度的类别
-            float maxConf = 0.0f;
-            int bestClassId = 0;
-            for (int j = 4; j < numAttributes; ++j)
-            {
-                float conf = detCol.at<float>(j);
-                if (conf > maxConf)
-                {
-                    maxConf = conf;
-                    bestClassId = j - 4;
-                }
-            }
-
-            // 置信度过滤
-            if (maxConf < confThreshold)
-                continue;
-
-            // 转换为左上角坐标并缩放到原图尺寸（考虑 letterbox 填充偏移）
-            int left   = static_cast<int>((cx - w / 2.0f - padLeft) * invR);
-            int top    = static_cast<int>((cy - h / 2.0f - padTop) * invR);
-            int width  = static_cast<int>(w * invR);
-            int height = static_cast<int>(h * invR);
-
-            // 边界裁剪
-            left   = std::max(0, left);
-            top    = std::max(0, top);
-            width  = std::min(width, imgWidth - left);
-            height = std::min(height, imgHeight - top);
-
-            DetectionResult det;
-            det.box = cv::Rect(left, top, width, height);
-            det.confidence = maxConf;
-            det.classId = bestClassId;
-            if (bestClassId >= 0 && bestClassId < static_cast<int>(classNames_.size()))
-            {
-                det.className = classNames_[bestClassId];
-            }
-            else
-            {
-                det.className = "class_" + std::to_string(bestClassId);
-            }
-            results.push_back(det);
-        }
-
-        // NMS后处理
-        if (!results.empty())
-        {
-            std::vector<cv::Rect> boxes;
-            std::vector<float> confs;
-            for (const auto& r : results)
-            {
-                boxes.push_back(r.box);
-                confs.push_back(r.confidence);
-            }
-
-            std::vector<int> indices;
-            cv::dnn::NMSBoxes(boxes, confs, confThreshold, nmsThreshold, indices);
-
-            std::vector<DetectionResult> nmsResults;
-            for (int idx : indices)
-            {
-                nmsResults.push_back(results[idx]);
-            }
-            return nmsResults;
-        }
+        // 按原始连续内存解析（[1, num_attributes, num_detections] 行主序）
+        if (!output.isContinuous())
+            output = output.clone();
+
+        YoloDecodeParams params;
+        params.confThreshold = confThreshold;
+        params.nmsThreshold = nmsThreshold;
+        params.scaleX = 1.0f / r;
+        params.scaleY = 1.0f / r;
+        params.padX = static_cast<float>(padLeft);
+        params.padY = static_cast<float>(padTop);
+        params.imgWidth = imgWidth;
+        params.imgHeight = imgHeight;
+        results = YoloPostprocess::decode(output.ptr<float>(), numAttributes, numDetections, params, classNames_);
     }
     catch (const cv::Exception& e)
     {
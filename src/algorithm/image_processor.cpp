@@ -1,5 +1,6 @@
 ﻿#include "image_processor.h"
 #include "opencv_algorithm.h"
+#include "tiled_executor.h"
 #include "logger.h"
 
 ImageProcessor::ImageProcessor() {}
@@ -33,7 +34,7 @@ cv::Mat ImageProcessor::convertColorSpace(const cv::Mat &src, const QString &mod
     }
 }
 
-cv::Mat ImageProcessor::executeAlgorithmQueue(const cv::Mat &src, const QVector<AlgorithmStep> &queue)
+cv::Mat ImageProcessor::executeAlgorithmQueue(const cv::Mat &src, const QVector<AlgorithmStep> &queue, int tileSize)
 {
     if(src.empty()) return src;
 
@@ -69,6 +70,24 @@ cv::Mat ImageProcessor::executeAlgorithmQueue(const cv::Mat &src, const QVector<
         cv::Mat currentMat = gray.clone();
         int executedSteps = 0;
 
+        // 连续的局部步骤攒成一段：分块时整段在块内依次执行，halo 取各步半径之和
+        std::vector<const AlgorithmStep*> localRun;
+        int runHalo = 0;
+        auto flushLocalRun = [&]() {
+            if (localRun.empty()) return;
+            auto runSteps = [&](const cv::Mat& tile) {
+                cv::Mat m = tile;
+                for (const AlgorithmStep* s : localRun) {
+                    m = OpenCVAlgorithm::execute(m, *s);
+                }
+                return m;
+            };
+            currentMat = tileSize > 0 ? TiledExecutor::apply(currentMat, runHalo, tileSize, runSteps)
+                                      : runSteps(currentMat);
+            localRun.clear();
+            runHalo = 0;
+        };
+
         for(const auto& step : queue)
         {
             if(!step.enabled) {
@@ -82,9 +101,17 @@ cv::Mat ImageProcessor::executeAlgorithmQueue(const cv::Mat &src, const QVector<
             }
 
             // 直接在cv::Mat上使用OpenCV算法
-            currentMat = OpenCVAlgorithm::execute(currentMat, step);
+            const int radius = OpenCVAlgorithm::neighborhoodRadius(step);
+            if (radius >= 0) {
+                localRun.push_back(&step);
+                runHalo += radius;
+            } else {
+                flushLocalRun();
+                currentMat = OpenCVAlgorithm::execute(currentMat, step);
+            }
             executedSteps++;
         }
+        flushLocalRun();
 
         spdlog::debug("[executeAlgorithmQueue] 完成，共执行 {} 个步骤", executedSteps);
 
@@ -104,27 +131,35 @@ cv::Mat ImageProcessor::executeAlgorithmQueue(const cv::Mat &src, const QVector<
     }
 }
 
-cv::Mat ImageProcessor::adjustParameter(const cv::Mat &src, int brightness, double contrast, double gamma,double sharpen)
+cv::Mat ImageProcessor::adjustParameter(const cv::Mat &src, int brightness, double contrast, double gamma,double sharpen,int tileSize)
 {
     if(src.empty()) return src;
 
     try {
-        cv::Mat dst;
-        src.convertTo(dst,-1,contrast,brightness);
-
         cv::Mat lut(1,256,CV_8U);
         for(int i=0;i<256;i++)
             lut.at<uchar>(i)=cv::saturate_cast<uchar>(pow(i/255.0,gamma)*255.0);
-        cv::LUT(dst,lut,dst);
-        if(sharpen>0.0)
-        {
-            cv::Mat blur;
-            cv::GaussianBlur(dst,blur,cv::Size(0,0),1.0);
-            cv::addWeighted(dst, 1.0 + sharpen,
-                        blur, -sharpen,
-                        0, dst);
+
+        auto adjust = [&](const cv::Mat& in) {
+            cv::Mat dst;
+            in.convertTo(dst,-1,contrast,brightness);
+            cv::LUT(dst,lut,dst);
+            if(sharpen>0.0)
+            {
+                cv::Mat blur;
+                cv::GaussianBlur(dst,blur,cv::Size(0,0),1.0);
+                cv::addWeighted(dst, 1.0 + sharpen,
+                            blur, -sharpen,
+                            0, dst);
+            }
+            return dst;
+        };
+
+        if (tileSize > 0) {
+            // 锐化的 σ=1 高斯核为 7x7，halo 取 3；其余均为逐像素运算
+            return TiledExecutor::apply(src, sharpen > 0.0 ? 3 : 0, tileSize, adjust);
         }
-        return dst;
+        return adjust(src);
     } catch (const cv::Exception& ex) {
         spdlog::error("图像增强参数调整错误: {}", ex.what());
         return src;
@@ -0,0 +1,302 @@
+﻿#include "line_match_engine.h"
+#include "logger.h"
+#include "utils/benchmark.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/line_descriptor.hpp>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+// ========== 检测器（按线程缓存） ==========
+
+cv::line_descriptor::LSDDetector& threadLsdDetector()
+{
+    thread_local cv::Ptr<cv::line_descriptor::LSDDetector> detector =
+        cv::line_descriptor::LSDDetector::createLSDDetector();
+    return *detector;
+}
+
+cv::line_descriptor::BinaryDescriptor& threadEdDetector()
+{
+    thread_local cv::Ptr<cv::line_descriptor::BinaryDescriptor> detector =
+        cv::line_descriptor::BinaryDescriptor::createBinaryDescriptor();
+    return *detector;
+}
+
+void appendKeyLines(const std::vector<cv::line_descriptor::KeyLine>& keylines, std::vector<cv::Vec4f>& lines)
+{
+    for (const auto& kl : keylines)
+    {
+        cv::Point2f p1 = kl.getStartPoint();
+        cv::Point2f p2 = kl.getEndPoint();
+        if (p1 != p2) {
+            lines.push_back(cv::Vec4f(p1.x, p1.y, p2.x, p2.y));
+        }
+    }
+}
+
+void detectLinesHoughP(const cv::Mat& gray, const LineDetectConfig& cfg, std::vector<cv::Vec4f>& lines)
+{
+    try {
+        cv::Mat edges;
+        cv::Canny(gray, edges, 50, 150);
+
+        std::vector<cv::Vec4i> linesInt;
+        cv::HoughLinesP(edges, linesInt, cfg.rho, cfg.theta, cfg.threshold, cfg.minLength, cfg.maxGap);
+
+        for (const auto& line : linesInt) {
+            lines.push_back(cv::Vec4f(line[0], line[1], line[2], line[3]));
+        }
+
+        spdlog::debug("[HoughP] 检测到 {} 条直线", linesInt.size());
+    } catch (const cv::Exception& ex) {
+        spdlog::error("HoughP OpenCV错误: {}", ex.what());
+    }
+}
+
+void detectLinesLSD(const cv::Mat& gray, std::vector<cv::Vec4f>& lines)
+{
+    try {
+        std::vector<cv::line_descriptor::KeyLine> keylines;
+        threadLsdDetector().detect(gray, keylines, 2, 1);
+        spdlog::debug("[LSD] 检测到 {} 条直线", keylines.size());
+        appendKeyLines(keylines, lines);
+    } catch (const cv::Exception& ex) {
+        spdlog::error("LSD OpenCV错误: {}", ex.what());
+    }
+}
+
+void detectLinesEDlines(const cv::Mat& gray, std::vector<cv::Vec4f>& lines)
+{
+    try {
+        std::vector<cv::line_descriptor::KeyLine> keylines;
+        threadEdDetector().detect(gray, keylines);
+        spdlog::debug("[EDlines] 检测到 {} 条直线", keylines.size());
+        appendKeyLines(keylines, lines);
+    } catch (const cv::Exception& ex) {
+        spdlog::error("EDlines OpenCV错误: {}", ex.what());
+    }
+}
+
+// ========== 参考线几何 ==========
+
+double calculateLineAngle(const cv::Vec4f& line)
+{
+    return std::atan2(line[3] - line[1], line[2] - line[0]) * 180.0 / CV_PI;
+}
+
+double pointToLineDistance(const cv::Point2f& point, const cv::Point2f& lineStart, const cv::Point2f& lineEnd)
+{
+    cv::Point2f lineVec = lineEnd - lineStart;
+    cv::Point2f pointVec = point - lineStart;
+
+    double lineLength = cv::norm(lineVec);
+    if (lineLength < 1e-6) {
+        return cv::norm(pointVec);
+    }
+
+    double cross = std::abs(lineVec.x * pointVec.y - lineVec.y * pointVec.x);
+    return cross / lineLength;
+}
+
+double calculateAngleDifference(double angle1, double angle2)
+{
+    double diff = std::abs(angle1 - angle2);
+    if (diff > 180.0) {
+        diff = 360.0 - diff;
+    }
+    return diff;
+}
+
+/// 搜索带几何：参考线方向 u、法向 n、四个角点（原图坐标）
+struct SearchBand
+{
+    cv::Point2f start, end;
+    cv::Point2f u, n;
+    float length = 0.f;
+    float halfWidth = 0.f;
+    std::vector<cv::Point2f> corners;
+};
+
+bool makeSearchBand(const LineDetectConfig& cfg, SearchBand& band)
+{
+    band.start = cfg.referenceLineStart;
+    band.end = cfg.referenceLineEnd;
+    cv::Point2f dir = band.end - band.start;
+    band.length = static_cast<float>(cv::norm(dir));
+    if (band.length < 1e-6f) return false;
+
+    band.u = dir * (1.0f / band.length);
+    band.n = cv::Point2f(-band.u.y, band.u.x);
+    band.halfWidth = cfg.searchRegionWidth / 2.0f;
+
+    cv::Point2f offset = band.n * band.halfWidth;
+    band.corners = {band.start + offset, band.end + offset, band.end - offset, band.start - offset};
+    return true;
+}
+
+} // anonymous namespace
+
+// ========== 公共接口 ==========
+
+void LineMatchEngine::detectLines(const cv::Mat& gray, const LineDetectConfig& cfg, std::vector<cv::Vec4f>& lines)
+{
+    if (gray.empty()) return;
+
+    switch (cfg.algorithm) {
+    case 0: detectLinesHoughP(gray, cfg, lines); break;
+    case 1: detectLinesLSD(gray, lines); break;
+    case 2: detectLinesEDlines(gray, lines); break;
+    default: break;
+    }
+}
+
+void LineMatchEngine::markMatched(LineMatchResult& result, const LineDetectConfig& cfg)
+{
+    const cv::Point2f refStart = cfg.referenceLineStart;
+    const cv::Point2f refEnd = cfg.referenceLineEnd;
+    const double refAngle = std::atan2(refEnd.y - refStart.y, refEnd.x - refStart.x) * 180.0 / CV_PI;
+
+    result.matched.assign(result.lines.size(), 0);
+    result.matchedCount = 0;
+
+    for (size_t i = 0; i < result.lines.size(); ++i) {
+        const cv::Vec4f& line = result.lines[i];
+        if (calculateAngleDifference(calculateLineAngle(line), refAngle) > cfg.angleThreshold)
+            continue;
+
+        cv::Point2f mid((line[0] + line[2]) / 2.0f, (line[1] + line[3]) / 2.0f);
+        if (pointToLineDistance(mid, refStart, refEnd) > cfg.distanceThreshold)
+            continue;
+
+        result.matched[i] = 1;
+        ++result.matchedCount;
+    }
+}
+
+LineMatchResult LineMatchEngine::matchReference(const cv::Mat& gray, const LineDetectConfig& cfg)
+{
+    LineMatchResult result;
+    if (gray.empty() || gray.type() != CV_8UC1) return result;
+
+    SearchBand band;
+    if (!makeSearchBand(cfg, band)) return result;
+
+    BenchmarkTimer t("LineMatch::matchReference");
+
+    const cv::Rect imageRect(0, 0, gray.cols, gray.rows);
+    result.searchRect = cv::boundingRect(band.corners) & imageRect;
+    if (result.searchRect.empty()) return result;
+
+    if (cfg.deskewSearchRegion) {
+        // 旋转摆正：搜索带映射为 W×H 的水平窄条，无需掩膜，也没有掩膜边界产生的伪边缘
+        const int W = std::max(1, cvCeil(band.length));
+        const int H = std::max(1, cvCeil(band.halfWidth * 2.0f));
+        const cv::Point2f c = (band.start + band.end) * 0.5f;
+
+        // 目标 (x, y) → 原图：c + u*(x - W/2) + n*(y - H/2)
+        cv::Matx23f M(band.u.x, band.n.x, c.x - band.u.x * W * 0.5f - band.n.x * H * 0.5f,
+                      band.u.y, band.n.y, c.y - band.u.y * W * 0.5f - band.n.y * H * 0.5f);
+
+        cv::Mat strip;
+        cv::warpAffine(gray, strip, M, cv::Size(W, H),
+                       cv::INTER_LINEAR | cv::WARP_INVERSE_MAP, cv::BORDER_REPLICATE);
+
+        std::vector<cv::Vec4f> local;
+        detectLines(strip, cfg, local);
+
+        result.lines.reserve(local.size());
+        for (const auto& l : local) {
+            result.lines.push_back(cv::Vec4f(
+                M(0, 0) * l[0] + M(0, 1) * l[1] + M(0, 2),
+                M(1, 0) * l[0] + M(1, 1) * l[1] + M(1, 2),
+                M(0, 0) * l[2] + M(0, 1) * l[3] + M(0, 2),
+                M(1, 0) * l[2] + M(1, 1) * l[3] + M(1, 2)));
+        }
+    } else {
+        // 外接矩形裁剪：掩膜只分配裁剪区域大小
+        const cv::Rect& rect = result.searchRect;
+        std::vector<cv::Point> poly;
+        poly.reserve(band.corners.size());
+        for (const auto& p : band.corners) {
+            poly.push_back(cv::Point(cvRound(p.x) - rect.x, cvRound(p.y) - rect.y));
+        }
+
+        cv::Mat mask = cv::Mat::zeros(rect.size(), CV_8UC1);
+        cv::fillConvexPoly(mask, poly, cv::Scalar(255));
+
+        cv::Mat masked = cv::Mat::zeros(rect.size(), CV_8UC1);
+        gray(rect).copyTo(masked, mask);
+
+        detectLines(masked, cfg, result.lines);
+        for (auto& l : result.lines) {
+            l[0] += rect.x; l[1] += rect.y;
+            l[2] += rect.x; l[3] += rect.y;
+        }
+    }
+
+    markMatched(result, cfg);
+    result.elapsedMs = t.elapsedMs();
+
+    spdlog::debug("[LineMatch] 处理区域 {}x{} / 原图 {}x{} ({:.1f}%), 直线 {} 条, 匹配 {} 条, 耗时 {:.2f} ms",
+                  result.searchRect.width, result.searchRect.height, gray.cols, gray.rows,
+                  100.0 * result.searchRect.area() / std::max(1, imageRect.area()),
+                  result.lines.size(), result.matchedCount, result.elapsedMs);
+    return result;
+}
+
+LineMatchResult LineMatchEngine::matchReferenceFullFrame(const cv::Mat& gray, const LineDetectConfig& cfg)
+{
+    LineMatchResult result;
+    SearchBand band;
+    if (gray.empty() || !makeSearchBand(cfg, band)) return result;
+
+    std::vector<cv::Point> poly;
+    for (const auto& p : band.corners) poly.push_back(cv::Point(p));
+
+    cv::Mat regionMask = cv::Mat::zeros(gray.size(), CV_8UC1);
+    cv::fillConvexPoly(regionMask, poly, cv::Scalar(255));
+
+    cv::Mat maskedGray;
+    gray.copyTo(maskedGray, regionMask);
+
+    // 旧实现每次新建检测器
+    if (cfg.algorithm == 1) {
+        auto detector = cv::line_descriptor::LSDDetector::createLSDDetector();
+        std::vector<cv::line_descriptor::KeyLine> keylines;
+        detector->detect(maskedGray, keylines, 2, 1);
+        appendKeyLines(keylines, result.lines);
+    } else if (cfg.algorithm == 2) {
+        auto detector = cv::line_descriptor::BinaryDescriptor::createBinaryDescriptor();
+        std::vector<cv::line_descriptor::KeyLine> keylines;
+        detector->detect(maskedGray, keylines);
+        appendKeyLines(keylines, result.lines);
+    } else {
+        detectLinesHoughP(maskedGray, cfg, result.lines);
+    }
+
+    result.searchRect = cv::Rect(0, 0, gray.cols, gray.rows);
+    markMatched(result, cfg);
+    return result;
+}
+
+void LineMatchEngine::benchmark(const cv::Mat& gray, const LineDetectConfig& cfg, int iterations)
+{
+    if (gray.empty() || iterations <= 0) return;
+
+    try {
+        LineDetectConfig cropped = cfg;
+        cropped.deskewSearchRegion = false;
+        LineDetectConfig deskewed = cfg;
+        deskewed.deskewSearchRegion = true;
+
+        spdlog::info("[BENCH] LineMatch 图像 {}x{}, 算法={}, 搜索带宽={}px",
+                     gray.cols, gray.rows, cfg.algorithm, cfg.searchRegionWidth);
+        benchmarkAvg("LineMatch::fullFrame", iterations, [&] { matchReferenceFullFrame(gray, cfg); });
+        benchmarkAvg("LineMatch::cropped", iterations, [&] { matchReference(gray, cropped); });
+        benchmarkAvg("LineMatch::deskewed", iterations, [&] { matchReference(gray, deskewed); });
+    } catch (const cv::Exception& ex) {
+        spdlog::error("LineMatch benchmark OpenCV错误: {}", ex.what());
+    }
+}
@@ -2,7 +2,6 @@
 #include "logger.h"
 #include "image_utils.h"
 #include <QCoreApplication>
-#include <QFile>
 
 MatchStrategy::MatchStrategy() {}
 
@@ -35,6 +34,9 @@ bool OpenCVMatchStrategy::createTemplate(const cv::Mat& fullImage,
             return false;
         }
 
+        m_templateGray = TemplateFile::makeGray(m_templateImage);
+        m_templateMapping.reset();
+
         // 2️⃣ 保存参数
         m_matchMethod = params.matchMethod;
         m_polygonPoints = polygon;
@@ -84,11 +86,7 @@ QVector<MatchResult> OpenCVMatchStrategy::findMatches(const cv::Mat& searchImage
             searchGray = searchImage;
         }
         
-        if (m_templateImage.channels() == 3) {
-            cv::cvtColor(m_templateImage, templateGray, cv::COLOR_BGR2GRAY);
-        } else {
-            templateGray = m_templateImage;
-        }
+        templateGray = m_templateGray.empty() ? TemplateFile::makeGray(m_templateImage) : m_templateGray;
 
         // 2️⃣ 执行模板匹配
         cv::Mat matchResult;
@@ -267,92 +265,44 @@ bool OpenCVMatchStrategy::saveTemplate(const QString& filePath) const
         return false;
     }
 
-    try {
-        // 使用 cv::FileStorage + MEMORY 模式序列化到内存字符串
-        cv::FileStorage fs(".tpl",
-            cv::FileStorage::WRITE | cv::FileStorage::MEMORY | cv::FileStorage::FORMAT_YAML);
-
-        fs << "templateImage" << m_templateImage;
-        fs << "matchMethod" << m_matchMethod;
-
-        fs << "polygonPoints" << "[";
-        for (const QPointF& pt : m_polygonPoints) {
-            fs << "{:" << "x" << pt.x() << "y" << pt.y() << "}";
-        }
-        fs << "]";
-
-        std::string content = fs.releaseAndGetString();
-
-        // 通过 Qt QFile 写出（支持中文路径）
-        QFile file(filePath);
-        if (!file.open(QIODevice::WriteOnly)) {
-            spdlog::error("保存模板文件失败: " + filePath);
-            return false;
-        }
-        file.write(content.data(), content.size());
-        file.close();
-
-        spdlog::info("模板保存成功: " + filePath);
+    // 模板仍引用该文件的映射说明是从该文件加载且未修改（重新创建模板时映射已释放），
+    // 无需重写；Windows 下也无法替换仍被映射的文件
+    if (m_templateMapping && m_templateMapping->maps(filePath)) {
+        spdlog::info("模板未修改，跳过保存: " + filePath);
         return true;
+    }
 
-    } catch (const cv::Exception& ex) {
-        spdlog::error("保存模板失败: " + QString(ex.what()));
+    TemplateFile::Content content;
+    content.image = m_templateImage;
+    content.gray = m_templateGray;
+    content.matchMethod = m_matchMethod;
+    content.polygonPoints = m_polygonPoints;
+
+    if (!TemplateFile::save(filePath, content)) {
+        spdlog::error("保存模板文件失败: " + filePath);
         return false;
     }
+
+    spdlog::info("模板保存成功: " + filePath);
+    return true;
 }
 
 bool OpenCVMatchStrategy::loadTemplate(const QString& filePath)
 {
-    try {
-        // 通过 Qt QFile 读取（支持中文路径）
-        QFile file(filePath);
-        if (!file.open(QIODevice::ReadOnly)) {
-            spdlog::error("加载模板文件失败: " + filePath);
-            return false;
-        }
-        QByteArray data = file.readAll();
-        file.close();
-
-        if (data.isEmpty()) {
-            spdlog::error("模板文件为空: " + filePath);
-            return false;
-        }
-
-        // 从内存字符串反序列化
-        cv::FileStorage fs(std::string(data.begin(), data.end()),
-            cv::FileStorage::READ | cv::FileStorage::MEMORY);
-
-        if (!fs.isOpened()) {
-            spdlog::error("模板文件格式错误: " + filePath);
-            return false;
-        }
-
-        fs["templateImage"] >> m_templateImage;
-        if (m_templateImage.empty()) {
-            spdlog::error("模板文件中没有有效的图像数据");
-            return false;
-        }
-
-        fs["matchMethod"] >> m_matchMethod;
-
-        // 读取多边形点
-        m_polygonPoints.clear();
-        cv::FileNode pts = fs["polygonPoints"];
-        if (pts.type() == cv::FileNode::SEQ) {
-            for (const auto& pt : pts) {
-                double x = pt["x"];
-                double y = pt["y"];
-                m_polygonPoints.append(QPointF(x, y));
-            }
-        }
-
-        m_hasTemplate = true;
-        spdlog::info("模板加载成功: " + filePath);
-        return true;
-
-    } catch (const cv::Exception& ex) {
-        spdlog::error("加载模板失败: " + QString(ex.what()));
+    TemplateFile::Content content;
+    if (!TemplateFile::load(filePath, content)) {
+        spdlog::error("加载模板文件失败: " + filePath);
         return false;
     }
-}
 
+    m_templateImage = content.image;
+    m_templateGray = content.gray;
+    m_templateMapping = content.mapping;
+    m_matchMethod = content.matchMethod;
+    m_polygonPoints = content.polygonPoints;
+
+    m_hasTemplate = true;
+    spdlog::info(QString("模板加载成功: %1%2").arg(filePath,
+                 content.legacyYaml ? "（旧版 YAML 格式，重新保存后转为二进制）" : ""));
+    return true;
+}
@@ -0,0 +1,183 @@
+#include "algorithm/ocr_recognizer.h"
+#include <QFile>
+#include <QTextStream>
+#include <opencv2/imgproc.hpp>
+#include "logger.h"
+#include "core/metrics.h"
+#include "utils/thread_tag.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+OcrRecognizer::OcrRecognizer()
+    : env_(ORT_LOGGING_LEVEL_WARNING, "OcrRecognizer")
+{
+}
+
+OcrRecognizer::~OcrRecognizer() = default;
+
+bool OcrRecognizer::loadModel(const QString& modelPath, const QString& keysPath, int numThreads)
+{
+    loaded_ = false;
+
+    QFile keysFile(keysPath);
+    if (!keysFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        spdlog::error("OcrRecognizer: cannot open keys file {}", keysPath);
+        return false;
+    }
+    keys_.clear();
+    keys_.emplace_back("#");  // CTC blank
+    QTextStream in(&keysFile);
+    in.setEncoding(QStringConverter::Utf8);
+    while (!in.atEnd())
+    {
+        QString line = in.readLine();
+        if (line.endsWith('\r')) line.chop(1);
+        keys_.push_back(line.toStdString());
+    }
+    keys_.emplace_back(" ");
+
+    try
+    {
+        sessionOptions_ = std::make_unique<Ort::SessionOptions>();
+        sessionOptions_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        sessionOptions_->SetIntraOpNumThreads(std::max(1, numThreads));
+        sessionOptions_->SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+
+#ifdef _WIN32
+        std::wstring model = modelPath.toStdWString();
+#else
+        std::string model = modelPath.toStdString();
+#endif
+        {
+            ThreadTag::ScopedSpawn tag("ocr");  // intra-op 线程池在此创建，归入 ocr
+            session_ = std::make_unique<Ort::Session>(env_, model.c_str(), *sessionOptions_);
+        }
+
+        Ort::AllocatorWithDefaultOptions allocator;
+        inputName_ = session_->GetInputNameAllocated(0, allocator).get();
+        outputName_ = session_->GetOutputNameAllocated(0, allocator).get();
+    }
+    catch (const Ort::Exception& e)
+    {
+        spdlog::error("OcrRecognizer: failed to load {}: {}", modelPath, e.what());
+        session_.reset();
+        return false;
+    }
+
+    loaded_ = true;
+    spdlog::info("OcrRecognizer: loaded {} ({} keys, {} threads)", modelPath, keys_.size(), numThreads);
+    return true;
+}
+
+std::vector<OcrRecognizer::Result> OcrRecognizer::recognize(const std::vector<cv::Mat>& crops)
+{
+    std::vector<Result> results(crops.size());
+    if (!loaded_ || crops.empty()) return results;
+
+    // 按高度 48 等比缩放，批内统一补零到最大宽度（向上取 8 的倍数，对齐模型下采样步长）
+    std::vector<cv::Mat> resized(crops.size());
+    std::vector<size_t> batchIndex;
+    int batchWidth = 8;
+    for (size_t i = 0; i < crops.size(); ++i)
+    {
+        const cv::Mat& crop = crops[i];
+        if (crop.empty() || crop.rows <= 0) continue;
+
+        cv::Mat bgr;
+        if (crop.channels() == 1)
+            cv::cvtColor(crop, bgr, cv::COLOR_GRAY2BGR);
+        else if (crop.channels() == 4)
+            cv::cvtColor(crop, bgr, cv::COLOR_BGRA2BGR);
+        else
+            bgr = crop;
+
+        const float scale = static_cast<float>(kInputHeight) / static_cast<float>(bgr.rows);
+        const int width = std::clamp(static_cast<int>(std::ceil(bgr.cols * scale)), 1, kMaxInputWidth);
+        cv::resize(bgr, resized[i], cv::Size(width, kInputHeight));
+        batchWidth = std::max(batchWidth, width);
+        batchIndex.push_back(i);
+    }
+    if (batchIndex.empty()) return results;
+    batchWidth = (batchWidth + 7) / 8 * 8;
+
+    const int64_t batch = static_cast<int64_t>(batchIndex.size());
+    const size_t planeSize = static_cast<size_t>(kInputHeight) * batchWidth;
+    std::vector<float> input(static_cast<size_t>(batch) * 3 * planeSize, 0.f);
+    for (size_t b = 0; b < batchIndex.size(); ++b)
+    {
+        const cv::Mat& img = resized[batchIndex[b]];
+        float* dst = input.data() + b * 3 * planeSize;
+        for (int y = 0; y < img.rows; ++y)
+        {
+            const uchar* row = img.ptr<uchar>(y);
+            for (int x = 0; x < img.cols; ++x)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    dst[c * planeSize + static_cast<size_t>(y) * batchWidth + x] =
+                        (row[x * 3 + c] - 127.5f) / 127.5f;
+                }
+            }
+        }
+    }
+
+    try
+    {
+        const std::vector<int64_t> shape = {batch, 3, kInputHeight, batchWidth};
+        Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
+            memoryInfo, input.data(), input.size(), shape.data(), shape.size());
+
+        static MetricHistogram& runLatency = MetricsRegistry::instance().histogram(
+            "edgevision_inference_duration_ms", "模型前向推理耗时（ms，不含前后处理）", {{"backend", "ocr_rec"}});
+        const char* inputNames[] = {inputName_.c_str()};
+        const char* outputNames[] = {outputName_.c_str()};
+        const auto runStart = std::chrono::steady_clock::now();
+        auto outputs = session_->Run(Ort::RunOptions{nullptr}, inputNames, &inputTensor, 1, outputNames, 1);
+        runLatency.observe(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - runStart).count());
+
+        // 输出 [N, T, C]：逐时间步取 argmax，去掉 blank 和连续重复
+        const auto outShape = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
+        if (outShape.size() != 3 || outShape[0] != batch)
+        {
+            spdlog::error("OcrRecognizer: unexpected output rank {}", outShape.size());
+            return results;
+        }
+        const int64_t steps = outShape[1];
+        const int64_t classes = outShape[2];
+        if (static_cast<size_t>(classes) != keys_.size())
+        {
+            spdlog::warn("OcrRecognizer: model has {} classes but dictionary has {}", classes, keys_.size());
+        }
+
+        const float* data = outputs[0].GetTensorData<float>();
+        for (size_t b = 0; b < batchIndex.size(); ++b)
+        {
+            Result& r = results[batchIndex[b]];
+            float scoreSum = 0.f;
+            int charCount = 0;
+            int64_t lastIndex = 0;
+            for (int64_t t = 0; t < steps; ++t)
+            {
+                const float* probs = data + (static_cast<int64_t>(b) * steps + t) * classes;
+                const int64_t index = std::max_element(probs, probs + classes) - probs;
+                if (index > 0 && index != lastIndex && static_cast<size_t>(index) < keys_.size())
+                {
+                    r.text += keys_[index];
+                    scoreSum += probs[index];
+                    ++charCount;
+                }
+                lastIndex = index;
+            }
+            r.score = charCount > 0 ? scoreSum / charCount : 0.f;
+        }
+    }
+    catch (const Ort::Exception& e)
+    {
+        spdlog::error("OcrRecognizer: inference failed: {}", e.what());
+    }
+    return results;
+}
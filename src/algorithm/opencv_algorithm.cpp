@@ -1,6 +1,8 @@
 ﻿#include "opencv_algorithm.h"
 #include "image_processor.h"
 #include "logger.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 
 OpenCVAlgorithm::OpenCVAlgorithm() {}
@@ -115,6 +117,42 @@ cv::Mat OpenCVAlgorithm::execute(const cv::Mat& region, const AlgorithmStep& ste
     }
 }
 
+int OpenCVAlgorithm::neighborhoodRadius(const AlgorithmStep& step)
+{
+    OpenCVAlgoType algoType = static_cast<OpenCVAlgoType>(
+        step.params["OpenCVAlgoType"].toInt()
+    );
+
+    auto circleRadius = [&]() {
+        return std::max(0, static_cast<int>(std::round(step.params.value("radius", 3.5).toDouble())));
+    };
+    auto rectRadius = [&]() {
+        int width = std::max(0, step.params.value("width", 5).toInt());
+        int height = std::max(0, step.params.value("height", 5).toInt());
+        return std::max(width, height) / 2;
+    };
+
+    switch(algoType)
+    {
+    // 腐蚀/膨胀：单次核半径；开/闭运算：腐蚀+膨胀两次叠加
+    case OpenCVAlgoType::DilationCircle:
+    case OpenCVAlgoType::ErosionCircle:
+        return circleRadius();
+    case OpenCVAlgoType::DilationRect:
+    case OpenCVAlgoType::ErosionRect:
+        return rectRadius();
+    case OpenCVAlgoType::OpeningCircle:
+    case OpenCVAlgoType::ClosingCircle:
+        return 2 * circleRadius();
+    case OpenCVAlgoType::OpeningRect:
+    case OpenCVAlgoType::ClosingRect:
+        return 2 * rectRadius();
+    default:
+        // 连通域/填充/形状变换/面积筛选需要完整区域
+        return -1;
+    }
+}
+
 // =============== 辅助函数 ===============
 
 cv::Mat OpenCVAlgorithm::createCircleKernel(int radius)
@@ -1,13 +1,263 @@
 #include "algorithm/ort_inference.h"
+#include "algorithm/yolo_postprocess.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QFileInfo>
 #include <QFile>
 #include <QDir>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
-#include <spdlog/spdlog.h>
+#include <QSet>
+#include <QStandardPaths>
+#include <opencv2/core/utility.hpp>
+#include "logger.h"
+#include "core/metrics.h"
+#include "utils/thread_tag.h"
+#include "utils/cpu_topology.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <numeric>
+#include <thread>
+
+/// intra-op 线程绑核计划：线程创建时依次领取一个逻辑处理器
+struct OrtThreadAffinity
+{
+    std::vector<int> cpus;
+    std::atomic<size_t> next{0};
+};
+
+namespace {
+
+// intra-op 线程池由 ORT 通过这两个回调创建/回收，借此把线程标记为 ort（并按计划绑核）
+OrtCustomThreadHandle createOrtThread(void* options, OrtThreadWorkerFn worker, void* param)
+{
+    auto* affinity = static_cast<OrtThreadAffinity*>(options);
+    int cpu = -1;
+    if (affinity && !affinity->cpus.empty())
+        cpu = affinity->cpus[affinity->next.fetch_add(1) % affinity->cpus.size()];
+
+    auto* thread = new std::thread([worker, param, cpu]() {
+        ThreadTag::setCurrent("ort");
+        if (cpu >= 0) CpuTopology::pinCurrentThread(cpu);
+        worker(param);
+    });
+    return reinterpret_cast<OrtCustomThreadHandle>(thread);
+}
+
+void joinOrtThread(OrtCustomThreadHandle handle)
+{
+    auto* thread = reinterpret_cast<std::thread*>(const_cast<OrtCustomHandleType*>(handle));
+    thread->join();
+    delete thread;
+}
+
+std::basic_string<ORTCHAR_T> toOrtPath(const QString& path)
+{
+#ifdef _WIN32
+    // ONNX Runtime Windows 版本只接受 wchar_t* 宽字符路径
+    return path.toStdWString();
+#else
+    return path.toStdString();
+#endif
+}
+
+GraphOptimizationLevel toOrtLevel(int level)
+{
+    switch (level) {
+    case 0: return GraphOptimizationLevel::ORT_DISABLE_ALL;
+    case 1: return GraphOptimizationLevel::ORT_ENABLE_BASIC;
+    case 2: return GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+    default: return GraphOptimizationLevel::ORT_ENABLE_ALL;
+    }
+}
+
+/**
+ * ONNX 模型（protobuf ModelProto）的流式扫描：只读取图中各节点的算子类型和权重的数据类型，
+ * 权重数据按长度直接 seek 跳过，几百 MB 的模型也只读取几十 KB。
+ * 字段号：ModelProto.graph=7；GraphProto.node=1、initializer=5；NodeProto.op_type=4；TensorProto.data_type=2
+ */
+class OnnxScanner
+{
+public:
+    QSet<QByteArray> opTypes;
+    int fp32Initializers = 0;
+    int fp16Initializers = 0;
+
+    bool scan(const QString& modelPath)
+    {
+        m_file.setFileName(modelPath);
+        if (!m_file.open(QIODevice::ReadOnly)) return false;
+        const qint64 end = m_file.size();
+        while (m_file.pos() < end) {
+            quint64 tag = 0, len = 0;
+            if (!readVarint(tag)) return false;
+            if (tag == ((7 << 3) | 2)) {
+                if (!readVarint(len) || !scanGraph(m_file.pos() + static_cast<qint64>(len))) return false;
+            } else if (!skipField(tag)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    enum { kFloat = 1, kFloat16 = 10 };     // TensorProto.DataType
+
+    bool scanGraph(qint64 end)
+    {
+        while (m_file.pos() < end) {
+            quint64 tag = 0, len = 0;
+            if (!readVarint(tag)) return false;
+            if (tag == ((1 << 3) | 2)) {
+                // 节点消息很小（算子类型、输入输出名、属性），整条读入内存解析
+                if (!readVarint(len) || len > 16 * 1024 * 1024) return false;
+                const QByteArray node = m_file.read(static_cast<qint64>(len));
+                if (node.size() != static_cast<qsizetype>(len)) return false;
+                const QByteArray op = nodeOpType(node);
+                if (!op.isEmpty()) opTypes.insert(op);
+            } else if (tag == ((5 << 3) | 2)) {
+                if (!readVarint(len)) return false;
+                const qint64 tensorEnd = m_file.pos() + static_cast<qint64>(len);
+                if (!scanTensor(tensorEnd) || !m_file.seek(tensorEnd)) return false;
+            } else if (!skipField(tag)) {
+                return false;
+            }
+        }
+        return m_file.pos() == end;
+    }
+
+    bool scanTensor(qint64 end)
+    {
+        // data_type 位于 dims 之后、数据之前；读到即返回，其余由调用方 seek 跳过
+        while (m_file.pos() < end) {
+            quint64 tag = 0, value = 0;
+            if (!readVarint(tag)) return false;
+            if (tag == ((2 << 3) | 0)) {
+                if (!readVarint(value)) return false;
+                if (value == kFloat) ++fp32Initializers;
+                else if (value == kFloat16) ++fp16Initializers;
+                return true;
+            }
+            if (!skipField(tag)) return false;
+        }
+        return true;
+    }
+
+    static QByteArray nodeOpType(const QByteArray& node)
+    {
+        const uchar* p = reinterpret_cast<const uchar*>(node.constData());
+        const uchar* end = p + node.size();
+        auto varint = [&](quint64& v) {
+            v = 0;
+            for (int shift = 0; p < end && shift < 64; shift += 7) {
+                const uchar b = *p++;
+                v |= quint64(b & 0x7f) << shift;
+                if (!(b & 0x80)) return true;
+            }
+            return false;
+        };
+        while (p < end) {
+            quint64 tag = 0, v = 0;
+            if (!varint(tag)) break;
+            switch (tag & 7) {
+            case 0: if (!varint(v)) return {}; break;
+            case 1: p += 8; break;
+            case 5: p += 4; break;
+            case 2:
+                if (!varint(v) || v > quint64(end - p)) return {};
+                if ((tag >> 3) == 4) return QByteArray(reinterpret_cast<const char*>(p), static_cast<qsizetype>(v));
+                p += v;
+                break;
+            default: return {};
+            }
+        }
+        return {};
+    }
+
+    bool readVarint(quint64& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            char c = 0;
+            if (!m_file.getChar(&c)) return false;
+            value |= quint64(static_cast<uchar>(c) & 0x7f) << shift;
+            if (!(static_cast<uchar>(c) & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool skipField(quint64 tag)
+    {
+        quint64 len = 0;
+        switch (tag & 7) {
+        case 0: return readVarint(len);
+        case 1: return m_file.seek(m_file.pos() + 8);
+        case 5: return m_file.seek(m_file.pos() + 4);
+        case 2: return readVarint(len) && m_file.seek(m_file.pos() + static_cast<qint64>(len));
+        default: return false;      // 已废弃的 group 编码，ONNX 不使用
+        }
+    }
+
+    QFile m_file;
+};
+
+/// 由模型内容识别精度：含量化算子 → INT8；权重以 float16 为主 → FP16（半精度输入在建会话后再确认）
+OrtModelPrecision detectPrecision(const QString& modelPath)
+{
+    OnnxScanner scanner;
+    if (!scanner.scan(modelPath)) {
+        spdlog::warn("OrtInference: cannot parse ONNX graph of {}, assuming FP32", modelPath);
+        return OrtModelPrecision::FP32;
+    }
+    for (const char* op : {"QuantizeLinear", "DequantizeLinear", "DynamicQuantizeLinear", "QLinearConv",
+                           "QLinearMatMul", "ConvInteger", "MatMulInteger"}) {
+        if (scanner.opTypes.contains(op)) return OrtModelPrecision::INT8;
+    }
+    if (scanner.fp16Initializers > scanner.fp32Initializers) return OrtModelPrecision::FP16;
+    return OrtModelPrecision::FP32;
+}
+
+/// 运行时 CPU 指令集：ORT 按指令集选择内核并做布局变换（NCHWc 块宽随 AVX2/AVX-512 不同）
+QString cpuIsaKey()
+{
+    static const QString key = [] {
+        QStringList isa;
+        const std::pair<int, const char*> features[] = {
+            {CV_CPU_SSE4_2, "sse4.2"}, {CV_CPU_AVX, "avx"}, {CV_CPU_AVX2, "avx2"}, {CV_CPU_FMA3, "fma3"},
+            {CV_CPU_AVX_512F, "avx512f"}, {CV_CPU_AVX512_SKX, "avx512skx"}, {CV_CPU_AVX512_CLX, "avx512vnni"},
+            {CV_CPU_AVX512_ICL, "avx512icl"}, {CV_CPU_NEON, "neon"}};
+        for (const auto& [feature, name] : features) {
+            if (cv::checkHardwareSupport(feature)) isa << name;
+        }
+        return isa.join(',');
+    }();
+    return key;
+}
+
+/// 优化图缓存路径：模型内容（路径/大小/修改时间）、ORT 版本、优化级别、CPU 拓扑与指令集任一变化都换新文件。
+/// 放在用户缓存目录：程序目录在产线机上通常只读（Program Files）
+QString optimizedCachePath(const QString& modelPath, int level)
+{
+    const QFileInfo info(modelPath);
+    const CpuTopology& topo = CpuTopology::current();
+    const QString key = QString("%1|%2|%3|%4|%5|%6|%7")
+        .arg(info.absoluteFilePath())
+        .arg(info.size())
+        .arg(info.lastModified().toMSecsSinceEpoch())
+        .arg(ORT_API_VERSION)
+        .arg(level)
+        .arg(topo.logicalCores)
+        .arg(cpuIsaKey());
+    const QString digest = QString::fromLatin1(
+        QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex().left(12));
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/ort_cache/" +
+           info.completeBaseName() + "." + digest + ".onnx";
+}
+
+} // namespace
 
 OrtInference::OrtInference()
     : env_(ORT_LOGGING_LEVEL_WARNING, "OrtInference")
@@ -16,20 +266,91 @@ OrtInference::OrtInference()
 
 OrtInference::~OrtInference() = default;
 
+std::unique_ptr<Ort::SessionOptions> OrtInference::makeSessionOptions(GraphOptimizationLevel level, bool cpuSession)
+{
+    const CpuTopology& topo = CpuTopology::current();
+    const int intraThreads = cpuConfig_.intraOpThreads > 0 ? cpuConfig_.intraOpThreads : topo.performanceCores;
+    const bool interOp = cpuConfig_.parallelism == OrtParallelism::InterOp;
+
+    auto options = std::make_unique<Ort::SessionOptions>();
+    options->SetGraphOptimizationLevel(level);
+    options->SetIntraOpNumThreads(intraThreads);
+    if (interOp) {
+        options->SetExecutionMode(ExecutionMode::ORT_PARALLEL);
+        options->SetInterOpNumThreads(cpuConfig_.interOpThreads > 0 ? cpuConfig_.interOpThreads : 2);
+    } else {
+        options->SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+    }
+    const char* spinning = cpuConfig_.allowSpinning ? "1" : "0";
+    options->AddConfigEntry("session.intra_op.allow_spinning", spinning);
+    options->AddConfigEntry("session.inter_op.allow_spinning", spinning);
+
+    // 调用线程本身承担一份 intra-op 工作，池内线程从第 2 个物理核起依次绑定；
+    // inter-op 线程同样经由该回调创建，InterOp 模式下不绑核以免与 intra-op 线程抢同一核
+    threadAffinity_.reset();
+    if (cpuSession && cpuConfig_.pinThreads && !interOp &&
+        intraThreads > 1 && intraThreads <= static_cast<int>(topo.primaryLogical.size())) {
+        threadAffinity_ = std::make_unique<OrtThreadAffinity>();
+        threadAffinity_->cpus.assign(topo.primaryLogical.begin() + 1,
+                                     topo.primaryLogical.begin() + intraThreads);
+    }
+    options->SetCustomCreateThreadFn(createOrtThread);
+    options->SetCustomThreadCreationOptions(threadAffinity_.get());
+    options->SetCustomJoinThreadFn(joinOrtThread);
+
+    spdlog::info("OrtInference: session options - intraOp={} interOp={} pinned={} spinning={} optLevel={} "
+                 "(cores: {} logical / {} physical / {} performance{})",
+                 intraThreads, interOp ? "on" : "off", threadAffinity_ != nullptr,
+                 cpuConfig_.allowSpinning, static_cast<int>(level),
+                 topo.logicalCores, topo.physicalCores, topo.performanceCores, topo.hybrid ? ", hybrid" : "");
+    return options;
+}
+
+void OrtInference::createCpuSession(const QString& modelPath)
+{
+    int level = cpuConfig_.optimizationLevel;
+    if (precision_ == OrtModelPrecision::INT8 && level < 2) {
+        // QDQ 节点融合为整数算子发生在扩展级优化，低于该级别会按反量化后的 FP32 计算
+        spdlog::info("OrtInference: INT8 (QDQ) model, raising graph optimization level {} -> 2", level);
+        level = 2;
+    }
+
+    const QString cachePath = cpuConfig_.cacheOptimizedModel && level > 0
+                                  ? optimizedCachePath(modelPath, level) : QString();
+    if (!cachePath.isEmpty() && QFile::exists(cachePath)) {
+        try {
+            // 缓存已是优化后的图，关闭图优化直接加载
+            sessionOptions_ = makeSessionOptions(GraphOptimizationLevel::ORT_DISABLE_ALL, true);
+            session_ = std::make_unique<Ort::Session>(env_, toOrtPath(cachePath).c_str(), *sessionOptions_);
+            spdlog::info("OrtInference: loaded optimized model cache {}", cachePath);
+            return;
+        } catch (const Ort::Exception& e) {
+            spdlog::warn("OrtInference: optimized model cache unusable, rebuilding: {}", e.what());
+            session_.reset();
+            QFile::remove(cachePath);
+        }
+    }
+
+    sessionOptions_ = makeSessionOptions(toOrtLevel(level), true);
+    if (!cachePath.isEmpty() && QDir().mkpath(QFileInfo(cachePath).absolutePath())) {
+        sessionOptions_->SetOptimizedModelFilePath(toOrtPath(cachePath).c_str());
+    }
+    session_ = std::make_unique<Ort::Session>(env_, toOrtPath(modelPath).c_str(), *sessionOptions_);
+    if (!cachePath.isEmpty())
+        spdlog::info("OrtInference: optimized model cached to {} (isa: {})", cachePath, cpuIsaKey());
+}
+
 bool OrtInference::loadModel(const QString& modelPath, bool useGpu)
 {
     loaded_ = false;
     usingGpu_ = false;
+    halfInput_ = false;
+    session_.reset();
 
     try
     {
-        std::string model = modelPath.toStdString();
-
-        sessionOptions_ = std::make_unique<Ort::SessionOptions>();
-        sessionOptions_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-
-        // 设置线程数（避免过度占用CPU）
-        sessionOptions_->SetIntraOpNumThreads(4);
+        precision_ = cpuConfig_.precision == OrtModelPrecision::Auto
+                         ? detectPrecision(modelPath) : cpuConfig_.precision;
 
         if (useGpu)
         {
@@ -40,6 +361,7 @@ bool OrtInference::loadModel(const QString& modelPath, bool useGpu)
                 // device_id=1 通常是独显，这里硬编码为 1（如果是单显卡会自动 fallback）
                 int deviceId = 0;
 
+                sessionOptions_ = makeSessionOptions(toOrtLevel(cpuConfig_.optimizationLevel), false);
                 OrtCUDAProviderOptions cudaOptions;
                 cudaOptions.device_id = deviceId;
                 sessionOptions_->AppendExecutionProvider_CUDA(cudaOptions);
@@ -49,29 +371,24 @@ bool OrtInference::loadModel(const QString& modelPath, bool useGpu)
             catch (const Ort::Exception& e)
             {
                 spdlog::warn("OrtInference: CUDA not available, falling back to CPU: {}", e.what());
-                // 创建新的 SessionOptions，只用 CPU
-                sessionOptions_ = std::make_unique<Ort::SessionOptions>();
-                sessionOptions_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-                sessionOptions_->SetIntraOpNumThreads(4);
                 usingGpu_ = false;
             }
             catch (const std::exception& e)
             {
                 spdlog::warn("OrtInference: CUDA init failed, falling back to CPU: {}", e.what());
-                sessionOptions_ = std::make_unique<Ort::SessionOptions>();
-                sessionOptions_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-                sessionOptions_->SetIntraOpNumThreads(4);
                 usingGpu_ = false;
             }
         }
 
-        // 创建 Session（延迟加载，减少初始化时间）
-        sessionOptions_->SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
-
-        // ONNX Runtime Windows 版本只接受 wchar_t* 宽字符路径
-        std::wstring wModel = modelPath.toStdWString();
-        session_ = std::make_unique<Ort::Session>(
-            env_, wModel.c_str(), *sessionOptions_);
+        if (usingGpu_)
+        {
+            session_ = std::make_unique<Ort::Session>(
+                env_, toOrtPath(modelPath).c_str(), *sessionOptions_);
+        }
+        else
+        {
+            createCpuSession(modelPath);
+        }
 
         if (!session_)
         {
@@ -79,9 +396,23 @@ bool OrtInference::loadModel(const QString& modelPath, bool useGpu)
             return false;
         }
 
+        // 未保留 float32 输入输出的 FP16 模型：输入输出张量均为 float16
+        if (session_->GetInputCount() > 0)
+        {
+            halfInput_ = session_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetElementType() ==
+                         ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+            if (halfInput_)
+                precision_ = OrtModelPrecision::FP16;
+        }
+        if (precision_ == OrtModelPrecision::FP16 && !usingGpu_)
+        {
+            spdlog::warn("OrtInference: CPU EP has few FP16 kernels, most ops run in FP32 via Cast; "
+                         "prefer an INT8 (QDQ) model for CPU deployment");
+        }
+
         loaded_ = true;
-        spdlog::info("OrtInference: model loaded successfully (backend: {})",
-                     usingGpu_ ? "CUDA" : "CPU");
+        spdlog::info("OrtInference: model loaded successfully (backend: {}, precision: {})",
+                     usingGpu_ ? "CUDA" : "CPU", OrtCpuConfig::precisionName(precision_));
 
         // 从 ONNX Session 读取实际输入形状（最可靠的方式）
         if (session_->GetInputCount() > 0)
@@ -148,7 +479,7 @@ std::vector<DetectionResult> OrtInference::detect(const cv::Mat& input,
 
     if (!loaded_ || input.empty())
     {
-        spdlog::warn("OrtInference: detect skipped - loaded={}, empty={}", loaded_, input.empty());
+        LOG_THROTTLED(spdlog::level::warn, 5000, "OrtInference: detect skipped - loaded={}, empty={}", loaded_, input.empty());
         return results;
     }
 
@@ -156,7 +487,7 @@ std::vector<DetectionResult> OrtInference::detect(const cv::Mat& input,
     {
         int imgWidth = input.cols;
         int imgHeight = input.rows;
-        spdlog::info("OrtInference: detect input image size = {}x{}", imgWidth, imgHeight);
+        STEP_LOG_DEBUG("OrtInference: detect input image size = {}x{}", imgWidth, imgHeight);
 
         // === YOLOv8 标准预处理：Letterbox + BGR→RGB + /255 ===
 
@@ -236,17 +567,35 @@ std::vector<DetectionResult> OrtInference::detect(const cv::Mat& input,
             OrtArenaAllocator, OrtMemTypeDefault);
 
         std::vector<Ort::Value> inputTensors;
-        inputTensors.push_back(Ort::Value::CreateTensor<float>(
-            memoryInfo, inputTensorValues.data(), inputTensorValues.size(),
-            inputShape.data(), inputShape.size()));
+        cv::Mat halfInput;
+        if (halfInput_)
+        {
+            // FP16 模型输入为 float16：整体转换一次（OpenCV 内部 SIMD）
+            cv::Mat(1, static_cast<int>(inputTensorValues.size()), CV_32F, inputTensorValues.data())
+                .convertTo(halfInput, CV_16F);
+            inputTensors.push_back(Ort::Value::CreateTensor(
+                memoryInfo, halfInput.data, halfInput.total() * halfInput.elemSize(),
+                inputShape.data(), inputShape.size(), ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16));
+        }
+        else
+        {
+            inputTensors.push_back(Ort::Value::CreateTensor<float>(
+                memoryInfo, inputTensorValues.data(), inputTensorValues.size(),
+                inputShape.data(), inputShape.size()));
+        }
 
         // 执行推理
+        static MetricHistogram& runLatency = MetricsRegistry::instance().histogram(
+            "edgevision_inference_duration_ms", "模型前向推理耗时（ms，不含前后处理）", {{"backend", "ort"}});
+        const auto runStart = std::chrono::steady_clock::now();
         Ort::RunOptions runOptions;
         std::vector<Ort::Value> outputTensors = session_->Run(
             runOptions,
             inputNamesCStr.data(),
             inputTensors.data(), inputTensors.size(),
             outputNamesCStr.data(), outputNamesCStr.size());
+        runLatency.observe(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - runStart).count());
 
         if (outputTensors.empty() || !outputTensors[0].IsTensor())
         {
@@ -254,114 +603,53 @@ std::vector<DetectionResult> OrtInference::detect(const cv::Mat& input,
             return results;
         }
 
-        // 获取输出数据
-        const float* outputData = outputTensors[0].GetTensorData<float>();
-        auto outputShape = outputTensors[0].GetTensorTypeAndShapeInfo().GetShape();
+        // 获取输出数据（float16 输出先转为 float32）
+        auto outputInfo = outputTensors[0].GetTensorTypeAndShapeInfo();
+        auto outputShape = outputInfo.GetShape();
+        const float* outputData = nullptr;
+        cv::Mat floatOutput;
+        if (outputInfo.GetElementType() == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16)
+        {
+            cv::Mat(1, static_cast<int>(outputInfo.GetElementCount()), CV_16F,
+                    const_cast<uint16_t*>(outputTensors[0].GetTensorData<uint16_t>()))
+                .convertTo(floatOutput, CV_32F);
+            outputData = floatOutput.ptr<float>();
+        }
+        else
+        {
+            outputData = outputTensors[0].GetTensorData<float>();
+        }
 
         // YOLOv8 输出: [1, 4+numClasses, numDetections]
         int numAttributes = static_cast<int>(outputShape[1]);
         int numDetections = static_cast<int>(outputShape[2]);
-        spdlog::info("OrtInference: output shape = [{}, {}, {}], inputWidth={}, inputHeight={}",
+        STEP_LOG_DEBUG("OrtInference: output shape = [{}, {}, {}], inputWidth={}, inputHeight={}",
                       outputShape[0], outputShape[1], outputShape[2], inputWidth, inputHeight);
 
-        float xScale = static_cast<float>(imgWidth) / inputWidth;
-        float yScale = static_cast<float>(imgHeight) / inputHeight;
 
+#ifdef EDGEVISION_STEP_DEBUG_LOG
         // === 诊断：打印输出数据的原始值 ===
         // 打印前10个值，检查数据是否正常
-        spdlog::info("OrtInference: first 10 output values:");
+        STEP_LOG_DEBUG("OrtInference: first 10 output values:");
         for (int k = 0; k < 10; ++k)
         {
-            spdlog::info("  outputData[{}] = {:.6f}", k, outputData[k]);
+            STEP_LOG_DEBUG("  outputData[{}] = {:.6f}", k, outputData[k]);
         }
         // === 诊断结束 ===
-
-        // 解析每个检测结果
-        for (int i = 0; i < numDetections; ++i)
-        {
-            // 找最大置信度的类别
-            float maxConf = 0.0f;
-            int bestClassId = 0;
-            for (int j = 4; j < numAttributes; ++j)
-            {
-                // YOLOv8输出列主序: outputData[j * numDetections + i]
-                float conf = outputData[j * numDetections + i];
-                if (conf > maxConf)
-                {
-                    maxConf = conf;
-                    bestClassId = j - 4;
-                }
-            }
-
-            // 置信度过滤
-            if (maxConf < confThreshold)
-                continue;
-
-            // cx, cy, w, h
-            float cx = outputData[0 * numDetections + i];
-            float cy = outputData[1 * numDetections + i];
-            float w  = outputData[2 * numDetections + i];
-            float h  = outputData[3 * numDetections + i];
-
-            int left   = static_cast<int>((cx - w / 2.0f) * xScale);
-            int top    = static_cast<int>((cy - h / 2.0f) * yScale);
-            int width  = static_cast<int>(w * xScale);
-            int height = static_cast<int>(h * yScale);
-
-            // 边界裁剪
-            left   = std::max(0, left);
-            top    = std::max(0, top);
-            width  = std::min(width, imgWidth - left);
-            height = std::min(height, imgHeight - top);
-
-            DetectionResult det;
-            det.box = cv::Rect(left, top, width, height);
-            det.confidence = maxConf;
-            det.classId = bestClassId;
-            if (bestClassId >= 0 && bestClassId < static_cast<int>(classNames_.size()))
-            {
-                det.className = classNames_[bestClassId];
-            }
-            else
-            {
-                det.className = "class_" + std::to_string(bestClassId);
-            }
-            results.push_back(det);
-        }
-
-        // 打印前5个候选的详情用于诊断
-        int logCount = std::min(5, static_cast<int>(results.size()));
-        for (int k = 0; k < logCount; ++k)
-        {
-            spdlog::info("OrtInference: candidate[{}] class={}({}) conf={:.4f} box=({},{},{},{})",
-                         k, results[k].className, results[k].classId, results[k].confidence,
-                         results[k].box.x, results[k].box.y, results[k].box.width, results[k].box.height);
-        }
-        spdlog::info("OrtInference: candidates after conf filter (threshold={:.2f}) = {}", confThreshold, results.size());
-
-        // NMS 后处理
-        if (!results.empty())
-        {
-            std::vector<cv::Rect> boxes;
-            std::vector<float> confs;
-            for (const auto& r : results)
-            {
-                boxes.push_back(r.box);
-                confs.push_back(r.confidence);
-            }
-
-            std::vector<int> indices;
-            cv::dnn::NMSBoxes(boxes, confs, confThreshold, nmsThreshold, indices);
-
-            std::vector<DetectionResult> nmsResults;
-            for (int idx : indices)
-            {
-                nmsResults.push_back(results[idx]);
-            }
-            spdlog::info("OrtInference: final results after NMS = {}", nmsResults.size());
-            return nmsResults;
-        }
-        spdlog::info("OrtInference: no candidates to NMS");
+#endif
+
+        YoloDecodeParams params;
+        params.confThreshold = confThreshold;
+        params.nmsThreshold = nmsThreshold;
+        // 输入经 letterbox：先减去填充偏移，再按 1/r 还原到原图
+        params.scaleX = 1.0f / r;
+        params.scaleY = 1.0f / r;
+        params.padX = static_cast<float>(padLeft);
+        params.padY = static_cast<float>(padTop);
+        params.imgWidth = imgWidth;
+        params.imgHeight = imgHeight;
+        results = YoloPostprocess::decode(outputData, numAttributes, numDetections, params, classNames_);
+        STEP_LOG_DEBUG("OrtInference: final results after NMS = {}", results.size());
     }
     catch (const Ort::Exception& e)
     {
@@ -0,0 +1,171 @@
+#include "algorithm/ort_model_comparison.h"
+#include "algorithm/ort_inference.h"
+#include "utils/path_utils.h"
+#include "logger.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr float kMatchIou = 0.5f;
+
+float iou(const cv::Rect& a, const cv::Rect& b)
+{
+    const int inter = (a & b).area();
+    if (inter <= 0) return 0.0f;
+    return static_cast<float>(inter) / static_cast<float>(a.area() + b.area() - inter);
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    const size_t idx = static_cast<size_t>(std::ceil(p * values.size())) - 1;
+    return values[std::min(idx, values.size() - 1)];
+}
+
+struct MatchStats
+{
+    int matched = 0;
+    double iouSum = 0;
+    double confDeltaSum = 0;
+};
+
+// 参考检测按置信度降序，逐个贪心匹配同类别 IoU 最大且未被占用的候选检测
+void matchDetections(const std::vector<DetectionResult>& reference,
+                     const std::vector<DetectionResult>& candidate, MatchStats& stats)
+{
+    std::vector<bool> used(candidate.size(), false);
+    for (const DetectionResult& ref : reference) {
+        int best = -1;
+        float bestIou = kMatchIou;
+        for (size_t i = 0; i < candidate.size(); ++i) {
+            if (used[i] || candidate[i].classId != ref.classId) continue;
+            const float v = iou(ref.box, candidate[i].box);
+            if (v >= bestIou) {
+                bestIou = v;
+                best = static_cast<int>(i);
+            }
+        }
+        if (best < 0) continue;
+        used[best] = true;
+        ++stats.matched;
+        stats.iouSum += bestIou;
+        stats.confDeltaSum += std::abs(ref.confidence - candidate[best].confidence);
+    }
+}
+
+} // namespace
+
+QVector<OrtModelReport> OrtModelComparison::run(const QString& imageDir, const QStringList& models,
+                                                const OrtCpuConfig& cpuConfig, const Options& options)
+{
+    QVector<OrtModelReport> reports;
+    if (models.isEmpty()) return reports;
+
+    const QFileInfoList files = QDir(imageDir).entryInfoList(
+        {"*.png", "*.jpg", "*.jpeg", "*.bmp", "*.tif", "*.tiff"}, QDir::Files, QDir::Name);
+    std::vector<cv::Mat> images;
+    for (const QFileInfo& fi : files) {
+        if (options.maxImages > 0 && static_cast<int>(images.size()) >= options.maxImages) break;
+        cv::Mat img = PathUtils::readImageFromFile(fi.absoluteFilePath(), cv::IMREAD_COLOR);
+        if (!img.empty()) images.push_back(std::move(img));
+    }
+    if (images.empty()) {
+        spdlog::error("[OrtCompare] 目录中没有可读取的图片: {}", imageDir);
+        return reports;
+    }
+    spdlog::info("[OrtCompare] 图片 {} 张（{}），模型 {} 个", images.size(), imageDir, models.size());
+
+    std::vector<std::vector<DetectionResult>> referenceResults;
+
+    for (int m = 0; m < models.size(); ++m) {
+        OrtModelReport report;
+        report.modelPath = models[m];
+
+        OrtInference inference;
+        inference.setCpuConfig(cpuConfig);
+        const auto loadStart = std::chrono::steady_clock::now();
+        if (!inference.loadModel(models[m], false)) {
+            spdlog::error("[OrtCompare] 模型加载失败: {}", models[m]);
+            reports.append(report);
+            if (m == 0) return reports;  // 参考模型不可用，无法对比
+            continue;
+        }
+        report.loadMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - loadStart).count();
+        report.precision = OrtCpuConfig::precisionName(inference.modelPrecision());
+
+        for (int i = 0; i < options.warmupRuns; ++i) {
+            inference.detect(images[i % images.size()], options.confThreshold, options.nmsThreshold,
+                             options.inputWidth, options.inputHeight);
+        }
+
+        std::vector<double> latencies;
+        latencies.reserve(images.size());
+        MatchStats match;
+        int referenceTotal = 0;
+        for (size_t i = 0; i < images.size(); ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            std::vector<DetectionResult> results = inference.detect(
+                images[i], options.confThreshold, options.nmsThreshold,
+                options.inputWidth, options.inputHeight);
+            latencies.push_back(std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count());
+            report.detections += static_cast<int>(results.size());
+
+            if (m == 0) {
+                referenceResults.push_back(std::move(results));
+            } else {
+                referenceTotal += static_cast<int>(referenceResults[i].size());
+                matchDetections(referenceResults[i], results, match);
+            }
+        }
+
+        report.images = static_cast<int>(images.size());
+        double total = 0;
+        for (double v : latencies) total += v;
+        report.meanMs = total / latencies.size();
+        report.p50Ms = percentile(latencies, 0.50);
+        report.p95Ms = percentile(latencies, 0.95);
+        if (m > 0) {
+            report.precisionVsRef = report.detections > 0 ? double(match.matched) / report.detections
+                                                          : (referenceTotal == 0 ? 1.0 : 0.0);
+            report.recallVsRef = referenceTotal > 0 ? double(match.matched) / referenceTotal : 1.0;
+            report.meanIou = match.matched > 0 ? match.iouSum / match.matched : 0.0;
+            report.meanConfDelta = match.matched > 0 ? match.confDeltaSum / match.matched : 0.0;
+        }
+
+        spdlog::info("[BENCH] OrtCompare {} ({}): load={:.0f}ms mean={:.2f}ms p50={:.2f}ms p95={:.2f}ms "
+                     "dets={} precision={:.3f} recall={:.3f} IoU={:.3f} |dConf|={:.3f}",
+                     QFileInfo(report.modelPath).fileName(), report.precision, report.loadMs,
+                     report.meanMs, report.p50Ms, report.p95Ms, report.detections,
+                     report.precisionVsRef, report.recallVsRef, report.meanIou, report.meanConfDelta);
+        reports.append(report);
+    }
+    return reports;
+}
+
+bool OrtModelComparison::writeCsv(const QVector<OrtModelReport>& reports, const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        spdlog::error("[OrtCompare] 无法写入 {}", path);
+        return false;
+    }
+    QTextStream out(&file);
+    out << "model,precision,load_ms,images,mean_ms,p50_ms,p95_ms,detections,"
+           "precision_vs_ref,recall_vs_ref,mean_iou,mean_conf_delta\n";
+    for (const OrtModelReport& r : reports) {
+        out << '"' << r.modelPath << "\"," << r.precision << ',' << r.loadMs << ',' << r.images << ','
+            << r.meanMs << ',' << r.p50Ms << ',' << r.p95Ms << ',' << r.detections << ','
+            << r.precisionVsRef << ',' << r.recallVsRef << ',' << r.meanIou << ','
+            << r.meanConfDelta << '\n';
+    }
+    return true;
+}
@@ -0,0 +1,217 @@
+﻿#include "tiled_executor.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+std::vector<cv::Rect> TiledExecutor::makeTiles(const cv::Size& size, int tileSize)
+{
+    std::vector<cv::Rect> tiles;
+    if (size.width <= 0 || size.height <= 0) return tiles;
+    if (tileSize <= 0) {
+        tiles.emplace_back(0, 0, size.width, size.height);
+        return tiles;
+    }
+    for (int y = 0; y < size.height; y += tileSize) {
+        for (int x = 0; x < size.width; x += tileSize) {
+            tiles.emplace_back(x, y, std::min(tileSize, size.width - x), std::min(tileSize, size.height - y));
+        }
+    }
+    return tiles;
+}
+
+cv::Mat TiledExecutor::apply(const cv::Mat& src, int halo, int tileSize, const TileOp& op)
+{
+    if (src.empty()) return cv::Mat();
+
+    const std::vector<cv::Rect> tiles = makeTiles(src.size(), tileSize);
+    if (tiles.size() <= 1) return op(src);
+
+    const cv::Rect imageRect(0, 0, src.cols, src.rows);
+    halo = std::max(0, halo);
+    auto expand = [&](const cv::Rect& core) {
+        return cv::Rect(core.x - halo, core.y - halo, core.width + 2 * halo, core.height + 2 * halo) & imageRect;
+    };
+
+    // 首块串行执行，确定输出类型
+    const cv::Rect firstOuter = expand(tiles[0]);
+    cv::Mat first = op(src(firstOuter));
+    if (first.size() != firstOuter.size()) return op(src);
+
+    cv::Mat dst(src.size(), first.type());
+    first(tiles[0] - firstOuter.tl()).copyTo(dst(tiles[0]));
+
+    std::atomic<bool> mismatch{false};
+    cv::parallel_for_(cv::Range(1, static_cast<int>(tiles.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            const cv::Rect outer = expand(tiles[i]);
+            cv::Mat result = op(src(outer));
+            if (result.size() != outer.size() || result.type() != dst.type()) {
+                mismatch = true;
+                continue;
+            }
+            result(tiles[i] - outer.tl()).copyTo(dst(tiles[i]));
+        }
+    });
+
+    return mismatch ? op(src) : dst;
+}
+
+namespace {
+
+int findRoot(std::vector<int>& parent, int x)
+{
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+void unite(std::vector<int>& parent, int a, int b)
+{
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a == b) return;
+    if (a < b) parent[b] = a;
+    else parent[a] = b;
+}
+
+/// 把 src 的统计量（块内坐标）并入 dst（整图坐标）
+void mergeStats(int* dst, const int* src, const cv::Point& offset)
+{
+    if (src[cv::CC_STAT_AREA] <= 0) return;
+
+    const int left = src[cv::CC_STAT_LEFT] + offset.x;
+    const int top = src[cv::CC_STAT_TOP] + offset.y;
+    const int right = left + src[cv::CC_STAT_WIDTH];
+    const int bottom = top + src[cv::CC_STAT_HEIGHT];
+
+    if (dst[cv::CC_STAT_AREA] == 0) {
+        dst[cv::CC_STAT_LEFT] = left;
+        dst[cv::CC_STAT_TOP] = top;
+        dst[cv::CC_STAT_WIDTH] = right - left;
+        dst[cv::CC_STAT_HEIGHT] = bottom - top;
+    } else {
+        const int minX = std::min(dst[cv::CC_STAT_LEFT], left);
+        const int minY = std::min(dst[cv::CC_STAT_TOP], top);
+        const int maxX = std::max(dst[cv::CC_STAT_LEFT] + dst[cv::CC_STAT_WIDTH], right);
+        const int maxY = std::max(dst[cv::CC_STAT_TOP] + dst[cv::CC_STAT_HEIGHT], bottom);
+        dst[cv::CC_STAT_LEFT] = minX;
+        dst[cv::CC_STAT_TOP] = minY;
+        dst[cv::CC_STAT_WIDTH] = maxX - minX;
+        dst[cv::CC_STAT_HEIGHT] = maxY - minY;
+    }
+    dst[cv::CC_STAT_AREA] += src[cv::CC_STAT_AREA];
+}
+
+} // namespace
+
+int TiledExecutor::connectedComponents(const cv::Mat& binary, cv::Mat& labels, cv::Mat& stats,
+                                       int tileSize, int connectivity)
+{
+    CV_Assert(binary.type() == CV_8UC1);
+
+    const std::vector<cv::Rect> tiles = makeTiles(binary.size(), tileSize);
+    if (tiles.size() <= 1) {
+        cv::Mat centroids;
+        return cv::connectedComponentsWithStats(binary, labels, stats, centroids, connectivity, CV_32S);
+    }
+
+    // 1) 各块独立标记
+    const int tileCount = static_cast<int>(tiles.size());
+    labels.create(binary.size(), CV_32S);
+    std::vector<cv::Mat> tileStats(tileCount);
+    std::vector<int> tileLabels(tileCount, 0);   // 块内前景标签数
+    cv::parallel_for_(cv::Range(0, tileCount), [&](const cv::Range& range) {
+        for (int t = range.start; t < range.end; ++t) {
+            cv::Mat local, centroids;
+            tileLabels[t] = cv::connectedComponentsWithStats(binary(tiles[t]), local, tileStats[t],
+                                                             centroids, connectivity, CV_32S) - 1;
+            local.copyTo(labels(tiles[t]));
+        }
+    });
+
+    // 2) 块内标签偏移为全局临时标签：块 t 的标签 l -> base[t] + l
+    std::vector<int> base(tileCount, 0);
+    for (int t = 1; t < tileCount; ++t) base[t] = base[t - 1] + tileLabels[t - 1];
+    const int provisional = base.back() + tileLabels.back();
+
+    cv::parallel_for_(cv::Range(0, tileCount), [&](const cv::Range& range) {
+        for (int t = range.start; t < range.end; ++t) {
+            if (base[t] == 0) continue;
+            cv::Mat block = labels(tiles[t]);
+            for (int y = 0; y < block.rows; ++y) {
+                int* row = block.ptr<int>(y);
+                for (int x = 0; x < block.cols; ++x) {
+                    if (row[x] > 0) row[x] += base[t];
+                }
+            }
+        }
+    });
+
+    // 3) 沿块接缝合并：接缝两侧相邻的前景像素属于同一区域
+    std::vector<int> parent(provisional + 1);
+    std::iota(parent.begin(), parent.end(), 0);
+    const bool diagonal = connectivity == 8;
+    auto link = [&](int a, int x, int y) {
+        if (x < 0 || y < 0 || x >= labels.cols || y >= labels.rows) return;
+        const int b = labels.at<int>(y, x);
+        if (b > 0) unite(parent, a, b);
+    };
+    for (int x = tileSize; x < labels.cols; x += tileSize) {
+        for (int y = 0; y < labels.rows; ++y) {
+            const int a = labels.at<int>(y, x - 1);
+            if (a == 0) continue;
+            link(a, x, y);
+            if (diagonal) {
+                link(a, x, y - 1);
+                link(a, x, y + 1);
+            }
+        }
+    }
+    for (int y = tileSize; y < labels.rows; y += tileSize) {
+        const int* above = labels.ptr<int>(y - 1);
+        for (int x = 0; x < labels.cols; ++x) {
+            const int a = above[x];
+            if (a == 0) continue;
+            link(a, x, y);
+            if (diagonal) {
+                link(a, x - 1, y);
+                link(a, x + 1, y);
+            }
+        }
+    }
+
+    // 4) 压缩为连续的最终标签，合并统计量
+    std::vector<int> finalLabel(provisional + 1, 0);
+    int count = 0;
+    for (int i = 1; i <= provisional; ++i) {
+        const int root = findRoot(parent, i);
+        if (finalLabel[root] == 0) finalLabel[root] = ++count;
+        finalLabel[i] = finalLabel[root];
+    }
+
+    stats = cv::Mat::zeros(count + 1, 5, CV_32S);
+    for (int t = 0; t < tileCount; ++t) {
+        const cv::Point offset = tiles[t].tl();
+        mergeStats(stats.ptr<int>(0), tileStats[t].ptr<int>(0), offset);
+        for (int l = 1; l <= tileLabels[t]; ++l) {
+            mergeStats(stats.ptr<int>(finalLabel[base[t] + l]), tileStats[t].ptr<int>(l), offset);
+        }
+    }
+
+    cv::parallel_for_(cv::Range(0, tileCount), [&](const cv::Range& range) {
+        for (int t = range.start; t < range.end; ++t) {
+            cv::Mat block = labels(tiles[t]);
+            for (int y = 0; y < block.rows; ++y) {
+                int* row = block.ptr<int>(y);
+                for (int x = 0; x < block.cols; ++x) {
+                    if (row[x] > 0) row[x] = finalLabel[row[x]];
+                }
+            }
+        }
+    });
+
+    return count + 1;
+}
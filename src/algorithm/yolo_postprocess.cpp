@@ -0,0 +1,234 @@
+#include "algorithm/yolo_postprocess.h"
+#include "utils/benchmark.h"
+#include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+DetectionResult makeDetection(const float* output, int numDetections, int anchor,
+                              int classId, float score, const YoloDecodeParams& p,
+                              const std::vector<std::string>& classNames)
+{
+    const float cx = output[0 * numDetections + anchor];
+    const float cy = output[1 * numDetections + anchor];
+    const float w  = output[2 * numDetections + anchor];
+    const float h  = output[3 * numDetections + anchor];
+
+    int left   = static_cast<int>((cx - w / 2.0f - p.padX) * p.scaleX);
+    int top    = static_cast<int>((cy - h / 2.0f - p.padY) * p.scaleY);
+    int width  = static_cast<int>(w * p.scaleX);
+    int height = static_cast<int>(h * p.scaleY);
+
+    // 边界裁剪
+    left   = std::max(0, left);
+    top    = std::max(0, top);
+    width  = std::min(width, p.imgWidth - left);
+    height = std::min(height, p.imgHeight - top);
+
+    DetectionResult det;
+    det.box = cv::Rect(left, top, width, height);
+    det.confidence = score;
+    det.classId = classId;
+    if (classId >= 0 && classId < static_cast<int>(classNames.size()))
+        det.className = classNames[classId];
+    else
+        det.className = "class_" + std::to_string(classId);
+    return det;
+}
+
+float iou(const cv::Rect& a, const cv::Rect& b)
+{
+    const int inter = (a & b).area();
+    if (inter <= 0) return 0.0f;
+    return static_cast<float>(inter) / static_cast<float>(a.area() + b.area() - inter);
+}
+
+// 原逐锚点标量解码 + 类别无关 NMSBoxes，仅供基准对比
+std::vector<DetectionResult> decodeLegacy(const float* output, int numAttributes, int numDetections,
+                                          const YoloDecodeParams& p,
+                                          const std::vector<std::string>& classNames)
+{
+    std::vector<DetectionResult> results;
+    for (int i = 0; i < numDetections; ++i)
+    {
+        float maxConf = 0.0f;
+        int bestClassId = 0;
+        for (int j = 4; j < numAttributes; ++j)
+        {
+            const float conf = output[j * numDetections + i];
+            if (conf > maxConf)
+            {
+                maxConf = conf;
+                bestClassId = j - 4;
+            }
+        }
+        if (maxConf < p.confThreshold)
+            continue;
+        results.push_back(makeDetection(output, numDetections, i, bestClassId, maxConf, p, classNames));
+    }
+
+    if (results.empty()) return results;
+
+    std::vector<cv::Rect> boxes;
+    std::vector<float> confs;
+    for (const auto& r : results)
+    {
+        boxes.push_back(r.box);
+        confs.push_back(r.confidence);
+    }
+    std::vector<int> indices;
+    cv::dnn::NMSBoxes(boxes, confs, p.confThreshold, p.nmsThreshold, indices);
+
+    std::vector<DetectionResult> nmsResults;
+    for (int idx : indices)
+        nmsResults.push_back(results[idx]);
+    return nmsResults;
+}
+
+// 合成 YOLOv8 输出：背景锚点低分，少量目标锚点及其邻近锚点在某一类别上高分
+std::vector<float> makeSyntheticOutput(int numClasses, int numDetections, int inputSize, int numObjects)
+{
+    const int numAttributes = 4 + numClasses;
+    std::vector<float> data(static_cast<size_t>(numAttributes) * numDetections);
+    cv::Mat mat(numAttributes, numDetections, CV_32F, data.data());
+    cv::RNG rng(0x5EED);
+
+    rng.fill(mat.rowRange(0, 2), cv::RNG::UNIFORM, 0.0, static_cast<double>(inputSize));
+    rng.fill(mat.rowRange(2, 4), cv::RNG::UNIFORM, 8.0, 96.0);
+    rng.fill(mat.rowRange(4, numAttributes), cv::RNG::UNIFORM, 0.0, 0.05);
+
+    for (int k = 0; k < numObjects; ++k)
+    {
+        const int anchor = rng.uniform(0, numDetections);
+        const int cls = rng.uniform(0, numClasses);
+        const float cx = rng.uniform(0.0f, static_cast<float>(inputSize));
+        const float cy = rng.uniform(0.0f, static_cast<float>(inputSize));
+        // 每个目标命中若干相邻锚点，模拟需要 NMS 抑制的重叠框
+        for (int n = 0; n < 6 && anchor + n < numDetections; ++n)
+        {
+            const int i = anchor + n;
+            mat.at<float>(0, i) = cx + rng.uniform(-4.0f, 4.0f);
+            mat.at<float>(1, i) = cy + rng.uniform(-4.0f, 4.0f);
+            mat.at<float>(2, i) = 64.0f + rng.uniform(-4.0f, 4.0f);
+            mat.at<float>(3, i) = 64.0f + rng.uniform(-4.0f, 4.0f);
+            mat.at<float>(4 + cls, i) = rng.uniform(0.5f, 0.95f);
+        }
+    }
+    return data;
+}
+
+} // namespace
+
+std::vector<DetectionResult> YoloPostprocess::decode(const float* output, int numAttributes, int numDetections,
+                                                     const YoloDecodeParams& params,
+                                                     const std::vector<std::string>& classNames)
+{
+    std::vector<DetectionResult> results;
+    const int numClasses = numAttributes - 4;
+    if (!output || numClasses <= 0 || numDetections <= 0)
+        return results;
+
+    // 各锚点的类别最高分：类别行连续存储，逐行 max 可整行向量化，无需转置整个张量
+    const cv::Mat classBlock(numClasses, numDetections, CV_32F,
+                             const_cast<float*>(output + 4 * static_cast<size_t>(numDetections)));
+    cv::Mat best;
+    cv::reduce(classBlock, best, 0, cv::REDUCE_MAX, CV_32F);
+    const float* bestScore = best.ptr<float>();
+
+    // 阈值提前拒绝，只对幸存锚点回查类别下标
+    struct Candidate { int anchor; int classId; float score; };
+    std::vector<Candidate> candidates;
+    for (int i = 0; i < numDetections; ++i)
+    {
+        const float score = bestScore[i];
+        // score <= 0 时原实现不会更新最大值，保持同一判定
+        if (score < params.confThreshold || score <= 0.0f)
+            continue;
+        int classId = 0;
+        for (int c = 0; c < numClasses; ++c)
+        {
+            if (classBlock.ptr<float>(c)[i] == score)
+            {
+                classId = c;
+                break;
+            }
+        }
+        candidates.push_back({i, classId, score});
+    }
+    if (candidates.empty())
+        return results;
+
+    // 按分数降序（同分保持锚点顺序）
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+
+    // 单次遍历的贪心 NMS：每个类别维护已保留框，只与同类比较
+    std::vector<std::vector<cv::Rect>> keptByClass(params.classAware ? numClasses : 1);
+    for (const Candidate& cand : candidates)
+    {
+        DetectionResult det = makeDetection(output, numDetections, cand.anchor, cand.classId,
+                                            cand.score, params, classNames);
+        auto& kept = keptByClass[params.classAware ? cand.classId : 0];
+        bool suppressed = false;
+        for (const cv::Rect& k : kept)
+        {
+            if (iou(det.box, k) > params.nmsThreshold)
+            {
+                suppressed = true;
+                break;
+            }
+        }
+        if (suppressed)
+            continue;
+        kept.push_back(det.box);
+        results.push_back(std::move(det));
+    }
+    return results;
+}
+
+void YoloPostprocess::benchmark(int iterations)
+{
+    if (iterations <= 0) return;
+
+    constexpr int kNumClasses = 80;
+    const std::vector<std::string> classNames;
+
+    for (int inputSize : {640, 1280})
+    {
+        // 三个检测头（stride 8/16/32）的锚点总数：640→8400，1280→33600
+        const int numDetections = (inputSize / 8) * (inputSize / 8) +
+                                  (inputSize / 16) * (inputSize / 16) +
+                                  (inputSize / 32) * (inputSize / 32);
+        const std::vector<float> data = makeSyntheticOutput(kNumClasses, numDetections, inputSize, 50);
+
+        YoloDecodeParams params;
+        params.confThreshold = 0.5f;
+        params.nmsThreshold = 0.4f;
+        params.imgWidth = inputSize;
+        params.imgHeight = inputSize;
+
+        std::vector<DetectionResult> legacy, agnostic, aware;
+        const std::string legacyName = "YoloPostprocess legacy " + std::to_string(inputSize);
+        const std::string agnosticName = "YoloPostprocess decode(class-agnostic) " + std::to_string(inputSize);
+        const std::string awareName = "YoloPostprocess decode(class-aware) " + std::to_string(inputSize);
+
+        benchmarkAvg(legacyName.c_str(), iterations, [&] {
+            legacy = decodeLegacy(data.data(), 4 + kNumClasses, numDetections, params, classNames);
+        });
+        params.classAware = false;
+        benchmarkAvg(agnosticName.c_str(), iterations, [&] {
+            agnostic = YoloPostprocess::decode(data.data(), 4 + kNumClasses, numDetections, params, classNames);
+        });
+        params.classAware = true;
+        benchmarkAvg(awareName.c_str(), iterations, [&] {
+            aware = YoloPostprocess::decode(data.data(), 4 + kNumClasses, numDetections, params, classNames);
+        });
+
+        spdlog::info("[BENCH] YoloPostprocess {}x{} ({} anchors x {} classes): legacy={} / class-agnostic={} / class-aware={} detections",
+                     inputSize, inputSize, numDetections, kNumClasses,
+                     legacy.size(), agnostic.size(), aware.size());
+    }
+}
@@ -43,7 +43,7 @@ QVector<ZXingBarcodeResult> ZXingBarcodeReader::readBarcodes(const cv::Mat& imag
 {
     if (image.empty())
     {
-        spdlog::info("[ZXing] 输入图像为空");
+        LOG_THROTTLED(spdlog::level::info, 5000, "[ZXing] 输入图像为空");
         return {};
     }
 
@@ -63,16 +63,31 @@ QVector<ZXingBarcodeResult> ZXingBarcodeReader::readBarcodes(const cv::Mat& imag
         gray = image.clone();
     }
 
-    return decodeImage(gray);
+    return decodeImage(gray, true, tryRotate_, tryInvert_, tryDownscale_);
 }
 
-QVector<ZXingBarcodeResult> ZXingBarcodeReader::decodeImage(const cv::Mat& gray)
+QVector<ZXingBarcodeResult> ZXingBarcodeReader::decodeWithEffort(const cv::Mat& gray, Effort effort) const
+{
+    switch (effort) {
+    case Effort::Fast:
+        return decodeImage(gray, false, false, false, false);
+    case Effort::Normal:
+        return decodeImage(gray, true, true, false, false);
+    case Effort::Thorough:
+    default:
+        return decodeImage(gray, true, true, true, true);
+    }
+}
+
+QVector<ZXingBarcodeResult> ZXingBarcodeReader::decodeImage(const cv::Mat& gray,
+                                                            bool tryHarder, bool tryRotate,
+                                                            bool tryInvert, bool tryDownscale) const
 {
     QVector<ZXingBarcodeResult> results;
 
     if (gray.empty() || gray.type() != CV_8UC1)
     {
-        spdlog::info("[ZXing] 图像格式错误，需要8位灰度图");
+        LOG_THROTTLED(spdlog::level::info, 5000, "[ZXing] 图像格式错误，需要8位灰度图");
         return results;
     }
 
@@ -136,10 +151,10 @@ QVector<ZXingBarcodeResult> ZXingBarcodeReader::decodeImage(const cv::Mat& gray)
         options.setFormats(formats);
 
         // 其他选项
-        options.setTryRotate(tryRotate_);
-        options.setTryInvert(tryInvert_);
-        options.setTryDownscale(tryDownscale_);
-        options.setTryHarder(true);
+        options.setTryRotate(tryRotate);
+        options.setTryInvert(tryInvert);
+        options.setTryDownscale(tryDownscale);
+        options.setTryHarder(tryHarder);
 
         // 执行识别
         auto barcodes = ZXing::ReadBarcodes(imageView, options);
@@ -154,7 +169,7 @@ QVector<ZXingBarcodeResult> ZXingBarcodeReader::decodeImage(const cv::Mat& gray)
 
             auto position = barcode.position();
 
-            spdlog::debug("[ZXing] corners: TL={},{} TR={},{} BR={},{} BL={},{} format={}",
+            STEP_LOG_DEBUG("[ZXing] corners: TL={},{} TR={},{} BR={},{} BL={},{} format={}",
                 position.topLeft().x, position.topLeft().y,
                 position.topRight().x, position.topRight().y,
                 position.bottomRight().x, position.bottomRight().y,
@@ -199,7 +214,7 @@ QVector<ZXingBarcodeResult> ZXingBarcodeReader::decodeImage(const cv::Mat& gray)
                     h = std::min(static_cast<double>(gray.rows) - y, h + padY * 2);
                 }
 
-                spdlog::debug("[ZXing] bbox: {} {} {} {} is1D={}", x, y, w, h, is1D);
+                STEP_LOG_DEBUG("[ZXing] bbox: {} {} {} {} is1D={}", x, y, w, h, is1D);
 
                 result.location = QRectF(x, y, w, h);
             }
@@ -212,21 +227,21 @@ QVector<ZXingBarcodeResult> ZXingBarcodeReader::decodeImage(const cv::Mat& gray)
 
             results.append(result);
 
-            spdlog::info("[ZXing] 识别到条码: {} 数据: {}", result.type.toStdString(), result.data.toStdString());
+            STEP_LOG_DEBUG("[ZXing] 识别到条码: {} 数据: {}", result.type.toStdString(), result.data.toStdString());
         }
 
         if (results.isEmpty())
         {
-            spdlog::info("[ZXing] 未识别到条码");
+            STEP_LOG_DEBUG("[ZXing] 未识别到条码");
         }
     }
     catch (const std::exception& ex)
     {
-        spdlog::debug("[ZXing] 识别异常: {}", ex.what());
+        LOG_THROTTLED(spdlog::level::debug, 5000, "[ZXing] 识别异常: {}", ex.what());
     }
     catch (...)
     {
-        spdlog::info("[ZXing] 未知异常");
+        LOG_THROTTLED(spdlog::level::info, 5000, "[ZXing] 未知异常");
     }
 
     return results;
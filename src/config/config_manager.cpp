@@ -62,6 +62,9 @@ QJsonObject AppConfig::toJson() const
     // MQTT 配置
     json["mqtt"] = mqttConfig.toJson();
 
+    // 常驻采集配置
+    json["capture"] = captureConfig.toJson();
+
     return json;
 }
 
@@ -128,6 +131,11 @@ void AppConfig::fromJson(const QJsonObject& json)
     if (json.contains("mqtt")) {
         mqttConfig.fromJson(json["mqtt"].toObject());
     }
+
+    // 常驻采集配置
+    if (json.contains("capture")) {
+        captureConfig.fromJson(json["capture"].toObject());
+    }
 }
 
 ConfigManager& ConfigManager::instance()
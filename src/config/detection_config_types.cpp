@@ -160,14 +160,8 @@ void OcrDetectionConfig::fromJson(const QJsonObject& obj) {
     enhance.contrast = obj["contrast"].toInt(100);
     enhance.gamma = obj["gamma"].toInt(100);
     enhance.sharpen = obj["sharpen"].toInt(100);
-    // OCR核心参数通过 OcrConfig 反序列化
-    QJsonObject ocrObj;
-    ocrObj["language"] = obj["language"];
-    ocrObj["pageMode"] = obj["pageMode"];
-    ocrObj["dpi"] = obj["dpi"];
-    ocrObj["confidenceThreshold"] = obj["confidenceThreshold"];
-    ocrObj["whitelist"] = obj["whitelist"];
-    ocr.fromJson(ocrObj);
+    // OCR核心参数通过 OcrConfig 反序列化（与 toJson 对称，扁平键直接交给 OcrConfig）
+    ocr.fromJson(obj);
     // 判定参数
     enableTextFilter = obj["enableTextFilter"].toBool(false);
     expectedText = obj["expectedText"].toString();
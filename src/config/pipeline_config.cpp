@@ -42,6 +42,12 @@ QJsonObject PipelineConfig::toJson() const {
     barcodeObj["codeTypes"] = barcode.codeTypes.join(",");
     barcodeObj["maxNumSymbols"] = barcode.maxNumSymbols;
     barcodeObj["returnQuality"] = barcode.returnQuality;
+    barcodeObj["enableLocalization"] = barcode.enableLocalization;
+    barcodeObj["localizationMaxSide"] = barcode.localizationMaxSide;
+    barcodeObj["maxCandidates"] = barcode.maxCandidates;
+    barcodeObj["enableTracking"] = barcode.enableTracking;
+    barcodeObj["trackingFullSearchInterval"] = barcode.trackingFullSearchInterval;
+    barcodeObj["trackingWindowMargin"] = barcode.trackingWindowMargin;
     obj["barcode"] = barcodeObj;
 
     // 滤波去噪参数
@@ -53,6 +59,15 @@ QJsonObject PipelineConfig::toJson() const {
     // 目标检测参数
     obj["objectDetection"] = objectDetection.toJson();
 
+    // 卡尺测量参数
+    obj["caliper"] = caliper.toJson();
+
+    // 大图分块参数
+    obj["tiling"] = tiling.toJson();
+
+    // 变化门控参数
+    obj["changeGate"] = changeGate.toJson();
+
     // 步骤控制
     QJsonArray enabledArr, orderArr;
     for (int i = 0; i < PipelineConfig::STEP_COUNT; ++i) {
@@ -152,17 +167,41 @@ void PipelineConfig::fromJson(const QJsonObject& obj) {
         objectDetection.fromJson(obj["objectDetection"].toObject());
     }
 
+    // 卡尺测量参数
+    if (obj.contains("caliper")) {
+        caliper.fromJson(obj["caliper"].toObject());
+    }
+
+    // 大图分块参数
+    if (obj.contains("tiling")) {
+        tiling.fromJson(obj["tiling"].toObject());
+    }
+
+    // 变化门控参数
+    if (obj.contains("changeGate")) {
+        changeGate.fromJson(obj["changeGate"].toObject());
+    }
+
     // 步骤控制
+    // 旧配置的步骤数可能少于当前 STEP_COUNT：已有部分照读，新增步骤默认关闭并排在末尾
     QJsonArray enabledArr = obj["stepEnabled"].toArray();
-    if (enabledArr.size() == PipelineConfig::STEP_COUNT) {
+    if (!enabledArr.isEmpty() && enabledArr.size() <= PipelineConfig::STEP_COUNT) {
         for (int i = 0; i < PipelineConfig::STEP_COUNT; ++i) {
-            stepEnabled[i] = enabledArr[i].toBool(true);
+            stepEnabled[i] = i < enabledArr.size() ? enabledArr[i].toBool(true) : false;
         }
     }
     QJsonArray orderArr = obj["stepOrder"].toArray();
-    if (orderArr.size() == PipelineConfig::STEP_COUNT) {
+    if (!orderArr.isEmpty() && orderArr.size() <= PipelineConfig::STEP_COUNT) {
+        std::array<bool, PipelineConfig::STEP_COUNT> placed{};
+        int pos = 0;
+        for (const auto& v : orderArr) {
+            int idx = v.toInt(-1);
+            if (idx < 0 || idx >= PipelineConfig::STEP_COUNT || placed[idx]) continue;
+            stepOrder[pos++] = idx;
+            placed[idx] = true;
+        }
         for (int i = 0; i < PipelineConfig::STEP_COUNT; ++i) {
-            stepOrder[i] = orderArr[i].toInt(i);
+            if (!placed[i]) stepOrder[pos++] = i;
         }
     }
 
@@ -208,6 +247,7 @@ QJsonObject LineDetectConfig::toJson() const {
     obj["angleThreshold"] = angleThreshold;
     obj["distanceThreshold"] = distanceThreshold;
     obj["searchRegionWidth"] = searchRegionWidth;
+    obj["deskewSearchRegion"] = deskewSearchRegion;
     return obj;
 }
 
@@ -226,6 +266,7 @@ void LineDetectConfig::fromJson(const QJsonObject& obj) {
     angleThreshold = obj["angleThreshold"].toDouble(10.0);
     distanceThreshold = obj["distanceThreshold"].toDouble(20.0);
     searchRegionWidth = obj["searchRegionWidth"].toInt(50);
+    deskewSearchRegion = obj["deskewSearchRegion"].toBool(false);
 }
 
 // ========== BarcodeConfig 序列化 ==========
@@ -247,6 +288,12 @@ QJsonObject BarcodeConfig::toJson() const {
     obj["preprocessMethod"] = preprocessMethod;
     obj["binarizationThreshold"] = binarizationThreshold;
     obj["morphologySize"] = morphologySize;
+    obj["enableLocalization"] = enableLocalization;
+    obj["localizationMaxSide"] = localizationMaxSide;
+    obj["maxCandidates"] = maxCandidates;
+    obj["enableTracking"] = enableTracking;
+    obj["trackingFullSearchInterval"] = trackingFullSearchInterval;
+    obj["trackingWindowMargin"] = trackingWindowMargin;
     return obj;
 }
 
@@ -271,4 +318,10 @@ void BarcodeConfig::fromJson(const QJsonObject& obj) {
     preprocessMethod = obj["preprocessMethod"].toInt(0);
     binarizationThreshold = obj["binarizationThreshold"].toInt(128);
     morphologySize = obj["morphologySize"].toInt(3);
+    enableLocalization = obj["enableLocalization"].toBool(true);
+    localizationMaxSide = obj["localizationMaxSide"].toInt(640);
+    maxCandidates = obj["maxCandidates"].toInt(8);
+    enableTracking = obj["enableTracking"].toBool(false);
+    trackingFullSearchInterval = obj["trackingFullSearchInterval"].toInt(30);
+    trackingWindowMargin = obj["trackingWindowMargin"].toInt(32);
 }
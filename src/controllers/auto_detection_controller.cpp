@@ -7,11 +7,27 @@
 #include "widgets/object_detection_tab_widget.h"
 #include "widgets/tab_manager.h"
 #include "data/roi_detection_result.h"
+#include "data/frame_view.h"
+#include "core/metrics.h"
+#include "core/session_recorder.h"
+#include "utils/thread_tag.h"
 #include <QFileInfo>
 #include <QCoreApplication>
 #include <QtConcurrent/QtConcurrent>
 #include <QFutureWatcher>
 
+namespace {
+
+/// 本轮批量检测保留的报告数（长时间批量运行的内存增长来源之一）
+MetricGauge& reportsGauge()
+{
+    static MetricGauge& gauge = MetricsRegistry::instance().gauge(
+        "edgevision_subsystem_items", "各子系统在内存中保留的条目数", {{"subsystem", "batch_reports"}});
+    return gauge;
+}
+
+} // namespace
+
 AutoDetectionController::AutoDetectionController(
     PipelineManager* pipeline,
     RoiManager* roiManager,
@@ -49,6 +65,7 @@ void AutoDetectionController::startDetection()
     m_stats.totalCount = m_tasks.size();
     m_reports.clear();
     m_failedImages.clear();
+    reportsGauge().set(0);
 
     m_elapsedTimer.start();
 
@@ -182,6 +199,8 @@ void AutoDetectionController::processImageTask(const ImageDetectionTask& task)
     // 注意：lambda中无法使用emit logMessage（无this指针），使用Logger::instance()代替
     QFuture<ImageDetectionResult> future = QtConcurrent::run(
         [pipelinePtr, tabMgrPtr, imagePath, imageName, imageId, roiConfigs, image]() -> ImageDetectionResult {
+            ThreadTag::Scope tag("batch");  // 全局线程池线程，执行完恢复原名
+
             // 创建图片级别的检测结果
             ImageDetectionResult imageResult;
             imageResult.imageId = imageId;
@@ -212,14 +231,19 @@ void AutoDetectionController::processImageTask(const ImageDetectionTask& task)
                 return imageResult;
             }
 
-            // 遍历每个ROI，独立评估检测结果
+            // 遍历每个ROI，独立评估检测结果（ROI 为整图的只读子视图，不拷贝像素）
+            const FrameView frame(finalImage);
             for (const RoiConfig& roiConfig : roiConfigs) {
                 if (!roiConfig.isActive) continue;
 
                 cv::Rect r = ImageUtils::mapRoiToCvRect(roiConfig.roiRect, finalImage.cols, finalImage.rows);
-                cv::Mat roiImage = r.empty() ? finalImage.clone() : finalImage(r).clone();
+                const FrameView roiFrame = r.empty() ? frame : frame.crop(r);
+                const cv::Mat& roiImage = roiFrame.mat();
+
+                SessionRecorder::instance().recordFrame(SessionRecorder::Origin::Batch,
+                    imageId + '/' + roiConfig.roiId, roiFrame, roiConfig.pipelineConfig, &roiConfig);
 
-                PipelineContext ctx = pipelinePtr->execute(roiImage, roiConfig.pipelineConfig);
+                PipelineContext ctx = pipelinePtr->execute(roiImage, roiConfig.pipelineConfig, roiConfig.roiId);
 
                 // [NOTE] 使用DetectionEvaluator评估该ROI的所有检测项
                 RoiDetectionResult roiResult = DetectionEvaluator::evaluateRoi(
@@ -283,6 +307,7 @@ void AutoDetectionController::processImageTask(const ImageDetectionTask& task)
             }
 
             m_reports.append(report);
+            reportsGauge().set(m_reports.size());
 
             // 发送信号
             emit imageProcessed(currentIndex, task.imagePath, passed);
@@ -29,8 +29,9 @@ void PipelineResultHandler::onPipelineResult(const PipelineResult& result)
         }
 
         const PipelineContext& ctx = result.context();
-        cv::Mat displayImage = DisplayRenderer::render(
-            ctx, m_pipelineManager->getDisplayMode());
+        const DisplayConfig::Mode mode = m_pipelineManager->getDisplayMode();
+        cv::Mat displayImage = DisplayRenderer::render(ctx, mode);
+        OverlayModel overlay = DisplayRenderer::overlayFor(ctx, mode);
 
         // [NOTE] 将结果存入per-ROI缓存
         if (m_roiManager) {
@@ -49,12 +50,12 @@ void PipelineResultHandler::onPipelineResult(const PipelineResult& result)
         double detectionMs = 0;
         {
             BenchmarkTimer t("ObjectDetection", &detectionMs);
-            handleObjectDetection(displayImage, ctx.srcBgr);
+            handleObjectDetection(overlay, ctx.srcBgr);
         }
 
         if (m_imageView) {
-            QImage qimg = ImageUtils::matToQImage(displayImage);
-            m_imageView->setImage(qimg);
+            m_imageView->setImageMat(displayImage);
+            m_imageView->setOverlay(overlay);
         }
 
         // 显示总处理时间（Pipeline + 目标检测）
@@ -94,7 +95,7 @@ void PipelineResultHandler::setVideoMode(bool active)
     m_isVideoMode = active;
 }
 
-void PipelineResultHandler::handleObjectDetection(cv::Mat& displayImage, const cv::Mat& pipelineSource)
+void PipelineResultHandler::handleObjectDetection(OverlayModel& overlay, const cv::Mat& pipelineSource)
 {
     if (!m_tabManager || !m_roiManager || !m_pipelineManager) return;
 
@@ -115,40 +116,20 @@ void PipelineResultHandler::handleObjectDetection(cv::Mat& displayImage, const c
                 detResults = objTab->runDetection(detectImage);
             }
             objTab->updateDetectionResults(detResults);
-            drawDetectionResults(displayImage, detResults);
+            appendDetectionOverlay(overlay, detResults);
         }
     }
 }
 
-void PipelineResultHandler::drawDetectionResults(cv::Mat& image, const std::vector<DetectionResult>& results)
+void PipelineResultHandler::appendDetectionOverlay(OverlayModel& overlay, const std::vector<DetectionResult>& results)
 {
-    if (image.empty()) return;
-
-    try {
-        for (const auto& det : results) {
-            cv::rectangle(image, det.box, cv::Scalar(0, 255, 0), 2);
-
-            std::string label = det.className + " " + cv::format("%.2f", det.confidence);
-            int baseline = 0;
-            cv::Size textSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 0.8, 2, &baseline);
-
-            cv::Point textOrg(det.box.x, det.box.y - 5);
-            if (textOrg.y - textSize.height < 0) {
-                textOrg.y = det.box.y + textSize.height + 5;
-            }
-
-            cv::rectangle(image,
-                cv::Point(textOrg.x, textOrg.y - textSize.height - 2),
-                cv::Point(textOrg.x + textSize.width + 2, textOrg.y + 4),
-                cv::Scalar(0, 255, 0), -1);
-
-            cv::putText(image, label, textOrg,
-                cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(0, 0, 0), 2);
-        }
-    } catch (const cv::Exception& ex) {
-        spdlog::error("绘制检测结果错误: {}", ex.what());
-    } catch (...) {
-        spdlog::info("[DrawResults] 未知异常");
-        spdlog::error("绘制检测结果未知异常");
+    for (const auto& det : results) {
+        QRectF box(det.box.x, det.box.y, det.box.width, det.box.height);
+        overlay.addBox(OverlayGroup::ObjectDetection, box, QColor(0, 255, 0), 2.0);
+
+        QString label = QString::fromStdString(det.className) + QString(" %1").arg(det.confidence, 0, 'f', 2);
+        overlay.addLabel(OverlayGroup::ObjectDetection,
+                         QPointF(det.box.x, det.box.y > 25 ? det.box.y - 5 : det.box.y + 25),
+                         label, QColor(0, 0, 0), QColor(0, 255, 0));
     }
 }
@@ -664,21 +664,24 @@ void RoiUiController::setupDisplayConnections(TabManager* tabManager)
     connect(this, &RoiUiController::roiDisplayChanged,
             this, [this](const QString& roiId) {
         cv::Mat displayImage;
+        OverlayModel overlay;
 
         // [NOTE] 优先从per-ROI缓存获取Pipeline处理后的结果
         if (m_pipelineManager && m_pipelineManager->hasCachedResult(roiId)) {
-            displayImage = m_pipelineManager->getCachedDisplay(
-                roiId, m_pipelineManager->getDisplayMode());
+            const auto mode = m_pipelineManager->getDisplayMode();
+            displayImage = m_pipelineManager->getCachedDisplay(roiId, mode);
+            overlay = m_pipelineManager->getCachedOverlay(roiId, mode);
         }
 
         // 缓存为空时显示原始图像
         if (displayImage.empty()) {
             displayImage = m_roiManager.getCurrentImage();
+            overlay.clear();
         }
 
         if (!displayImage.empty()) {
-            QImage qimg = ImageUtils::matToQImage(displayImage);
-            m_view->setImage(qimg);
+            m_view->setImageMat(displayImage);
+            m_view->setOverlay(overlay);
             if (m_statusBar) m_statusBar->showMessage("已切换显示", 2000);
         }
     });
@@ -1,6 +1,48 @@
 ﻿#include "barcode_step.h"
+#include "barcode_localizer.h"
+#include "core/metrics.h"
 #include "logger.h"
 #include <opencv2/imgproc.hpp>
+#include <opencv2/core/utility.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+MetricHistogram& stageDuration(const char* stage)
+{
+    return MetricsRegistry::instance().histogram(
+        "edgevision_barcode_stage_ms", "条码识别各阶段耗时（ms）", {{"stage", stage}});
+}
+
+/// 作用域耗时写入阶段直方图（每帧执行，不打日志）
+class StageTimer
+{
+public:
+    explicit StageTimer(MetricHistogram& histogram)
+        : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+    ~StageTimer() {
+        m_histogram.observe(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - m_start).count());
+    }
+
+private:
+    MetricHistogram& m_histogram;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/// 把 extra 中未出现过的码（同内容同类型且位置相交视为同一个）追加到 out
+void appendUnique(QVector<ZXingBarcodeResult>& out, const QVector<ZXingBarcodeResult>& extra)
+{
+    for (const auto& r : extra) {
+        const bool duplicate = std::any_of(out.begin(), out.end(), [&](const ZXingBarcodeResult& m) {
+            return m.data == r.data && m.type == r.type && m.location.intersects(r.location);
+        });
+        if (!duplicate) out.append(r);
+    }
+}
+
+} // namespace
 
 StepBarcodeRecognition::StepBarcodeRecognition()
 {
@@ -36,6 +78,160 @@ QString StepBarcodeRecognition::convertBarcodeType(const QString& zxingType) con
     return zxingType;
 }
 
+void StepBarcodeRecognition::appendOverlay(OverlayModel& overlay, const BarcodeResult& result) const
+{
+    QString label = QString("[%1] %2").arg(result.type, result.data);
+    if (result.quality > 0)
+        label += QString(" (%1%)").arg(result.quality, 0, 'f', 0);
+
+    overlay.addBox(OverlayGroup::Barcode, result.location, QColor(0, 255, 0), 2.0);
+    overlay.addLabel(OverlayGroup::Barcode,
+                     QPointF(result.location.x(), std::max(result.location.y() - 5.0, 20.0)),
+                     label);
+}
+
+QVector<ZXingBarcodeResult> StepBarcodeRecognition::decodeCandidates(const cv::Mat& gray,
+                                                                    const BarcodeConfig& cfg) const
+{
+    BarcodeLocalizer::Params params;
+    params.maxSide = cfg.localizationMaxSide;
+    params.maxCandidates = cfg.maxCandidates;
+
+    std::vector<BarcodeCandidate> candidates;
+    {
+        static MetricHistogram& localize = stageDuration("localize");
+        StageTimer t(localize);
+        candidates = BarcodeLocalizer::locate(gray, params);
+    }
+    if (candidates.empty()) return {};
+
+    // 每个窗口独立解码，互不共享状态，可直接并行
+    std::vector<QVector<ZXingBarcodeResult>> perWindow(candidates.size());
+    {
+        static MetricHistogram& decodeWindows = stageDuration("decode_windows");
+        StageTimer t(decodeWindows);
+        cv::parallel_for_(cv::Range(0, static_cast<int>(candidates.size())),
+                          [&](const cv::Range& range) {
+            static constexpr ZXingBarcodeReader::Effort kEfforts[] = {
+                ZXingBarcodeReader::Effort::Fast,
+                ZXingBarcodeReader::Effort::Normal,
+                ZXingBarcodeReader::Effort::Thorough
+            };
+            for (int i = range.start; i < range.end; ++i) {
+                const cv::Rect& rect = candidates[i].rect;
+                cv::Mat window = gray(rect);
+                for (auto effort : kEfforts) {
+                    auto found = reader_.decodeWithEffort(window, effort);
+                    if (found.isEmpty()) continue;
+                    for (auto& r : found) {
+                        r.location.translate(rect.x, rect.y);
+                    }
+                    perWindow[i] = std::move(found);
+                    break;
+                }
+            }
+        });
+    }
+
+    // 外扩后的窗口可能重叠：同内容同类型且位置相交视为同一个码
+    QVector<ZXingBarcodeResult> merged;
+    for (const auto& found : perWindow) {
+        appendUnique(merged, found);
+    }
+
+    STEP_LOG_DEBUG("[Barcode] 候选窗口 {} 个，解出 {} 个条码", candidates.size(), merged.size());
+    return merged;
+}
+
+void StepBarcodeRecognition::resetTracking()
+{
+    QMutexLocker locker(&trackMutex_);
+    tracks_.clear();
+}
+
+bool StepBarcodeRecognition::verifyTracked(const QString& roiId, const cv::Mat& gray,
+                                           const BarcodeConfig& cfg, QVector<ZXingBarcodeResult>& out)
+{
+    TrackState state;
+    {
+        QMutexLocker locker(&trackMutex_);
+        auto it = tracks_.find(roiId);
+        if (it == tracks_.end() || it->codes.isEmpty() || it->frameSize != gray.size())
+            return false;
+        // 周期性全图搜索：发现新进入视野的码
+        if (cfg.trackingFullSearchInterval > 0 &&
+            it->framesSinceFullSearch >= cfg.trackingFullSearchInterval)
+            return false;
+        state = *it;
+    }
+
+    const cv::Rect imageRect(0, 0, gray.cols, gray.rows);
+    const int margin = std::max(0, cfg.trackingWindowMargin);
+    QVector<ZXingBarcodeResult> verified;
+    verified.reserve(state.codes.size());
+
+    for (const auto& prev : state.codes)
+    {
+        QRect r = prev.location.toAlignedRect();
+        cv::Rect window = cv::Rect(r.x() - margin, r.y() - margin,
+                                   r.width() + 2 * margin, r.height() + 2 * margin) & imageRect;
+        if (window.empty()) break;
+
+        bool matched = false;
+        for (auto effort : {ZXingBarcodeReader::Effort::Fast, ZXingBarcodeReader::Effort::Normal})
+        {
+            for (auto found : reader_.decodeWithEffort(gray(window), effort))
+            {
+                if (found.data != prev.data || found.type != prev.type) continue;
+                found.location.translate(window.x, window.y);
+                verified.append(found);
+                matched = true;
+                break;
+            }
+            if (matched) break;
+        }
+        if (!matched) break;
+    }
+
+    const bool hit = verified.size() == state.codes.size();
+    quint64 attempts = ++trackVerifications_;
+    if (hit) ++trackHits_;
+
+    if (attempts % 100 == 0)
+    {
+        auto stats = trackingStats();
+        spdlog::info("[Barcode] 跟踪缓存命中率 {:.1f}% ({}/{})",
+                     stats.hitRate() * 100.0, stats.hits, stats.verifications);
+    }
+
+    if (!hit) return false;
+
+    {
+        QMutexLocker locker(&trackMutex_);
+        TrackState& slot = tracks_[roiId];
+        slot.codes = verified;
+        slot.frameSize = gray.size();
+        slot.framesSinceFullSearch = state.framesSinceFullSearch + 1;
+    }
+    out = std::move(verified);
+    return true;
+}
+
+void StepBarcodeRecognition::updateTrack(const QString& roiId, const cv::Size& frameSize,
+                                         const QVector<ZXingBarcodeResult>& codes)
+{
+    QMutexLocker locker(&trackMutex_);
+    if (codes.isEmpty())
+    {
+        tracks_.remove(roiId);
+        return;
+    }
+    TrackState& slot = tracks_[roiId];
+    slot.codes = codes;
+    slot.frameSize = frameSize;
+    slot.framesSinceFullSearch = 0;
+}
+
 void StepBarcodeRecognition::run(PipelineContext& ctx)
 {
     if (!ctx.config || !ctx.config->barcode.enableBarcode)
@@ -66,8 +262,47 @@ void StepBarcodeRecognition::run(PipelineContext& ctx)
     try
     {
         ctx.barcodeResults.clear();
+        ctx.overlay.removeGroup(OverlayGroup::Barcode);
+
+        const BarcodeConfig& cfg = ctx.config->barcode;
+        QVector<ZXingBarcodeResult> zxingResults;
 
-        QVector<ZXingBarcodeResult> zxingResults = reader_.readBarcodes(input);
+        cv::Mat gray;
+        if (input.channels() == 3)
+            cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
+        else if (input.channels() == 4)
+            cv::cvtColor(input, gray, cv::COLOR_BGRA2GRAY);
+        else
+            gray = input;
+        const bool grayValid = gray.type() == CV_8UC1;
+
+        // 跟踪命中：旧位置附近验证通过，跳过全图搜索
+        bool tracked = false;
+        if (cfg.enableTracking && grayValid)
+        {
+            static MetricHistogram& verify = stageDuration("verify_tracked");
+            StageTimer t(verify);
+            tracked = verifyTracked(ctx.roiId, gray, cfg, zxingResults);
+        }
+
+        if (!tracked)
+        {
+            if (cfg.enableLocalization && grayValid)
+                zxingResults = decodeCandidates(gray, cfg);
+
+            // 没有候选解出，或解出数量少于期望（maxNumSymbols）时补做全图解码，
+            // 视野内有多个码时召回不低于原先
+            const bool tooFew = cfg.maxNumSymbols > 0 && zxingResults.size() < cfg.maxNumSymbols;
+            if (zxingResults.isEmpty() || tooFew)
+            {
+                static MetricHistogram& fullFrame = stageDuration("full_frame");
+                StageTimer t(fullFrame);
+                appendUnique(zxingResults, reader_.readBarcodes(input));
+            }
+
+            if (cfg.enableTracking)
+                updateTrack(ctx.roiId, input.size(), zxingResults);
+        }
 
         for (const auto& zxingResult : zxingResults)
         {
@@ -78,6 +313,7 @@ void StepBarcodeRecognition::run(PipelineContext& ctx)
             result.quality = zxingResult.quality;
 
             ctx.barcodeResults.append(result);
+            appendOverlay(ctx.overlay, result);
         }
 
         int numFound = ctx.barcodeResults.size();
@@ -91,18 +327,26 @@ void StepBarcodeRecognition::run(PipelineContext& ctx)
             ctx.barcodeStatus = "未检测到条码";
         }
 
-        spdlog::info("[Barcode] {}", ctx.barcodeStatus.toStdString());
+        if (cfg.enableTracking)
+        {
+            auto stats = trackingStats();
+            ctx.barcodeStatus += QString(" [%1, 跟踪命中率 %2%]")
+                                     .arg(tracked ? "跟踪" : "全搜")
+                                     .arg(stats.hitRate() * 100.0, 0, 'f', 1);
+        }
+
+        STEP_LOG_DEBUG("[Barcode] {}", ctx.barcodeStatus.toStdString());
     }
     catch (const std::exception& ex)
     {
         QString error = QString("条码识别错误: %1").arg(ex.what());
         ctx.barcodeStatus = error;
-        spdlog::info("[Barcode] {}", error.toStdString());
+        LOG_THROTTLED(spdlog::level::info, 5000, "[Barcode] {}", error.toStdString());
     }
     catch (...)
     {
         QString error = "条码识别发生未知错误";
         ctx.barcodeStatus = error;
-        spdlog::info("[Barcode] {}", error.toStdString());
+        LOG_THROTTLED(spdlog::level::info, 5000, "[Barcode] {}", error.toStdString());
     }
 }
@@ -0,0 +1,273 @@
+﻿#include "core/capture_service.h"
+#include "core/metrics.h"
+#include "logger.h"
+#include "utils/thread_tag.h"
+#include <QFileInfo>
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+#include <chrono>
+
+namespace {
+
+int backendApi(const QString& backend)
+{
+    if (backend == "dshow") return cv::CAP_DSHOW;
+    if (backend == "msmf") return cv::CAP_MSMF;
+    if (backend == "v4l2") return cv::CAP_V4L2;
+    if (backend == "ffmpeg") return cv::CAP_FFMPEG;
+    return cv::CAP_ANY;
+}
+
+} // namespace
+
+double CaptureService::Frame::ageMs(qint64 now) const
+{
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::duration(now - capturedAt)).count();
+}
+
+CaptureService::CaptureService(QObject* parent)
+    : QObject(parent)
+{
+}
+
+CaptureService::~CaptureService()
+{
+    stop();
+}
+
+qint64 CaptureService::now()
+{
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+void CaptureService::start(const CaptureConfig& config)
+{
+    stop();
+    m_config = config;
+    if (!m_config.enabled) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ring.assign(static_cast<size_t>(qMax(2, m_config.ringSize)), Frame{});
+        m_sequence = 0;
+    }
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&CaptureService::run, this);
+}
+
+void CaptureService::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running.store(false, std::memory_order_release);
+    }
+    m_stopCv.notify_all();
+    m_frameCv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    // frameAfter 的等待方看到停止后立即返回；等它们离开，之后析构时不会再有线程访问本对象
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_waitersCv.wait(lock, [this] { return m_waiters == 0; });
+}
+
+CaptureService::Frame CaptureService::latest() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_sequence == 0 || m_ring.empty()) return Frame{};
+    return m_ring[m_sequence % m_ring.size()];
+}
+
+CaptureService::Frame CaptureService::frameAfter(qint64 notBefore, int timeoutMs) const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ++m_waiters;
+    m_frameCv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] {
+        return !m_running.load(std::memory_order_acquire) ||
+               (m_sequence > 0 && m_ring[m_sequence % m_ring.size()].capturedAt >= notBefore);
+    });
+    Frame frame;
+    if (m_sequence > 0 && !m_ring.empty()) frame = m_ring[m_sequence % m_ring.size()];
+    if (--m_waiters == 0) m_waitersCv.notify_all();
+    return frame;
+}
+
+bool CaptureService::sleepFor(int ms)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return !m_stopCv.wait_for(lock, std::chrono::milliseconds(ms), [this] {
+        return !m_running.load(std::memory_order_acquire);
+    });
+}
+
+bool CaptureService::openDevice(cv::VideoCapture& capture, bool& isFile) const
+{
+    bool isIndex = false;
+    const int index = m_config.device.toInt(&isIndex);
+    const int api = backendApi(m_config.backend);
+
+    try {
+        if (isIndex) {
+            isFile = false;
+            if (api == cv::CAP_ANY) {
+#ifdef Q_OS_WIN
+                capture.open(index, cv::CAP_DSHOW);  // 与 VideoManager 一致，优先 DirectShow
+#endif
+                if (!capture.isOpened()) capture.open(index, cv::CAP_ANY);
+            } else {
+                capture.open(index, api);
+            }
+        } else {
+            // /dev/videoN 是字符设备而非普通文件，按实时相机处理
+            isFile = QFileInfo(m_config.device).isFile();
+            capture.open(m_config.device.toLocal8Bit().constData(), api);
+        }
+    } catch (const cv::Exception& e) {
+        spdlog::warn("[Capture] 打开设备 {} 异常: {}", m_config.device, e.what());
+        return false;
+    }
+    if (!capture.isOpened()) return false;
+
+    if (m_config.width > 0 && m_config.height > 0) {
+        capture.set(cv::CAP_PROP_FRAME_WIDTH, m_config.width);
+        capture.set(cv::CAP_PROP_FRAME_HEIGHT, m_config.height);
+    }
+    if (m_config.fps > 0) capture.set(cv::CAP_PROP_FPS, m_config.fps);
+    // 驱动队列只留一帧，read() 拿到的就是最新曝光的画面
+    if (!isFile) capture.set(cv::CAP_PROP_BUFFERSIZE, 1);
+
+    spdlog::info("[Capture] 已打开 {} ({}x{} @ {:.1f}fps, backend={})", m_config.device,
+                 static_cast<int>(capture.get(cv::CAP_PROP_FRAME_WIDTH)),
+                 static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT)),
+                 capture.get(cv::CAP_PROP_FPS), capture.getBackendName());
+    return true;
+}
+
+void CaptureService::run()
+{
+    ThreadTag::setCurrent("capture");
+
+    static MetricCounter& framesTotal = MetricsRegistry::instance().counter(
+        "edgevision_capture_frames_total", "常驻采集服务采集的帧数");
+    static MetricCounter& reopenTotal = MetricsRegistry::instance().counter(
+        "edgevision_capture_reopen_total", "采集设备打开失败或断开后的重试次数");
+    static MetricGauge& fpsGauge = MetricsRegistry::instance().gauge(
+        "edgevision_capture_fps", "常驻采集服务实际帧率");
+
+    cv::VideoCapture capture;
+    cv::Mat raw;    // 翻转前的原始帧，只在本线程使用
+
+    while (m_running.load(std::memory_order_acquire)) {
+        bool isFile = false;
+        if (!openDevice(capture, isFile)) {
+            LOG_THROTTLED(spdlog::level::warn, 30000, "[Capture] 无法打开设备 {}，{} ms 后重试",
+                          m_config.device, m_config.reopenIntervalMs);
+            reopenTotal.inc();
+            if (!sleepFor(m_config.reopenIntervalMs)) break;
+            continue;
+        }
+
+        // 视频文件作为虚拟相机：按文件帧率节拍读取并循环
+        const double sourceFps = capture.get(cv::CAP_PROP_FPS);
+        const auto filePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / (sourceFps > 0 ? sourceFps : 30.0)));
+        auto nextFrameAt = std::chrono::steady_clock::now();
+
+        int warmup = isFile ? 0 : m_config.warmupFrames;
+        bool rewound = false;
+        int fpsFrames = 0;
+        auto fpsWindowStart = std::chrono::steady_clock::now();
+
+        while (m_running.load(std::memory_order_acquire)) {
+            // 复用即将被覆盖的槽位缓冲（仅当消费者已不再持有）
+            cv::Mat buffer;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Frame& slot = m_ring[(m_sequence + 1) % m_ring.size()];
+                if (slot.image.u && slot.image.u->refcount == 1) {
+                    buffer = std::move(slot.image);
+                }
+            }
+
+            bool ok = false;
+            try {
+                if (m_config.flipHorizontal) {
+                    ok = capture.read(raw);
+                    if (ok) cv::flip(raw, buffer, 1);
+                } else {
+                    ok = capture.read(buffer);
+                }
+            } catch (const cv::Exception& e) {
+                spdlog::warn("[Capture] 读取帧异常: {}", e.what());
+                ok = false;
+            }
+
+            if (!ok || buffer.empty()) {
+                // 文件读到末尾时回到开头；回卷后仍读不到帧视为源失效
+                if (isFile && !rewound && capture.set(cv::CAP_PROP_POS_FRAMES, 0)) {
+                    rewound = true;
+                    continue;
+                }
+                break;
+            }
+            rewound = false;
+
+            if (warmup > 0) {
+                --warmup;
+                continue;
+            }
+
+            bool firstFrame = false;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_sequence;
+                Frame& slot = m_ring[m_sequence % m_ring.size()];
+                slot.image = std::move(buffer);
+                slot.sequence = m_sequence;
+                slot.capturedAt = now();
+                firstFrame = !m_ready.exchange(true, std::memory_order_acq_rel);
+            }
+            m_frameCv.notify_all();
+            framesTotal.inc();
+            if (firstFrame) {
+                emit deviceStateChanged(true, m_config.device);
+            }
+
+            ++fpsFrames;
+            const auto current = std::chrono::steady_clock::now();
+            const double windowSec = std::chrono::duration<double>(current - fpsWindowStart).count();
+            if (windowSec >= 1.0) {
+                m_fps.store(fpsFrames / windowSec, std::memory_order_relaxed);
+                fpsGauge.set(fpsFrames / windowSec);
+                fpsFrames = 0;
+                fpsWindowStart = current;
+            }
+
+            if (isFile) {
+                nextFrameAt += filePeriod;
+                if (nextFrameAt < current) nextFrameAt = current;  // 落后时不追帧
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_stopCv.wait_until(lock, nextFrameAt, [this] {
+                        return !m_running.load(std::memory_order_acquire);
+                    })) {
+                    break;
+                }
+            }
+        }
+
+        capture.release();
+        m_fps.store(0.0, std::memory_order_relaxed);
+        fpsGauge.set(0.0);
+        if (m_ready.exchange(false, std::memory_order_acq_rel)) {
+            emit deviceStateChanged(false, m_config.device);
+        }
+
+        if (m_running.load(std::memory_order_acquire)) {
+            spdlog::warn("[Capture] 设备 {} 已断开，{} ms 后重新打开", m_config.device, m_config.reopenIntervalMs);
+            reopenTotal.inc();
+            if (!sleepFor(m_config.reopenIntervalMs)) break;
+        }
+    }
+}
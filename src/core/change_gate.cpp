@@ -0,0 +1,101 @@
+﻿#include "core/change_gate.h"
+#include "core/metrics.h"
+#include "logger.h"
+#include <opencv2/imgproc.hpp>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+
+bool ChangeGate::shouldProcess(const QString& key, const cv::Mat& frame, const ChangeGateConfig& cfg,
+                               size_t configFingerprint)
+{
+    if (!cfg.enabled || frame.empty()) {
+        return true;
+    }
+
+    const cv::Mat thumb = thumbnail(frame, cfg.gridSize);
+
+    QMutexLocker locker(&m_mutex);
+    State& state = m_states[key];
+
+    bool changed = state.reference.empty() ||
+                   state.reference.size() != thumb.size() ||
+                   state.configFingerprint != configFingerprint ||
+                   (cfg.maxSkipFrames > 0 && state.skippedInRow >= cfg.maxSkipFrames);
+
+    if (!changed) {
+        cv::Mat diff;
+        cv::absdiff(thumb, state.reference, diff);
+        const int changedCells = cv::countNonZero(diff > cfg.pixelThreshold);
+        const int required = std::max(1, static_cast<int>(std::ceil(cfg.minChangedRatio * diff.total())));
+        changed = changedCells >= required;
+    }
+
+    if (changed) {
+        state.reference = thumb;
+        state.configFingerprint = configFingerprint;
+        state.skippedInRow = 0;
+    } else {
+        ++state.skippedInRow;
+    }
+    locker.unlock();
+
+    count(changed);
+    return changed;
+}
+
+void ChangeGate::invalidate(const QString& key)
+{
+    QMutexLocker locker(&m_mutex);
+    m_states.remove(key);
+}
+
+void ChangeGate::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_states.clear();
+}
+
+cv::Mat ChangeGate::thumbnail(const cv::Mat& frame, int gridSize)
+{
+    cv::Mat gray;
+    if (frame.channels() == 3) {
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    } else if (frame.channels() == 4) {
+        cv::cvtColor(frame, gray, cv::COLOR_BGRA2GRAY);
+    } else {
+        gray = frame;
+    }
+
+    // 长边缩到 gridSize 格，INTER_AREA 即各块均值，对传感器噪声天然平滑
+    const int grid = std::max(4, gridSize);
+    const double scale = static_cast<double>(grid) / std::max(gray.cols, gray.rows);
+    const cv::Size size(std::max(1, static_cast<int>(std::lround(gray.cols * scale))),
+                        std::max(1, static_cast<int>(std::lround(gray.rows * scale))));
+    cv::Mat thumb;
+    cv::resize(gray, thumb, size, 0, 0, cv::INTER_AREA);
+    return thumb;
+}
+
+void ChangeGate::count(bool processed)
+{
+    static MetricCounter& processedFrames = MetricsRegistry::instance().counter(
+        "edgevision_change_gate_frames_total", "变化门控判定的实时帧数", {{"decision", "processed"}});
+    static MetricCounter& skippedFrames = MetricsRegistry::instance().counter(
+        "edgevision_change_gate_frames_total", "变化门控判定的实时帧数", {{"decision", "skipped"}});
+
+    if (processed) {
+        processedFrames.inc();
+        ++m_processed;
+    } else {
+        skippedFrames.inc();
+        ++m_skipped;
+    }
+
+    const quint64 total = m_processed.load() + m_skipped.load();
+    if (total % 300 == 0) {
+        spdlog::info("[ChangeGate] 已判定 {} 帧，执行 {}，跳过 {} ({:.1f}%)",
+                     total, m_processed.load(), m_skipped.load(),
+                     100.0 * m_skipped.load() / total);
+    }
+}
@@ -0,0 +1,196 @@
+#include "core/log_ring_sink.h"
+#include "utils/thread_tag.h"
+
+#include <chrono>
+
+#include "spdlog/details/log_msg.h"
+#include "spdlog/pattern_formatter.h"
+
+namespace {
+
+constexpr auto kIdleWait = std::chrono::milliseconds(50);       ///< 空闲时的最长休眠（防止丢失唤醒）
+constexpr auto kFlushTimeout = std::chrono::milliseconds(1000);
+constexpr auto kDropReportInterval = std::chrono::seconds(1);
+
+size_t roundUpPow2(size_t v)
+{
+    size_t p = 2;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+} // namespace
+
+LogRingSink::LogRingSink(std::vector<spdlog::sink_ptr> sinks, size_t capacity)
+    : m_sinks(std::move(sinks))
+{
+    const size_t size = roundUpPow2(capacity);
+    m_slots = std::make_unique<Slot[]>(size);
+    m_mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        m_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    m_running.store(true, std::memory_order_release);
+    m_worker = std::thread([this]() { run(); });
+}
+
+LogRingSink::~LogRingSink()
+{
+    stop();
+}
+
+void LogRingSink::log(const spdlog::details::log_msg& msg)
+{
+    if (!m_running.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(m_directMutex);
+        writeDownstream(msg);
+        return;
+    }
+
+    if (!tryPush(msg)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (m_sleeping.load(std::memory_order_acquire)) {
+        m_wake.notify_one();
+    }
+}
+
+bool LogRingSink::tryPush(const spdlog::details::log_msg& msg)
+{
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &m_slots[pos & m_mask];
+        const size_t seq = slot->seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false;  // 队列已满
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->time = msg.time;
+    slot->level = msg.level;
+    slot->threadId = msg.thread_id;
+    slot->loggerName.assign(msg.logger_name.data(), msg.logger_name.size());
+    slot->payload.assign(msg.payload.data(), msg.payload.size());
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogRingSink::drainOnce()
+{
+    bool any = false;
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = m_slots[pos & m_mask];
+        if (slot.seq.load(std::memory_order_acquire) != pos + 1) break;
+
+        spdlog::details::log_msg msg(slot.time, spdlog::source_loc{}, slot.loggerName, slot.level, slot.payload);
+        msg.thread_id = slot.threadId;
+        writeDownstream(msg);
+
+        slot.seq.store(pos + m_mask + 1, std::memory_order_release);
+        m_dequeuePos.store(++pos, std::memory_order_release);
+        any = true;
+    }
+    return any;
+}
+
+void LogRingSink::writeDownstream(const spdlog::details::log_msg& msg)
+{
+    for (auto& sink : m_sinks) {
+        if (sink->should_log(msg.level)) {
+            sink->log(msg);
+        }
+    }
+}
+
+void LogRingSink::reportDropped()
+{
+    const uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped == m_reportedDropped) return;
+
+    const std::string text = "[Log] 日志队列已满，丢弃 " + std::to_string(dropped - m_reportedDropped) + " 条日志";
+    m_reportedDropped = dropped;
+    spdlog::details::log_msg msg(spdlog::source_loc{}, "app", spdlog::level::warn, text);
+    writeDownstream(msg);
+}
+
+void LogRingSink::run()
+{
+    ThreadTag::setCurrent("log");
+    auto lastReport = std::chrono::steady_clock::now();
+    while (m_running.load(std::memory_order_acquire)) {
+        if (!drainOnce()) {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_sleeping.store(true, std::memory_order_release);
+            // 生产者不加锁通知，可能错过唤醒，因此只做有限时长的等待
+            m_wake.wait_for(lock, kIdleWait);
+            m_sleeping.store(false, std::memory_order_release);
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= kDropReportInterval) {
+            reportDropped();
+            lastReport = now;
+        }
+    }
+    drainOnce();
+    reportDropped();
+}
+
+void LogRingSink::flush()
+{
+    if (m_running.load(std::memory_order_acquire)) {
+        const size_t target = m_enqueuePos.load(std::memory_order_acquire);
+        const auto deadline = std::chrono::steady_clock::now() + kFlushTimeout;
+        while (m_dequeuePos.load(std::memory_order_acquire) < target
+               && std::chrono::steady_clock::now() < deadline) {
+            m_wake.notify_one();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    for (auto& sink : m_sinks) {
+        sink->flush();
+    }
+}
+
+void LogRingSink::set_pattern(const std::string& pattern)
+{
+    for (auto& sink : m_sinks) {
+        sink->set_pattern(pattern);
+    }
+}
+
+void LogRingSink::set_formatter(std::unique_ptr<spdlog::formatter> formatter)
+{
+    for (auto& sink : m_sinks) {
+        sink->set_formatter(formatter->clone());
+    }
+}
+
+void LogRingSink::stop()
+{
+    if (!m_running.exchange(false, std::memory_order_acq_rel)) return;
+
+    // 此后新消息同步写出；后台线程退出前写完队列中剩余的消息
+    m_wake.notify_one();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+    {
+        // 收尾：切换瞬间仍可能有生产者写入了队列
+        std::lock_guard<std::mutex> lock(m_directMutex);
+        drainOnce();
+    }
+    for (auto& sink : m_sinks) {
+        sink->flush();
+    }
+}
@@ -11,6 +11,10 @@
 #include <QTimer>
 
 #include "spdlog/sinks/rotating_file_sink.h"
+#include "core/log_ring_sink.h"
+
+#include <algorithm>
+#include <mutex>
 
 // ============================================================
 // Global state (file-scope, not exported)
@@ -43,7 +47,9 @@ static void qtMessageHandler(QtMsgType type, const QMessageLogContext &ctx, cons
 
 // ============================================================
 // Session log buffer sink: stores formatted messages for re-rendering
+// Bounded: oldest entries are evicted (and counted) past kMaxSessionEntries
 // ============================================================
+#include <deque>
 #include <vector>
 
 struct LogEntry {
@@ -51,17 +57,68 @@ struct LogEntry {
     spdlog::level::level_enum level;
 };
 
-static std::vector<LogEntry> s_sessionBuffer;
+static constexpr size_t kMaxSessionEntries = 20000;
+
+class SessionLogBuffer {
+public:
+    void append(QString text, spdlog::level::level_enum level) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.push_back({std::move(text), level});
+        if (m_entries.size() > kMaxSessionEntries) {
+            m_entries.pop_front();
+            ++m_firstIndex;
+        }
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_firstIndex += m_entries.size();
+        m_entries.clear();
+    }
+
+    // Copy entries with absolute index >= from; returns the absolute index of the first copied entry
+    size_t copySince(size_t from, std::vector<LogEntry>& out) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t start = std::max(from, m_firstIndex);
+        for (size_t i = start - m_firstIndex; i < m_entries.size(); ++i) {
+            out.push_back(m_entries[i]);
+        }
+        return start;
+    }
+
+    size_t endIndex() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_firstIndex + m_entries.size();
+    }
+
+    uint64_t evicted() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_firstIndex;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::deque<LogEntry> m_entries;
+    size_t m_firstIndex = 0;    // absolute index of m_entries.front()
+};
+
+static SessionLogBuffer s_sessionBuffer;
+static std::shared_ptr<LogRingSink> s_ringSink;
 
 class SessionBufferSink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+    explicit SessionBufferSink(SessionLogBuffer& buffer) : m_buffer(buffer) {}
+
 protected:
     void sink_it_(const spdlog::details::log_msg &msg) override {
         spdlog::memory_buf_t buf;
         formatter_->format(msg, buf);
-        QString text = QString::fromUtf8(buf.data(), static_cast<int>(buf.size()));
-        s_sessionBuffer.push_back({text, msg.level});
+        m_buffer.append(QString::fromUtf8(buf.data(), static_cast<int>(buf.size())), msg.level);
     }
     void flush_() override {}
+
+private:
+    SessionLogBuffer& m_buffer;
 };
 
 // ============================================================
@@ -82,7 +139,10 @@ void rerenderSessionLogs()
     }
 
     // No new logs and no level change → nothing to do
-    if (s_lastRenderedIndex >= s_sessionBuffer.size() && !levelChanged) return;
+    if (s_lastRenderedIndex >= s_sessionBuffer.endIndex() && !levelChanged) return;
+
+    std::vector<LogEntry> entries;
+    const size_t start = s_sessionBuffer.copySince(s_lastRenderedIndex, entries);
 
     QTextCursor cursor(s_uiTextEdit->textCursor());
     cursor.movePosition(QTextCursor::End);
@@ -99,9 +159,16 @@ void rerenderSessionLogs()
         }
     };
 
+    // Entries evicted before they were rendered
+    if (start > s_lastRenderedIndex && s_lastRenderedIndex > 0) {
+        QTextCharFormat fmt;
+        fmt.setForeground(levelColor(spdlog::level::debug));
+        cursor.setCharFormat(fmt);
+        cursor.insertText(QString("... 省略 %1 条较早的日志 ...\n").arg(start - s_lastRenderedIndex));
+    }
+
     // Incremental: only render new entries
-    for (size_t i = s_lastRenderedIndex; i < s_sessionBuffer.size(); ++i) {
-        const auto& entry = s_sessionBuffer[i];
+    for (const auto& entry : entries) {
         if (entry.level < minLevel) continue;
 
         QTextCharFormat fmt;
@@ -109,17 +176,18 @@ void rerenderSessionLogs()
         cursor.setCharFormat(fmt);
         cursor.insertText(entry.formatted + "\n");
     }
-    s_lastRenderedIndex = s_sessionBuffer.size();
+    s_lastRenderedIndex = start + entries.size();
 }
 
 // ============================================================
 // Public API
 // ============================================================
 
-void setupLogging(QTextEdit* uiTextEdit, const QString& logDir)
+void setupLogging(QTextEdit* uiTextEdit, const QString& logDir, LogMode mode)
 {
     s_uiTextEdit = uiTextEdit;
     s_sessionBuffer.clear();
+    s_lastRenderedIndex = s_sessionBuffer.endIndex();
 
     // 1) Create rotating file sink: 5MB max, 3 rotated files
     QDir dir(logDir);
@@ -132,11 +200,20 @@ void setupLogging(QTextEdit* uiTextEdit, const QString& logDir)
         s_logFilePath.toStdString(), 5 * 1024 * 1024, 3);
 
     // 2) Create session buffer sink for colored rendering
-    auto sessionSink = std::make_shared<SessionBufferSink>();
+    auto sessionSink = std::make_shared<SessionBufferSink>(s_sessionBuffer);
     sessionSink->set_pattern("%Y-%m-%d %H:%M:%S [%l] %v");
 
     // 3) Create multi-sink logger (session buffer + file only, no qt_color_sink)
+    //    Async mode puts both behind the lock-free ring
     std::vector<spdlog::sink_ptr> sinks = {sessionSink, s_fileSink};
+    if (s_ringSink) {
+        s_ringSink->stop();
+        s_ringSink.reset();
+    }
+    if (mode == LogMode::Async) {
+        s_ringSink = std::make_shared<LogRingSink>(sinks);
+        sinks = {s_ringSink};
+    }
     s_logger = std::make_shared<spdlog::logger>("app", sinks.begin(), sinks.end());
     s_logger->set_pattern("%Y-%m-%d %H:%M:%S [%l] %v");
     s_logger->set_level(spdlog::level::debug);
@@ -147,7 +224,8 @@ void setupLogging(QTextEdit* uiTextEdit, const QString& logDir)
     // 4) Install Qt message handler to redirect qDebug etc.
     qInstallMessageHandler(qtMessageHandler);
 
-    // 5) Timer to re-render logs with colors every 100ms
+    // 5) Keep the widget bounded as well; timer re-renders logs with colors every 100ms
+    uiTextEdit->document()->setMaximumBlockCount(static_cast<int>(kMaxSessionEntries));
     auto* timer = new QTimer(uiTextEdit);
     QObject::connect(timer, &QTimer::timeout, uiTextEdit, []() {
         rerenderSessionLogs();
@@ -155,6 +233,69 @@ void setupLogging(QTextEdit* uiTextEdit, const QString& logDir)
     timer->start(100);
 }
 
+void shutdownLogging()
+{
+    if (s_ringSink) {
+        s_ringSink->stop();
+    }
+    flushLogs();
+}
+
+LogDropStats logDropStats()
+{
+    LogDropStats stats;
+    stats.queueDropped = s_ringSink ? s_ringSink->droppedCount() : 0;
+    stats.sessionEvicted = s_sessionBuffer.evicted();
+    return stats;
+}
+
+void benchmarkLogging(int iterations)
+{
+    if (iterations <= 0) return;
+
+    const QString dir = QDir::temp().filePath("edgevision_log_bench");
+    QDir().mkpath(dir);
+
+    // Per-frame hot-path volume before this change: ORT detect ~20 info lines,
+    // shape filter ~6, barcode/ZXing ~3
+    constexpr int kLinesPerFrame = 29;
+
+    auto measure = [&](const char* name, bool async) {
+        SessionLogBuffer buffer;
+        auto session = std::make_shared<SessionBufferSink>(buffer);
+        auto file = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+            QDir(dir).filePath(QString("%1.log").arg(name)).toStdString(), 5 * 1024 * 1024, 1);
+        std::vector<spdlog::sink_ptr> sinks = {session, file};
+        std::shared_ptr<LogRingSink> ring;
+        if (async) {
+            ring = std::make_shared<LogRingSink>(sinks);
+            sinks = {ring};
+        }
+        spdlog::logger logger(name, sinks.begin(), sinks.end());
+        logger.set_pattern("%Y-%m-%d %H:%M:%S [%l] %v");
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            logger.info("OrtInference: candidate[{}] class={}({}) conf={:.4f} box=({},{},{},{})",
+                        i % 5, "person", 0, 0.87f, 120, 64, 200, 380);
+        }
+        const double callerMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        const uint64_t dropped = ring ? ring->droppedCount() : 0;
+        if (ring) ring->stop();
+
+        const double perCallUs = callerMs * 1000.0 / iterations;
+        spdlog::info("[BENCH] logging({}): {:.2f} us/call, {:.1f} us/frame ({} lines), dropped={}",
+                     name, perCallUs, perCallUs * kLinesPerFrame, kLinesPerFrame, dropped);
+    };
+
+    measure("sync", false);
+    measure("async", true);
+    spdlog::info("[BENCH] logging(stripped STEP_LOG_DEBUG): 0 us/call (compiled out)");
+
+    QDir(dir).removeRecursively();
+}
+
 void setUILogLevel(spdlog::level::level_enum level)
 {
     s_uiLevel = level;
@@ -0,0 +1,257 @@
+﻿#include "core/mat_arena.h"
+#include "core/metrics.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+struct ArenaMetrics {
+    MetricCounter& hits = MetricsRegistry::instance().counter(
+        "edgevision_mat_arena_hits_total", "Pipeline 图像缓冲从线程池复用的次数");
+    MetricCounter& misses = MetricsRegistry::instance().counter(
+        "edgevision_mat_arena_misses_total", "Pipeline 图像缓冲在池中未命中、向堆新分配的次数");
+    MetricGauge& bytesHeld = MetricsRegistry::instance().gauge(
+        "edgevision_mat_arena_bytes", "所有缓冲池当前保留的空闲字节数");
+};
+
+ArenaMetrics& arenaMetrics()
+{
+    static ArenaMetrics metrics;
+    return metrics;
+}
+
+/// 所有池的登记表；池与登记表均不析构，进程退出阶段释放的 Mat 仍可安全归还
+struct ArenaRegistry {
+    std::mutex mutex;
+    std::vector<MatArena*> all;
+    std::vector<MatArena*> idle;     // 所属线程已退出，等待新线程接手
+    std::atomic<int64_t> bytesHeld{0};
+    std::atomic<uint64_t> tick{0};   // 全局使用时间戳，跨池比较新旧
+};
+
+ArenaRegistry& registry()
+{
+    static ArenaRegistry* r = new ArenaRegistry();
+    return *r;
+}
+
+/// 线程私有状态：退出时把池交回登记表，保留其中的缓冲
+struct ThreadArena {
+    MatArena* arena = nullptr;
+    int depth = 0;
+
+    ~ThreadArena()
+    {
+        if (!arena) return;
+        ArenaRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.idle.push_back(arena);
+    }
+};
+
+thread_local ThreadArena t_arena;
+
+void adjustHeld(int64_t delta)
+{
+    registry().bytesHeld.fetch_add(delta, std::memory_order_relaxed);
+    arenaMetrics().bytesHeld.add(static_cast<double>(delta));
+}
+
+} // namespace
+
+/**
+ * 池化分配器：仅对 Scope 内的大块分配生效，其余委托给 OpenCV 标准分配器
+ * （委托分配的 UMatData 归标准分配器所有，释放时不会回到这里）
+ */
+class MatArenaAllocator : public cv::MatAllocator
+{
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data0, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override
+    {
+        MatArena* arena = data0 ? nullptr : MatArena::current();
+        if (!arena) {
+            return stdAllocator()->allocate(dims, sizes, type, data0, step, flags, usageFlags);
+        }
+
+        size_t total = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; --i) {
+            if (step) step[i] = total;
+            total *= static_cast<size_t>(sizes[i]);
+        }
+        if (total < MatArena::kMinPooledBytes) {
+            return stdAllocator()->allocate(dims, sizes, type, data0, step, flags, usageFlags);
+        }
+
+        uchar* data = arena->take(total);
+        if (data) {
+            arenaMetrics().hits.inc();
+        } else {
+            arenaMetrics().misses.inc();
+            data = static_cast<uchar*>(cv::fastMalloc(total));
+        }
+
+        auto* u = new cv::UMatData(this);
+        u->data = u->origdata = data;
+        u->size = total;
+        u->userdata = arena;
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag, cv::UMatUsageFlags) const override
+    {
+        return u != nullptr;
+    }
+
+    void deallocate(cv::UMatData* u) const override
+    {
+        if (!u) return;
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        static_cast<MatArena*>(u->userdata)->give(u->size, u->origdata);
+        u->origdata = nullptr;
+        delete u;
+    }
+
+private:
+    static const cv::MatAllocator* stdAllocator() { return cv::Mat::getStdAllocator(); }
+};
+
+// ========== Scope ==========
+
+MatArena::Scope::Scope()
+{
+    if (!t_arena.arena) {
+        ArenaRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.idle.empty()) {
+            t_arena.arena = r.idle.back();
+            r.idle.pop_back();
+        } else {
+            t_arena.arena = new MatArena();
+            r.all.push_back(t_arena.arena);
+        }
+    }
+    ++t_arena.depth;
+}
+
+MatArena::Scope::~Scope()
+{
+    --t_arena.depth;
+}
+
+// ========== MatArena ==========
+
+MatArena::MatArena()
+{
+    m_free.reserve(64);
+}
+
+MatArena* MatArena::current()
+{
+    return t_arena.depth > 0 ? t_arena.arena : nullptr;
+}
+
+void MatArena::install()
+{
+    static std::once_flag once;
+    std::call_once(once, [] {
+        static MatArenaAllocator* allocator = new MatArenaAllocator();
+        cv::Mat::setDefaultAllocator(allocator);
+        arenaMetrics();
+        spdlog::info("[MatArena] Pipeline 图像缓冲池已启用 (保留上限 {} MB)", kMaxBytes / (1024 * 1024));
+    });
+}
+
+void MatArena::trimAll()
+{
+    ArenaRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (MatArena* arena : r.all) {
+        arena->trim();
+    }
+}
+
+uchar* MatArena::take(size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int best = -1;
+    for (int i = 0; i < static_cast<int>(m_free.size()); ++i) {
+        if (m_free[i].size == size && (best < 0 || m_free[i].lastUse > m_free[best].lastUse)) {
+            best = i;
+        }
+    }
+    if (best < 0) return nullptr;
+
+    uchar* data = m_free[best].data;
+    m_free[best] = m_free.back();
+    m_free.pop_back();
+    adjustHeld(-static_cast<int64_t>(size));
+    return data;
+}
+
+void MatArena::give(size_t size, uchar* data)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back({size, data, registry().tick.fetch_add(1, std::memory_order_relaxed) + 1});
+        adjustHeld(static_cast<int64_t>(size));
+    }
+    if (registry().bytesHeld.load(std::memory_order_relaxed) > static_cast<int64_t>(kMaxBytes)) {
+        enforceBudget();
+    }
+}
+
+void MatArena::trim()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Block& block : m_free) {
+        adjustHeld(-static_cast<int64_t>(block.size));
+        cv::fastFree(block.data);
+    }
+    m_free.clear();
+}
+
+uint64_t MatArena::oldestUse()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t oldest = UINT64_MAX;
+    for (const Block& block : m_free) {
+        oldest = std::min(oldest, block.lastUse);
+    }
+    return oldest;
+}
+
+void MatArena::evictOldest()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_free.empty()) return;
+    auto oldest = std::min_element(m_free.begin(), m_free.end(),
+                                   [](const Block& a, const Block& b) { return a.lastUse < b.lastUse; });
+    adjustHeld(-static_cast<int64_t>(oldest->size));
+    cv::fastFree(oldest->data);
+    *oldest = m_free.back();
+    m_free.pop_back();
+}
+
+void MatArena::enforceBudget()
+{
+    // 锁顺序：登记表 -> 单个池（give 释放池锁后才进入这里）
+    ArenaRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    while (r.bytesHeld.load(std::memory_order_relaxed) > static_cast<int64_t>(kMaxBytes)) {
+        MatArena* victim = nullptr;
+        uint64_t oldest = UINT64_MAX;
+        for (MatArena* arena : r.all) {
+            const uint64_t use = arena->oldestUse();
+            if (use < oldest) {
+                oldest = use;
+                victim = arena;
+            }
+        }
+        if (!victim) break;
+        victim->evictOldest();
+    }
+}
@@ -0,0 +1,276 @@
+﻿#include "core/metrics.h"
+
+#include <algorithm>
+
+#include <QJsonArray>
+
+// ========== MetricGauge / MetricHistogram ==========
+
+void MetricGauge::add(double delta)
+{
+    double current = m_value.load(std::memory_order_relaxed);
+    while (!m_value.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+}
+
+MetricHistogram::MetricHistogram(std::vector<double> bounds)
+    : m_bounds(std::move(bounds))
+    , m_buckets(std::make_unique<std::atomic<uint64_t>[]>(m_bounds.size() + 1))
+{
+    std::sort(m_bounds.begin(), m_bounds.end());
+    for (size_t i = 0; i <= m_bounds.size(); ++i) {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricHistogram::observe(double v)
+{
+    // 桶数很少（十几个），线性查找比二分更快
+    size_t idx = 0;
+    while (idx < m_bounds.size() && v > m_bounds[idx]) {
+        ++idx;
+    }
+    m_buckets[idx].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+
+    double current = m_sum.load(std::memory_order_relaxed);
+    while (!m_sum.compare_exchange_weak(current, current + v, std::memory_order_relaxed)) {
+    }
+}
+
+std::vector<uint64_t> MetricHistogram::bucketCounts() const
+{
+    std::vector<uint64_t> counts(m_bounds.size() + 1);
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+double MetricHistogram::quantile(double q) const
+{
+    const std::vector<uint64_t> counts = bucketCounts();
+    uint64_t total = 0;
+    for (uint64_t c : counts) total += c;
+    if (total == 0 || m_bounds.empty()) return 0.0;
+
+    const double rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(total);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] == 0) continue;
+        if (static_cast<double>(cumulative + counts[i]) >= rank) {
+            if (i == m_bounds.size()) return m_bounds.back();   // +Inf 桶：只能给出下界
+            const double lower = (i == 0) ? 0.0 : m_bounds[i - 1];
+            const double fraction = (rank - static_cast<double>(cumulative)) / static_cast<double>(counts[i]);
+            return lower + (m_bounds[i] - lower) * fraction;
+        }
+        cumulative += counts[i];
+    }
+    return m_bounds.back();
+}
+
+// ========== MetricsRegistry ==========
+
+namespace {
+
+QByteArray formatValue(double v)
+{
+    return QByteArray::number(v, 'g', 12);
+}
+
+QByteArray escapeLabelValue(const QString& value)
+{
+    QByteArray out = value.toUtf8();
+    out.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return out;
+}
+
+/// 渲染 {k="v",...}；extra 用于直方图的 le 标签
+QByteArray renderLabels(const MetricLabels& labels, const QByteArray& extra = {})
+{
+    if (labels.isEmpty() && extra.isEmpty()) return {};
+
+    QByteArray out = "{";
+    for (int i = 0; i < labels.size(); ++i) {
+        if (i > 0) out += ',';
+        out += labels[i].first.toUtf8() + "=\"" + escapeLabelValue(labels[i].second) + '"';
+    }
+    if (!extra.isEmpty()) {
+        if (!labels.isEmpty()) out += ',';
+        out += extra;
+    }
+    out += '}';
+    return out;
+}
+
+} // namespace
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::MetricsRegistry()
+{
+    m_clock.start();
+}
+
+const std::vector<double>& MetricsRegistry::latencyBucketsMs()
+{
+    static const std::vector<double> buckets = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+    return buckets;
+}
+
+MetricsRegistry::Series& MetricsRegistry::findOrCreate(const QString& name, const QString& help,
+                                                       Type type, const MetricLabels& labels)
+{
+    Family* family = nullptr;
+    for (auto& f : m_families) {
+        if (f->name == name) {
+            family = f.get();
+            break;
+        }
+    }
+    if (!family) {
+        m_families.push_back(std::make_unique<Family>());
+        family = m_families.back().get();
+        family->name = name;
+        family->help = help;
+        family->type = type;
+    }
+    Q_ASSERT_X(family->type == type, "MetricsRegistry", "metric registered with different types");
+
+    for (auto& s : family->series) {
+        if (s->labels == labels) return *s;
+    }
+    family->series.push_back(std::make_unique<Series>());
+    family->series.back()->labels = labels;
+    return *family->series.back();
+}
+
+MetricCounter& MetricsRegistry::counter(const QString& name, const QString& help, const MetricLabels& labels)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Series& s = findOrCreate(name, help, Type::Counter, labels);
+    if (!s.counter) s.counter = std::make_unique<MetricCounter>();
+    return *s.counter;
+}
+
+MetricGauge& MetricsRegistry::gauge(const QString& name, const QString& help, const MetricLabels& labels)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Series& s = findOrCreate(name, help, Type::Gauge, labels);
+    if (!s.gauge) s.gauge = std::make_unique<MetricGauge>();
+    return *s.gauge;
+}
+
+MetricHistogram& MetricsRegistry::histogram(const QString& name, const QString& help,
+                                            const MetricLabels& labels, const std::vector<double>& bounds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Series& s = findOrCreate(name, help, Type::Histogram, labels);
+    if (!s.histogram) s.histogram = std::make_unique<MetricHistogram>(bounds);
+    return *s.histogram;
+}
+
+void MetricsRegistry::trackRate(const MetricCounter& source, MetricGauge& target, int windowSec)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& r : m_rates) {
+        if (r.source == &source && r.target == &target) return;
+    }
+    m_rates.push_back({&source, &target, std::max(1, windowSec) * 1000LL, {}});
+}
+
+void MetricsRegistry::sampleRates()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const qint64 now = m_clock.elapsed();
+    for (auto& r : m_rates) {
+        r.samples.emplace_back(now, r.source->value());
+        while (r.samples.size() > 2 && now - r.samples[1].first >= r.windowMs) {
+            r.samples.pop_front();
+        }
+        const auto& [t0, v0] = r.samples.front();
+        const qint64 dt = now - t0;
+        r.target->set(dt > 0 ? static_cast<double>(r.samples.back().second - v0) * 1000.0 / dt : 0.0);
+    }
+}
+
+QByteArray MetricsRegistry::renderPrometheus() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    QByteArray out;
+    out.reserve(8192);
+    for (const auto& family : m_families) {
+        const QByteArray name = family->name.toUtf8();
+        const char* typeName = family->type == Type::Counter ? "counter"
+                             : family->type == Type::Gauge   ? "gauge"
+                                                             : "histogram";
+        out += "# HELP " + name + ' ' + family->help.toUtf8().replace('\n', "\\n") + '\n';
+        out += "# TYPE " + name + ' ' + typeName + '\n';
+
+        for (const auto& s : family->series) {
+            if (s->counter) {
+                out += name + renderLabels(s->labels) + ' ' + QByteArray::number(s->counter->value()) + '\n';
+            } else if (s->gauge) {
+                out += name + renderLabels(s->labels) + ' ' + formatValue(s->gauge->value()) + '\n';
+            } else if (s->histogram) {
+                const auto& bounds = s->histogram->bounds();
+                const std::vector<uint64_t> counts = s->histogram->bucketCounts();
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i < counts.size(); ++i) {
+                    cumulative += counts[i];
+                    const QByteArray le = i < bounds.size() ? formatValue(bounds[i]) : QByteArray("+Inf");
+                    out += name + "_bucket" + renderLabels(s->labels, "le=\"" + le + '"')
+                         + ' ' + QByteArray::number(cumulative) + '\n';
+                }
+                out += name + "_sum" + renderLabels(s->labels) + ' ' + formatValue(s->histogram->sum()) + '\n';
+                // 与桶计数取自同一轮读取，避免 _count 与 +Inf 桶不一致
+                out += name + "_count" + renderLabels(s->labels) + ' ' + QByteArray::number(cumulative) + '\n';
+            }
+        }
+    }
+    return out;
+}
+
+QJsonObject MetricsRegistry::toJson() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    QJsonArray metrics;
+    for (const auto& family : m_families) {
+        for (const auto& s : family->series) {
+            QJsonObject item;
+            item["name"] = family->name;
+            if (!s->labels.isEmpty()) {
+                QJsonObject labels;
+                for (const auto& [key, value] : s->labels) labels[key] = value;
+                item["labels"] = labels;
+            }
+            if (s->counter) {
+                item["type"] = "counter";
+                item["value"] = static_cast<qint64>(s->counter->value());
+            } else if (s->gauge) {
+                item["type"] = "gauge";
+                item["value"] = s->gauge->value();
+            } else if (s->histogram) {
+                const uint64_t count = s->histogram->count();
+                item["type"] = "histogram";
+                item["count"] = static_cast<qint64>(count);
+                item["sum"] = s->histogram->sum();
+                item["avg"] = count > 0 ? s->histogram->sum() / count : 0.0;
+                item["p50"] = s->histogram->quantile(0.50);
+                item["p95"] = s->histogram->quantile(0.95);
+                item["p99"] = s->histogram->quantile(0.99);
+            }
+            metrics.append(item);
+        }
+    }
+
+    QJsonObject json;
+    json["metrics"] = metrics;
+    return json;
+}
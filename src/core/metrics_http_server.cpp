@@ -0,0 +1,110 @@
+﻿#include "core/metrics_http_server.h"
+#include "core/metrics.h"
+#include "logger.h"
+
+#include <QJsonDocument>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+namespace {
+
+constexpr int kMaxRequestLineBytes = 4096;
+constexpr int kRequestTimeoutMs = 5000;
+
+void writeResponse(QTcpSocket* socket, const QByteArray& status,
+                   const QByteArray& contentType, const QByteArray& body)
+{
+    QByteArray response = "HTTP/1.0 " + status + "\r\n"
+                          "Content-Type: " + contentType + "\r\n"
+                          "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                          "Connection: close\r\n\r\n";
+    response += body;
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+} // namespace
+
+MetricsHttpServer::MetricsHttpServer(QObject* parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &MetricsHttpServer::onNewConnection);
+}
+
+MetricsHttpServer::~MetricsHttpServer()
+{
+    stop();
+}
+
+bool MetricsHttpServer::start(quint16 port, const QHostAddress& address)
+{
+    if (m_server->isListening()) return true;
+
+    if (!m_server->listen(address, port)) {
+        spdlog::warn(QString("[Metrics] HTTP 端点监听失败 %1:%2 - %3")
+                         .arg(address.toString()).arg(port).arg(m_server->errorString()));
+        return false;
+    }
+    spdlog::info(QString("[Metrics] HTTP 端点已启动 http://%1:%2/metrics")
+                     .arg(address.toString()).arg(m_server->serverPort()));
+    return true;
+}
+
+void MetricsHttpServer::stop()
+{
+    if (m_server->isListening()) {
+        m_server->close();
+    }
+}
+
+bool MetricsHttpServer::isListening() const
+{
+    return m_server->isListening();
+}
+
+quint16 MetricsHttpServer::port() const
+{
+    return m_server->serverPort();
+}
+
+void MetricsHttpServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { handleRequest(socket); });
+        // 客户端迟迟不发请求时主动断开，避免连接堆积
+        QTimer::singleShot(kRequestTimeoutMs, socket, [socket]() { socket->abort(); });
+    }
+}
+
+void MetricsHttpServer::handleRequest(QTcpSocket* socket)
+{
+    if (!socket->canReadLine()) {
+        if (socket->bytesAvailable() > kMaxRequestLineBytes) {
+            writeResponse(socket, "414 URI Too Long", "text/plain", "request line too long\n");
+        }
+        return;
+    }
+    // 只处理一次请求；剩余请求头直接丢弃
+    disconnect(socket, &QTcpSocket::readyRead, this, nullptr);
+
+    const QList<QByteArray> parts = socket->readLine(kMaxRequestLineBytes).trimmed().split(' ');
+    socket->readAll();
+    if (parts.size() < 2 || parts[0] != "GET") {
+        writeResponse(socket, "405 Method Not Allowed", "text/plain", "only GET is supported\n");
+        return;
+    }
+
+    const QByteArray path = parts[1].split('?').first();
+    if (path == "/metrics") {
+        writeResponse(socket, "200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                      MetricsRegistry::instance().renderPrometheus());
+    } else if (path == "/metrics.json") {
+        writeResponse(socket, "200 OK", "application/json",
+                      QJsonDocument(MetricsRegistry::instance().toJson()).toJson(QJsonDocument::Compact));
+    } else {
+        writeResponse(socket, "404 Not Found", "text/plain", "try /metrics or /metrics.json\n");
+    }
+}
@@ -1,31 +1,88 @@
 #include "core/mqtt_client.h"
+#include "logger.h"
 #include <QMetaObject>
-#include <QMutexLocker>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+namespace {
+
+constexpr int kConnectTimeoutSec = 10;          ///< 单次连接超时（在 Paho 线程中计时）
+constexpr int kDisconnectTimeoutMs = 2000;      ///< 断开时等待未完成消息的时间
+constexpr int kShutdownWaitMs = 1000;           ///< 析构时最多等待进行中的连接/断开完成的时间
+
+/// 异步操作监听器，回调完成后自行释放（回调在 Paho 线程执行）
+class ActionListener : public mqtt::iaction_listener
+{
+public:
+    using Callback = std::function<void(bool ok, const mqtt::token& tok)>;
+
+    explicit ActionListener(Callback done) : m_done(std::move(done)) {}
+
+    void on_success(const mqtt::token& tok) override { finish(true, tok); }
+    void on_failure(const mqtt::token& tok) override { finish(false, tok); }
+
+private:
+    void finish(bool ok, const mqtt::token& tok)
+    {
+        m_done(ok, tok);
+        delete this;
+    }
+
+    Callback m_done;
+};
+
+} // namespace
 
 MqttClient::MqttClient(const MqttConfig& config, QObject* parent)
     : QObject(parent)
     , m_config(config)
     , m_reconnectTimer(this)
 {
-    // 重连定时器信号槽
+    m_reconnectTimer.setSingleShot(true);
     QObject::connect(&m_reconnectTimer, &QTimer::timeout, this, [this]() {
-        if (!m_connected && m_config.enabled) {
-            m_reconnectCount++;
-            emit reconnectAttempt(m_reconnectCount);
-
-            if (m_config.maxReconnectAttempts > 0 && m_reconnectCount >= m_config.maxReconnectAttempts) {
-                stopReconnect();
-                emit connectionError("达到最大重连次数限制");
-                return;
-            }
-            connect();
-        }
+        if (m_state != State::Backoff) return;
+        setState(State::Disconnected);
+        advance();
     });
 }
 
 MqttClient::~MqttClient()
 {
-    disconnect();
+    // 先使 Paho 线程中的回调失效：清除后它们不再访问本对象
+    {
+        std::lock_guard<std::mutex> lock(m_liveness->mutex);
+        m_liveness->alive = false;
+    }
+    m_wantConnected = false;
+    stopReconnect();
+
+    if (m_client) {
+        try {
+            // 连接/断开请求进行中（Connecting / Disconnecting）：先等它结束再销毁客户端
+            if (m_pendingToken) {
+                m_pendingToken->wait_for(std::chrono::milliseconds(kShutdownWaitMs));
+            }
+            // 退出时给 Broker 一个正常断开的机会，但最多等待 kShutdownWaitMs
+            if (m_client->is_connected()) {
+                m_client->disconnect(kShutdownWaitMs)->wait_for(std::chrono::milliseconds(kShutdownWaitMs));
+            }
+        } catch (const mqtt::exception&) {
+            // 忽略断开时的异常
+        }
+        m_pendingToken.reset();
+        m_client.reset();
+    }
+    m_connected.store(false, std::memory_order_release);
+}
+
+void MqttClient::post(const std::shared_ptr<Liveness>& liveness, MqttClient* self, std::function<void()> fn)
+{
+    // 持锁投递：析构函数清除标记前已投递的事件随对象析构一并移除，不会在释放后执行
+    std::lock_guard<std::mutex> lock(liveness->mutex);
+    if (!liveness->alive) return;
+    QMetaObject::invokeMethod(self, std::move(fn), Qt::QueuedConnection);
 }
 
 void MqttClient::connect()
@@ -34,31 +91,87 @@ void MqttClient::connect()
         return;
     }
 
-    if (m_connected) {
-        return;
+    m_wantConnected = true;
+    if (m_state == State::Backoff) {
+        // 手动连接时跳过剩余的退避等待
+        m_reconnectTimer.stop();
+        setState(State::Disconnected);
     }
+    advance();
+}
 
-    try {
-        // 构造服务器地址
-        std::string serverUri = "tcp://" +
-            m_config.brokerHost.toStdString() + ":" +
-            std::to_string(m_config.brokerPort);
-
-        // 创建异步客户端 (serverURI, clientId, maxBufferedMessages)
-        m_client = std::make_unique<mqtt::async_client>(
-            serverUri,
-            m_config.clientId.toStdString(),
-            100
-        );
+void MqttClient::disconnect()
+{
+    m_wantConnected = false;
+    stopReconnect();
+    advance();
+}
+
+void MqttClient::advance()
+{
+    switch (m_state) {
+    case State::Disconnected:
+        if (m_wantConnected && m_config.enabled) {
+            startConnect();
+        }
+        break;
+    case State::Connected:
+        if (!m_wantConnected || m_recreateClient) {
+            startDisconnect();
+        }
+        break;
+    case State::Backoff:
+        if (!m_wantConnected) {
+            m_reconnectTimer.stop();
+            setState(State::Disconnected);
+        }
+        break;
+    case State::Connecting:
+    case State::Disconnecting:
+        break;  // 等待操作回调后再推进
+    }
+}
+
+void MqttClient::createClient()
+{
+    // 构造服务器地址
+    std::string serverUri = "tcp://" +
+        m_config.brokerHost.toStdString() + ":" +
+        std::to_string(m_config.brokerPort);
+
+    // 创建异步客户端 (serverURI, clientId, maxBufferedMessages)
+    m_client = std::make_unique<mqtt::async_client>(
+        serverUri,
+        m_config.clientId.toStdString(),
+        100
+    );
+
+    // 设置回调
+    setupCallbacks();
+}
+
+void MqttClient::startConnect()
+{
+    const quint64 generation = ++m_generation;
+    setState(State::Connecting);
 
-        // 设置回调
-        setupCallbacks();
+    try {
+        // 配置变更后丢弃旧客户端（此时没有进行中的操作）
+        m_pendingToken.reset();
+        if (m_recreateClient) {
+            m_client.reset();
+            m_recreateClient = false;
+        }
+        if (!m_client) {
+            createClient();
+        }
 
         // 连接选项
         mqtt::connect_options connOpts;
         connOpts.set_keep_alive_interval(60);
         connOpts.set_clean_session(true);
         connOpts.set_automatic_reconnect(false); // 我们自己管理重连
+        connOpts.set_connect_timeout(kConnectTimeoutSec);
 
         // 认证配置
         if (m_config.useAuth) {
@@ -66,56 +179,154 @@ void MqttClient::connect()
             connOpts.set_password(m_config.password.toStdString());
         }
 
-        // 执行连接
-        m_client->connect(connOpts)->wait();
+        // 发起连接，结果在 Paho 线程回调后转发回 Qt 线程
+        auto* listener = new ActionListener([liveness = m_liveness, self = this, generation]
+                                            (bool ok, const mqtt::token& tok) {
+            QString error;
+            if (!ok) {
+                error = QString::fromStdString(mqtt::exception::error_str(tok.get_return_code()));
+            }
+            post(liveness, self, [self, generation, ok, error]() {
+                self->onConnectFinished(generation, ok, error);
+            });
+        });
+        try {
+            m_pendingToken = m_client->connect(connOpts, nullptr, *listener);
+        } catch (...) {
+            delete listener;
+            throw;
+        }
+    } catch (const mqtt::exception& ex) {
+        onConnectFinished(generation, false, QString::fromStdString(ex.what()));
+    }
+}
+
+void MqttClient::startDisconnect()
+{
+    const quint64 generation = ++m_generation;
+    m_connected.store(false, std::memory_order_release);  // 立即停止发布
+    setState(State::Disconnecting);
+
+    auto* listener = new ActionListener([liveness = m_liveness, self = this, generation](bool, const mqtt::token&) {
+        post(liveness, self, [self, generation]() {
+            self->onDisconnectFinished(generation);
+        });
+    });
+    try {
+        m_pendingToken = m_client->disconnect(kDisconnectTimeoutMs, nullptr, *listener);
+    } catch (const mqtt::exception&) {
+        // 忽略断开时的异常，按已断开处理
+        delete listener;
+        onDisconnectFinished(generation);
+    }
+}
+
+void MqttClient::onConnectFinished(quint64 generation, bool ok, const QString& error)
+{
+    if (generation != m_generation || m_state != State::Connecting) {
+        return;  // 过期的回调
+    }
+    m_pendingToken.reset();
 
+    if (ok) {
         m_connected.store(true, std::memory_order_release);
         m_reconnectCount = 0;
+        setState(State::Connected);
         emit connected();
+        advance();  // 连接期间可能已请求断开或修改了配置
+        return;
+    }
 
-    } catch (const mqtt::exception& ex) {
-        m_connected.store(false, std::memory_order_release);
-        emit connectionError(QString::fromStdString(ex.what()));
+    setState(State::Disconnected);
+    emit connectionError(error);
 
-        // 启动自动重连
-        if (m_config.autoReconnect) {
-            startReconnect();
-        }
+    if (m_wantConnected && m_config.autoReconnect) {
+        scheduleReconnect();
+    } else {
+        m_wantConnected = false;
+        advance();
     }
 }
 
-void MqttClient::disconnect()
+void MqttClient::onDisconnectFinished(quint64 generation)
 {
-    stopReconnect();
-
-    if (!m_connected || !m_client) {
+    if (generation != m_generation || m_state != State::Disconnecting) {
         return;
     }
+    m_pendingToken.reset();
 
-    try {
-        auto token = m_client->disconnect();
-        token->wait();
-    } catch (const mqtt::exception&) {
-        // 忽略断开时的异常
+    setState(State::Disconnected);
+    emit disconnected();
+    advance();  // 配置变更时会用新配置重新连接
+}
+
+void MqttClient::onConnectionLost(const QString& cause)
+{
+    if (m_state != State::Connected) {
+        return;
     }
 
     m_connected.store(false, std::memory_order_release);
-    m_client.reset();
+    setState(State::Disconnected);
     emit disconnected();
+    emit connectionError(QString("连接丢失: %1").arg(cause));
+
+    if (m_wantConnected && m_config.autoReconnect) {
+        m_reconnectCount = 0;
+        scheduleReconnect();
+    } else {
+        advance();
+    }
+}
+
+void MqttClient::scheduleReconnect()
+{
+    if (m_config.maxReconnectAttempts > 0 && m_reconnectCount >= m_config.maxReconnectAttempts) {
+        m_wantConnected = false;
+        emit connectionError("达到最大重连次数限制");
+        return;
+    }
+    ++m_reconnectCount;
+
+    // 指数退避：reconnectIntervalMs * 2^(n-1)，不超过 reconnectMaxIntervalMs；
+    // 在 [delay/2, delay] 内随机抖动，避免多台设备在 Broker 恢复时同时重连
+    const qint64 base = std::max(1000, m_config.reconnectIntervalMs);
+    const qint64 cap = std::max<qint64>(base, m_config.reconnectMaxIntervalMs);
+    const int shift = std::min(m_reconnectCount - 1, 20);
+    const qint64 delay = std::min(cap, base << shift);
+    const int jittered = static_cast<int>(delay / 2 + QRandomGenerator::global()->bounded(delay / 2 + 1));
+
+    spdlog::info("[MQTT] {} ms 后第 {} 次重连", jittered, m_reconnectCount);
+    setState(State::Backoff);
+    m_reconnectTimer.start(jittered);
+    emit reconnectAttempt(m_reconnectCount, jittered);
+}
+
+void MqttClient::stopReconnect()
+{
+    m_reconnectTimer.stop();
+    m_reconnectCount = 0;
+    if (m_state == State::Backoff) {
+        setState(State::Disconnected);
+    }
+}
+
+void MqttClient::setState(State state)
+{
+    m_state = state;
 }
 
-void MqttClient::publish(const QString& topic, const QString& payload, int qos, bool retained)
+void MqttClient::publish(const QString& topic, const QByteArray& payload, int qos, bool retained)
 {
     if (!m_connected.load(std::memory_order_acquire) || !m_client) {
         return;
     }
 
     try {
-        std::string payloadStr = payload.toStdString();
         m_client->publish(
             topic.toStdString(),
-            payloadStr.c_str(),
-            payloadStr.size(),
+            payload.constData(),
+            static_cast<size_t>(payload.size()),
             qos,
             retained
         );
@@ -124,6 +335,41 @@ void MqttClient::publish(const QString& topic, const QString& payload, int qos,
     }
 }
 
+void MqttClient::publishTracked(const QString& topic, const QByteArray& payload, int qos, quint64 tag)
+{
+    if (!m_connected.load(std::memory_order_acquire) || !m_client) {
+        notifyDelivery(tag, false);
+        return;
+    }
+
+    // 确认在 Paho 线程回调，客户端可能已被销毁（退出/重建配置），经存活标记投递
+    auto* listener = new ActionListener([liveness = m_liveness, self = this, tag](bool ok, const mqtt::token&) {
+        post(liveness, self, [self, tag, ok]() { emit self->publishCompleted(tag, ok); });
+    });
+    try {
+        m_client->publish(
+            topic.toStdString(),
+            payload.constData(),
+            static_cast<size_t>(payload.size()),
+            qos,
+            false,
+            nullptr,
+            *listener
+        );
+    } catch (const mqtt::exception& ex) {
+        delete listener;
+        notifyDelivery(tag, false);
+        emit connectionError(QString("发布消息失败: %1").arg(QString::fromStdString(ex.what())));
+    }
+}
+
+void MqttClient::notifyDelivery(quint64 tag, bool ok)
+{
+    QMetaObject::invokeMethod(this, [this, tag, ok]() {
+        emit publishCompleted(tag, ok);
+    }, Qt::QueuedConnection);
+}
+
 void MqttClient::subscribe(const QString& topic, int qos)
 {
     if (!m_connected.load(std::memory_order_acquire) || !m_client) {
@@ -152,14 +398,13 @@ void MqttClient::unsubscribe(const QString& topic)
 
 void MqttClient::updateConfig(const MqttConfig& config)
 {
-    bool wasConnected = m_connected.load(std::memory_order_acquire);
-    if (wasConnected) {
-        disconnect();
-    }
     m_config = config;
-    if (wasConnected && m_config.enabled) {
-        connect();
+    m_wantConnected = m_wantConnected && m_config.enabled;
+    if (m_client) {
+        m_recreateClient = true;  // 地址/认证可能已变化，下次连接前重建客户端
     }
+    stopReconnect();
+    advance();
 }
 
 void MqttClient::setupCallbacks()
@@ -168,45 +413,21 @@ void MqttClient::setupCallbacks()
         return;
     }
 
-    // 使用 lambda 回调，通过 QMetaObject::invokeMethod 转发到 Qt 主线程
-    m_client->set_message_callback([this](mqtt::const_message_ptr msg) {
+    // 使用 lambda 回调，经存活标记转发到 Qt 主线程
+    m_client->set_message_callback([liveness = m_liveness, self = this](mqtt::const_message_ptr msg) {
         QString topic = QString::fromStdString(msg->get_topic());
         QString payload = QString::fromStdString(msg->get_payload_str());
 
-        // 通过 QMetaObject::invokeMethod 确保在 Qt 主线程中触发信号
-        QMetaObject::invokeMethod(this, [this, topic, payload]() {
-            emit messageReceived(topic, payload);
-        }, Qt::QueuedConnection);
+        // 在 Qt 主线程中触发信号
+        post(liveness, self, [self, topic, payload]() {
+            emit self->messageReceived(topic, payload);
+        });
     });
 
     // 连接丢失回调
-    m_client->set_connection_lost_handler([this](const std::string& cause) mutable {
-        m_connected.store(false, std::memory_order_release);
-        QMetaObject::invokeMethod(this, [this, cause]() {
-            emit disconnected();
-            emit connectionError(QString("连接丢失: %1").arg(QString::fromStdString(cause)));
-
-            // 启动自动重连
-            if (m_config.autoReconnect) {
-                startReconnect();
-            }
-        }, Qt::QueuedConnection);
+    m_client->set_connection_lost_handler([liveness = m_liveness, self = this](const std::string& cause) {
+        post(liveness, self, [self, cause]() {
+            self->onConnectionLost(QString::fromStdString(cause));
+        });
     });
 }
-
-void MqttClient::startReconnect()
-{
-    if (!m_config.autoReconnect) {
-        return;
-    }
-
-    m_reconnectCount = 0;
-    m_reconnectTimer.setInterval(m_config.reconnectIntervalMs);
-    m_reconnectTimer.start();
-}
-
-void MqttClient::stopReconnect()
-{
-    m_reconnectTimer.stop();
-    m_reconnectCount = 0;
-}
\ No newline at end of file
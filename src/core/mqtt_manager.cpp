@@ -1,19 +1,37 @@
 ﻿#include "core/mqtt_manager.h"
+#include "core/mqtt_report_publisher.h"
+#include "core/mqtt_outbox.h"
+#include "core/metrics.h"
+#include "core/session_recorder.h"
 #include "logger.h"
 #include "config_manager.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QDateTime>
+#include <QCoreApplication>
+#include <QStandardPaths>
+#include <algorithm>
+#include <chrono>
 
 MqttManager::MqttManager(QObject* parent)
     : QObject(parent)
 {
     connect(&m_heartbeatTimer, &QTimer::timeout, this, &MqttManager::onSendHeartbeat);
+    connect(&m_metricsTimer, &QTimer::timeout, this, &MqttManager::onSendMetrics);
 }
 
 MqttManager::~MqttManager()
 {
     stopHeartbeat();
+    stopMetrics();
+    // 退出前发出当前聚合窗口：阻塞等待上报线程 flush 完，再处理已排队到本线程的发布请求
+    // （启用发件箱时未确认的消息由发件箱析构落盘）
+    if (m_reportPublisher && m_reportThread.isRunning()) {
+        m_reportPublisher->requestFlush(true);
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    }
+    m_reportThread.quit();
+    m_reportThread.wait();
 }
 
 void MqttManager::initializeFromConfig()
@@ -57,6 +75,47 @@ void MqttManager::initialize(const MqttConfig& config)
     connect(m_client, &MqttClient::messageReceived,
             this, &MqttManager::onMqttMessageReceived);
 
+    // 上报管线运行在独立线程，GUI 线程只负责把最终消息交给客户端
+    m_reportPublisher = new MqttReportPublisher(config);
+    m_reportPublisher->moveToThread(&m_reportThread);
+    connect(&m_reportThread, &QThread::finished,
+            m_reportPublisher, &QObject::deleteLater);
+
+    if (config.outboxEnabled) {
+        // 上报消息经离线发件箱发送：断线时落盘，重连后按序补发
+        // 放在应用数据目录（安装目录通常不可写）
+        m_outbox = new MqttOutbox(config,
+            QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/mqtt_outbox");
+        m_outbox->moveToThread(&m_reportThread);
+        connect(&m_reportThread, &QThread::finished,
+                m_outbox, &QObject::deleteLater);
+        connect(m_reportPublisher, &MqttReportPublisher::payloadReady,
+                m_outbox, &MqttOutbox::submit);
+        connect(m_outbox, &MqttOutbox::sendRequested,
+                this, [this](const QString& topic, const QByteArray& payload, int qos, quint64 tag) {
+            m_client->publishTracked(topic, payload, qos, tag);
+        });
+        connect(m_client, &MqttClient::publishCompleted,
+                m_outbox, &MqttOutbox::onPublishCompleted);
+        MqttOutbox* outbox = m_outbox;
+        connect(m_client, &MqttClient::connected, m_outbox, [outbox]() { outbox->setConnected(true); });
+        connect(m_client, &MqttClient::disconnected, m_outbox, [outbox]() { outbox->setConnected(false); });
+    } else {
+        connect(m_reportPublisher, &MqttReportPublisher::payloadReady,
+                this, [this](const QString& topic, const QByteArray& payload, int qos) {
+            if (m_client && m_client->isConnected()) {
+                m_client->publish(topic, payload, qos);
+            }
+        });
+    }
+
+    m_reportThread.setObjectName("MqttReportThread");
+    m_reportThread.start();
+    if (m_outbox) {
+        MqttOutbox* outbox = m_outbox;
+        QMetaObject::invokeMethod(m_outbox, [outbox]() { outbox->open(); }, Qt::QueuedConnection);
+    }
+
     if (config.enabled) {
         m_client->connect();
     }
@@ -66,16 +125,9 @@ void MqttManager::initialize(const MqttConfig& config)
 
 void MqttManager::publishResult(const DetectionResultReport& report)
 {
-    if (!m_client || !m_client->isConnected()) return;
+    if (!m_client || !m_client->config().enabled || !m_reportPublisher) return;
 
-    QJsonObject json = report.toJson();
-    json["deviceId"] = m_client->config().clientId;
-
-    QJsonDocument doc(json);
-    m_client->publish(
-        m_client->config().publishTopic,
-        QString::fromUtf8(doc.toJson(QJsonDocument::Compact)),
-        m_client->config().qos);
+    m_reportPublisher->submit(report);
 }
 
 void MqttManager::publishJson(const QString& topic, const QJsonObject& json)
@@ -85,10 +137,22 @@ void MqttManager::publishJson(const QString& topic, const QJsonObject& json)
     QJsonDocument doc(json);
     m_client->publish(
         topic,
-        QString::fromUtf8(doc.toJson(QJsonDocument::Compact)),
+        doc.toJson(QJsonDocument::Compact),
         m_client->config().qos);
 }
 
+void MqttManager::publishCommandResponse(const QString& cmd, const QString& commandId, const QJsonObject& fields)
+{
+    if (!m_client || m_client->config().responseTopic.isEmpty()) return;
+
+    QJsonObject payload = fields;
+    payload["deviceId"] = m_client->config().clientId;
+    payload["cmd"] = cmd;
+    if (!commandId.isEmpty()) payload["id"] = commandId;
+    payload["ts"] = QDateTime::currentMSecsSinceEpoch();
+    publishJson(m_client->config().responseTopic, payload);
+}
+
 // ==================== 功能3: 心跳 ====================
 
 void MqttManager::startHeartbeat()
@@ -117,10 +181,40 @@ void MqttManager::onSendHeartbeat()
     QJsonDocument doc(payload);
     m_client->publish(
         m_client->config().heartbeatTopic,
-        QString::fromUtf8(doc.toJson(QJsonDocument::Compact)),
+        doc.toJson(QJsonDocument::Compact),
         0);  // 心跳使用 QoS 0，减轻服务器压力
 }
 
+// ==================== 功能4: 运行指标 ====================
+
+void MqttManager::startMetrics()
+{
+    if (m_client && m_client->config().metricsIntervalMs > 0 && !m_client->config().metricsTopic.isEmpty()) {
+        m_metricsTimer.start(m_client->config().metricsIntervalMs);
+    }
+}
+
+void MqttManager::stopMetrics()
+{
+    m_metricsTimer.stop();
+}
+
+void MqttManager::onSendMetrics()
+{
+    if (!m_client || !m_client->isConnected()) return;
+
+    QJsonObject payload = MetricsRegistry::instance().toJson();
+    payload["deviceId"] = m_client->config().clientId;
+    payload["ts"] = QDateTime::currentMSecsSinceEpoch();
+    payload["uptime"] = m_uptimeTimer.elapsed() / 1000;
+
+    QJsonDocument doc(payload);
+    m_client->publish(
+        m_client->config().metricsTopic,
+        doc.toJson(QJsonDocument::Compact),
+        0);  // 指标为周期快照，丢一条无妨
+}
+
 // ==================== 功能2: 指令处理 ====================
 
 void MqttManager::onMqttConnected()
@@ -129,6 +223,7 @@ void MqttManager::onMqttConnected()
         m_client->subscribe(m_client->config().subscribeTopic, m_client->config().qos);
     }
     startHeartbeat();
+    startMetrics();
     emit mqttConnected();
 }
 
@@ -155,10 +250,12 @@ void MqttManager::parseCommand(const QJsonObject& json)
     QString cmd = json["cmd"].toString();
 
     spdlog::info(QString("[MQTT] 解析到指令: %1").arg(cmd));
+    SessionRecorder::instance().recordCommand(json);
 
     if (cmd == "capture") {
         spdlog::info("[MQTT] 触发: 采集检测");
-        emit captureRequested();
+        emit captureRequested(json["id"].toString(),
+                              std::chrono::steady_clock::now().time_since_epoch().count());
     } else if (cmd == "start_detection") {
         spdlog::info("[MQTT] 触发: 开始批量检测");
         emit startDetectionRequested();
@@ -169,6 +266,20 @@ void MqttManager::parseCommand(const QJsonObject& json)
         spdlog::info("[MQTT] 触发: 回复心跳");
         emit pingRequested();
         onSendHeartbeat();
+    } else if (cmd == "record_start") {
+        // 录制路径固定在应用数据目录下，不接受远端指定的路径；可指定大小/时长上限，达到后自动停止
+        SessionRecorder::Options options;
+        if (json["format"].toString() == "png") options.imageFormat = "png";
+        options.maxBytes = std::max<qint64>(0, json["maxBytes"].toInteger());
+        options.maxDurationSec = std::max(0, json["maxDurationSec"].toInt());
+        const QString path = SessionRecorder::defaultPath();
+        const bool ok = SessionRecorder::instance().start(path, options);
+        publishCommandResponse(cmd, json["id"].toString(),
+            {{"status", ok ? "ok" : "error"}, {"path", path}});
+    } else if (cmd == "record_stop") {
+        const QString path = SessionRecorder::instance().path();
+        SessionRecorder::instance().stop();
+        publishCommandResponse(cmd, json["id"].toString(), {{"status", "ok"}, {"path", path}});
     } else {
         spdlog::warn(QString("[MQTT] 未知指令: %1").arg(cmd));
     }
@@ -0,0 +1,491 @@
+﻿#include "core/mqtt_outbox.h"
+#include "logger.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr qint64 kSegmentBytes = 4 * 1024 * 1024;   ///< 单个分段上限（另不超过容量上限的 1/4）
+constexpr int kHeaderBytes = 8;                      ///< u32 bodyLen + u16 crc + u16 保留
+constexpr int kBodyFixedBytes = 8 + 1 + 2;           ///< seq + qos + topicLen
+constexpr quint32 kMaxBodyBytes = 64 * 1024 * 1024;  ///< 防止损坏的长度字段导致大块分配
+constexpr int kMaxInflight = 20;                     ///< 补发时未确认消息上限
+constexpr int kMaxDirect = 200;                      ///< 直发未确认上限，超出后走日志
+constexpr int kPumpIntervalMs = 100;
+constexpr quint64 kDirectTagBit = quint64(1) << 63;
+// 补发 tag = 重发代数(22 位) << 40 | 序号(40 位)
+constexpr int kSeqBits = 40;
+constexpr quint64 kSeqMask = (quint64(1) << kSeqBits) - 1;
+constexpr quint64 kGenerationMask = (quint64(1) << 22) - 1;
+
+QByteArray encodeRecord(quint64 seq, int qos, const QString& topic, const QByteArray& payload)
+{
+    const QByteArray topicUtf8 = topic.toUtf8();
+
+    QByteArray body(kBodyFixedBytes + topicUtf8.size() + payload.size(), Qt::Uninitialized);
+    uchar* p = reinterpret_cast<uchar*>(body.data());
+    qToLittleEndian<quint64>(seq, p);
+    p[8] = static_cast<uchar>(qos);
+    qToLittleEndian<quint16>(static_cast<quint16>(topicUtf8.size()), p + 9);
+    std::memcpy(p + kBodyFixedBytes, topicUtf8.constData(), topicUtf8.size());
+    std::memcpy(p + kBodyFixedBytes + topicUtf8.size(), payload.constData(), payload.size());
+
+    QByteArray record(kHeaderBytes, '\0');
+    uchar* h = reinterpret_cast<uchar*>(record.data());
+    qToLittleEndian<quint32>(static_cast<quint32>(body.size()), h);
+    qToLittleEndian<quint16>(qChecksum(body), h + 4);
+    record.append(body);
+    return record;
+}
+
+/// 从文件当前位置读一条记录；返回 0=成功, 1=到达末尾/不完整, 2=记录损坏
+int decodeNext(QFile& file, quint64& seq, int& qos, QString& topic, QByteArray& payload)
+{
+    const QByteArray header = file.read(kHeaderBytes);
+    if (header.size() < kHeaderBytes) return 1;
+
+    const uchar* h = reinterpret_cast<const uchar*>(header.constData());
+    const quint32 bodyLen = qFromLittleEndian<quint32>(h);
+    const quint16 crc = qFromLittleEndian<quint16>(h + 4);
+    if (bodyLen < static_cast<quint32>(kBodyFixedBytes) || bodyLen > kMaxBodyBytes) return 2;
+
+    const QByteArray body = file.read(bodyLen);
+    if (body.size() < static_cast<qsizetype>(bodyLen)) return 1;
+    if (qChecksum(body) != crc) return 2;
+
+    const uchar* p = reinterpret_cast<const uchar*>(body.constData());
+    seq = qFromLittleEndian<quint64>(p);
+    qos = p[8];
+    const quint16 topicLen = qFromLittleEndian<quint16>(p + 9);
+    if (kBodyFixedBytes + topicLen > static_cast<int>(bodyLen)) return 2;
+    topic = QString::fromUtf8(body.constData() + kBodyFixedBytes, topicLen);
+    payload = body.mid(kBodyFixedBytes + topicLen);
+    return 0;
+}
+
+bool fsyncFile(QFile& file)
+{
+    if (!file.flush()) return false;
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // namespace
+
+MqttOutbox::MqttOutbox(const MqttConfig& config, const QString& directory, QObject* parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_dir(directory)
+    , m_pumpTimer(new QTimer(this))
+    , m_syncTimer(new QTimer(this))
+{
+    connect(m_pumpTimer, &QTimer::timeout, this, &MqttOutbox::pump);
+    connect(m_syncTimer, &QTimer::timeout, this, &MqttOutbox::onSyncTimer);
+}
+
+MqttOutbox::~MqttOutbox()
+{
+    spillDirect();
+    syncWriteSegment();
+    persistCursor();
+}
+
+// ==================== 启动恢复 ====================
+
+void MqttOutbox::open()
+{
+    QDir dir(m_dir);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        spdlog::error("[MQTT] 无法创建离线缓存目录 {}，断线期间的上报将丢失", m_dir);
+    }
+
+    QFile cursorFile(m_dir + "/cursor");
+    if (cursorFile.open(QIODevice::ReadOnly)) {
+        m_ackedSeq = cursorFile.readAll().trimmed().toULongLong();
+    }
+
+    const QStringList files = dir.entryList({"*.seg"}, QDir::Files, QDir::Name);
+    for (const QString& name : files) {
+        Segment segment;
+        segment.path = m_dir + "/" + name;
+        if (scanSegment(segment)) {
+            m_segments.append(segment);
+        } else {
+            QFile::remove(segment.path);
+        }
+    }
+
+    m_nextSeq = std::max(m_ackedSeq, m_segments.isEmpty() ? quint64(0) : m_segments.last().lastSeq) + 1;
+    compact();
+    rewind();
+
+    const int interval = m_config.outboxFsyncIntervalMs > 0 ? m_config.outboxFsyncIntervalMs : 1000;
+    m_syncTimer->start(interval);
+
+    if (hasBacklog()) {
+        spdlog::info("[MQTT] 离线缓存中有 {} 条待补发消息", m_nextSeq - 1 - m_ackedSeq);
+    }
+}
+
+bool MqttOutbox::scanSegment(Segment& segment)
+{
+    QFile file(segment.path);
+    if (!file.open(QIODevice::ReadWrite)) return false;
+
+    qint64 validEnd = 0;
+    quint64 seq = 0;
+    int qos = 0;
+    QString topic;
+    QByteArray payload;
+    for (;;) {
+        const int rc = decodeNext(file, seq, qos, topic, payload);
+        if (rc != 0) {
+            if (rc == 2 || file.pos() != validEnd) {
+                // 末尾写了一半或已损坏：截断到最后一条完整记录
+                spdlog::warn("[MQTT] 离线缓存分段 {} 在偏移 {} 处截断", segment.path, validEnd);
+                file.resize(validEnd);
+            }
+            break;
+        }
+        if (segment.firstSeq == 0) segment.firstSeq = seq;
+        segment.lastSeq = seq;
+        validEnd = file.pos();
+    }
+    segment.size = validEnd;
+    return segment.firstSeq != 0;
+}
+
+// ==================== 写入 ====================
+
+void MqttOutbox::submit(const QString& topic, const QByteArray& payload, int qos)
+{
+    // 在线且无积压：直接发送，保持低延迟
+    if (m_connected && !hasBacklog() && m_direct.size() < kMaxDirect) {
+        const quint64 tag = kDirectTagBit | ++m_directCounter;
+        m_direct.insert(tag, Record{0, qos, topic, payload});
+        emit sendRequested(topic, payload, qos, tag);
+        return;
+    }
+
+    appendRecord(Record{0, qos, topic, payload});
+    if (m_connected && !m_pumpTimer->isActive()) {
+        m_pumpTimer->start(kPumpIntervalMs);
+    }
+}
+
+bool MqttOutbox::appendRecord(Record record)
+{
+    record.seq = m_nextSeq;
+
+    // 分段不超过容量的 1/4：超限时按段丢弃，一次最多丢掉约 1/4 的缓存
+    const qint64 segmentBytes = std::min(kSegmentBytes, quotaBytes() / 4);
+    if (!m_writeFile || m_segments.isEmpty() || m_segments.last().size >= segmentBytes) {
+        if (!openWriteSegment(record.seq)) {
+            return false;
+        }
+    }
+
+    const QByteArray bytes = encodeRecord(record.seq, record.qos, record.topic, record.payload);
+    if (m_writeFile->write(bytes) != bytes.size()) {
+        spdlog::error("[MQTT] 离线缓存写入失败: {}", m_writeFile->errorString());
+        return false;
+    }
+
+    ++m_nextSeq;
+    Segment& segment = m_segments.last();
+    if (segment.firstSeq == 0) segment.firstSeq = record.seq;
+    segment.lastSeq = record.seq;
+    segment.size += bytes.size();
+
+    if (m_config.outboxFsyncIntervalMs <= 0) {
+        fsyncFile(*m_writeFile);
+    } else {
+        m_unsynced = true;
+    }
+
+    enforceQuota();
+    return true;
+}
+
+bool MqttOutbox::openWriteSegment(quint64 firstSeq)
+{
+    closeWriteSegment();
+
+    Segment segment;
+    segment.path = QString("%1/%2.seg").arg(m_dir).arg(firstSeq, 20, 10, QChar('0'));
+    m_writeFile = std::make_unique<QFile>(segment.path);
+    if (!m_writeFile->open(QIODevice::WriteOnly | QIODevice::Append)) {
+        spdlog::error("[MQTT] 无法创建离线缓存分段: {}", segment.path);
+        m_writeFile.reset();
+        return false;
+    }
+    m_segments.append(segment);
+    return true;
+}
+
+void MqttOutbox::closeWriteSegment()
+{
+    if (!m_writeFile) return;
+    syncWriteSegment();
+    m_writeFile.reset();
+}
+
+void MqttOutbox::syncWriteSegment()
+{
+    if (m_writeFile && m_unsynced) {
+        fsyncFile(*m_writeFile);
+    }
+    m_unsynced = false;
+}
+
+void MqttOutbox::onSyncTimer()
+{
+    syncWriteSegment();
+    if (m_cursorDirty) {
+        persistCursor();
+    }
+}
+
+void MqttOutbox::persistCursor()
+{
+    if (!m_cursorDirty) return;
+
+    QSaveFile file(m_dir + "/cursor");
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QByteArray::number(m_ackedSeq));
+        if (file.commit()) {
+            m_cursorDirty = false;
+        }
+    }
+}
+
+// ==================== 补发 ====================
+
+void MqttOutbox::setConnected(bool connected)
+{
+    m_connected = connected;
+    if (!connected) {
+        m_pumpTimer->stop();
+        rewind();
+        spillDirect();
+        return;
+    }
+
+    rewind();
+    if (hasBacklog()) {
+        spdlog::info("[MQTT] 开始补发离线缓存: {} 条", m_nextSeq - 1 - m_ackedSeq);
+        m_pumpTimer->start(kPumpIntervalMs);
+    }
+}
+
+void MqttOutbox::spillDirect()
+{
+    // 直发中的消息不确定是否送达，写回日志等待重发（云端按 reportId / batchId 去重）
+    QList<quint64> tags = m_direct.keys();
+    std::sort(tags.begin(), tags.end());
+    for (quint64 tag : tags) {
+        appendRecord(m_direct.value(tag));
+    }
+    m_direct.clear();
+}
+
+quint64 MqttOutbox::replayTag(quint64 seq) const
+{
+    return ((quint64(m_generation) & kGenerationMask) << kSeqBits) | (seq & kSeqMask);
+}
+
+void MqttOutbox::rewind()
+{
+    ++m_generation;  // 之前发出的补发消息的确认作废
+    m_sentSeq = m_ackedSeq;
+    m_ackedAhead.clear();
+    m_inflight = 0;
+    m_readFile.reset();
+    m_readSegment = 0;
+    m_readOffset = 0;
+    while (m_readSegment < m_segments.size() && m_segments[m_readSegment].lastSeq <= m_ackedSeq) {
+        ++m_readSegment;
+    }
+}
+
+bool MqttOutbox::readNext(Record& out)
+{
+    while (m_readSegment < m_segments.size()) {
+        const bool isWriteSegment = m_writeFile && m_readSegment == m_segments.size() - 1;
+        if (isWriteSegment) {
+            m_writeFile->flush();  // 读取正在追加的分段前先把缓冲写入文件
+        }
+
+        if (!m_readFile) {
+            m_readFile = std::make_unique<QFile>(m_segments[m_readSegment].path);
+            if (!m_readFile->open(QIODevice::ReadOnly)) {
+                m_readFile.reset();
+                ++m_readSegment;
+                m_readOffset = 0;
+                continue;
+            }
+        }
+        m_readFile->seek(m_readOffset);
+
+        Record record;
+        const int rc = decodeNext(*m_readFile, record.seq, record.qos, record.topic, record.payload);
+        if (rc == 0) {
+            m_readOffset = m_readFile->pos();
+            if (record.seq <= m_sentSeq) continue;
+            out = record;
+            return true;
+        }
+
+        if (rc == 1 && isWriteSegment) {
+            return false;  // 已读到追加位置
+        }
+        if (rc == 2) {
+            spdlog::error("[MQTT] 离线缓存记录损坏，跳过分段剩余部分: {}", m_segments[m_readSegment].path);
+        }
+        m_readFile.reset();
+        ++m_readSegment;
+        m_readOffset = 0;
+    }
+    return false;
+}
+
+void MqttOutbox::pump()
+{
+    if (!m_connected) {
+        m_pumpTimer->stop();
+        return;
+    }
+
+    int budget = std::max(1, m_config.outboxReplayRate * kPumpIntervalMs / 1000);
+    Record record;
+    while (budget > 0 && m_inflight < kMaxInflight && readNext(record)) {
+        m_sentSeq = record.seq;
+        ++m_inflight;
+        --budget;
+        emit sendRequested(record.topic, record.payload, record.qos, replayTag(record.seq));
+    }
+
+    if (!hasBacklog()) {
+        m_pumpTimer->stop();
+    }
+}
+
+void MqttOutbox::onPublishCompleted(quint64 tag, bool ok)
+{
+    if (tag & kDirectTagBit) {
+        auto it = m_direct.find(tag);
+        if (it == m_direct.end()) return;  // 断线时已写回日志
+        Record record = it.value();
+        m_direct.erase(it);
+        if (!ok) {
+            appendRecord(record);
+        }
+        return;
+    }
+
+    // rewind() 之前发出的消息迟到的确认：m_inflight 已清零，不再计数
+    if ((tag >> kSeqBits) != (quint64(m_generation) & kGenerationMask)) return;
+    const quint64 seq = tag & kSeqMask;
+    if (seq <= m_ackedSeq || seq > m_sentSeq) return;
+
+    if (m_inflight > 0) --m_inflight;
+    if (!ok) {
+        // 从已确认位置重新发送，保证顺序
+        rewind();
+        if (m_connected && !m_pumpTimer->isActive()) {
+            m_pumpTimer->start(kPumpIntervalMs);
+        }
+        return;
+    }
+
+    m_ackedAhead.insert(seq);
+    advanceAck();
+
+    if (!hasBacklog()) {
+        spdlog::info("[MQTT] 离线缓存补发完成");
+    }
+}
+
+void MqttOutbox::advanceAck()
+{
+    const quint64 before = m_ackedSeq;
+    while (m_ackedAhead.remove(m_ackedSeq + 1)) {
+        ++m_ackedSeq;
+    }
+    if (m_ackedSeq != before) {
+        m_cursorDirty = true;
+        compact();
+    }
+}
+
+// ==================== 压缩与容量 ====================
+
+void MqttOutbox::compact()
+{
+    int removable = 0;
+    while (removable < m_segments.size() && m_segments[removable].lastSeq <= m_ackedSeq) {
+        ++removable;
+    }
+    if (removable == 0) return;
+
+    // 先关闭句柄再删除（Windows 无法删除打开中的文件）
+    if (m_readSegment < removable) {
+        m_readFile.reset();
+        m_readSegment = 0;
+        m_readOffset = 0;
+    } else {
+        m_readSegment -= removable;
+    }
+    if (m_writeFile && removable == m_segments.size()) {
+        // 当前分段已全部确认：关闭后删除，下次写入时新建
+        m_writeFile.reset();
+        m_unsynced = false;
+    }
+
+    for (int i = 0; i < removable; ++i) {
+        QFile::remove(m_segments.first().path);
+        m_segments.removeFirst();
+    }
+}
+
+qint64 MqttOutbox::quotaBytes() const
+{
+    return qint64(std::max(1, m_config.outboxMaxMB)) * 1024 * 1024;
+}
+
+void MqttOutbox::enforceQuota()
+{
+    const qint64 maxBytes = quotaBytes();
+    qint64 total = 0;
+    for (const auto& segment : m_segments) total += segment.size;
+
+    // 必要时连同当前追加分段一起丢弃（compact 会关闭其句柄，下次写入新建分段），容量上限是硬上限
+    while (total > maxBytes && !m_segments.isEmpty()) {
+        const Segment oldest = m_segments.first();
+        if (oldest.lastSeq > m_ackedSeq) {
+            spdlog::warn("[MQTT] 离线缓存超过 {}MB，丢弃最旧的 {} 条消息",
+                         m_config.outboxMaxMB, oldest.lastSeq - std::max(m_ackedSeq, oldest.firstSeq - 1));
+        }
+        total -= oldest.size;
+        m_ackedSeq = std::max(m_ackedSeq, oldest.lastSeq);
+        m_cursorDirty = true;
+        compact();
+        if (m_sentSeq < m_ackedSeq) {
+            rewind();
+        }
+    }
+}
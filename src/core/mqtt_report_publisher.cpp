@@ -0,0 +1,145 @@
+﻿#include "core/mqtt_report_publisher.h"
+#include "config/detection_type.h"
+#include "logger.h"
+#include <QTimer>
+#include <QDateTime>
+#include <QUuid>
+#include <algorithm>
+
+namespace {
+/// reportIntervalMs = 0 且仅状态变化上报时，未变化报告的统计汇总周期
+constexpr int kStateSummaryIntervalMs = 1000;
+/// summary 中保留的失败原因数量
+constexpr int kMaxFailReasons = 5;
+}
+
+MqttReportPublisher::MqttReportPublisher(const MqttConfig& config, QObject* parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_format(ReportCodec::formatFromString(config.payloadEncoding))
+    , m_flushTimer(new QTimer(this))
+{
+    connect(m_flushTimer, &QTimer::timeout, this, &MqttReportPublisher::flush);
+}
+
+void MqttReportPublisher::submit(const DetectionResultReport& report)
+{
+    QMetaObject::invokeMethod(this, [this, report]() { handleReport(report); }, Qt::QueuedConnection);
+}
+
+void MqttReportPublisher::requestFlush(bool wait)
+{
+    QMetaObject::invokeMethod(this, [this]() { flush(); },
+                              wait ? Qt::BlockingQueuedConnection : Qt::QueuedConnection);
+}
+
+void MqttReportPublisher::handleReport(const DetectionResultReport& report)
+{
+    // 逐条上报：保持原有单报告格式
+    if (m_config.reportIntervalMs <= 0 && !m_config.reportOnStateChange) {
+        ReportCodec::encodeReport(trimReport(report), m_config.clientId, m_config.reportRegions,
+                                  m_format, m_buffer);
+        emitPayload();
+        return;
+    }
+
+    if (m_total == 0 && m_pending.isEmpty()) {
+        m_windowStartMs = report.timestamp;
+    }
+
+    const QString roiKey = report.roiName.isEmpty() ? QStringLiteral("全图") : report.roiName;
+    ++m_total;
+    RoiCounter& roi = m_byRoi[roiKey];
+    ++roi.total;
+    if (report.passed) {
+        ++m_passed;
+        ++roi.passed;
+    } else if (!report.failReason.isEmpty()) {
+        ++m_failReasons[report.failReason];
+    }
+
+    const QString stateKey = report.roiId.isEmpty() ? roiKey : report.roiId;
+    auto last = m_lastState.constFind(stateKey);
+    const bool changed = (last == m_lastState.constEnd()) || (last.value() != report.passed);
+    m_lastState[stateKey] = report.passed;
+
+    if (!m_config.reportOnStateChange || changed) {
+        m_pending.append(trimReport(report));
+    }
+
+    if (m_pending.size() >= std::max(1, m_config.reportMaxBatch)) {
+        flush();
+    } else if (m_config.reportIntervalMs <= 0 && changed) {
+        flush();  // 状态变化立即发送
+    }
+
+    ensureTimer();
+}
+
+void MqttReportPublisher::ensureTimer()
+{
+    if (m_flushTimer->isActive()) return;
+    m_flushTimer->start(m_config.reportIntervalMs > 0 ? m_config.reportIntervalMs : kStateSummaryIntervalMs);
+}
+
+void MqttReportPublisher::flush()
+{
+    if (m_total == 0 && m_pending.isEmpty()) {
+        m_flushTimer->stop();  // 空闲时不空转
+        return;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    ReportCodec::BatchSummary summary;
+    summary.batchId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    summary.windowStart = m_windowStartMs > 0 ? m_windowStartMs : now;
+    summary.windowEnd = now;
+    summary.total = m_total;
+    summary.passed = m_passed;
+    for (auto it = m_byRoi.constBegin(); it != m_byRoi.constEnd(); ++it) {
+        summary.byRoi[it.key()] = {it->total, it->passed};
+    }
+
+    // 只保留出现次数最多的几个失败原因
+    QList<QPair<int, QString>> reasons;
+    for (auto it = m_failReasons.constBegin(); it != m_failReasons.constEnd(); ++it) {
+        reasons.append({it.value(), it.key()});
+    }
+    std::sort(reasons.begin(), reasons.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (int i = 0; i < reasons.size() && i < kMaxFailReasons; ++i) {
+        summary.failReasons.append({reasons[i].second, reasons[i].first});
+    }
+
+    ReportCodec::encodeBatch(summary, m_pending, m_config.clientId, m_config.reportRegions,
+                             m_format, m_buffer);
+    emitPayload();
+
+    m_windowStartMs = 0;
+    m_total = 0;
+    m_passed = 0;
+    m_byRoi.clear();
+    m_failReasons.clear();
+    m_pending.clear();
+}
+
+DetectionResultReport MqttReportPublisher::trimReport(const DetectionResultReport& report) const
+{
+    DetectionResultReport trimmed = report;
+    if (!m_config.reportBarcodes) {
+        const QString barcodeType = detectionTypeToString(DetectionType::Barcode);
+        trimmed.itemResults.erase(
+            std::remove_if(trimmed.itemResults.begin(), trimmed.itemResults.end(),
+                           [&](const DetectionItemReport& item) { return item.detectionType == barcodeType; }),
+            trimmed.itemResults.end());
+        trimmed.customFields.remove("barcodes");
+    }
+    return trimmed;
+}
+
+void MqttReportPublisher::emitPayload()
+{
+    // m_buffer 供下一条消息复用，信号带出按实际大小拷贝的副本
+    emit payloadReady(m_config.publishTopic, QByteArray(m_buffer.constData(), m_buffer.size()), m_config.qos);
+}
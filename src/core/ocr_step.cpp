@@ -1,29 +1,52 @@
 #include "ocr_step.h"
 #include "config/pipeline_config.h"
 #include "OcrLite.h"
+#include "algorithm/ocr_recognizer.h"
+#include "core/metrics.h"
+#include "utils/benchmark.h"
+#include "utils/thread_tag.h"
 #include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <bit>
+#include <chrono>
 #include <QDir>
 #include <QCoreApplication>
+#include <QStringList>
 #include <spdlog/spdlog.h>
 
-StepOcrRecognition::StepOcrRecognition() = default;
-StepOcrRecognition::~StepOcrRecognition() = default;
+namespace {
 
-void StepOcrRecognition::initRapidOcr()
+QString ocrModelsDir()
 {
-    if (m_initialized) return;
-
-    m_ocr = std::make_unique<OcrLite>();
-    m_ocr->setNumThread(4);
-
     // 模型路径：相对于可执行文件
-    QString appDir = QCoreApplication::applicationDirPath();
-    QString modelsDir = appDir + "/resources/ocr_models";
+    QString modelsDir = QCoreApplication::applicationDirPath() + "/resources/ocr_models";
 
     // 如果 appDir 下没有，尝试从项目根目录找
     if (!QDir(modelsDir).exists()) {
         modelsDir = QDir::currentPath() + "/resources/ocr_models";
     }
+    return modelsDir;
+}
+
+MetricHistogram& ocrDuration(const char* mode)
+{
+    return MetricsRegistry::instance().histogram(
+        "edgevision_ocr_duration_ms", "OCR 单帧耗时（ms，含前后处理）", {{"mode", mode}});
+}
+
+} // namespace
+
+StepOcrRecognition::StepOcrRecognition() = default;
+StepOcrRecognition::~StepOcrRecognition() = default;
+
+void StepOcrRecognition::initRapidOcr(int numThreads)
+{
+    if (m_initialized) return;
+
+    m_ocr = std::make_unique<OcrLite>();
+    m_ocr->setNumThread(numThreads);
+
+    const QString modelsDir = ocrModelsDir();
 
     std::string detPath  = (modelsDir + "/ch_PP-OCRv4_det_mobile.onnx").toStdString();
     std::string clsPath  = (modelsDir + "/ch_ppocr_mobile_v2.0_cls_mobile.onnx").toStdString();
@@ -36,7 +59,11 @@ void StepOcrRecognition::initRapidOcr()
     spdlog::info("[OCR]   rec:  {}", recPath);
     spdlog::info("[OCR]   keys: {}", keysPath);
 
-    bool ok = m_ocr->initModels(detPath, clsPath, recPath, keysPath);
+    bool ok = false;
+    {
+        ThreadTag::ScopedSpawn tag("ocr");  // 推理会话的线程池在此创建，归入 ocr
+        ok = m_ocr->initModels(detPath, clsPath, recPath, keysPath);
+    }
     if (!ok) {
         spdlog::error("[OCR] Failed to init RapidOCR models!");
         m_ocr.reset();
@@ -47,6 +74,230 @@ void StepOcrRecognition::initRapidOcr()
     spdlog::info("[OCR] RapidOCR initialized successfully");
 }
 
+bool StepOcrRecognition::initRecognizer(int numThreads)
+{
+    if (m_recognizerTried) return m_recognizer != nullptr;
+    m_recognizerTried = true;
+
+    const QString modelsDir = ocrModelsDir();
+    m_recognizer = std::make_unique<OcrRecognizer>();
+    if (!m_recognizer->loadModel(modelsDir + "/ch_PP-OCRv4_rec_mobile.onnx",
+                                 modelsDir + "/ppocr_keys_v1.txt", numThreads)) {
+        spdlog::error("[OCR] Failed to init batched recognizer");
+        m_recognizer.reset();
+        return false;
+    }
+    return true;
+}
+
+void StepOcrRecognition::resetCache()
+{
+    QMutexLocker locker(&m_cacheMutex);
+    m_cache.clear();
+}
+
+StepOcrRecognition::TextHash StepOcrRecognition::textHash(const cv::Mat& region)
+{
+    TextHash hash{};
+    if (region.empty()) return hash;
+
+    cv::Mat gray;
+    if (region.channels() == 3)
+        cv::cvtColor(region, gray, cv::COLOR_BGR2GRAY);
+    else if (region.channels() == 4)
+        cv::cvtColor(region, gray, cv::COLOR_BGRA2GRAY);
+    else
+        gray = region;
+
+    cv::Mat thumb;
+    cv::resize(gray, thumb, cv::Size(33, 8), 0, 0, cv::INTER_AREA);
+    int bit = 0;
+    for (int y = 0; y < thumb.rows; ++y) {
+        const uchar* row = thumb.ptr<uchar>(y);
+        for (int x = 0; x < 32; ++x, ++bit) {
+            if (row[x] > row[x + 1]) hash[bit / 64] |= quint64(1) << (bit % 64);
+        }
+    }
+    return hash;
+}
+
+int StepOcrRecognition::hammingDistance(const TextHash& a, const TextHash& b)
+{
+    int distance = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        distance += std::popcount(a[i] ^ b[i]);
+    }
+    return distance;
+}
+
+void StepOcrRecognition::countLookups(quint64 lookups, quint64 hits)
+{
+    if (lookups == 0) return;
+    const quint64 before = m_cacheLookups.fetch_add(lookups);
+    m_cacheHits += hits;
+
+    if ((before + lookups) / 100 != before / 100) {
+        auto stats = cacheStats();
+        spdlog::info("[OCR] 结果缓存命中率 {:.1f}% ({}/{})",
+                     stats.hitRate() * 100.0, stats.hits, stats.lookups);
+    }
+}
+
+QVector<StepOcrRecognition::TextBox> StepOcrRecognition::detectFull(const cv::Mat& src, const OcrConfig& cfg)
+{
+    // RapidOCR 接受 BGR 图像，直接传入
+    // 参数: padding, maxSideLen, boxScoreThresh, boxThresh, unClipRatio, doAngle, mostAngle
+    OcrResult result = m_ocr->detect(
+        src,
+        50,                              // padding
+        cfg.maxSideLen,                  // maxSideLen
+        0.5f,                            // boxScoreThresh
+        cfg.confidenceThreshold,         // boxThresh (复用置信度阈值)
+        1.6f,                            // unClipRatio
+        cfg.doAngle,                     // doAngle (方向检测，关闭即跳过 cls)
+        cfg.mostAngle                    // mostAngle
+    );
+
+    QVector<TextBox> boxes;
+    const QRect imageRect(0, 0, src.cols, src.rows);
+    for (const auto& block : result.textBlocks) {
+        TextBox box;
+
+        // 从 boxPoint 计算包围盒
+        if (!block.boxPoint.empty()) {
+            int minX = block.boxPoint[0].x, maxX = block.boxPoint[0].x;
+            int minY = block.boxPoint[0].y, maxY = block.boxPoint[0].y;
+            for (size_t i = 1; i < block.boxPoint.size(); ++i) {
+                if (block.boxPoint[i].x < minX) minX = block.boxPoint[i].x;
+                if (block.boxPoint[i].x > maxX) maxX = block.boxPoint[i].x;
+                if (block.boxPoint[i].y < minY) minY = block.boxPoint[i].y;
+                if (block.boxPoint[i].y > maxY) maxY = block.boxPoint[i].y;
+            }
+            box.rect = QRect(minX, minY, maxX - minX, maxY - minY);
+        }
+
+        box.text = QString::fromStdString(block.text);
+        box.confidence = block.boxScore;
+        const QRect clipped = box.rect & imageRect;
+        if (!clipped.isEmpty()) {
+            box.hash = textHash(src(cv::Rect(clipped.x(), clipped.y(), clipped.width(), clipped.height())));
+        }
+        boxes.append(box);
+    }
+    return boxes;
+}
+
+bool StepOcrRecognition::lookupFull(const QString& roiId, const cv::Mat& src, const OcrConfig& cfg,
+                                    QVector<TextBox>& out)
+{
+    CacheSlot slot;
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        auto it = m_cache.find(roiId);
+        if (it == m_cache.end() || it->frameSize != src.size()) return false;
+        slot = *it;
+    }
+
+    bool hit = hammingDistance(textHash(src), slot.frameHash) <= cfg.cacheMaxDistance;
+    const QRect imageRect(0, 0, src.cols, src.rows);
+    for (int i = 0; hit && i < slot.boxes.size(); ++i) {
+        const QRect clipped = slot.boxes[i].rect & imageRect;
+        if (clipped.isEmpty()) continue;
+        const TextHash h = textHash(src(cv::Rect(clipped.x(), clipped.y(), clipped.width(), clipped.height())));
+        hit = hammingDistance(h, slot.boxes[i].hash) <= cfg.cacheMaxDistance;
+    }
+
+    countLookups(1, hit ? 1 : 0);
+    if (hit) out = slot.boxes;
+    return hit;
+}
+
+void StepOcrRecognition::storeFull(const QString& roiId, const cv::Mat& src, const QVector<TextBox>& boxes)
+{
+    CacheSlot slot;
+    slot.frameSize = src.size();
+    slot.frameHash = textHash(src);
+    slot.boxes = boxes;
+
+    QMutexLocker locker(&m_cacheMutex);
+    m_cache[roiId] = std::move(slot);
+}
+
+QVector<StepOcrRecognition::TextBox> StepOcrRecognition::recognizeFixed(
+    const QString& roiId, const cv::Mat& src, const OcrConfig& cfg, bool useCache,
+    int& cachedCount, int& inferredCount)
+{
+    cachedCount = 0;
+    inferredCount = 0;
+    const QRect imageRect(0, 0, src.cols, src.rows);
+
+    QVector<TextBox> boxes;
+    boxes.reserve(cfg.fixedRegions.size());
+    for (const QRect& r : cfg.fixedRegions) {
+        const QRect clipped = r & imageRect;
+        if (clipped.isEmpty()) continue;
+        TextBox box;
+        box.rect = clipped;
+        box.hash = textHash(src(cv::Rect(clipped.x(), clipped.y(), clipped.width(), clipped.height())));
+        boxes.append(box);
+    }
+
+    // 缓存命中的区域直接复用，其余区域收集后一次批量识别
+    QVector<bool> cached(boxes.size(), false);
+    if (useCache) {
+        QMutexLocker locker(&m_cacheMutex);
+        auto it = m_cache.find(roiId);
+        if (it != m_cache.end() && it->frameSize == src.size()) {
+            for (int i = 0; i < boxes.size(); ++i) {
+                for (const TextBox& prev : it->boxes) {
+                    if (prev.rect == boxes[i].rect &&
+                        hammingDistance(prev.hash, boxes[i].hash) <= cfg.cacheMaxDistance) {
+                        boxes[i].text = prev.text;
+                        boxes[i].confidence = prev.confidence;
+                        cached[i] = true;
+                        ++cachedCount;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<cv::Mat> crops;
+    std::vector<int> cropIndex;
+    for (int i = 0; i < boxes.size(); ++i) {
+        if (cached[i]) continue;
+        const QRect& r = boxes[i].rect;
+        crops.push_back(src(cv::Rect(r.x(), r.y(), r.width(), r.height())));
+        cropIndex.push_back(i);
+    }
+    inferredCount = static_cast<int>(crops.size());
+    if (!crops.empty()) {
+        const auto recognized = m_recognizer->recognize(crops);
+        for (size_t k = 0; k < recognized.size(); ++k) {
+            TextBox& box = boxes[cropIndex[k]];
+            box.text = QString::fromStdString(recognized[k].text);
+            box.confidence = recognized[k].score;
+        }
+    }
+
+    if (useCache) {
+        countLookups(boxes.size(), cachedCount);
+        CacheSlot slot;
+        slot.frameSize = src.size();
+        slot.boxes = boxes;
+        QMutexLocker locker(&m_cacheMutex);
+        m_cache[roiId] = std::move(slot);
+    }
+
+    // 识别置信度低于阈值的区域视为无文字
+    QVector<TextBox> accepted;
+    for (const TextBox& box : boxes) {
+        if (!box.text.isEmpty() && box.confidence >= cfg.confidenceThreshold) accepted.append(box);
+    }
+    return accepted;
+}
+
 void StepOcrRecognition::run(PipelineContext& ctx)
 {
     if (!ctx.config) return;
@@ -64,71 +315,138 @@ void StepOcrRecognition::run(PipelineContext& ctx)
     }
     if (src.empty()) return;
 
-    // 初始化 RapidOCR
-    initRapidOcr();
-    if (!m_ocr) {
-        ctx.reason = "OCR初始化失败: 请检查ocr_models目录";
-        return;
+    const bool fixedMode = cfg.engineMode == OcrEngineMode::FixedRegions && !cfg.fixedRegions.isEmpty();
+
+    // 初始化 RapidOCR / 批量识别器
+    if (fixedMode) {
+        if (!initRecognizer(cfg.numThreads)) {
+            ctx.reason = "OCR初始化失败: 请检查ocr_models目录";
+            return;
+        }
+    } else {
+        initRapidOcr(cfg.numThreads);
+        if (!m_ocr) {
+            ctx.reason = "OCR初始化失败: 请检查ocr_models目录";
+            return;
+        }
     }
 
     try {
-        // RapidOCR 接受 BGR 图像，直接传入
-        // 参数: padding, maxSideLen, boxScoreThresh, boxThresh, unClipRatio, doAngle, mostAngle
-        OcrResult result = m_ocr->detect(
-            src,
-            50,                              // padding
-            960,                             // maxSideLen
-            0.5f,                            // boxScoreThresh
-            cfg.confidenceThreshold,         // boxThresh (复用置信度阈值)
-            1.6f,                            // unClipRatio
-            true,                            // doAngle (启用方向检测)
-            true                             // mostAngle
-        );
-
-        if (result.strRes.empty()) {
+        const auto start = std::chrono::steady_clock::now();
+        QVector<TextBox> boxes;
+        const char* mode = "full";
+        int cachedCount = 0;
+        int inferredCount = 0;
+
+        if (fixedMode) {
+            boxes = recognizeFixed(ctx.roiId, src, cfg, cfg.enableCache, cachedCount, inferredCount);
+            mode = (cachedCount > 0 && inferredCount == 0) ? "cached" : "fixed";
+        } else if (cfg.enableCache && lookupFull(ctx.roiId, src, cfg, boxes)) {
+            mode = "cached";
+        } else {
+            boxes = detectFull(src, cfg);
+            if (cfg.enableCache) storeFull(ctx.roiId, src, boxes);
+        }
+
+        const double elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        ocrDuration(mode).observe(elapsedMs);
+
+        ctx.overlay.removeGroup(OverlayGroup::Ocr);
+
+        if (boxes.isEmpty()) {
             ctx.ocrText = "";
             ctx.ocrRegions.clear();
             ctx.reason = "OCR: 未识别到文字";
             return;
         }
 
-        // 设置识别文本
-        ctx.ocrText = QString::fromStdString(result.strRes).trimmed();
-
         // 设置识别区域
+        QStringList lines;
         ctx.ocrRegions.clear();
-        for (const auto& block : result.textBlocks) {
+        for (const auto& box : boxes) {
             OcrRegion region;
+            region.x = box.rect.x();
+            region.y = box.rect.y();
+            region.width = box.rect.width();
+            region.height = box.rect.height();
+            region.text = box.text;
+            region.confidence = box.confidence;
+            ctx.ocrRegions.append(region);
+            lines.append(box.text);
 
-            // 从 boxPoint 计算包围盒
-            if (!block.boxPoint.empty()) {
-                int minX = block.boxPoint[0].x, maxX = block.boxPoint[0].x;
-                int minY = block.boxPoint[0].y, maxY = block.boxPoint[0].y;
-                for (size_t i = 1; i < block.boxPoint.size(); ++i) {
-                    if (block.boxPoint[i].x < minX) minX = block.boxPoint[i].x;
-                    if (block.boxPoint[i].x > maxX) maxX = block.boxPoint[i].x;
-                    if (block.boxPoint[i].y < minY) minY = block.boxPoint[i].y;
-                    if (block.boxPoint[i].y > maxY) maxY = block.boxPoint[i].y;
-                }
-                region.x = minX;
-                region.y = minY;
-                region.width = maxX - minX;
-                region.height = maxY - minY;
+            // 矢量叠加：绿色框 + 文本标签（过长截断）
+            QString label = region.text;
+            if (region.confidence > 0) {
+                label += QString(" (%1%)").arg(region.confidence * 100, 0, 'f', 1);
             }
-
-            region.text = QString::fromStdString(block.text);
-            region.confidence = block.boxScore;
-            ctx.ocrRegions.append(region);
+            if (label.length() > 30) {
+                label = label.left(27) + "...";
+            }
+            ctx.overlay.addBox(OverlayGroup::Ocr,
+                               QRectF(region.x, region.y, region.width, region.height),
+                               QColor(0, 255, 0), 2.0);
+            ctx.overlay.addLabel(OverlayGroup::Ocr,
+                                 QPointF(region.x, std::max(region.y - 5, 20)),
+                                 label);
         }
 
+        // 设置识别文本
+        ctx.ocrText = lines.join('\n').trimmed();
+
         ctx.reason = QString("OCR (RapidOCR): 识别 %1 个区域, 共 %2 字符")
                          .arg(ctx.ocrRegions.size())
                          .arg(ctx.ocrText.length());
 
-        spdlog::info("[OCR] {}", ctx.reason.toStdString());
+        spdlog::info("[OCR] {} [{} {:.1f} ms, 缓存 {} 区域]", ctx.reason.toStdString(), mode, elapsedMs, cachedCount);
     }
     catch (const std::exception& ex) {
         ctx.reason = QString("OCR 异常: %1").arg(ex.what());
         spdlog::error("[OCR] {}", ctx.reason.toStdString());
     }
 }
+
+void StepOcrRecognition::benchmark(const cv::Mat& image, const OcrConfig& cfg, int iterations)
+{
+    if (image.empty() || iterations <= 0) return;
+
+    initRapidOcr(cfg.numThreads);
+    if (!m_ocr || !initRecognizer(cfg.numThreads)) return;
+
+    try {
+        OcrConfig full = cfg;
+        full.doAngle = true;
+        OcrConfig noAngle = cfg;
+        noAngle.doAngle = false;
+
+        // 未标定固定区域时，用 Full 模式检出的文本框代替（即产线标定后的效果）
+        OcrConfig fixed = cfg;
+        if (fixed.fixedRegions.isEmpty()) {
+            for (const auto& box : detectFull(image, full)) {
+                fixed.fixedRegions.append(box.rect);
+            }
+        }
+
+        spdlog::info("[BENCH] OCR 图像 {}x{}, 固定区域 {} 个, maxSideLen={}",
+                     image.cols, image.rows, fixed.fixedRegions.size(), cfg.maxSideLen);
+        benchmarkAvg("OCR::full(det+cls+rec)", iterations, [&] { detectFull(image, full); });
+        benchmarkAvg("OCR::full(det+rec)", iterations, [&] { detectFull(image, noAngle); });
+        if (fixed.fixedRegions.isEmpty()) return;
+
+        const QString key = QStringLiteral("__ocr_benchmark__");
+        int cachedCount = 0;
+        int inferredCount = 0;
+        benchmarkAvg("OCR::fixed(batched rec)", iterations, [&] {
+            recognizeFixed(key, image, fixed, false, cachedCount, inferredCount);
+        });
+        recognizeFixed(key, image, fixed, true, cachedCount, inferredCount);
+        benchmarkAvg("OCR::fixed(cached)", iterations, [&] {
+            recognizeFixed(key, image, fixed, true, cachedCount, inferredCount);
+        });
+
+        QMutexLocker locker(&m_cacheMutex);
+        m_cache.remove(key);
+    } catch (const std::exception& ex) {
+        spdlog::error("OCR benchmark 错误: {}", ex.what());
+    }
+}
@@ -1,9 +1,306 @@
 ﻿#include "pipeline.h"
 #include "logger.h"
+#include "core/metrics.h"
+#include "core/mat_arena.h"
+#include "utils/thread_tag.h"
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace {
+
+/// 指标标签用的步骤名（ASCII，与 StepType 顺序一致，新增步骤时同步补充）
+constexpr std::array<const char*, PipelineConfig::STEP_COUNT> kStepMetricNames = {
+    "color_channel", "enhance", "filter", "algorithm_queue", "shape_filter",
+    "line_detector", "barcode", "image_filter", "ocr", "caliper",
+};
+
+struct PipelineMetrics {
+    MetricCounter& runs = MetricsRegistry::instance().counter(
+        "edgevision_pipeline_runs_total", "Pipeline 执行次数（每个 ROI 计一次）");
+    MetricHistogram& runLatency = MetricsRegistry::instance().histogram(
+        "edgevision_pipeline_duration_ms", "单次 Pipeline 执行耗时（ms）");
+    std::array<MetricHistogram*, PipelineConfig::STEP_COUNT> stepLatency{};
+
+    PipelineMetrics()
+    {
+        for (int i = 0; i < PipelineConfig::STEP_COUNT; ++i) {
+            stepLatency[i] = &MetricsRegistry::instance().histogram(
+                "edgevision_step_duration_ms", "Pipeline 各步骤耗时（ms）",
+                {{"step", kStepMetricNames[i]}});
+        }
+    }
+};
+
+PipelineMetrics& pipelineMetrics()
+{
+    static PipelineMetrics metrics;
+    return metrics;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+int defaultParallelBranches()
+{
+    return std::clamp(QThread::idealThreadCount(), 1, 4);
+}
+
+/// 分支工作池：独立于全局池，避免与调用 Pipeline::run 的 QtConcurrent 任务互相占满
+QThreadPool& branchPool()
+{
+    static QThreadPool* pool = [] {
+        auto* p = new QThreadPool();
+        p->setMaxThreadCount(defaultParallelBranches());
+        p->setExpiryTimeout(30000);
+        return p;
+    }();
+    return *pool;
+}
+
+void runStep(IPipelineStep* step, PipelineContext& ctx)
+{
+    // 步骤输出及临时图像从本线程缓冲池取，上一帧释放的同尺寸缓冲直接复用
+    MatArena::Scope arenaScope;
+    const auto stepStart = std::chrono::steady_clock::now();
+    step->run(ctx);
+    const int type = static_cast<int>(step->stepType());
+    if (type >= 0 && type < PipelineConfig::STEP_COUNT) {
+        pipelineMetrics().stepLatency[type]->observe(elapsedMs(stepStart));
+    }
+}
+
+/// 参与依赖计算的字段位
+constexpr ContextFields kTrackedFields =
+    ContextField::ChannelImg | ContextField::Enhanced | ContextField::FilteredImage |
+    ContextField::OcrInputImage | ContextField::FilterMask | ContextField::ExtractedMask |
+    ContextField::Regions | ContextField::LineResult | ContextField::Caliper |
+    ContextField::Barcode | ContextField::Ocr | ContextField::ObjectDetection |
+    ContextField::VisualBase | ContextField::Pass |
+    (((ContextField::OverlayBase << static_cast<int>(OverlayGroup::Count)) - 1) & ~(ContextField::OverlayBase - 1));
+
+void copyField(ContextFields field, const PipelineContext& from, PipelineContext& to)
+{
+    switch (field) {
+    case ContextField::ChannelImg:      to.channelImg = from.channelImg; break;
+    case ContextField::Enhanced:        to.enhanced = from.enhanced; break;
+    case ContextField::FilteredImage:   to.filteredImage = from.filteredImage; break;
+    case ContextField::OcrInputImage:   to.ocrInputImage = from.ocrInputImage; break;
+    case ContextField::FilterMask:      to.filterMask = from.filterMask; break;
+    case ContextField::ExtractedMask:   to.extractedMask = from.extractedMask; break;
+    case ContextField::Regions:
+        to.regionCount = from.regionCount;
+        to.regionFeatures = from.regionFeatures;
+        break;
+    case ContextField::LineResult:
+        to.lineDetectImage = from.lineDetectImage;
+        to.matchedLineCount = from.matchedLineCount;
+        to.totalLineCount = from.totalLineCount;
+        break;
+    case ContextField::Caliper:         to.caliper = from.caliper; break;
+    case ContextField::Barcode:
+        to.barcodeResults = from.barcodeResults;
+        to.barcodeStatus = from.barcodeStatus;
+        break;
+    case ContextField::Ocr:
+        to.ocrText = from.ocrText;
+        to.ocrRegions = from.ocrRegions;
+        break;
+    case ContextField::ObjectDetection: to.objectDetectionResults = from.objectDetectionResults; break;
+    case ContextField::VisualBase:      to.visualBase = from.visualBase; break;
+    case ContextField::Pass:            to.pass = from.pass; break;
+    default:
+        for (int g = 0; g < static_cast<int>(OverlayGroup::Count); ++g) {
+            const auto group = static_cast<OverlayGroup>(g);
+            if (field == ContextField::overlay(group)) {
+                to.overlay.removeGroup(group);
+                to.overlay.append(from.overlay.filtered(group));
+                break;
+            }
+        }
+        break;
+    }
+}
+
+/**
+ * 由步骤顺序 + 读写集编译出的依赖图
+ *
+ * 步骤 i 的每个读/写字段都取自顺序上在它之前的最后一个写者（写字段也要继承，
+ * 这样未实际改写时保持前值），这些写者即 i 的前驱。各步骤在自己的上下文副本上执行，
+ * 因此写后读之外的冲突（写后写、读后写）无需排序，最终结果按顺序取每个字段的最后写者。
+ */
+struct StepGraph
+{
+    std::vector<std::vector<std::pair<ContextFields, int>>> inputs;  ///< (字段, 来源步骤)
+    std::vector<std::vector<int>> successors;
+    std::vector<int> predecessorCount;
+    std::vector<std::pair<ContextFields, int>> outputs;             ///< (字段, 最后写者)
+    bool chain = true;                                              ///< 无可并发的分支
+};
+
+StepGraph compileGraph(const std::vector<IPipelineStep*>& steps)
+{
+    const int n = static_cast<int>(steps.size());
+    StepGraph graph;
+    graph.inputs.resize(n);
+    graph.successors.resize(n);
+    graph.predecessorCount.assign(n, 0);
+
+    std::array<int, 32> lastWriter;
+    lastWriter.fill(-1);
+    std::vector<uint64_t> reach(n, 0);   // 传递前驱集合（n <= 64 时用于判定是否为链）
+
+    for (int i = 0; i < n; ++i) {
+        const ContextFields writes = steps[i]->writes() & kTrackedFields;
+        const ContextFields fields = (steps[i]->reads() | writes) & kTrackedFields;
+
+        std::vector<int> preds;
+        for (int b = 0; b < 32; ++b) {
+            const ContextFields bit = 1u << b;
+            if (!(fields & bit) || lastWriter[b] < 0) continue;
+            graph.inputs[i].push_back({bit, lastWriter[b]});
+            preds.push_back(lastWriter[b]);
+        }
+        std::sort(preds.begin(), preds.end());
+        preds.erase(std::unique(preds.begin(), preds.end()), preds.end());
+        for (int p : preds) {
+            graph.successors[p].push_back(i);
+            if (n <= 64) reach[i] |= reach[p] | (uint64_t(1) << p);
+        }
+        graph.predecessorCount[i] = static_cast<int>(preds.size());
+        if (i > 0 && (n > 64 || !(reach[i] & (uint64_t(1) << (i - 1))))) {
+            graph.chain = false;
+        }
+
+        for (int b = 0; b < 32; ++b) {
+            if (writes & (1u << b)) lastWriter[b] = i;
+        }
+    }
+    if (n > 64) graph.chain = true;   // 超出位集容量时保守串行
+
+    for (int b = 0; b < 32; ++b) {
+        if (lastWriter[b] >= 0) graph.outputs.push_back({1u << b, lastWriter[b]});
+    }
+    return graph;
+}
+
+void runSequential(const std::vector<IPipelineStep*>& steps, PipelineContext& ctx)
+{
+    for (IPipelineStep* step : steps) {
+        runStep(step, ctx);
+    }
+}
+
+/**
+ * 按依赖图执行：就绪步骤中留一个在本线程执行，其余交给分支工作池；
+ * 步骤完成后由完成它的线程直接接着执行新就绪的第一个后继，保持分支内串行且不回到调度线程排队
+ */
+void runGraph(const std::vector<IPipelineStep*>& steps, const StepGraph& graph,
+              PipelineContext& ctx, int maxParallel)
+{
+    const int n = static_cast<int>(steps.size());
+    const PipelineContext& base = ctx;
+    std::vector<PipelineContext> results(n);
+    std::vector<int> pending = graph.predecessorCount;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<int> ready;
+    int finished = 0;
+    int running = 0;
+    for (int i = 0; i < n; ++i) {
+        if (pending[i] == 0) ready.push_back(i);
+    }
+
+    auto execute = [&](int i) {
+        while (i >= 0) {
+            // 任何异常都不能越过下面的计数更新，否则调度线程永远等不到 finished == n
+            PipelineContext local;
+            try {
+                local = base;
+                for (const auto& [field, producer] : graph.inputs[i]) {
+                    copyField(field, results[producer], local);
+                }
+                runStep(steps[i], local);
+            } catch (const std::exception& e) {
+                spdlog::error("[Pipeline] 步骤 {} 异常: {}", static_cast<int>(steps[i]->stepType()), e.what());
+            } catch (...) {
+                spdlog::error("[Pipeline] 步骤 {} 抛出未知异常", static_cast<int>(steps[i]->stepType()));
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            results[i] = std::move(local);
+            ++finished;
+            int next = -1;
+            for (int s : graph.successors[i]) {
+                if (--pending[s] != 0) continue;
+                if (next < 0) next = s;
+                else ready.push_back(s);
+            }
+            if (next < 0) --running;
+            i = next;
+            changed.notify_all();
+        }
+    };
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (finished < n) {
+            int inlineStep = -1;
+            while (!ready.empty() && running < maxParallel) {
+                const int i = ready.front();
+                ready.pop_front();
+                ++running;
+                if (ready.empty() || running >= maxParallel) {
+                    inlineStep = i;
+                    break;
+                }
+                branchPool().start([&execute, i]() {
+                    ThreadTag::setCurrent("pipeline");
+                    execute(i);
+                });
+            }
+            if (inlineStep >= 0) {
+                lock.unlock();
+                execute(inlineStep);
+                lock.lock();
+                continue;
+            }
+            changed.wait(lock, [&] {
+                return finished == n || (!ready.empty() && running < maxParallel);
+            });
+        }
+    }
+
+    // 合并：每个字段取顺序上的最后写者；reason 取顺序上最后一个改写它的步骤
+    for (const auto& [field, producer] : graph.outputs) {
+        copyField(field, results[producer], ctx);
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        if (results[i].reason != base.reason) {
+            ctx.reason = results[i].reason;
+            break;
+        }
+    }
+}
+
+} // namespace
 
 // ========== Pipeline类实现 ==========
 
-Pipeline::Pipeline() = default;
+Pipeline::Pipeline()
+    : maxParallelBranches_(defaultParallelBranches())
+{
+}
 
 // ========== 步骤管理 ==========
 
@@ -82,13 +379,31 @@ void Pipeline::run(PipelineContext& ctx)
         return;
     }
 
-    for (size_t i = 0; i < steps_.size(); ++i) {
-        auto& step = steps_[i];
-        if (step) {
-            if (ctx.config && !ctx.config->stepEnabled[static_cast<int>(step->stepType())]) {
-                continue;
-            }
-            step->run(ctx);
-        }
+    PipelineMetrics& metrics = pipelineMetrics();
+    const auto runStart = std::chrono::steady_clock::now();
+
+    // 各 ROI 启用的步骤不同，依赖图按本次启用的步骤编译（步骤数很少，开销可忽略）
+    std::vector<IPipelineStep*> active;
+    active.reserve(steps_.size());
+    for (auto& step : steps_) {
+        if (!step) continue;
+        const int type = static_cast<int>(step->stepType());
+        if (ctx.config && !ctx.config->stepEnabled[type]) continue;
+        active.push_back(step.get());
+    }
+
+    const StepGraph graph = compileGraph(active);
+    if (maxParallelBranches_ <= 1 || graph.chain) {
+        runSequential(active, ctx);
+    } else {
+        runGraph(active, graph, ctx, maxParallelBranches_);
     }
+
+    metrics.runs.inc();
+    metrics.runLatency.observe(elapsedMs(runStart));
+}
+
+void Pipeline::setMaxParallelBranches(int n)
+{
+    maxParallelBranches_ = std::max(1, n);
 }
@@ -0,0 +1,105 @@
+#include "core/pipeline_steps.h"
+#include "caliper_tool.h"
+#include "logger.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+void StepCaliper::run(PipelineContext& ctx)
+{
+    if (!ctx.config || ctx.srcBgr.empty()) return;
+
+    ctx.caliper = CaliperResult();
+    ctx.overlay.removeGroup(OverlayGroup::Caliper);
+
+    const LineDetectConfig& line = ctx.config->lineDetect;
+    if (!line.referenceLineValid) {
+        ctx.caliper.pass = false;
+        ctx.caliper.message = "卡尺: 测量路径未绘制（直线页\"绘制参考线\"）";
+        return;
+    }
+
+    try {
+        cv::Mat srcVis = ctx.visualBase.empty() ? ctx.srcBgr : ctx.visualBase;
+        cv::Mat gray;
+        if (srcVis.channels() == 1)
+            gray = srcVis;
+        else
+            cv::cvtColor(srcVis, gray, cv::COLOR_BGR2GRAY);
+
+        ctx.caliper = CaliperTool::measure(gray, line.referenceLineStart, line.referenceLineEnd,
+                                           ctx.config->caliper);
+        if (!ctx.caliper.valid) ctx.caliper.pass = false;
+
+        appendOverlay(ctx, line.referenceLineStart, line.referenceLineEnd);
+    } catch (const cv::Exception& ex) {
+        spdlog::error("Caliper OpenCV错误: {}", ex.what());
+        ctx.caliper.pass = false;
+        ctx.caliper.message = "卡尺测量失败";
+    }
+}
+
+void StepCaliper::appendOverlay(PipelineContext& ctx, const cv::Point2f& start, const cv::Point2f& end) const
+{
+    const CaliperConfig& cfg = ctx.config->caliper;
+    const CaliperResult& res = ctx.caliper;
+    OverlayModel& overlay = ctx.overlay;
+
+    // 卡尺框
+    const float halfL = static_cast<float>(cfg.searchLength) * 0.5f;
+    const float halfP = static_cast<float>(std::max(1.0, cfg.projectionLength)) * 0.5f;
+    for (const auto& c : CaliperTool::layout(start, end, cfg)) {
+        cv::Point2f n = c.normal * halfL, t = c.tangent * halfP;
+        cv::Point2f corners[4] = {c.center - n - t, c.center + n - t, c.center + n + t, c.center - n + t};
+        OverlayPolyline box;
+        box.group = OverlayGroup::Caliper;
+        for (const auto& p : corners) box.points.append(QPointF(p.x, p.y));
+        box.closed = true;
+        box.color = QColor(0, 200, 255);
+        box.penWidth = 1.0;
+        overlay.polylines.append(box);
+    }
+
+    // 亚像素边缘点（十字）：内点绿色/青色，离群点红色
+    auto addCross = [&](const CaliperEdgePoint& e, const QColor& color) {
+        const double r = 3.0;
+        overlay.addLine(OverlayGroup::Caliper, e.pos - QPointF(r, 0), e.pos + QPointF(r, 0), color, 1.0);
+        overlay.addLine(OverlayGroup::Caliper, e.pos - QPointF(0, r), e.pos + QPointF(0, r), color, 1.0);
+    };
+    for (const auto& e : res.edges)
+        addCross(e, e.inlier ? QColor(0, 255, 0) : QColor(255, 0, 0));
+    for (const auto& e : res.secondEdges)
+        addCross(e, e.inlier ? QColor(0, 255, 255) : QColor(255, 0, 0));
+
+    // 拟合几何
+    if (res.inlierCount > 0) {
+        if (cfg.shape == 1 && res.circleRadius > 0) {
+            OverlayPolyline arc;
+            arc.group = OverlayGroup::Caliper;
+            arc.color = QColor(255, 255, 0);
+            arc.penWidth = 2.0;
+            const double theta0 = std::atan2(end.y - start.y, end.x - start.x);
+            const double span = std::clamp(cfg.arcSpanDeg, 1.0, 360.0) * CV_PI / 180.0;
+            const int segments = 72;
+            for (int i = 0; i <= segments; ++i) {
+                double theta = theta0 + span * i / segments;
+                arc.points.append(res.circleCenter + res.circleRadius * QPointF(std::cos(theta), std::sin(theta)));
+            }
+            overlay.polylines.append(arc);
+        } else if (cfg.shape != 1) {
+            // 拟合直线在参考线两端点投影之间的线段
+            auto project = [&](const cv::Point2f& p) {
+                QPointF d = QPointF(p.x, p.y) - res.linePoint;
+                double s = d.x() * res.lineDir.x() + d.y() * res.lineDir.y();
+                return res.linePoint + s * res.lineDir;
+            };
+            overlay.addLine(OverlayGroup::Caliper, project(start), project(end), QColor(255, 255, 0), 2.0);
+        }
+    }
+
+    if (!res.message.isEmpty()) {
+        overlay.addLabel(OverlayGroup::Caliper, QPointF(start.x, std::max(start.y - 8.0f, 20.0f)), res.message,
+                         QColor(255, 255, 255),
+                         res.pass ? QColor(0, 128, 0) : QColor(200, 0, 0));
+    }
+}
@@ -1,6 +1,8 @@
 #include "core/pipeline_steps.h"
 #include "config/pipeline_config.h"
+#include "tiled_executor.h"
 #include <opencv2/imgproc.hpp>
+#include <algorithm>
 
 void StepImageFilter::run(PipelineContext& ctx)
 {
@@ -12,7 +14,9 @@ void StepImageFilter::run(PipelineContext& ctx)
     cv::Mat src = ctx.enhanced.empty() ? (ctx.channelImg.empty() ? ctx.srcBgr : ctx.channelImg) : ctx.enhanced;
     if (src.empty()) return;
 
-    cv::Mat result;
+    // 滤波算子及其影响半径（分块时作为 halo）
+    TiledExecutor::TileOp filter;
+    int halo = 0;
 
     switch (cfg.filterType) {
     case FilterDenoiseType::Gaussian: {
@@ -20,8 +24,13 @@ void StepImageFilter::run(PipelineContext& ctx)
         int ksize = cfg.gaussianKernelSize;
         if (ksize % 2 == 0) ksize += 1;  // 确保为奇数
         if (ksize < 1) ksize = 1;
-        cv::GaussianBlur(src, result, cv::Size(ksize, ksize),
-                        cfg.gaussianSigmaX, cfg.gaussianSigmaY);
+        halo = ksize / 2;
+        filter = [ksize, &cfg](const cv::Mat& in) {
+            cv::Mat out;
+            cv::GaussianBlur(in, out, cv::Size(ksize, ksize),
+                            cfg.gaussianSigmaX, cfg.gaussianSigmaY);
+            return out;
+        };
         break;
     }
     case FilterDenoiseType::Median: {
@@ -29,15 +38,25 @@ void StepImageFilter::run(PipelineContext& ctx)
         int ksize = cfg.medianKernelSize;
         if (ksize % 2 == 0) ksize += 1;  // 确保为奇数
         if (ksize < 3) ksize = 3;
-        cv::medianBlur(src, result, ksize);
+        halo = ksize / 2;
+        filter = [ksize](const cv::Mat& in) {
+            cv::Mat out;
+            cv::medianBlur(in, out, ksize);
+            return out;
+        };
         break;
     }
     case FilterDenoiseType::Bilateral: {
         // 双边滤波
         int d = cfg.bilateralD;
         if (d <= 0) d = 9;
-        cv::bilateralFilter(src, result, d,
-                           cfg.bilateralSigmaColor, cfg.bilateralSigmaSpace);
+        halo = d / 2;
+        filter = [d, &cfg](const cv::Mat& in) {
+            cv::Mat out;
+            cv::bilateralFilter(in, out, d,
+                               cfg.bilateralSigmaColor, cfg.bilateralSigmaSpace);
+            return out;
+        };
         break;
     }
     case FilterDenoiseType::Morphology: {
@@ -46,29 +65,45 @@ void StepImageFilter::run(PipelineContext& ctx)
         if (ksize < 1) ksize = 1;
         cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE,
                                                    cv::Size(ksize, ksize));
+        const int iterations = std::max(1, cfg.morphologyIterations);
+        // 开/闭运算为腐蚀+膨胀各 iterations 次，影响半径翻倍
+        const bool compound = cfg.morphologyOp == MorphologyOpType::Open ||
+                              cfg.morphologyOp == MorphologyOpType::Close;
+        halo = (ksize / 2) * iterations * (compound ? 2 : 1);
 
-        switch (cfg.morphologyOp) {
-        case MorphologyOpType::Open:
-            cv::morphologyEx(src, result, cv::MORPH_OPEN, kernel,
-                            cv::Point(-1, -1), cfg.morphologyIterations);
-            break;
-        case MorphologyOpType::Close:
-            cv::morphologyEx(src, result, cv::MORPH_CLOSE, kernel,
-                            cv::Point(-1, -1), cfg.morphologyIterations);
-            break;
-        case MorphologyOpType::Erode:
-            cv::erode(src, result, kernel, cv::Point(-1, -1),
-                     cfg.morphologyIterations);
-            break;
-        case MorphologyOpType::Dilate:
-            cv::dilate(src, result, kernel, cv::Point(-1, -1),
-                      cfg.morphologyIterations);
-            break;
-        }
+        filter = [kernel, &cfg](const cv::Mat& in) {
+            cv::Mat out;
+            switch (cfg.morphologyOp) {
+            case MorphologyOpType::Open:
+                cv::morphologyEx(in, out, cv::MORPH_OPEN, kernel,
+                                cv::Point(-1, -1), cfg.morphologyIterations);
+                break;
+            case MorphologyOpType::Close:
+                cv::morphologyEx(in, out, cv::MORPH_CLOSE, kernel,
+                                cv::Point(-1, -1), cfg.morphologyIterations);
+                break;
+            case MorphologyOpType::Erode:
+                cv::erode(in, out, kernel, cv::Point(-1, -1),
+                         cfg.morphologyIterations);
+                break;
+            case MorphologyOpType::Dilate:
+                cv::dilate(in, out, kernel, cv::Point(-1, -1),
+                          cfg.morphologyIterations);
+                break;
+            }
+            return out;
+        };
         break;
     }
     }
 
+    if (!filter) return;
+
+    const TilingConfig& tiling = ctx.config->tiling;
+    cv::Mat result = tiling.appliesTo(src.cols, src.rows)
+                         ? TiledExecutor::apply(src, halo, tiling.tileSize, filter)
+                         : filter(src);
+
     if (!result.empty()) {
         ctx.filteredImage = result;
         ctx.enhanced = result;
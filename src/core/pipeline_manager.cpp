@@ -7,6 +7,7 @@
 #include "algorithm/display_renderer.h"
 #include "utils/benchmark.h"
 #include "utils/model_warmup.h"
+#include "core/mat_arena.h"
 #include <algorithm>
 #include <map>
 
@@ -15,6 +16,7 @@ PipelineManager::PipelineManager(QObject* parent)
     , m_processor(std::make_unique<ImageProcessor>())
     , m_scheduler(std::make_unique<PipelineScheduler>(this))
 {
+    MatArena::install();
     resetConfigToDefaults();
     initPipeline();
     ModelWarmUp::warmUpAll();
@@ -31,6 +33,7 @@ PipelineManager::~PipelineManager() = default;
 void PipelineManager::resetConfigToDefaults()
 {
     m_config.resetToDefaults();
+    touchConfig();
     spdlog::info("[PipelineManager] resetConfigToDefaults");
 }
 
@@ -40,6 +43,7 @@ void PipelineManager::addAlgorithmStep(const AlgorithmStep& step)
 {
     m_algorithmQueue.append(step);
     m_config.algorithmQueue = m_algorithmQueue;
+    touchConfig();
     emit algorithmQueueChanged(m_algorithmQueue.size());
 }
 
@@ -49,6 +53,7 @@ void PipelineManager::removeAlgorithmStep(int index)
     {
         m_algorithmQueue.removeAt(index);
         m_config.algorithmQueue = m_algorithmQueue;
+        touchConfig();
         emit algorithmQueueChanged(m_algorithmQueue.size());
     }
 }
@@ -59,6 +64,7 @@ void PipelineManager::swapAlgorithmStep(int index1, int index2)
     {
         m_algorithmQueue.swapItemsAt(index1, index2);
         m_config.algorithmQueue = m_algorithmQueue;
+        touchConfig();
         emit algorithmQueueChanged(m_algorithmQueue.size());
     }
 }
@@ -67,12 +73,14 @@ void PipelineManager::clearAlgorithmQueue()
 {
     m_algorithmQueue.clear();
     m_config.algorithmQueue.clear();
+    touchConfig();
     emit algorithmQueueChanged(0);
 }
 
 // ========== Pipeline执行 ==========
 
-PipelineContext PipelineManager::execute(const cv::Mat& inputImage, const PipelineConfig& config)
+PipelineContext PipelineManager::execute(const cv::Mat& inputImage, const PipelineConfig& config,
+                                         const QString& roiId)
 {
     if (inputImage.empty())
     {
@@ -95,6 +103,7 @@ PipelineContext PipelineManager::execute(const cv::Mat& inputImage, const Pipeli
     ctx.srcBgr = inputImage;
     ctx.visualBase = inputImage;  // 初始化可视化基底为原图
     ctx.config = &config;
+    ctx.roiId = roiId;
 
     try {
         {
@@ -132,6 +141,7 @@ spdlog::error(QString("Pipeline执行异常: %1").arg(ex.what()));
     if (m_hasPendingReset.loadAcquire()) {
         m_algorithmQueue.clear();
         m_config.algorithmQueue.clear();
+        touchConfig();
         m_config.shapeFilter.clear();
         m_displayMode = DisplayConfig::Mode::MaskGreenWhite;
         m_overlayAlpha = AppConstants::DEFAULT_OVERLAY_ALPHA;
@@ -164,6 +174,7 @@ void PipelineManager::updateAlgorithmStep(int index, const AlgorithmStep& step)
     {
         m_algorithmQueue[index] = step;
         m_config.algorithmQueue = m_algorithmQueue;
+        touchConfig();
         emit algorithmQueueChanged(m_algorithmQueue.size());
     }
 }
@@ -174,6 +185,18 @@ void PipelineManager::clearLastResult()
     m_lastContext = PipelineContext();
 }
 
+void PipelineManager::resetSourceState()
+{
+    for (size_t i = 0; i < m_pipeline.size(); ++i) {
+        if (auto* barcode = dynamic_cast<StepBarcodeRecognition*>(m_pipeline.getStep(static_cast<int>(i)))) {
+            barcode->resetTracking();
+        } else if (auto* ocr = dynamic_cast<StepOcrRecognition*>(m_pipeline.getStep(static_cast<int>(i)))) {
+            ocr->resetCache();
+        }
+    }
+    MatArena::trimAll();  // 新源的图像尺寸可能不同，旧尺寸的空闲缓冲不再命中
+}
+
 void PipelineManager::setDisplayMode(DisplayConfig::Mode mode)
 {
     m_displayMode = mode;
@@ -187,6 +210,14 @@ cv::Mat PipelineManager::getLastDisplayWithMode(DisplayConfig::Mode mode) const
     return DisplayRenderer::render(m_lastContext, mode);
 }
 
+OverlayModel PipelineManager::getLastOverlayWithMode(DisplayConfig::Mode mode) const
+{
+    QMutexLocker locker(&m_contextMutex);
+    if (m_lastContext.srcBgr.empty()) return OverlayModel();
+
+    return DisplayRenderer::overlayFor(m_lastContext, mode);
+}
+
 bool PipelineManager::hasLastResult() const
 {
     QMutexLocker locker(&m_contextMutex);
@@ -204,10 +235,11 @@ void PipelineManager::resetPipeline()
     // Pipeline未在运行，直接执行重置（无需加锁，因为在UI线程且无并发）
     m_algorithmQueue.clear();
     m_config.algorithmQueue.clear();
+    touchConfig();
     m_config.shapeFilter.clear();
     // [FIX] 重置步骤配置到默认值
-    m_config.stepEnabled = {false, false, false, false, false, false, false, false, false};
-    m_config.stepOrder = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    m_config.stepEnabled = {false, false, false, false, false, false, false, false, false, false};
+    m_config.stepOrder = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
     m_config.enableObjectDetection = false;
     m_config.objectDetectionApplyEnabled = false;
     m_displayMode = DisplayConfig::Mode::MaskGreenWhite;
@@ -222,6 +254,7 @@ void PipelineManager::setStepEnabled(int stepIndex, bool enabled)
 {
     if (stepIndex < 0 || stepIndex >= PipelineConfig::STEP_COUNT) return;
     m_config.stepEnabled[stepIndex] = enabled;
+    touchConfig();
 }
 
 bool PipelineManager::isStepEnabled(int stepIndex) const
@@ -258,6 +291,7 @@ void PipelineManager::initPipeline()
     allSteps[6] = std::make_unique<StepBarcodeRecognition>();
     allSteps[7] = std::make_unique<StepImageFilter>();
     allSteps[8] = std::make_unique<StepOcrRecognition>();
+    allSteps[9] = std::make_unique<StepCaliper>();
 
     // 按默认顺序添加所有步骤
     for (int idx : m_config.stepOrder) {
@@ -296,6 +330,14 @@ cv::Mat PipelineManager::getCachedDisplay(const QString& roiId, DisplayConfig::M
     return DisplayRenderer::render(*it, mode);
 }
 
+OverlayModel PipelineManager::getCachedOverlay(const QString& roiId, DisplayConfig::Mode mode) const
+{
+    QMutexLocker locker(&m_roiCacheMutex);
+    auto it = m_roiCache.find(roiId);
+    if (it == m_roiCache.end() || it->srcBgr.empty()) return OverlayModel();
+    return DisplayRenderer::overlayFor(*it, mode);
+}
+
 void PipelineManager::clearCachedResult(const QString& roiId)
 {
     QMutexLocker locker(&m_roiCacheMutex);
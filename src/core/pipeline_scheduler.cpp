@@ -1,12 +1,48 @@
 ﻿#include "pipeline_scheduler.h"
 #include "pipeline_manager.h"
 #include "logger.h"
+#include "core/metrics.h"
+#include "utils/thread_tag.h"
 #include <QElapsedTimer>
+#include <QJsonDocument>
 #include <QtConcurrent/QtConcurrent>
 
 // PipelineRequest 静态成员
 QAtomicInt PipelineRequest::s_nextId{0};
 
+namespace {
+
+struct SchedulerMetrics {
+    MetricCounter& submitted = MetricsRegistry::instance().counter(
+        "edgevision_scheduler_requests_total", "提交到调度器的 Pipeline 请求数");
+    MetricCounter& dropped = MetricsRegistry::instance().counter(
+        "edgevision_scheduler_dropped_total", "队列满时被丢弃的请求数");
+    MetricCounter& completed = MetricsRegistry::instance().counter(
+        "edgevision_scheduler_completed_total", "执行完成的请求数（含失败）");
+    MetricCounter& failed = MetricsRegistry::instance().counter(
+        "edgevision_scheduler_failed_total", "执行失败的请求数");
+    MetricGauge& queueDepth = MetricsRegistry::instance().gauge(
+        "edgevision_scheduler_queue_depth", "等待执行的请求数");
+    MetricGauge& throughput = MetricsRegistry::instance().gauge(
+        "edgevision_scheduler_throughput", "最近 10 秒平均每秒完成的请求数");
+    MetricHistogram& latency = MetricsRegistry::instance().histogram(
+        "edgevision_scheduler_latency_ms", "单次请求在线程池中的执行耗时（ms）");
+    MetricCounter& superseded = MetricsRegistry::instance().counter(
+        "edgevision_stream_frames_superseded_total", "流式槽中未执行即被新帧取代的帧数");
+    MetricHistogram& frameAge = MetricsRegistry::instance().histogram(
+        "edgevision_stream_frame_age_ms", "流式帧从提交到结果完成的帧龄（ms，含等待）");
+
+    SchedulerMetrics() { MetricsRegistry::instance().trackRate(completed, throughput); }
+};
+
+SchedulerMetrics& schedulerMetrics()
+{
+    static SchedulerMetrics metrics;
+    return metrics;
+}
+
+} // namespace
+
 PipelineScheduler::PipelineScheduler(PipelineManager* pipeline, QObject* parent)
     : QObject(parent)
     , m_pipeline(pipeline)
@@ -20,6 +56,8 @@ PipelineScheduler::PipelineScheduler(PipelineManager* pipeline, QObject* parent)
     // 创建 FutureWatcher
     m_watcher = new QFutureWatcher<PipelineResult>(this);
     connect(m_watcher, &QFutureWatcher<PipelineResult>::finished, this, &PipelineScheduler::onTaskFinished);
+
+    schedulerMetrics();
 }
 
 PipelineScheduler::~PipelineScheduler()
@@ -32,12 +70,100 @@ PipelineScheduler::~PipelineScheduler()
 
 // ========== 请求接口 ==========
 
-qint64 PipelineScheduler::submit(const cv::Mat& image, const PipelineConfig& config, int priority, const QString& caller)
+qint64 PipelineScheduler::submit(const cv::Mat& image, const PipelineConfig& config, int priority, const QString& caller,
+                                 const QString& roiId)
 {
-    PipelineRequest request(image, config, priority, caller);
+    PipelineRequest request(image, config, priority, caller, roiId);
     return submit(std::move(request));
 }
 
+qint64 PipelineScheduler::submit(const FrameView& frame, const PipelineConfig& config, int priority, const QString& caller,
+                                 const QString& roiId)
+{
+    PipelineRequest request(frame, config, priority, caller, roiId);
+    return submit(std::move(request));
+}
+
+qint64 PipelineScheduler::submitLatest(const QString& source, const FrameView& frame, const PipelineConfig& config,
+                                       const QString& caller, const QString& roiId)
+{
+    if (!passChangeGate(source, frame, config)) {
+        return -1;
+    }
+
+    PipelineRequest request(frame, config, 0, caller, roiId);
+    const qint64 requestId = request.id();
+
+    QMutexLocker locker(&m_queueMutex);
+    schedulerMetrics().submitted.inc();
+    auto slot = m_streamSlots.find(source);
+    if (slot != m_streamSlots.end()) {
+        // 旧帧尚未开始执行，直接被新帧取代（参考帧已是新帧，无需清除门控状态）
+        m_streamSources.remove(slot->second.id());
+        slot->second = std::move(request);
+        schedulerMetrics().superseded.inc();
+    } else {
+        m_streamSlots.emplace(source, std::move(request));
+        m_streamOrder.append(source);
+    }
+    m_streamSources.insert(requestId, source);
+    locker.unlock();
+
+    emitQueueChanged();
+    if (!m_processing.loadAcquire()) {
+        processNext();
+    }
+    return requestId;
+}
+
+bool PipelineScheduler::passChangeGate(const QString& source, const FrameView& frame, const PipelineConfig& config)
+{
+    if (!config.changeGate.enabled) return true;
+
+    // 配置指纹：任何参数调整都必须立即生效，不受门控影响。
+    // 序列化整份配置代价不小，只在 PipelineManager 配置修订号变化时重新计算
+    const quint64 revision = m_pipeline->configRevision();
+    if (!m_gateFingerprintValid || revision != m_gateRevision) {
+        m_gateFingerprint = qHash(QJsonDocument(config.toJson()).toJson(QJsonDocument::Compact));
+        m_gateRevision = revision;
+        m_gateFingerprintValid = true;
+    }
+    if (m_changeGate.shouldProcess(source, frame.mat(), config.changeGate, m_gateFingerprint)) {
+        return true;
+    }
+
+    // 该 source 还有更新的帧在槽中等待或正在执行：结果马上返回，不再重发更早的结果
+    if (m_streamSources.key(source, -1) >= 0) {
+        return false;
+    }
+
+    auto it = m_lastStreamResults.find(source);
+    if (it != m_lastStreamResults.end()) {
+        emit finished(it->second);
+    }
+    return false;
+}
+
+const PipelineResult* PipelineScheduler::lastStreamResult(const QString& source) const
+{
+    auto it = m_lastStreamResults.find(source);
+    return it != m_lastStreamResults.end() ? &it->second : nullptr;
+}
+
+void PipelineScheduler::resetChangeGate()
+{
+    m_changeGate.reset();
+    m_lastStreamResults.clear();
+}
+
+void PipelineScheduler::forgetStreamRequest(qint64 requestId)
+{
+    const QString source = m_streamSources.take(requestId);
+    if (!source.isEmpty()) {
+        m_changeGate.invalidate(source);
+    }
+}
+
 qint64 PipelineScheduler::submit(PipelineRequest request)
 {
     qint64 requestId = request.id();
@@ -54,6 +180,8 @@ qint64 PipelineScheduler::submit(PipelineRequest request)
         }
     }
 
+    schedulerMetrics().submitted.inc();
+
     // 队列满时，移除最低优先级的请求
     while (m_queue.size() >= m_maxQueueSize) {
         int lowestIdx = 0;
@@ -64,6 +192,7 @@ qint64 PipelineScheduler::submit(PipelineRequest request)
         }
         spdlog::debug("[PipelineScheduler] 队列满，移除低优先级请求: {}", m_queue[lowestIdx].id());
         m_queue.removeAt(lowestIdx);
+        schedulerMetrics().dropped.inc();
     }
 
     // 添加到队列
@@ -92,16 +221,35 @@ void PipelineScheduler::cancel(qint64 requestId)
             return;
         }
     }
+
+    for (auto it = m_streamSlots.begin(); it != m_streamSlots.end(); ++it) {
+        if (it->second.id() == requestId) {
+            spdlog::debug("[PipelineScheduler] 取消流式请求: {} ({})", requestId, it->first);
+            m_streamOrder.removeOne(it->first);
+            forgetStreamRequest(requestId);
+            m_streamSlots.erase(it);
+            locker.unlock();
+            emit cancelled(requestId);
+            emitQueueChanged();
+            return;
+        }
+    }
 }
 
 void PipelineScheduler::cancelAll()
 {
     QMutexLocker locker(&m_queueMutex);
 
-    if (m_queue.isEmpty()) return;
+    if (m_queue.isEmpty() && m_streamSlots.empty()) return;
 
-    spdlog::debug("[PipelineScheduler] 取消所有请求，队列长度: {}", m_queue.size());
+    spdlog::debug("[PipelineScheduler] 取消所有请求，队列长度: {}，流式槽: {}",
+                  m_queue.size(), m_streamSlots.size());
     m_queue.clear();
+    for (const auto& [source, request] : m_streamSlots) {
+        forgetStreamRequest(request.id());
+    }
+    m_streamSlots.clear();
+    m_streamOrder.clear();
     locker.unlock();
 
     m_debounceTimer->stop();
@@ -131,7 +279,7 @@ void PipelineScheduler::setDeduplicationEnabled(bool enabled)
 int PipelineScheduler::pendingCount() const
 {
     QMutexLocker locker(&m_queueMutex);
-    return m_queue.size();
+    return m_queue.size() + static_cast<int>(m_streamSlots.size());
 }
 
 // ========== 内部实现 ==========
@@ -152,9 +300,20 @@ void PipelineScheduler::processNext()
     QMutexLocker locker(&m_queueMutex);
 
     // 队列为空
-    if (m_queue.isEmpty()) {
+    if (m_queue.isEmpty() && m_streamOrder.isEmpty()) {
+        return;
+    }
+
+    // 流式帧与普通请求交替派发，避免连续视频流饿死界面参数调整
+    if (!m_streamOrder.isEmpty() && (m_queue.isEmpty() || !m_lastWasStream)) {
+        auto node = m_streamSlots.extract(m_streamOrder.takeFirst());
+        m_lastWasStream = true;
+        locker.unlock();
+        emitQueueChanged();
+        executeRequest(node.mapped());
         return;
     }
+    m_lastWasStream = false;
 
     // 取出最高优先级的请求
     int highestIdx = 0;
@@ -186,10 +345,11 @@ void PipelineScheduler::executeRequest(const PipelineRequest& request)
 
     // 捕获需要的指针和数据（按值），避免在后台线程中捕获 this
     PipelineManager* pipeline = m_pipeline;
-    PipelineRequest req = request.snapshot();  // 深拷贝，确保线程安全
+    PipelineRequest req = request.snapshot();  // 共享只读图像视图，步骤不会改写输入
 
     QFuture<PipelineResult> future = QtConcurrent::run(
         [pipeline, req = std::move(req)]() mutable -> PipelineResult {
+            ThreadTag::Scope tag("scheduler");  // 全局线程池线程，执行完恢复原名
             QElapsedTimer timer;
             timer.start();
 
@@ -200,7 +360,7 @@ void PipelineScheduler::executeRequest(const PipelineRequest& request)
                 }
 
                 // 执行 Pipeline
-                PipelineContext ctx = pipeline->execute(req.image(), req.config());
+                PipelineContext ctx = pipeline->execute(req.image(), req.config(), req.roiId());
                 double elapsed = timer.elapsed();
 
                 return PipelineResult::success(std::move(req), std::move(ctx), elapsed);
@@ -236,6 +396,24 @@ void PipelineScheduler::onTaskFinished()
     m_processing.storeRelease(0);
     emit processingChanged(false);
 
+    SchedulerMetrics& metrics = schedulerMetrics();
+    metrics.completed.inc();
+    metrics.latency.observe(result.elapsedMs());
+    if (!result.isSuccess()) {
+        metrics.failed.inc();
+    }
+
+    // 流式请求：记录帧龄；成功结果留作门控跳过时的重发结果，失败则让下一帧重新执行
+    const bool streamed = m_streamSources.contains(result.requestId());
+    if (streamed) {
+        metrics.frameAge.observe(result.frameAgeMs());
+        if (result.isSuccess()) {
+            m_lastStreamResults.insert_or_assign(m_streamSources.take(result.requestId()), result);
+        } else {
+            forgetStreamRequest(result.requestId());
+        }
+    }
+
     // 只在失败或耗时 >0ms 时打印
     if (!result.isSuccess() || result.elapsedMs() > 0) {
         spdlog::debug("[PipelineScheduler] 请求执行完成: {} 耗时: {}ms 成功: {}",
@@ -245,7 +423,15 @@ void PipelineScheduler::onTaskFinished()
     emit finished(result);
 
     // 检查队列中是否还有待处理的请求
-    if (pendingCount() > 0) {
+    bool streamPending = false;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        streamPending = !m_streamOrder.isEmpty();
+    }
+    if (streamPending) {
+        // 流式帧立即派发，不留间隔
+        processNext();
+    } else if (pendingCount() > 0) {
         // 延迟处理下一个请求，避免过于频繁
         QTimer::singleShot(10, this, &PipelineScheduler::processNext);
     }
@@ -253,5 +439,7 @@ void PipelineScheduler::onTaskFinished()
 
 void PipelineScheduler::emitQueueChanged()
 {
-    emit queueChanged(pendingCount());
+    const int pending = pendingCount();
+    schedulerMetrics().queueDepth.set(pending);
+    emit queueChanged(pending);
 }
@@ -1,10 +1,20 @@
 ﻿#include "pipeline_steps.h"
 #include "opencv_algorithm.h"
+#include "tiled_executor.h"
+#include "line_match_engine.h"
 #include "logger.h"
-#include <opencv2/line_descriptor.hpp>
 #include <cmath>
 #include <algorithm>
 
+namespace {
+// 大图时返回分块边长，否则 0（整帧处理）
+int tileSizeFor(const PipelineContext& ctx, const cv::Mat& img)
+{
+    const TilingConfig& tiling = ctx.config->tiling;
+    return tiling.appliesTo(img.cols, img.rows) ? tiling.tileSize : 0;
+}
+}
+
 void StepColorChannel::run(PipelineContext &ctx)
 {
     if (ctx.srcBgr.empty() || !ctx.config) return;
@@ -63,7 +73,8 @@ void StepEnhance::run(PipelineContext& ctx)
                 ctx.config->enhance.brightness,
                 ctx.config->enhance.contrast / 100.0,
                 ctx.config->enhance.gamma / 100.0,
-                ctx.config->enhance.sharpen / 100.0
+                ctx.config->enhance.sharpen / 100.0,
+                tileSizeFor(ctx, ctx.channelImg)
                 );
             ctx.visualBase = ctx.enhanced;
         } catch (const cv::Exception& ex) {
@@ -107,7 +118,6 @@ void StepFilter::run(PipelineContext& ctx)
             } else {
                 gray = ctx.enhanced;
             }
-            if (!gray.isContinuous()) gray = gray.clone();
             cv::inRange(gray,
                         cv::Scalar(ctx.config->colorFilter.grayLow),
                         cv::Scalar(ctx.config->colorFilter.grayHigh),
@@ -194,7 +204,7 @@ void StepAlgorithmQueue::run(PipelineContext& ctx)
 
             if (input.empty()) return;
 
-            cv::Mat result = m_processor->executeAlgorithmQueue(input, *m_algorithmQueue);
+            cv::Mat result = m_processor->executeAlgorithmQueue(input, *m_algorithmQueue, tileSizeFor(ctx, input));
 
             if (!result.empty())
             {
@@ -239,20 +249,23 @@ void StepShapeFilter::run(PipelineContext& ctx)
             }
             cv::threshold(binary, binary, 127, 255, cv::THRESH_BINARY);
 
-            cv::Mat labels, stats, centroids;
-            int numBefore = cv::connectedComponentsWithStats(binary, labels, stats, centroids, 8) - 1;
+            // 大图分块标记，接缝处合并跨块区域，计数与整帧一致
+            const int tileSize = tileSizeFor(ctx, binary);
+            auto countRegions = [tileSize](const cv::Mat& region) {
+                cv::Mat labels, stats, centroids;
+                return (tileSize > 0 ? TiledExecutor::connectedComponents(region, labels, stats, tileSize, 8)
+                                     : cv::connectedComponentsWithStats(region, labels, stats, centroids, 8)) - 1;
+            };
+            int numBefore = countRegions(binary);
 
-            spdlog::info("========== 形状筛选 ==========");
-            spdlog::debug("筛选模式: {}", getFilterModeName(filter.mode).toStdString());
-            spdlog::debug("筛选前区域数量: {}", numBefore);
+            STEP_LOG_DEBUG("[ShapeFilter] 模式: {}, 筛选前区域数量: {}",
+                           getFilterModeName(filter.mode).toStdString(), numBefore);
 
             cv::Mat filteredRegion = applyFilter(binary, filter);
 
-            cv::Mat filteredLabels, filteredStats, filteredCentroids;
-            int numAfter = cv::connectedComponentsWithStats(filteredRegion, filteredLabels, filteredStats, filteredCentroids, 8) - 1;
+            int numAfter = filteredRegion.empty() ? 0 : countRegions(filteredRegion);
 
-            spdlog::debug("筛选后区域数量: {}", numAfter);
-            spdlog::info("==============================");
+            STEP_LOG_DEBUG("[ShapeFilter] 筛选后区域数量: {}", numAfter);
 
             ctx.regionCount = numAfter;
 
@@ -288,7 +301,7 @@ cv::Mat StepShapeFilter::applyFilterAnd(const cv::Mat& regions, const ShapeFilte
         {
             if (!cond.isValid()) continue;
 
-            spdlog::info("  应用条件: {}", cond.toString().toStdString());
+            STEP_LOG_DEBUG("  应用条件: {}", cond.toString().toStdString());
 
             result = OpenCVAlgorithm::selectShapeByFeature(
                 result,
@@ -297,9 +310,12 @@ cv::Mat StepShapeFilter::applyFilterAnd(const cv::Mat& regions, const ShapeFilte
                 cond.maxValue
             );
 
+#ifdef EDGEVISION_STEP_DEBUG_LOG
+            // 仅用于调试日志的区域计数，默认构建不做整图连通域分析
             cv::Mat labels, stats, centroids;
             int count = cv::connectedComponentsWithStats(result, labels, stats, centroids, 8) - 1;
-            spdlog::info("    剩余区域: {}", count);
+            STEP_LOG_DEBUG("    剩余区域: {}", count);
+#endif
         }
 
         return result;
@@ -314,7 +330,7 @@ cv::Mat StepShapeFilter::applyFilterOr(const cv::Mat& regions, const ShapeFilter
         {
             if (!cond.isValid()) continue;
 
-            spdlog::info("  应用条件: {}", cond.toString().toStdString());
+            STEP_LOG_DEBUG("  应用条件: {}", cond.toString().toStdString());
 
             cv::Mat singleResult = OpenCVAlgorithm::selectShapeByFeature(
                 regions,
@@ -323,9 +339,11 @@ cv::Mat StepShapeFilter::applyFilterOr(const cv::Mat& regions, const ShapeFilter
                 cond.maxValue
             );
 
+#ifdef EDGEVISION_STEP_DEBUG_LOG
             cv::Mat labels, stats, centroids;
             int count = cv::connectedComponentsWithStats(singleResult, labels, stats, centroids, 8) - 1;
-            spdlog::info("    该条件匹配区域: {}", count);
+            STEP_LOG_DEBUG("    该条件匹配区域: {}", count);
+#endif
 
             if (!hasResult) {
                 result = singleResult;
@@ -338,78 +356,6 @@ cv::Mat StepShapeFilter::applyFilterOr(const cv::Mat& regions, const ShapeFilter
         return hasResult ? result : cv::Mat();
     }
 
-// ========== 直线检测辅助函数 ==========
-
-static void detectLinesHoughP(const cv::Mat& edges, const PipelineConfig* cfg, std::vector<cv::Vec4f>& lines)
-{
-    if (!cfg || edges.empty()) return;
-    try {
-        std::vector<cv::Vec4i> linesInt;
-        cv::HoughLinesP(edges, linesInt, cfg->lineDetect.rho, cfg->lineDetect.theta,
-                       cfg->lineDetect.threshold, cfg->lineDetect.minLength, cfg->lineDetect.maxGap);
-
-        for (const auto& line : linesInt) {
-            lines.push_back(cv::Vec4f(line[0], line[1], line[2], line[3]));
-        }
-
-        spdlog::debug("[HoughP] 检测到 {} 条直线", lines.size());
-    } catch (const cv::Exception& ex) {
-spdlog::error("HoughP OpenCV错误: {}", ex.what());
-    } catch (...) {
-        spdlog::info("[HoughP] 未知异常");
-    spdlog::error("HoughP 未知异常");
-    }
-}
-
-static void detectLinesLSD(const cv::Mat& src, std::vector<cv::Vec4f>& lines)
-{
-    if (src.empty()) return;
-    try {
-        auto LSDDetector = cv::line_descriptor::LSDDetector::createLSDDetector();
-        std::vector<cv::line_descriptor::KeyLine> keylines;
-        LSDDetector->detect(src, keylines, 2, 1);
-        spdlog::debug("[LSD] 检测到 {} 条直线", keylines.size());
-        for (const auto& kl : keylines)
-        {
-            cv::Point2f p1 = kl.getStartPoint();
-            cv::Point2f p2 = kl.getEndPoint();
-            if (p1 != p2) {
-                lines.push_back(cv::Vec4f(p1.x, p1.y, p2.x, p2.y));
-            }
-        }
-    } catch (const cv::Exception& ex) {
-spdlog::error("LSD OpenCV错误: {}", ex.what());
-    } catch (...) {
-        spdlog::info("[LSD] 未知异常");
-    spdlog::error("LSD 未知异常");
-    }
-}
-
-static void detectLinesEDlines(const cv::Mat& src, std::vector<cv::Vec4f>& lines)
-{
-    if (src.empty()) return;
-    try {
-        auto edDetector = cv::line_descriptor::BinaryDescriptor::createBinaryDescriptor();
-        std::vector<cv::line_descriptor::KeyLine> keylines;
-        edDetector->detect(src, keylines);
-        spdlog::debug("[EDlines] 检测到 {} 条直线", keylines.size());
-
-        for (const auto& kl : keylines)
-        {
-            cv::Point2f p1 = kl.getStartPoint();
-            cv::Point2f p2 = kl.getEndPoint();
-            if (p1 != p2) {
-                lines.push_back(cv::Vec4f(p1.x, p1.y, p2.x, p2.y));
-            }
-        }
-    } catch (const cv::Exception& ex) {
-spdlog::error("EDlines OpenCV错误: {}", ex.what());
-    } catch (...) {
-        spdlog::info("[EDlines] 未知异常");
-    spdlog::error("EDlines 未知异常");
-    }
-}
-
 void StepLineDetector::run(PipelineContext& ctx)
 {
     if (!ctx.config) return;
@@ -439,26 +385,16 @@ void StepLineDetector::runLineDetect(PipelineContext& ctx)
             srcColor = srcVis;
         }
 
-        cv::Mat edges;
-        cv::Canny(srcGray, edges, 50, 150);
-
         std::vector<cv::Vec4f> lines;
+        LineMatchEngine::detectLines(srcGray, ctx.config->lineDetect, lines);
 
-        if (ctx.config->lineDetect.algorithm == 0) {
-            detectLinesHoughP(edges, ctx.config, lines);
-        } else if (ctx.config->lineDetect.algorithm == 1) {
-            detectLinesLSD(srcGray, lines);
-        } else if (ctx.config->lineDetect.algorithm == 2) {
-            detectLinesEDlines(srcGray, lines);
-        }
-
-        ctx.lineDetectImage = srcColor.clone();
-
+        // 底图直接复用（不克隆），检测到的直线以矢量叠加层输出
+        ctx.lineDetectImage = srcColor;
+        ctx.overlay.removeGroup(OverlayGroup::Line);
         for (const auto& line : lines) {
-            cv::line(ctx.lineDetectImage,
-                    cv::Point(line[0], line[1]),
-                    cv::Point(line[2], line[3]),
-                    cv::Scalar(0, 255, 0), 1);
+            ctx.overlay.addLine(OverlayGroup::Line,
+                                QPointF(line[0], line[1]), QPointF(line[2], line[3]),
+                                QColor(0, 255, 0), 1.0);
         }
 
         ctx.totalLineCount = static_cast<int>(lines.size());
@@ -472,71 +408,6 @@ spdlog::error("LineDetector OpenCV错误: {}", ex.what());
     }
 }
 
-// ========== 参考线匹配辅助函数 ==========
-
-static double calculateLineAngle(const cv::Vec4f& line)
-{
-    cv::Point2f p1(line[0], line[1]);
-    cv::Point2f p2(line[2], line[3]);
-    double angle = std::atan2(p2.y - p1.y, p2.x - p1.x) * 180.0 / CV_PI;
-    return angle;
-}
-
-static double pointToLineDistance(const cv::Point2f& point, 
-                                  const cv::Point2f& lineStart, 
-                                  const cv::Point2f& lineEnd)
-{
-    cv::Point2f lineVec = lineEnd - lineStart;
-    cv::Point2f pointVec = point - lineStart;
-    
-    double lineLength = cv::norm(lineVec);
-    if (lineLength < 1e-6) {
-        return cv::norm(pointVec);
-    }
-    
-    double cross = std::abs(lineVec.x * pointVec.y - lineVec.y * pointVec.x);
-    return cross / lineLength;
-}
-
-static double calculateAngleDifference(double angle1, double angle2)
-{
-    double diff = std::abs(angle1 - angle2);
-    if (diff > 180.0) {
-        diff = 360.0 - diff;
-    }
-    return diff;
-}
-
-static bool isLineMatchingReference(const cv::Vec4f& line,
-                                    const cv::Point2f& refStart,
-                                    const cv::Point2f& refEnd,
-                                    double refAngle,
-                                    double angleThreshold,
-                                    double distanceThreshold)
-{
-    double lineAngle = calculateLineAngle(line);
-    double angleDiff = calculateAngleDifference(lineAngle, refAngle);
-    
-    if (angleDiff > angleThreshold) {
-        return false;
-    }
-    
-    cv::Point2f lineMid((line[0] + line[2]) / 2.0f, (line[1] + line[3]) / 2.0f);
-    double dist = pointToLineDistance(lineMid, refStart, refEnd);
-    
-    if (dist > distanceThreshold) {
-        return false;
-    }
-    
-    return true;
-}
-
-static double calculateReferenceLineAngle(const PipelineConfig* cfg)
-{
-    return std::atan2(cfg->lineDetect.referenceLineEnd.y - cfg->lineDetect.referenceLineStart.y,
-                      cfg->lineDetect.referenceLineEnd.x - cfg->lineDetect.referenceLineStart.x) * 180.0 / CV_PI;
-}
-
 void StepLineDetector::runReferenceLineMatch(PipelineContext& ctx)
 {
     if (!ctx.config->lineDetect.enableReferenceLineMatch) {
@@ -558,106 +429,51 @@ void StepLineDetector::runReferenceLineMatch(PipelineContext& ctx)
 
         cv::Point2f refStart = ctx.config->lineDetect.referenceLineStart;
         cv::Point2f refEnd = ctx.config->lineDetect.referenceLineEnd;
-
-        cv::Point2f lineDir = refEnd - refStart;
-        double lineLength = cv::norm(lineDir);
-        if (lineLength < 1e-6) {
+        if (cv::norm(refEnd - refStart) < 1e-6) {
             ctx.reason = "参考线长度太短";
             return;
         }
 
-        cv::Point2f normal(-lineDir.y / lineLength, lineDir.x / lineLength);
-
-        double halfWidth = ctx.config->lineDetect.searchRegionWidth / 2.0;
-        cv::Point2f offset = normal * halfWidth;
-
-        std::vector<cv::Point> searchRegion = {
-            cv::Point(refStart.x + offset.x, refStart.y + offset.y),
-            cv::Point(refEnd.x + offset.x, refEnd.y + offset.y),
-            cv::Point(refEnd.x - offset.x, refEnd.y - offset.y),
-            cv::Point(refStart.x - offset.x, refStart.y - offset.y)
-        };
-
-        cv::Mat regionMask = cv::Mat::zeros(src.size(), CV_8UC1);
-        std::vector<std::vector<cv::Point>> contours = {searchRegion};
-        cv::fillPoly(regionMask, contours, cv::Scalar(255));
-
         cv::Mat gray;
         cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
 
-        cv::Mat maskedGray;
-        gray.copyTo(maskedGray, regionMask);
+        // 只在参考线搜索带内检测，匹配标记随结果返回
+        LineMatchResult match = LineMatchEngine::matchReference(gray, ctx.config->lineDetect);
 
-        cv::Mat edges;
-        cv::Canny(maskedGray, edges, 50, 150);
+        // 底图直接复用（不克隆），参考线/匹配线/其余直线以矢量叠加层输出
+        ctx.lineDetectImage = src;
+        ctx.overlay.removeGroup(OverlayGroup::Line);
 
-        std::vector<cv::Vec4f> allLines;
+        ctx.overlay.addLine(OverlayGroup::Line,
+                            QPointF(refStart.x, refStart.y), QPointF(refEnd.x, refEnd.y),
+                            QColor(255, 255, 0), 4.0);
 
-        if (ctx.config->lineDetect.algorithm == 0) {
-            detectLinesHoughP(edges, ctx.config, allLines);
-        } else if (ctx.config->lineDetect.algorithm == 1) {
-            detectLinesLSD(maskedGray, allLines);
-        } else if (ctx.config->lineDetect.algorithm == 2) {
-            detectLinesEDlines(maskedGray, allLines);
+        for (size_t i = 0; i < match.lines.size(); ++i) {
+            if (!match.matched[i]) continue;
+            const auto& line = match.lines[i];
+            ctx.overlay.addLine(OverlayGroup::Line,
+                                QPointF(line[0], line[1]), QPointF(line[2], line[3]),
+                                QColor(255, 0, 255), 3.0);
         }
 
-        double refAngle = calculateReferenceLineAngle(ctx.config);
-
-        std::vector<cv::Vec4f> matchedLines;
-        for (const auto& line : allLines) {
-            if (isLineMatchingReference(line,
-                                        ctx.config->lineDetect.referenceLineStart,
-                                        ctx.config->lineDetect.referenceLineEnd,
-                                        refAngle,
-                                        ctx.config->lineDetect.angleThreshold,
-                                        ctx.config->lineDetect.distanceThreshold)) {
-                matchedLines.push_back(line);
-            }
-        }
-
-        ctx.lineDetectImage = src.clone();
-
-        cv::line(ctx.lineDetectImage,
-                 ctx.config->lineDetect.referenceLineStart,
-                 ctx.config->lineDetect.referenceLineEnd,
-                 cv::Scalar(0, 255, 255), 4, cv::LINE_AA);
-
-        for (const auto& line : matchedLines) {
-            cv::line(ctx.lineDetectImage,
-                     cv::Point(line[0], line[1]),
-                     cv::Point(line[2], line[3]),
-                     cv::Scalar(255, 0, 255), 3, cv::LINE_AA);
-        }
-
-        for (const auto& line : allLines) {
-            bool isMatched = false;
-            for (const auto& matched : matchedLines) {
-                if (std::abs(line[0] - matched[0]) < 1 &&
-                    std::abs(line[1] - matched[1]) < 1 &&
-                    std::abs(line[2] - matched[2]) < 1 &&
-                    std::abs(line[3] - matched[3]) < 1) {
-                    isMatched = true;
-                    break;
-                }
-            }
-            if (!isMatched) {
-                cv::line(ctx.lineDetectImage,
-                         cv::Point(line[0], line[1]),
-                         cv::Point(line[2], line[3]),
-                         cv::Scalar(0, 255, 0), 1, cv::LINE_AA);
-            }
+        for (size_t i = 0; i < match.lines.size(); ++i) {
+            if (match.matched[i]) continue;
+            const auto& line = match.lines[i];
+            ctx.overlay.addLine(OverlayGroup::Line,
+                                QPointF(line[0], line[1]), QPointF(line[2], line[3]),
+                                QColor(0, 255, 0), 1.0);
         }
 
         ctx.reason = QString("参考线匹配: 找到 %1/%2 条匹配直线 (角度容差:%3°, 距离容差:%4px)")
-                         .arg(matchedLines.size())
-                         .arg(allLines.size())
+                         .arg(match.matchedCount)
+                         .arg(match.lines.size())
                          .arg(ctx.config->lineDetect.angleThreshold)
                          .arg(ctx.config->lineDetect.distanceThreshold);
 
-        ctx.matchedLineCount = static_cast<int>(matchedLines.size());
-        ctx.totalLineCount = static_cast<int>(allLines.size());
+        ctx.matchedLineCount = match.matchedCount;
+        ctx.totalLineCount = static_cast<int>(match.lines.size());
 
-        spdlog::debug("[LineDetector:ReferenceLineMatch] {}", ctx.reason.toStdString());
+        STEP_LOG_DEBUG("[LineDetector:ReferenceLineMatch] {}", ctx.reason.toStdString());
     } catch (const cv::Exception& ex) {
 spdlog::error("LineDetector:ReferenceLineMatch OpenCV错误: {}", ex.what());
         ctx.reason = "参考线匹配失败";
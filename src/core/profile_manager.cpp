@@ -2,9 +2,25 @@
 #include "roi_manager.h"
 #include "core/pipeline_manager.h"
 #include "logger.h"
+#include "utils/benchmark.h"
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QCoreApplication>
+#include <QStandardPaths>
 #include <QDateTime>
+#include <opencv2/imgcodecs.hpp>
+
+namespace {
+constexpr int kCatalogVersion = 2;
+constexpr int kRefreshDebounceMs = 300;
+}
 
 ProfileManager::ProfileManager(RoiManager* roiManager,
                                PipelineManager* pipelineManager,
@@ -12,7 +28,22 @@ ProfileManager::ProfileManager(RoiManager* roiManager,
     : QObject(parent)
     , m_roiManager(roiManager)
     , m_pipelineManager(pipelineManager)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_refreshTimer(new QTimer(this))
 {
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(kRefreshDebounceMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, &ProfileManager::scanProfiles);
+
+    // 目录增删、profile.json 被修改/替换时增量刷新
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString&) {
+        scheduleRefresh();
+    });
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString&) {
+        scheduleRefresh();
+    });
+
+    loadCatalogCache();
     scanProfiles();
 }
 
@@ -33,29 +64,259 @@ void ProfileManager::ensureProfilesDir() const
     }
 }
 
-// ==================== 扫描方案 ====================
+QString ProfileManager::catalogCachePath() const
+{
+    // 放在被监视的 profiles 目录之外：QSaveFile 的临时文件和重命名会触发 directoryChanged
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/profile_catalog.json";
+}
+
+// ==================== 方案目录 ====================
+
+void ProfileManager::loadCatalogCache()
+{
+    // 旧版本缓存在 profiles 目录内，启动时（尚未开始监视）清理掉
+    QFile::remove(profilesDirectory() + "/catalog.json");
+
+    QFile file(catalogCachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root["version"].toInt() != kCatalogVersion
+        || root["profilesDir"].toString() != profilesDirectory()) {
+        return;
+    }
+
+    for (const auto& val : root["entries"].toArray()) {
+        QJsonObject obj = val.toObject();
+        CatalogEntry entry;
+        entry.dirName = obj["dirName"].toString();
+        entry.mtimeMs = obj["mtimeMs"].toInteger();
+        entry.fileSize = obj["fileSize"].toInteger();
+        entry.summary.profileId = obj["profileId"].toString();
+        entry.summary.profileName = obj["profileName"].toString();
+        entry.summary.description = obj["description"].toString();
+        entry.summary.updatedAt = QDateTime::fromString(obj["updatedAt"].toString(), Qt::ISODate);
+        entry.summary.roiCount = obj["roiCount"].toInt();
+        entry.summary.templateCount = obj["templateCount"].toInt();
+        entry.summary.thumbnailPath = obj["thumbnailPath"].toString();
+        if (!entry.dirName.isEmpty() && !entry.summary.profileId.isEmpty()) {
+            m_catalog[entry.summary.profileId] = entry;
+        }
+    }
+}
+
+void ProfileManager::saveCatalogCache() const
+{
+    if (!QDir(profilesDirectory()).exists()) {
+        return;
+    }
+    const QString path = catalogCachePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QJsonArray entries;
+    for (const auto& entry : m_catalog) {
+        QJsonObject obj;
+        obj["dirName"] = entry.dirName;
+        obj["mtimeMs"] = entry.mtimeMs;
+        obj["fileSize"] = entry.fileSize;
+        obj["profileId"] = entry.summary.profileId;
+        obj["profileName"] = entry.summary.profileName;
+        obj["description"] = entry.summary.description;
+        obj["updatedAt"] = entry.summary.updatedAt.toString(Qt::ISODate);
+        obj["roiCount"] = entry.summary.roiCount;
+        obj["templateCount"] = entry.summary.templateCount;
+        obj["thumbnailPath"] = entry.summary.thumbnailPath;
+        entries.append(obj);
+    }
+
+    QJsonObject root;
+    root["version"] = kCatalogVersion;
+    root["profilesDir"] = profilesDirectory();
+    root["entries"] = entries;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
+bool ProfileManager::readCatalogEntry(const QString& dirName, CatalogEntry& entry) const
+{
+    const QString dirPath = profilesDirectory() + "/" + dirName;
+    QFile file(dirPath + "/profile.json");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QJsonParseError err;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+        spdlog::warn("[ProfileManager] profile.json 解析失败: {} ({})", dirPath, err.errorString());
+        return false;
+    }
+
+    // 只取摘要字段，不构造 PipelineConfig，也不加载模板
+    QJsonObject obj = doc.object();
+    QFileInfo info(file);
+    entry.dirName = dirName;
+    entry.mtimeMs = info.lastModified().toMSecsSinceEpoch();
+    entry.fileSize = info.size();
+    entry.summary.profileId = obj["profileId"].toString();
+    entry.summary.profileName = obj["profileName"].toString();
+    entry.summary.description = obj["description"].toString();
+    entry.summary.updatedAt = QDateTime::fromString(obj["updatedAt"].toString(), Qt::ISODate);
+    entry.summary.roiCount = obj["roiTemplates"].toArray().size();
+    entry.summary.templateCount = obj["templates"].toArray().size();
+
+    const QString thumbPath = dirPath + "/thumbnail.png";
+    entry.summary.thumbnailPath = QFileInfo::exists(thumbPath) ? thumbPath : QString();
+
+    return !entry.summary.profileId.isEmpty();
+}
 
 void ProfileManager::scanProfiles()
 {
-    m_profiles.clear();
+    BenchmarkTimer timer("ProfileManager::scanProfiles");
 
     QDir dir(profilesDirectory());
     if (!dir.exists()) {
+        if (!m_catalog.isEmpty()) {
+            m_catalog.clear();
+            m_loaded.clear();
+            emit profileListChanged();
+        }
+        updateWatchedPaths();
         return;
     }
 
-    // 扫描所有子目录
+    // 按目录名索引已有条目
+    QMap<QString, CatalogEntry> byDir;
+    for (const auto& entry : m_catalog) {
+        byDir[entry.dirName] = entry;
+    }
+
+    QMap<QString, CatalogEntry> catalog;
+    int parsed = 0;
+    bool changed = false;
+
     QStringList subDirs = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
     for (const QString& subDir : subDirs) {
-        QString profilePath = profilesDirectory() + "/" + subDir;
-        InspectionProfile profile;
-        if (profile.loadFromDirectory(profilePath)) {
-            m_profiles[profile.profileId] = profile;
+        QFileInfo jsonInfo(profilesDirectory() + "/" + subDir + "/profile.json");
+        if (!jsonInfo.exists()) {
+            continue;
+        }
+
+        auto cached = byDir.constFind(subDir);
+        if (cached != byDir.constEnd()
+            && cached->mtimeMs == jsonInfo.lastModified().toMSecsSinceEpoch()
+            && cached->fileSize == jsonInfo.size()) {
+            catalog[cached->summary.profileId] = *cached;
+            continue;
         }
+
+        CatalogEntry entry;
+        if (readCatalogEntry(subDir, entry)) {
+            catalog[entry.summary.profileId] = entry;
+            // 磁盘上的方案已变化，丢弃旧的完整方案缓存
+            m_loaded.remove(entry.summary.profileId);
+            ++parsed;
+            changed = true;
+        }
+    }
+
+    if (catalog.size() != m_catalog.size()) {
+        changed = true;
+    }
+    for (auto it = m_loaded.begin(); it != m_loaded.end();) {
+        it = catalog.contains(it.key()) ? std::next(it) : m_loaded.erase(it);
+    }
+    if (!m_activeProfileId.isEmpty() && !catalog.contains(m_activeProfileId)) {
+        m_activeProfileId.clear();
+    }
+
+    m_catalog = catalog;
+    updateWatchedPaths();
+
+    if (changed) {
+        saveCatalogCache();
+        emit profileListChanged();
     }
 
     spdlog::info(
-        QString("[ProfileManager] 扫描到 %1 个检测方案").arg(m_profiles.size()));
+        QString("[ProfileManager] 扫描到 %1 个检测方案（重新解析 %2 个）")
+            .arg(m_catalog.size()).arg(parsed));
+}
+
+InspectionProfile* ProfileManager::ensureLoaded(const QString& profileId)
+{
+    auto loaded = m_loaded.find(profileId);
+    if (loaded != m_loaded.end()) {
+        return &loaded.value();
+    }
+
+    auto entry = m_catalog.constFind(profileId);
+    if (entry == m_catalog.constEnd()) {
+        return nullptr;
+    }
+
+    InspectionProfile profile;
+    if (!profile.loadFromDirectory(profilesDirectory() + "/" + entry->dirName, false)) {
+        spdlog::error(
+            QString("[ProfileManager] 方案加载失败: %1").arg(entry->dirName));
+        return nullptr;
+    }
+    return &m_loaded.insert(profileId, profile).value();
+}
+
+bool ProfileManager::persistProfile(InspectionProfile& profile)
+{
+    ensureProfilesDir();
+    if (!profile.saveToDirectory(profilesDirectory())) {
+        return false;
+    }
+
+    CatalogEntry entry;
+    if (readCatalogEntry(profile.profileName, entry)) {
+        m_catalog[profile.profileId] = entry;
+    }
+    saveCatalogCache();
+    updateWatchedPaths();
+    return true;
+}
+
+void ProfileManager::updateWatchedPaths()
+{
+    QStringList wanted;
+    if (QDir(profilesDirectory()).exists()) {
+        wanted.append(profilesDirectory());
+    }
+    for (const auto& entry : m_catalog) {
+        wanted.append(profilesDirectory() + "/" + entry.dirName + "/profile.json");
+    }
+
+    // 原子替换文件（先写临时文件再重命名）后监视会失效，需要重新添加
+    QStringList watched = m_watcher->files() + m_watcher->directories();
+    QStringList stale;
+    for (const QString& path : watched) {
+        if (!wanted.contains(path)) stale.append(path);
+    }
+    if (!stale.isEmpty()) {
+        m_watcher->removePaths(stale);
+    }
+    QStringList missing;
+    for (const QString& path : wanted) {
+        if (!watched.contains(path)) missing.append(path);
+    }
+    if (!missing.isEmpty()) {
+        m_watcher->addPaths(missing);
+    }
+}
+
+void ProfileManager::scheduleRefresh()
+{
+    m_refreshTimer->start();
 }
 
 // ==================== 方案管理 ====================
@@ -76,22 +337,45 @@ bool ProfileManager::saveCurrentAsProfile(const QString& profileName,
     profile.description = description;
 
     // 如果有活跃方案ID，保留ID
-    if (!m_activeProfileId.isEmpty() && m_profiles.contains(m_activeProfileId)) {
-        if (m_profiles[m_activeProfileId].profileName == profileName) {
-            profile.profileId = m_activeProfileId;
+    auto active = m_catalog.constFind(m_activeProfileId);
+    if (active != m_catalog.constEnd() && active->summary.profileName == profileName) {
+        profile.profileId = m_activeProfileId;
+    }
+
+    // 缩略图供方案列表显示，目录扫描时无需解码任何模板
+    if (!currentImage.empty()) {
+        std::vector<uchar> png;
+        if (cv::imencode(".png", profile.generateThumbnail(currentImage), png)) {
+            const QString dirPath = profilesDirectory() + "/" + profileName;
+            QDir().mkpath(dirPath);
+            QSaveFile thumbFile(dirPath + "/thumbnail.png");
+            if (thumbFile.open(QIODevice::WriteOnly)) {
+                thumbFile.write(reinterpret_cast<const char*>(png.data()), static_cast<qint64>(png.size()));
+                thumbFile.commit();
+            }
         }
     }
 
     // 保存到目录
-    ensureProfilesDir();
-    if (!profile.saveToDirectory(profilesDirectory())) {
+    if (!persistProfile(profile)) {
         spdlog::error(
             QString("[ProfileManager] 保存方案失败: %1").arg(profileName));
         return false;
     }
 
+    // 同名覆盖时移除旧ID的目录条目
+    for (auto it = m_catalog.begin(); it != m_catalog.end();) {
+        if (it.key() != profile.profileId && it->dirName == profileName) {
+            m_loaded.remove(it.key());
+            it = m_catalog.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    saveCatalogCache();
+
     // 更新缓存
-    m_profiles[profile.profileId] = profile;
+    m_loaded[profile.profileId] = profile;
     m_activeProfileId = profile.profileId;
 
     spdlog::info(
@@ -107,20 +391,29 @@ bool ProfileManager::saveCurrentAsProfile(const QString& profileName,
 
 bool ProfileManager::loadProfile(const QString& profileId)
 {
-    if (!m_profiles.contains(profileId)) {
+    BenchmarkTimer timer("ProfileManager::loadProfile");
+    InspectionProfile* loaded = ensureLoaded(profileId);
+    if (!loaded) {
         spdlog::error(
             QString("[ProfileManager] 方案不存在: %1").arg(profileId));
         return false;
     }
 
-    const InspectionProfile& profile = m_profiles[profileId];
-
     cv::Mat currentImage = m_roiManager->getFullImage();
     if (currentImage.empty()) {
         spdlog::error("[ProfileManager] 当前无图片，无法应用方案");
         return false;
     }
 
+    // 应用时才加载模板（内存映射，只读取文件头）
+    const QString dirPath = profilesDirectory() + "/" + m_catalog.value(profileId).dirName;
+    for (auto& tpl : loaded->templates) {
+        if (tpl.templateImage.empty()) {
+            tpl.load(dirPath);
+        }
+    }
+
+    const InspectionProfile& profile = *loaded;
     QSize imageSize(currentImage.cols, currentImage.rows);
     m_roiManager->applyProfile(profile, imageSize);
 
@@ -138,15 +431,8 @@ bool ProfileManager::loadProfile(const QString& profileId)
 QList<ProfileManager::ProfileSummary> ProfileManager::getProfileList() const
 {
     QList<ProfileSummary> list;
-    for (auto it = m_profiles.constBegin(); it != m_profiles.constEnd(); ++it) {
-        ProfileSummary summary;
-        summary.profileId = it.value().profileId;
-        summary.profileName = it.value().profileName;
-        summary.description = it.value().description;
-        summary.updatedAt = it.value().updatedAt;
-        summary.roiCount = it.value().roiTemplates.size();
-        summary.templateCount = it.value().templates.size();
-        list.append(summary);
+    for (auto it = m_catalog.constBegin(); it != m_catalog.constEnd(); ++it) {
+        list.append(it.value().summary);
     }
 
     // 按更新时间倒序
@@ -160,12 +446,15 @@ QList<ProfileManager::ProfileSummary> ProfileManager::getProfileList() const
 
 bool ProfileManager::deleteProfile(const QString& profileId)
 {
-    if (!m_profiles.contains(profileId)) {
+    if (!m_catalog.contains(profileId)) {
         return false;
     }
 
-    const InspectionProfile& profile = m_profiles[profileId];
-    QString dirPath = profilesDirectory() + "/" + profile.profileName;
+    const CatalogEntry entry = m_catalog.value(profileId);
+    QString dirPath = profilesDirectory() + "/" + entry.dirName;
+
+    // 先释放模板文件映射，再删除目录
+    m_loaded.remove(profileId);
 
     // 删除目录
     QDir dir(dirPath);
@@ -173,8 +462,10 @@ bool ProfileManager::deleteProfile(const QString& profileId)
         dir.removeRecursively();
     }
 
-    QString name = profile.profileName;
-    m_profiles.remove(profileId);
+    QString name = entry.summary.profileName;
+    m_catalog.remove(profileId);
+    saveCatalogCache();
+    updateWatchedPaths();
 
     if (m_activeProfileId == profileId) {
         m_activeProfileId.clear();
@@ -188,17 +479,17 @@ bool ProfileManager::deleteProfile(const QString& profileId)
     return true;
 }
 
-InspectionProfile ProfileManager::getProfile(const QString& profileId) const
+InspectionProfile ProfileManager::getProfile(const QString& profileId)
 {
-    if (m_profiles.contains(profileId)) {
-        return m_profiles[profileId];
+    if (const InspectionProfile* profile = ensureLoaded(profileId)) {
+        return *profile;
     }
     return InspectionProfile();
 }
 
 void ProfileManager::setActiveProfile(const QString& profileId)
 {
-    if (m_profiles.contains(profileId)) {
+    if (m_catalog.contains(profileId)) {
         m_activeProfileId = profileId;
     }
 }
@@ -211,13 +502,14 @@ bool ProfileManager::saveTemplateToProfile(const QString& profileId,
                                            const QVector<QPointF>& polygonPoints,
                                            int matchMethod)
 {
-    if (!m_profiles.contains(profileId)) {
+    InspectionProfile* loaded = ensureLoaded(profileId);
+    if (!loaded) {
         spdlog::error(
             QString("[ProfileManager] 方案不存在: %1").arg(profileId));
         return false;
     }
 
-    InspectionProfile& profile = m_profiles[profileId];
+    InspectionProfile& profile = *loaded;
 
     TemplateEntry entry(templateName);
     entry.templateImage = templateImage.clone();
@@ -227,14 +519,14 @@ bool ProfileManager::saveTemplateToProfile(const QString& profileId,
     profile.addTemplate(entry);
 
     // 重新保存方案到目录
-    ensureProfilesDir();
-    profile.saveToDirectory(profilesDirectory());
+    persistProfile(profile);
 
     spdlog::info(
         QString("[ProfileManager] 模板已保存: 方案=%1, 模板=%2")
             .arg(profile.profileName).arg(templateName));
 
     emit templateSaved(profileId, templateName);
+    emit profileListChanged();
     return true;
 }
 
@@ -244,11 +536,12 @@ bool ProfileManager::loadTemplateFromProfile(const QString& profileId,
                                              QVector<QPointF>& outPolygonPoints,
                                              int& outMatchMethod)
 {
-    if (!m_profiles.contains(profileId)) {
+    InspectionProfile* loaded = ensureLoaded(profileId);
+    if (!loaded) {
         return false;
     }
 
-    const InspectionProfile& profile = m_profiles[profileId];
+    const InspectionProfile& profile = *loaded;
     const TemplateEntry* entry = profile.findTemplate(templateName);
     if (!entry) {
         spdlog::warn(
@@ -257,9 +550,11 @@ bool ProfileManager::loadTemplateFromProfile(const QString& profileId,
         return false;
     }
 
+    BenchmarkTimer timer("ProfileManager::loadTemplateFromProfile");
+
     // 如果模板图像为空，尝试从文件加载
     if (entry->templateImage.empty()) {
-        QString dirPath = profilesDirectory() + "/" + profile.profileName;
+        QString dirPath = profilesDirectory() + "/" + m_catalog.value(profileId).dirName;
         TemplateEntry* nonConstEntry = const_cast<TemplateEntry*>(entry);
         if (!nonConstEntry->load(dirPath)) {
             spdlog::error(
@@ -274,28 +569,30 @@ bool ProfileManager::loadTemplateFromProfile(const QString& profileId,
     return true;
 }
 
-QStringList ProfileManager::getTemplateNames(const QString& profileId) const
+QStringList ProfileManager::getTemplateNames(const QString& profileId)
 {
-    if (!m_profiles.contains(profileId)) {
+    const InspectionProfile* profile = ensureLoaded(profileId);
+    if (!profile) {
         return {};
     }
-    return m_profiles[profileId].templateNames();
+    return profile->templateNames();
 }
 
 bool ProfileManager::removeTemplateFromProfile(const QString& profileId,
                                                const QString& templateName)
 {
-    if (!m_profiles.contains(profileId)) {
+    InspectionProfile* loaded = ensureLoaded(profileId);
+    if (!loaded) {
         return false;
     }
 
-    InspectionProfile& profile = m_profiles[profileId];
+    InspectionProfile& profile = *loaded;
     if (profile.removeTemplate(templateName)) {
         // 重新保存方案
-        ensureProfilesDir();
-        profile.saveToDirectory(profilesDirectory());
+        persistProfile(profile);
 
         emit templateRemoved(profileId, templateName);
+        emit profileListChanged();
         return true;
     }
     return false;
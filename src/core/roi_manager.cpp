@@ -3,6 +3,7 @@
 #include "image_view.h"
 #include "algorithm/image_utils.h"
 #include "utils/path_utils.h"
+#include "core/metrics.h"
 #include <QStatusBar>
 #include <QDir>
 #include <QFileInfo>
@@ -33,6 +34,7 @@ void RoiManager::setFullImage(const cv::Mat &img, const QString &filePath)
             if (!filePath.isEmpty()) {
                 it.value().filePath = filePath;
             }
+            updateImageMemoryMetric();
         }
     }
 }
@@ -51,6 +53,7 @@ void RoiManager::clear()
     m_imageRoisMap.clear();
     m_currentImageId.clear();
     m_imageCounter = 0;
+    updateImageMemoryMetric();
 }
 
 // ==================== 多图片管理 ====================
@@ -79,6 +82,7 @@ QString RoiManager::addImage(const cv::Mat &img, const QString &name, const QStr
     imageRois.activeRoiId.clear();
 
     m_imageRoisMap.insert(imageId, imageRois);
+    updateImageMemoryMetric();
 
     spdlog::info("[RoiManager] 图片已添加: id={}, name={}, filePath={}", imageId.toStdString(), imageRois.name.toStdString(), filePath.toStdString());
 
@@ -113,6 +117,7 @@ bool RoiManager::removeImage(const QString &imageId)
     }
 
     m_imageRoisMap.remove(imageId);
+    updateImageMemoryMetric();
 
     if (m_currentImageId == imageId) {
         if (!m_imageRoisMap.isEmpty()) {
@@ -229,35 +234,40 @@ QStringList RoiManager::importImagesFromFolder(const QString& dirPath, const QSt
 // ==================== 单ROI模式（基于 RoiConfig）====================
 
 cv::Mat RoiManager::getCurrentImage() const
+{
+    return getCurrentFrame().mat();
+}
+
+FrameView RoiManager::getCurrentFrame() const
 {
     auto it = m_imageRoisMap.find(m_currentImageId);
     if (it == m_imageRoisMap.end()) {
-        return cv::Mat();
+        return FrameView();
     }
 
     const ImageRois& imageRois = it.value();
     if (imageRois.image.empty()) {
-        return cv::Mat();
+        return FrameView();
     }
 
     // 没有激活的ROI，返回完整图像
     if (imageRois.activeRoiId.isEmpty()) {
-        return imageRois.image;
+        return FrameView(imageRois.image);
     }
 
-    // 查找激活的ROI配置并裁剪
+    // 查找激活的ROI配置，返回子视图（图像只会被整体替换，不会原地改写，无需拷贝）
     for (const auto& cfg : imageRois.roiConfigs) {
         if (cfg.roiId == imageRois.activeRoiId) {
             cv::Rect r = ImageUtils::mapRoiToCvRect(cfg.roiRect, imageRois.image.cols, imageRois.image.rows);
             if (!r.empty()) {
-                return imageRois.image(r).clone();
+                return FrameView(imageRois.image, r);
             }
             break;
         }
     }
 
     // 激活的ROI无效，返回完整图像
-    return imageRois.image;
+    return FrameView(imageRois.image);
 }
 
 bool RoiManager::setRoi(const QRectF &roiRectF)
@@ -587,6 +597,18 @@ QString RoiManager::generateDefaultImageName()
     return QString("图片_%1").arg(m_imageCounter + 1);
 }
 
+void RoiManager::updateImageMemoryMetric() const
+{
+    static MetricGauge& gauge = MetricsRegistry::instance().gauge(
+        "edgevision_subsystem_bytes", "各子系统在内存中保留的数据量（字节）", {{"subsystem", "roi_images"}});
+
+    double bytes = 0.0;
+    for (const ImageRois& imageRois : m_imageRoisMap) {
+        bytes += static_cast<double>(imageRois.image.total() * imageRois.image.elemSize());
+    }
+    gauge.set(bytes);
+}
+
 // ==================== 检测方案支持 ====================
 
 InspectionProfile RoiManager::exportAsProfile(const QString& profileName, const QSize& refImageSize) const
@@ -0,0 +1,358 @@
+﻿#include "core/session_recorder.h"
+#include "core/metrics.h"
+#include "logger.h"
+#include "utils/thread_tag.h"
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonValue>
+#include <QSet>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <opencv2/imgcodecs.hpp>
+#include <chrono>
+
+namespace {
+
+using RecordType = SessionFile::RecordType;
+
+struct RecorderMetrics
+{
+    MetricCounter& frames = MetricsRegistry::instance().counter(
+        "edgevision_session_frames_total", "会话录制写入的 Pipeline 输入帧数");
+    MetricCounter& dropped = MetricsRegistry::instance().counter(
+        "edgevision_session_dropped_frames_total", "会话录制因压缩积压丢弃的帧数");
+    MetricGauge& bytes = MetricsRegistry::instance().gauge(
+        "edgevision_session_bytes", "当前录制文件大小（字节）");
+};
+
+RecorderMetrics& recorderMetrics()
+{
+    static RecorderMetrics metrics;
+    return metrics;
+}
+
+qint64 steadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+SessionRecorder& SessionRecorder::instance()
+{
+    static SessionRecorder recorder;
+    return recorder;
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    stop();
+}
+
+QString SessionRecorder::originName(Origin origin)
+{
+    switch (origin) {
+    case Origin::Live: return "live";
+    case Origin::Batch: return "batch";
+    default: return "interactive";
+    }
+}
+
+SessionRecorder::Origin SessionRecorder::originFromName(const QString& name)
+{
+    if (name == "live") return Origin::Live;
+    if (name == "batch") return Origin::Batch;
+    return Origin::Interactive;
+}
+
+QString SessionRecorder::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/sessions/session_" +
+           QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + '.' + SessionFile::kSuffix;
+}
+
+QString SessionRecorder::path() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_path;
+}
+
+qint64 SessionRecorder::elapsedNs() const
+{
+    return steadyNs() - m_startNs;
+}
+
+bool SessionRecorder::start(const QString& path, const Options& options)
+{
+    stop();
+    if (!m_writer.open(path)) return false;
+
+    QCborMap meta;
+    meta[QStringLiteral("startedAt")] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    meta[QStringLiteral("host")] = QSysInfo::machineHostName();
+    meta[QStringLiteral("app")] = QCoreApplication::applicationVersion();
+    meta[QStringLiteral("imageFormat")] = options.imageFormat;
+    m_writer.append(RecordType::Meta, 0, meta.toCborValue().toCbor());
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_options = options;
+        m_path = path;
+        m_startNs = steadyNs();
+        m_jobs.clear();
+        m_pendingImages = 0;
+        m_stopping = false;
+        m_configIds.clear();
+        m_lastSource.release();
+        m_lastImageId = 0;
+        m_nextImageId = 1;
+        m_frames = m_commands = m_dropped = 0;
+    }
+    m_thread = std::thread(&SessionRecorder::run, this);
+    m_recording.store(true, std::memory_order_release);
+    spdlog::info("[SessionRecorder] 开始录制: {}", path);
+    return true;
+}
+
+void SessionRecorder::stop()
+{
+    if (!m_thread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_recording.store(false, std::memory_order_release);
+        if (!m_stopping) {      // 达到上限时 record 线程已自行停止
+            m_stopping = true;
+            discardPendingImagesLocked();
+        }
+    }
+    m_cv.notify_all();
+    // 队列中只剩已编码的记录，record 线程写完结束标记后退出；至多等待正在压缩的一帧
+    m_thread.join();
+}
+
+void SessionRecorder::discardPendingImagesLocked()
+{
+    // Frame 总排在所引用的 Image 之后，一次遍历即可找出引用被丢弃图像的帧
+    QSet<int> droppedImages;
+    int droppedFrames = 0;
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        const auto type = static_cast<RecordType>(it->type);
+        if (type == RecordType::Image) {
+            droppedImages.insert(it->imageId);
+            it = m_jobs.erase(it);
+        } else if (type == RecordType::Frame && droppedImages.contains(it->imageId)) {
+            ++droppedFrames;
+            it = m_jobs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_pendingImages -= static_cast<int>(droppedImages.size());
+    m_frames -= droppedFrames;
+    m_dropped += droppedFrames;
+    recorderMetrics().dropped.inc(static_cast<uint64_t>(droppedFrames));
+}
+
+bool SessionRecorder::limitReached(QString* reason) const
+{
+    if (m_options.maxBytes > 0 && m_writer.bytesWritten() >= m_options.maxBytes) {
+        *reason = QString("文件大小达到上限 %1 MB").arg(m_options.maxBytes / (1024.0 * 1024.0), 0, 'f', 1);
+        return true;
+    }
+    if (m_options.maxDurationSec > 0 && elapsedNs() >= m_options.maxDurationSec * 1000000000LL) {
+        *reason = QString("录制时长达到上限 %1 秒").arg(m_options.maxDurationSec);
+        return true;
+    }
+    return false;
+}
+
+int SessionRecorder::configIdLocked(const QByteArray& encoded, qint64 timeNs)
+{
+    const QByteArray key = QCryptographicHash::hash(encoded, QCryptographicHash::Sha1);
+    auto it = m_configIds.constFind(key);
+    if (it != m_configIds.constEnd()) return it.value();
+
+    const int id = m_configIds.size() + 1;
+    m_configIds.insert(key, id);
+
+    QCborMap map = QCborValue::fromCbor(encoded).toMap();
+    map[QStringLiteral("id")] = id;
+    Job job;
+    job.type = static_cast<int>(RecordType::Config);
+    job.timeNs = timeNs;
+    job.payload = map.toCborValue().toCbor();
+    enqueueLocked(std::move(job));
+    return id;
+}
+
+void SessionRecorder::enqueueLocked(Job&& job)
+{
+    m_jobs.push_back(std::move(job));
+    m_cv.notify_one();
+}
+
+void SessionRecorder::recordFrame(Origin origin, const QString& source, const FrameView& frame,
+                                  const PipelineConfig& config, const RoiConfig* roi)
+{
+    if (!isRecording() || frame.empty()) return;
+
+    const qint64 timeNs = elapsedNs();
+
+    // 配置在调用线程序列化（去重键），ROI 快照去掉与 pipeline 重复的配置
+    QCborMap configMap;
+    configMap[QStringLiteral("pipeline")] = QCborValue::fromJsonValue(config.toJson());
+    if (roi) {
+        QJsonObject roiJson = roi->toJson();
+        roiJson.remove("pipelineConfig");
+        configMap[QStringLiteral("roi")] = QCborValue::fromJsonValue(roiJson);
+    }
+    const QByteArray encodedConfig = configMap.toCborValue().toCbor();
+
+    const cv::Mat& sourceImage = frame.source().empty() ? frame.mat() : frame.source();
+    const cv::Rect rect = frame.source().empty() ? cv::Rect(0, 0, frame.mat().cols, frame.mat().rows)
+                                                 : frame.roi();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping) return;
+
+    // 同一源图缓冲（多 ROI、参数调整后重新提交）只写一次图像；
+    // 持有 m_lastSource 引用期间该缓冲不会被释放复用，数据指针相同即像素相同
+    int imageId = m_lastImageId;
+    if (m_lastSource.empty() || sourceImage.data != m_lastSource.data ||
+        sourceImage.size() != m_lastSource.size() || sourceImage.type() != m_lastSource.type()) {
+        if (m_pendingImages >= m_options.maxPendingFrames) {
+            ++m_dropped;
+            recorderMetrics().dropped.inc();
+            return;
+        }
+        imageId = m_nextImageId++;
+        m_lastSource = sourceImage;
+        m_lastImageId = imageId;
+
+        Job job;
+        job.type = static_cast<int>(RecordType::Image);
+        job.timeNs = timeNs;
+        job.image = sourceImage;
+        job.imageId = imageId;
+        ++m_pendingImages;
+        enqueueLocked(std::move(job));
+    }
+
+    QCborMap map;
+    map[QStringLiteral("image")] = imageId;
+    map[QStringLiteral("config")] = configIdLocked(encodedConfig, timeNs);
+    map[QStringLiteral("roi")] = QCborArray{rect.x, rect.y, rect.width, rect.height};
+    map[QStringLiteral("origin")] = originName(origin);
+    map[QStringLiteral("source")] = source;
+    if (roi) map[QStringLiteral("roiId")] = roi->roiId;
+
+    Job job;
+    job.type = static_cast<int>(RecordType::Frame);
+    job.timeNs = timeNs;
+    job.payload = map.toCborValue().toCbor();
+    job.imageId = imageId;
+    enqueueLocked(std::move(job));
+
+    ++m_frames;
+    recorderMetrics().frames.inc();
+}
+
+void SessionRecorder::recordCommand(const QJsonObject& command)
+{
+    if (!isRecording()) return;
+
+    Job job;
+    job.type = static_cast<int>(RecordType::Command);
+    job.timeNs = elapsedNs();
+    job.payload = QCborValue::fromJsonValue(command).toCbor();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping) return;
+    ++m_commands;
+    enqueueLocked(std::move(job));
+}
+
+void SessionRecorder::run()
+{
+    ThreadTag::setCurrent("record");
+
+    std::vector<int> params;
+    const bool png = m_options.imageFormat == "png";
+    const std::string ext = png ? ".png" : ".jpg";
+    if (png) params = {cv::IMWRITE_PNG_COMPRESSION, 1};
+    else params = {cv::IMWRITE_JPEG_QUALITY, m_options.jpegQuality};
+    std::vector<uchar> encoded;
+    const auto deadline = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(m_startNs)) +
+                          std::chrono::seconds(m_options.maxDurationSec);
+
+    for (;;) {
+        Job job;
+        QString limitReason;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            const auto ready = [this] { return m_stopping || !m_jobs.empty(); };
+            if (m_options.maxDurationSec > 0) m_cv.wait_until(lock, deadline, ready);
+            else m_cv.wait(lock, ready);
+
+            // 达到上限：不再接受新帧，丢弃未压缩的图像，写完已就绪的记录后结束（不能在本线程 join）
+            if (!m_stopping && limitReached(&limitReason)) {
+                m_recording.store(false, std::memory_order_release);
+                m_stopping = true;
+                discardPendingImagesLocked();
+            }
+            if (m_jobs.empty() && !m_stopping) continue;
+            if (!m_jobs.empty()) {
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+        }
+        if (!limitReason.isEmpty()) spdlog::info("[SessionRecorder] {}，自动停止录制", limitReason);
+        if (job.type == 0) break;       // 停止且已写完
+
+        const auto type = static_cast<RecordType>(job.type);
+        if (type == RecordType::Image) {
+            QCborMap map;
+            map[QStringLiteral("id")] = job.imageId;
+            map[QStringLiteral("format")] = m_options.imageFormat;
+            try {
+                cv::imencode(ext, job.image, encoded, params);
+                map[QStringLiteral("data")] = QByteArray(reinterpret_cast<const char*>(encoded.data()),
+                                                         static_cast<qsizetype>(encoded.size()));
+            } catch (const cv::Exception& e) {
+                spdlog::error("[SessionRecorder] 图像压缩失败: {}", e.what());
+            }
+            job.image.release();
+            job.payload = map.toCborValue().toCbor();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_pendingImages;
+        }
+
+        m_writer.append(type, job.timeNs, job.payload);
+        recorderMetrics().bytes.set(static_cast<double>(m_writer.bytesWritten()));
+    }
+
+    QCborMap summary;
+    int frames = 0, commands = 0, dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        frames = m_frames;
+        commands = m_commands;
+        dropped = m_dropped;
+        m_lastSource.release();
+    }
+    summary[QStringLiteral("frames")] = frames;
+    summary[QStringLiteral("commands")] = commands;
+    summary[QStringLiteral("dropped")] = dropped;
+    m_writer.append(RecordType::End, elapsedNs(), summary.toCborValue().toCbor());
+    const qint64 bytes = m_writer.bytesWritten();
+    m_writer.close();
+
+    spdlog::info("[SessionRecorder] 录制结束: {}（{} 帧，{} 条指令，丢弃 {} 帧，{:.1f} MB）",
+                 m_path, frames, commands, dropped, bytes / (1024.0 * 1024.0));
+}
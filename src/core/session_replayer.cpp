@@ -0,0 +1,398 @@
+﻿#include "core/session_replayer.h"
+#include "core/pipeline_manager.h"
+#include "core/pipeline_result.h"
+#include "core/pipeline_scheduler.h"
+#include "logger.h"
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborStreamReader>
+#include <QCborValue>
+#include <QtConcurrent/QtConcurrent>
+#include <opencv2/imgcodecs.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using RecordType = SessionFile::RecordType;
+
+constexpr int kDrainPollMs = 50;
+constexpr qint64 kImageHeadBytes = 64;  ///< Image 负载中 id/format 位于图像数据之前
+
+/// 从 Image 负载开头解析 "id"（流式读取，不读入图像数据），失败返回 0
+int imageRecordId(const QByteArray& head)
+{
+    QCborStreamReader reader(head);
+    if (!reader.isMap() || !reader.enterContainer()) return 0;
+    while (reader.hasNext()) {
+        if (!reader.isString()) return 0;
+        QString key;
+        auto chunk = reader.readString();
+        while (chunk.status == QCborStreamReader::Ok) {
+            key += chunk.data;
+            chunk = reader.readString();
+        }
+        if (chunk.status == QCborStreamReader::Error) return 0;
+        if (key == QLatin1String("id")) {
+            return reader.isInteger() ? static_cast<int>(reader.toInteger()) : 0;
+        }
+        if (!reader.next()) return 0;   // 跳过其他字段的值
+    }
+    return 0;
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    const size_t idx = static_cast<size_t>(std::ceil(p * values.size())) - 1;
+    return values[std::min(idx, values.size() - 1)];
+}
+
+cv::Mat decodeImage(const QByteArray& payload)
+{
+    const QByteArray data = QCborValue::fromCbor(payload).toMap().value(QStringLiteral("data")).toByteArray();
+    if (data.isEmpty()) return {};
+    try {
+        const cv::Mat encoded(1, static_cast<int>(data.size()), CV_8UC1, const_cast<char*>(data.constData()));
+        return cv::imdecode(encoded, cv::IMREAD_UNCHANGED);
+    } catch (const cv::Exception& e) {
+        spdlog::error("[SessionReplayer] 图像解码失败: {}", e.what());
+        return {};
+    }
+}
+
+} // namespace
+
+QJsonObject SessionReplayer::Report::toJson() const
+{
+    QJsonObject obj;
+    obj["frames"] = frames;
+    obj["submitted"] = submitted;
+    obj["completed"] = completed;
+    obj["failed"] = failed;
+    obj["skipped"] = skipped;
+    obj["commands"] = commands;
+    obj["wallMs"] = wallMs;
+    obj["throughputFps"] = throughputFps;
+    obj["meanMs"] = meanMs;
+    obj["p50Ms"] = p50Ms;
+    obj["p95Ms"] = p95Ms;
+    obj["latencyP50Ms"] = latencyP50Ms;
+    obj["latencyP95Ms"] = latencyP95Ms;
+    obj["maxLagMs"] = maxLagMs;
+    return obj;
+}
+
+SessionReplayer::SessionReplayer(PipelineManager* pipeline, QObject* parent)
+    : QObject(parent)
+    , m_pipeline(pipeline)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &SessionReplayer::step);
+
+    m_drainTimer.setInterval(kDrainPollMs);
+    connect(&m_drainTimer, &QTimer::timeout, this, &SessionReplayer::checkDrained);
+
+    connect(m_pipeline->scheduler(), &PipelineScheduler::finished,
+            this, &SessionReplayer::onPipelineFinished);
+}
+
+SessionReplayer::~SessionReplayer()
+{
+    stop();
+}
+
+bool SessionReplayer::open(const QString& path)
+{
+    stop();
+    m_events.clear();
+    m_configs.clear();
+    m_imageRecords.clear();
+    m_frameCount = 0;
+    m_cachedImageId = 0;
+    m_cachedImage.release();
+    m_prefetchId = 0;
+
+    if (!m_reader.open(path)) return false;
+
+    const QVector<SessionFile::RecordInfo>& records = m_reader.records();
+    for (int i = 0; i < records.size(); ++i) {
+        const SessionFile::RecordInfo& record = records[i];
+        switch (record.type) {
+        case RecordType::Config: {
+            const QCborMap map = m_reader.map(record);
+            PipelineConfig config;
+            config.fromJson(map.value(QStringLiteral("pipeline")).toJsonValue().toObject());
+            m_configs.insert(static_cast<int>(map.value(QStringLiteral("id")).toInteger()), config);
+            break;
+        }
+        case RecordType::Image: {
+            // 按记录内的编号建索引（Frame 按该编号引用），图像负载按需读取
+            const int imageId = imageRecordId(m_reader.payloadHead(record, kImageHeadBytes));
+            if (imageId <= 0 || m_imageRecords.contains(imageId)) {
+                spdlog::error("[SessionReplayer] {}: 第 {} 条记录的图像编号无效或重复: {}", path, i, imageId);
+                m_events.clear();
+                m_frameCount = 0;
+                m_reader.close();
+                return false;
+            }
+            m_imageRecords.insert(imageId, i);
+            break;
+        }
+        case RecordType::Frame: {
+            const QCborMap map = m_reader.map(record);
+            const QCborArray roi = map.value(QStringLiteral("roi")).toArray();
+            Event event;
+            event.type = RecordType::Frame;
+            event.timeNs = record.timeNs;
+            event.imageId = static_cast<int>(map.value(QStringLiteral("image")).toInteger());
+            event.configId = static_cast<int>(map.value(QStringLiteral("config")).toInteger());
+            if (roi.size() == 4) {
+                event.roi = cv::Rect(static_cast<int>(roi[0].toInteger()), static_cast<int>(roi[1].toInteger()),
+                                     static_cast<int>(roi[2].toInteger()), static_cast<int>(roi[3].toInteger()));
+            }
+            event.origin = SessionRecorder::originFromName(map.value(QStringLiteral("origin")).toString());
+            event.source = map.value(QStringLiteral("source")).toString();
+            event.roiId = map.value(QStringLiteral("roiId")).toString();
+            m_events.append(event);
+            ++m_frameCount;
+            break;
+        }
+        case RecordType::Command: {
+            Event event;
+            event.type = RecordType::Command;
+            event.timeNs = record.timeNs;
+            event.record = i;
+            m_events.append(event);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    for (const Event& event : m_events) {
+        if (event.type == RecordType::Frame && !m_imageRecords.contains(event.imageId)) {
+            spdlog::error("[SessionReplayer] {}: 帧引用了不存在的图像 {}（{} ms）",
+                          path, event.imageId, event.timeNs / 1000000);
+            m_events.clear();
+            m_frameCount = 0;
+            m_reader.close();
+            return false;
+        }
+    }
+
+    // 各线程录制的时刻在入队前取得，文件中可能有微小乱序
+    std::stable_sort(m_events.begin(), m_events.end(),
+                     [](const Event& a, const Event& b) { return a.timeNs < b.timeNs; });
+
+    spdlog::info("[SessionReplayer] {}: {} 帧，{} 个配置快照，{} 张图像，时长 {:.1f} s",
+                 path, m_frameCount, m_configs.size(), m_imageRecords.size(), durationMs() / 1000.0);
+    return true;
+}
+
+double SessionReplayer::durationMs() const
+{
+    return m_events.isEmpty() ? 0.0 : m_events.last().timeNs / 1e6;
+}
+
+void SessionReplayer::start(Pace pace)
+{
+    if (m_running || m_events.isEmpty()) return;
+
+    m_pace = pace;
+    m_report = Report{};
+    m_report.frames = m_frameCount;
+    m_pipelineMs.clear();
+    m_latencyMs.clear();
+    m_inflight.clear();
+    m_next = 0;
+    m_appliedConfigId = 0;
+    m_waitingId = -1;
+
+    if (m_pace == Pace::Fast) {
+        // 闭环提交，每次只有一个请求，消抖只会白白增加延迟
+        m_savedDebounceMs = m_pipeline->scheduler()->debounceMs();
+        m_pipeline->scheduler()->setDebounceMs(0);
+    }
+
+    m_running = true;
+    m_clock.start();
+    m_drainTimer.start();
+    prefetchAfter(-1);
+    step();
+}
+
+void SessionReplayer::stop()
+{
+    if (!m_running) return;
+    for (auto it = m_inflight.cbegin(); it != m_inflight.cend(); ++it) {
+        m_pipeline->scheduler()->cancel(it.key());
+    }
+    m_inflight.clear();
+    finish();
+}
+
+void SessionReplayer::step()
+{
+    while (m_running && m_next < m_events.size()) {
+        const Event& event = m_events[m_next];
+        if (m_pace == Pace::Original) {
+            const double dueMs = event.timeNs / 1e6;
+            const double nowMs = m_clock.nsecsElapsed() / 1e6;
+            if (dueMs > nowMs) {
+                m_timer.start(static_cast<int>(std::ceil(dueMs - nowMs)));
+                return;
+            }
+            m_report.maxLagMs = std::max(m_report.maxLagMs, nowMs - dueMs);
+        } else if (m_waitingId >= 0) {
+            return;     // 等待上一帧结果
+        }
+
+        const int index = m_next++;
+        if (event.type == RecordType::Command) {
+            ++m_report.commands;
+            const QByteArray payload = m_reader.payload(m_reader.records()[event.record]);
+            emit commandReplayed(QCborValue::fromCbor(payload).toMap().toJsonObject());
+            continue;
+        }
+
+        dispatchFrame(event);
+        prefetchAfter(index);
+        emit progress(m_report.submitted + m_report.skipped, m_frameCount);
+    }
+}
+
+void SessionReplayer::dispatchFrame(const Event& event)
+{
+    auto config = m_configs.constFind(event.configId);
+    const cv::Mat image = imageFor(event.imageId);
+    if (config == m_configs.constEnd() || image.empty()) {
+        spdlog::warn("[SessionReplayer] 帧缺少图像 {} 或配置 {}，跳过", event.imageId, event.configId);
+        ++m_report.skipped;
+        return;
+    }
+
+    // 界面提交的帧对应 PipelineManager 当前配置：配置切换时同步重建步骤（与生产时界面操作一致）；
+    // 批量检测只按 ROI 配置执行，不改动当前配置
+    if (event.origin != SessionRecorder::Origin::Batch && event.configId != m_appliedConfigId) {
+        m_pipeline->setConfig(config.value());
+        m_pipeline->rebuildPipeline();
+        m_appliedConfigId = event.configId;
+    }
+
+    const FrameView frame = event.roi.empty() ? FrameView(image) : FrameView(image, event.roi);
+    PipelineScheduler* scheduler = m_pipeline->scheduler();
+    const qint64 submittedAt = m_clock.nsecsElapsed();
+    const qint64 requestId = (m_pace == Pace::Original && event.origin == SessionRecorder::Origin::Live)
+        ? scheduler->submitLatest(event.source, frame, config.value(), "SessionReplayer", event.roiId)
+        : scheduler->submit(frame, config.value(), 0, "SessionReplayer", event.roiId);
+    if (requestId < 0) {
+        ++m_report.skipped;     // 变化门控判定无变化
+        return;
+    }
+
+    ++m_report.submitted;
+    m_inflight.insert(requestId, submittedAt);
+    if (m_pace == Pace::Fast) m_waitingId = requestId;
+}
+
+void SessionReplayer::onPipelineFinished(const PipelineResult& result)
+{
+    if (!m_running) return;
+    auto it = m_inflight.find(result.requestId());
+    if (it == m_inflight.end()) return;
+
+    m_latencyMs.push_back((m_clock.nsecsElapsed() - it.value()) / 1e6);
+    m_inflight.erase(it);
+    m_pipelineMs.push_back(result.elapsedMs());
+    ++m_report.completed;
+    if (!result.isSuccess()) ++m_report.failed;
+
+    if (result.requestId() == m_waitingId) {
+        m_waitingId = -1;
+        QTimer::singleShot(0, this, &SessionReplayer::step);
+    }
+}
+
+void SessionReplayer::checkDrained()
+{
+    const PipelineScheduler* scheduler = m_pipeline->scheduler();
+    if (!m_running || scheduler->pendingCount() > 0 || scheduler->isProcessing()) return;
+
+    // 调度器已空闲仍未返回的请求：在流式槽中被新帧覆盖或被取消，不会再有结果
+    if (!m_inflight.isEmpty()) {
+        m_report.skipped += m_inflight.size();
+        m_inflight.clear();
+    }
+    if (m_waitingId >= 0) {
+        m_waitingId = -1;
+        step();
+        return;
+    }
+    if (m_next >= m_events.size()) finish();
+}
+
+void SessionReplayer::finish()
+{
+    m_running = false;
+    m_timer.stop();
+    m_drainTimer.stop();
+    if (m_savedDebounceMs >= 0) {
+        m_pipeline->scheduler()->setDebounceMs(m_savedDebounceMs);
+        m_savedDebounceMs = -1;
+    }
+
+    m_report.wallMs = m_clock.nsecsElapsed() / 1e6;
+    m_report.throughputFps = m_report.wallMs > 0 ? m_report.completed * 1000.0 / m_report.wallMs : 0.0;
+    double total = 0;
+    for (double v : m_pipelineMs) total += v;
+    m_report.meanMs = m_pipelineMs.empty() ? 0.0 : total / m_pipelineMs.size();
+    m_report.p50Ms = percentile(m_pipelineMs, 0.50);
+    m_report.p95Ms = percentile(m_pipelineMs, 0.95);
+    m_report.latencyP50Ms = percentile(m_latencyMs, 0.50);
+    m_report.latencyP95Ms = percentile(m_latencyMs, 0.95);
+
+    spdlog::info("[BENCH] SessionReplay {}: frames={} completed={} failed={} skipped={} commands={} "
+                 "wall={:.0f}ms throughput={:.1f}fps pipeline mean={:.2f}ms p50={:.2f}ms p95={:.2f}ms "
+                 "latency p50={:.2f}ms p95={:.2f}ms maxLag={:.1f}ms",
+                 m_pace == Pace::Fast ? "fast" : "original", m_report.frames, m_report.completed,
+                 m_report.failed, m_report.skipped, m_report.commands, m_report.wallMs,
+                 m_report.throughputFps, m_report.meanMs, m_report.p50Ms, m_report.p95Ms,
+                 m_report.latencyP50Ms, m_report.latencyP95Ms, m_report.maxLagMs);
+    emit replayFinished(m_report);
+}
+
+cv::Mat SessionReplayer::imageFor(int imageId)
+{
+    if (imageId == m_cachedImageId) return m_cachedImage;
+
+    cv::Mat image;
+    if (imageId == m_prefetchId) {
+        image = m_prefetch.result();
+        m_prefetchId = 0;
+    } else if (m_imageRecords.contains(imageId)) {
+        image = decodeImage(m_reader.payload(m_reader.records()[m_imageRecords.value(imageId)]));
+    }
+    m_cachedImageId = imageId;
+    m_cachedImage = image;
+    return image;
+}
+
+void SessionReplayer::prefetchAfter(int index)
+{
+    const int current = index >= 0 ? m_events[index].imageId : 0;
+    for (int i = index + 1; i < m_events.size(); ++i) {
+        const Event& event = m_events[i];
+        if (event.type != RecordType::Frame || event.imageId == current) continue;
+        if (event.imageId == m_prefetchId || !m_imageRecords.contains(event.imageId)) return;
+
+        // 文件读取留在 GUI 线程（Reader 非线程安全），只把解码放到后台
+        const QByteArray payload = m_reader.payload(m_reader.records()[m_imageRecords.value(event.imageId)]);
+        m_prefetch = QtConcurrent::run([payload]() { return decodeImage(payload); });
+        m_prefetchId = event.imageId;
+        return;
+    }
+}
@@ -1,8 +1,31 @@
 ﻿#include "video_manager.h"
 #include "logger.h"
+#include "core/metrics.h"
+#include "utils/thread_tag.h"
 #include <QFileInfo>
 #include <chrono>
 
+namespace {
+
+struct VideoMetrics {
+    MetricCounter& frames = MetricsRegistry::instance().counter(
+        "edgevision_video_frames_total", "播放/采集读取到的视频帧总数");
+    MetricCounter& readFailures = MetricsRegistry::instance().counter(
+        "edgevision_video_read_failures_total", "视频帧读取失败次数（含 OpenCV 异常）");
+    MetricGauge& fps = MetricsRegistry::instance().gauge(
+        "edgevision_video_fps", "最近 10 秒的平均读帧速率");
+
+    VideoMetrics() { MetricsRegistry::instance().trackRate(frames, fps); }
+};
+
+VideoMetrics& videoMetrics()
+{
+    static VideoMetrics metrics;
+    return metrics;
+}
+
+} // namespace
+
 VideoManager::VideoManager(QObject* parent)
     : QObject(parent)
     , m_sourceType(VideoSource::None)
@@ -14,6 +37,8 @@ VideoManager::VideoManager(QObject* parent)
 {
     m_timer = new QTimer(this);
     connect(m_timer, &QTimer::timeout, this, &VideoManager::onTimeout);
+
+    videoMetrics();  // 提前注册，未播放时端点也能看到 0 值
 }
 
 VideoManager::~VideoManager()
@@ -52,6 +77,7 @@ bool VideoManager::openFile(const QString& filePath)
 
     // 先关闭当前视频
     close();
+    emit aboutToOpenCamera(cameraIndex);
 
     try {
 
@@ -60,7 +86,10 @@ bool VideoManager::openFile(const QString& filePath)
     std::string stdPath = filePath.toLocal8Bit().constData();
     spdlog::info(QString("转换后的标准路径: %1").arg(QString::fromLocal8Bit(stdPath.c_str())));
     
-    m_videoCapture.open(stdPath);
+    {
+        ThreadTag::ScopedSpawn tag("capture");  // 解码后端线程归入 capture
+        m_videoCapture.open(stdPath);
+    }
     
     spdlog::info(QString("OpenCV打开结果: %1").arg(m_videoCapture.isOpened() ? "成功" : "失败"));
     
@@ -121,6 +150,7 @@ bool VideoManager::openCamera(int cameraIndex)
 
     // 打开相机 - 使用DirectShow后端避免MSMF兼容性问题
     spdlog::info(QString("尝试打开相机设备: %1 (使用DirectShow后端)").arg(cameraIndex));
+    ThreadTag::ScopedSpawn tag("capture");  // 采集后端线程归入 capture
     auto startTime = std::chrono::steady_clock::now();
     m_videoCapture.open(cameraIndex, cv::CAP_DSHOW);
     auto endTime = std::chrono::steady_clock::now();
@@ -280,11 +310,9 @@ cv::Mat VideoManager::getNextFrame()
             stop();
         }
     } catch (const cv::Exception& ex) {
-        QString msg = QString("读取下一帧OpenCV错误: %1").arg(ex.what());
-        spdlog::error(msg);
+        LOG_THROTTLED(spdlog::level::err, 5000, QString("读取下一帧OpenCV错误: %1").arg(ex.what()));
     } catch (const std::exception& ex) {
-        QString msg = QString("读取下一帧异常: %1").arg(ex.what());
-        spdlog::error(msg);
+        LOG_THROTTLED(spdlog::level::err, 5000, QString("读取下一帧异常: %1").arg(ex.what()));
     }
 
     return cv::Mat();
@@ -358,18 +386,21 @@ void VideoManager::onTimeout()
             }
             m_currentFrame = frame;
             m_currentFrameIndex++;
+            videoMetrics().frames.inc();
             emit frameReady(frame);
         } else {
             if (m_sourceType == VideoSource::LocalFile) {
                 stop();
+            } else {
+                videoMetrics().readFailures.inc();
             }
         }
     } catch (const cv::Exception& ex) {
-        QString msg = QString("视频帧读取OpenCV错误: %1").arg(ex.what());
-        spdlog::error(msg);
+        videoMetrics().readFailures.inc();
+        LOG_THROTTLED(spdlog::level::err, 5000, QString("视频帧读取OpenCV错误: %1").arg(ex.what()));
     } catch (const std::exception& ex) {
-        QString msg = QString("视频帧读取异常: %1").arg(ex.what());
-        spdlog::error(msg);
+        videoMetrics().readFailures.inc();
+        LOG_THROTTLED(spdlog::level::err, 5000, QString("视频帧读取异常: %1").arg(ex.what()));
     }
 }
 
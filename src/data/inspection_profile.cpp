@@ -11,34 +11,17 @@
 bool TemplateEntry::load(const QString& baseDir) {
     QString tplPath = baseDir + "/templates/" + templateName + ".tpl";
 
-    QFile file(tplPath);
-    if (!file.open(QIODevice::ReadOnly)) {
+    TemplateFile::Content content;
+    if (!TemplateFile::load(tplPath, content)) {
         return false;
     }
-    QByteArray data = file.readAll();
-    file.close();
-    if (data.isEmpty()) return false;
-
-    try {
-        cv::FileStorage fs(std::string(data.begin(), data.end()),
-            cv::FileStorage::READ | cv::FileStorage::MEMORY);
-        if (!fs.isOpened()) return false;
-
-        fs["templateImage"] >> templateImage;
-        if (templateImage.empty()) return false;
 
-        fs["matchMethod"] >> params.matchMethod;
-
-        params.polygonPoints.clear();
-        cv::FileNode pts = fs["polygonPoints"];
-        if (pts.type() == cv::FileNode::SEQ) {
-            for (const auto& pt : pts) {
-                params.polygonPoints.append(QPointF(pt["x"], pt["y"]));
-            }
-        }
-    } catch (const cv::Exception&) {
-        return false;
-    }
+    templateImage = content.image;
+    templateGray = content.gray;
+    mapping = content.mapping;
+    params.matchMethod = content.matchMethod;
+    params.polygonPoints = content.polygonPoints;
+    // 旧版 YAML 模板不在读取时改写，显式 save() 时转为二进制
 
     templateFilePath = "templates/" + templateName + ".tpl";
     return true;
@@ -54,26 +37,25 @@ bool TemplateEntry::save(const QString& baseDir) {
 
     QString tplPath = baseDir + "/templates/" + templateName + ".tpl";
 
-    try {
-        cv::FileStorage fs(".tpl",
-            cv::FileStorage::WRITE | cv::FileStorage::MEMORY | cv::FileStorage::FORMAT_YAML);
-
-        fs << "templateImage" << templateImage;
-        fs << "matchMethod" << params.matchMethod;
-
-        fs << "polygonPoints" << "[";
-        for (const auto& pt : params.polygonPoints) {
-            fs << "{:" << "x" << pt.x() << "y" << pt.y() << "}";
+    // 图像仍指向该文件的映射说明未被修改，无需重写（Windows 下也无法替换已映射的文件）
+    if (mapping && mapping->maps(tplPath)) {
+        if (mapping->contains(templateImage.data)) {
+            templateFilePath = "templates/" + templateName + ".tpl";
+            return true;
         }
-        fs << "]";
-
-        std::string content = fs.releaseAndGetString();
+        // 图像已替换：灰度模型仍指向旧映射，按新图像重新生成后释放映射，QSaveFile 才能替换文件
+        if (mapping->contains(templateGray.data)) {
+            templateGray = TemplateFile::makeGray(templateImage);
+        }
+        mapping.reset();
+    }
 
-        QFile file(tplPath);
-        if (!file.open(QIODevice::WriteOnly)) return false;
-        file.write(content.data(), content.size());
-        file.close();
-    } catch (const cv::Exception&) {
+    TemplateFile::Content content;
+    content.image = templateImage;
+    content.gray = templateGray;
+    content.matchMethod = params.matchMethod;
+    content.polygonPoints = params.polygonPoints;
+    if (!TemplateFile::save(tplPath, content)) {
         return false;
     }
 
@@ -305,7 +287,7 @@ bool InspectionProfile::saveToDirectory(const QString& profilesDir) {
     return true;
 }
 
-bool InspectionProfile::loadFromDirectory(const QString& profileDir) {
+bool InspectionProfile::loadFromDirectory(const QString& profileDir, bool loadTemplates) {
     QFile file(profileDir + "/profile.json");
     if (!file.open(QIODevice::ReadOnly)) {
         return false;
@@ -316,8 +298,10 @@ bool InspectionProfile::loadFromDirectory(const QString& profileDir) {
     fromJson(doc.object());
 
     // 加载模板图像
-    for (auto& tpl : templates) {
-        tpl.load(profileDir);
+    if (loadTemplates) {
+        for (auto& tpl : templates) {
+            tpl.load(profileDir);
+        }
     }
 
     return true;
@@ -0,0 +1,313 @@
+#include "data/report_codec.h"
+#include "config/detection_type.h"
+#include "logger.h"
+#include "utils/benchmark.h"
+#include <QCborStreamWriter>
+#include <QCborValue>
+#include <QJsonDocument>
+
+namespace {
+
+constexpr qint64 kSchemaVersion = 1;
+
+// 顶层字段编号（CBOR 整数键），与 cloud_dashboard/report_codec.py 中的表保持一致
+enum Key : qint64 {
+    KeyVersion = 0,
+    KeyReportId = 1,
+    KeyImageId = 2,
+    KeyImageName = 3,
+    KeyRoiId = 4,
+    KeyRoiName = 5,
+    KeyTimestamp = 6,
+    KeyPassed = 7,
+    KeyFailReason = 8,
+    KeyItems = 9,
+    KeyTotalItems = 10,
+    KeyPassedItems = 11,
+    KeyFailedItems = 12,
+    KeyCustomFields = 13,
+    KeyDeviceId = 14,
+    KeyKind = 16,
+    KeyWindowStart = 21,
+    KeyWindowEnd = 22,
+    KeySummary = 23,
+    KeyReports = 24,
+    KeyBatchId = 25
+};
+
+enum Kind : qint64 { KindReport = 0, KindBatch = 1 };
+
+// ==================== JSON ====================
+
+QJsonObject reportToJson(const DetectionResultReport& report, const QString& deviceId, bool includeItems)
+{
+    QJsonObject json = report.toJson();
+    json["deviceId"] = deviceId;
+
+    // 检测项统计（totalItems 等）已在 toJson 中计算，关闭区域详情时只去掉明细
+    if (!includeItems) json.remove("itemResults");
+    if (report.customFields.isEmpty()) json.remove("customFields");
+    if (report.failReason.isEmpty()) json.remove("failReason");
+    if (report.imageId.isEmpty()) json.remove("imageId");
+    if (report.roiId.isEmpty()) json.remove("roiId");
+    return json;
+}
+
+QJsonObject batchToJson(const ReportCodec::BatchSummary& summary, const QVector<DetectionResultReport>& reports,
+                        const QString& deviceId, bool includeItems)
+{
+    QJsonObject sum;
+    sum["total"] = summary.total;
+    sum["passed"] = summary.passed;
+    sum["failed"] = summary.total - summary.passed;
+    sum["passRate"] = summary.total > 0 ? static_cast<double>(summary.passed) / summary.total : 1.0;
+
+    QJsonObject byRoi;
+    for (auto it = summary.byRoi.constBegin(); it != summary.byRoi.constEnd(); ++it) {
+        QJsonObject roi;
+        roi["total"] = it->first;
+        roi["passed"] = it->second;
+        roi["failed"] = it->first - it->second;
+        byRoi[it.key()] = roi;
+    }
+    sum["byRoi"] = byRoi;
+
+    QJsonObject reasons;
+    for (const auto& reason : summary.failReasons) {
+        reasons[reason.first] = reason.second;
+    }
+    sum["failReasons"] = reasons;
+
+    QJsonArray reportArray;
+    for (const auto& report : reports) {
+        reportArray.append(reportToJson(report, deviceId, includeItems));
+    }
+
+    QJsonObject batch;
+    batch["type"] = "batch";
+    batch["batchId"] = summary.batchId;
+    batch["deviceId"] = deviceId;
+    batch["windowStart"] = summary.windowStart;
+    batch["windowEnd"] = summary.windowEnd;
+    batch["dateTime"] = QDateTime::fromMSecsSinceEpoch(summary.windowEnd).toString(Qt::ISODate);
+    batch["summary"] = sum;
+    batch["reports"] = reportArray;
+    return batch;
+}
+
+// ==================== CBOR ====================
+
+void writeKey(QCborStreamWriter& w, Key key)
+{
+    w.append(static_cast<qint64>(key));
+}
+
+/// 检测类型：已知类型写 DetectionType 序号，其余原样写字符串
+void writeDetectionType(QCborStreamWriter& w, const QString& name)
+{
+    const DetectionType type = stringToDetectionType(name);
+    if (detectionTypeToString(type) == name)
+        w.append(static_cast<qint64>(type));
+    else
+        w.append(name);
+}
+
+qsizetype reportFieldCount(const DetectionResultReport& r, bool includeItems)
+{
+    qsizetype count = 8;  // reportId imageName roiName timestamp passed totalItems passedItems failedItems
+    if (!r.imageId.isEmpty()) ++count;
+    if (!r.roiId.isEmpty()) ++count;
+    if (!r.failReason.isEmpty()) ++count;
+    if (includeItems) ++count;
+    if (!r.customFields.isEmpty()) ++count;
+    return count;
+}
+
+void writeReportFields(QCborStreamWriter& w, const DetectionResultReport& r, bool includeItems)
+{
+    qint64 passCount = 0;
+    for (const auto& item : r.itemResults) {
+        if (item.passed) ++passCount;
+    }
+    const qint64 totalCount = r.itemResults.size();
+
+    writeKey(w, KeyReportId);
+    w.append(r.reportId);
+    if (!r.imageId.isEmpty()) {
+        writeKey(w, KeyImageId);
+        w.append(r.imageId);
+    }
+    writeKey(w, KeyImageName);
+    w.append(r.imageName);
+    if (!r.roiId.isEmpty()) {
+        writeKey(w, KeyRoiId);
+        w.append(r.roiId);
+    }
+    writeKey(w, KeyRoiName);
+    w.append(r.roiName);
+    writeKey(w, KeyTimestamp);
+    w.append(r.timestamp);
+    writeKey(w, KeyPassed);
+    w.append(r.passed);
+    if (!r.failReason.isEmpty()) {
+        writeKey(w, KeyFailReason);
+        w.append(r.failReason);
+    }
+
+    if (includeItems) {
+        // 每个检测项为定长数组 [itemName, detectionType, passed, failReason]
+        writeKey(w, KeyItems);
+        w.startArray(static_cast<quint64>(totalCount));
+        for (const auto& item : r.itemResults) {
+            w.startArray(4);
+            w.append(item.itemName);
+            writeDetectionType(w, item.detectionType);
+            w.append(item.passed);
+            w.append(item.failReason);
+            w.endArray();
+        }
+        w.endArray();
+    }
+
+    writeKey(w, KeyTotalItems);
+    w.append(totalCount);
+    writeKey(w, KeyPassedItems);
+    w.append(passCount);
+    writeKey(w, KeyFailedItems);
+    w.append(totalCount - passCount);
+
+    if (!r.customFields.isEmpty()) {
+        writeKey(w, KeyCustomFields);
+        w.startMap(static_cast<quint64>(r.customFields.size()));
+        for (auto it = r.customFields.constBegin(); it != r.customFields.constEnd(); ++it) {
+            w.append(it.key());
+            QCborValue::fromVariant(it.value()).toCbor(w);
+        }
+        w.endMap();
+    }
+}
+
+void writeHeader(QCborStreamWriter& w, qsizetype fieldCount, Kind kind, const QString& deviceId)
+{
+    w.append(QCborKnownTags::Signature);  // D9 D9 F7：接收端识别为 CBOR
+    w.startMap(static_cast<quint64>(fieldCount + 3));
+    writeKey(w, KeyVersion);
+    w.append(kSchemaVersion);
+    writeKey(w, KeyKind);
+    w.append(static_cast<qint64>(kind));
+    writeKey(w, KeyDeviceId);
+    w.append(deviceId);
+}
+
+} // namespace
+
+ReportCodec::Format ReportCodec::formatFromString(const QString& name)
+{
+    if (name.compare("cbor", Qt::CaseInsensitive) == 0) return Format::Cbor;
+    if (!name.isEmpty() && name.compare("json", Qt::CaseInsensitive) != 0) {
+        spdlog::warn("未知的上报编码 '{}'，使用 json", name);
+    }
+    return Format::Json;
+}
+
+void ReportCodec::encodeReport(const DetectionResultReport& report, const QString& deviceId,
+                               bool includeItems, Format format, QByteArray& out)
+{
+    out.resize(0);  // 保留已分配容量，CBOR 直接追加写入
+    if (format == Format::Json) {
+        out = QJsonDocument(reportToJson(report, deviceId, includeItems)).toJson(QJsonDocument::Compact);
+        return;
+    }
+
+    QCborStreamWriter w(&out);
+    writeHeader(w, reportFieldCount(report, includeItems), KindReport, deviceId);
+    writeReportFields(w, report, includeItems);
+    w.endMap();
+}
+
+void ReportCodec::encodeBatch(const BatchSummary& summary, const QVector<DetectionResultReport>& reports,
+                              const QString& deviceId, bool includeItems, Format format, QByteArray& out)
+{
+    out.resize(0);  // 保留已分配容量，CBOR 直接追加写入
+    if (format == Format::Json) {
+        out = QJsonDocument(batchToJson(summary, reports, deviceId, includeItems)).toJson(QJsonDocument::Compact);
+        return;
+    }
+
+    QCborStreamWriter w(&out);
+    writeHeader(w, 5, KindBatch, deviceId);
+    writeKey(w, KeyBatchId);
+    w.append(summary.batchId);
+    writeKey(w, KeyWindowStart);
+    w.append(summary.windowStart);
+    writeKey(w, KeyWindowEnd);
+    w.append(summary.windowEnd);
+
+    // summary = [total, passed, {roi: [total, passed]}, {reason: count}]
+    writeKey(w, KeySummary);
+    w.startArray(4);
+    w.append(static_cast<qint64>(summary.total));
+    w.append(static_cast<qint64>(summary.passed));
+    w.startMap(static_cast<quint64>(summary.byRoi.size()));
+    for (auto it = summary.byRoi.constBegin(); it != summary.byRoi.constEnd(); ++it) {
+        w.append(it.key());
+        w.startArray(2);
+        w.append(static_cast<qint64>(it->first));
+        w.append(static_cast<qint64>(it->second));
+        w.endArray();
+    }
+    w.endMap();
+    w.startMap(static_cast<quint64>(summary.failReasons.size()));
+    for (const auto& reason : summary.failReasons) {
+        w.append(reason.first);
+        w.append(static_cast<qint64>(reason.second));
+    }
+    w.endMap();
+    w.endArray();
+
+    writeKey(w, KeyReports);
+    w.startArray(static_cast<quint64>(reports.size()));
+    for (const auto& report : reports) {
+        w.startMap(static_cast<quint64>(reportFieldCount(report, includeItems)));
+        writeReportFields(w, report, includeItems);
+        w.endMap();
+    }
+    w.endArray();
+
+    w.endMap();
+}
+
+void ReportCodec::benchmark(const DetectionResultReport& sample, int iterations)
+{
+    if (iterations <= 0) return;
+
+    const QString deviceId = "bench_device";
+    constexpr int kBatchSize = 50;
+
+    QVector<DetectionResultReport> reports(kBatchSize, sample);
+    BatchSummary summary;
+    summary.windowStart = sample.timestamp;
+    summary.windowEnd = sample.timestamp + 1000;
+    summary.total = kBatchSize;
+    summary.passed = sample.passed ? kBatchSize : 0;
+    summary.byRoi[sample.roiName] = {kBatchSize, summary.passed};
+    if (!sample.passed && !sample.failReason.isEmpty())
+        summary.failReasons.append({sample.failReason, kBatchSize});
+
+    QByteArray json, cbor;
+    benchmarkAvg("ReportCodec::encodeReport(json)", iterations,
+                 [&] { encodeReport(sample, deviceId, true, Format::Json, json); });
+    benchmarkAvg("ReportCodec::encodeReport(cbor)", iterations,
+                 [&] { encodeReport(sample, deviceId, true, Format::Cbor, cbor); });
+    spdlog::info("[BENCH] ReportCodec 单报告({}个检测项): JSON={}B, CBOR={}B ({:.0f}%)",
+                 sample.itemResults.size(), json.size(), cbor.size(),
+                 json.isEmpty() ? 0.0 : 100.0 * cbor.size() / json.size());
+
+    benchmarkAvg("ReportCodec::encodeBatch(json)", iterations,
+                 [&] { encodeBatch(summary, reports, deviceId, true, Format::Json, json); });
+    benchmarkAvg("ReportCodec::encodeBatch(cbor)", iterations,
+                 [&] { encodeBatch(summary, reports, deviceId, true, Format::Cbor, cbor); });
+    spdlog::info("[BENCH] ReportCodec 聚合({}条): JSON={}B, CBOR={}B ({:.0f}%)",
+                 kBatchSize, json.size(), cbor.size(),
+                 json.isEmpty() ? 0.0 : 100.0 * cbor.size() / json.size());
+}
@@ -0,0 +1,173 @@
+#include "data/session_file.h"
+#include "logger.h"
+#include <QCborValue>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr char kMagic[8] = {'E', 'V', 'S', 'E', 'S', 'S', 'N', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr quint32 kMaxPayload = 256u * 1024u * 1024u;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+static_assert(sizeof(FileHeader) == 16, "FileHeader 布局必须固定为 16 字节");
+
+struct RecordHeader
+{
+    uint32_t type;
+    uint32_t size;
+    int64_t timeNs;
+};
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader 布局必须固定为 16 字节");
+
+} // namespace
+
+// ========== Writer ==========
+
+SessionFile::Writer::Writer() = default;
+
+SessionFile::Writer::~Writer()
+{
+    close();
+}
+
+bool SessionFile::Writer::open(const QString& path)
+{
+    close();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file = std::make_unique<QFile>(path);
+    if (!m_file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        spdlog::error("[SessionFile] 无法创建录制文件 {}: {}", path, m_file->errorString());
+        m_file.reset();
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = qToLittleEndian(kVersion);
+    m_bytes = m_file->write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return m_bytes == sizeof(header);
+}
+
+bool SessionFile::Writer::isOpen() const
+{
+    return m_file && m_file->isOpen();
+}
+
+bool SessionFile::Writer::append(RecordType type, qint64 timeNs, const QByteArray& payload)
+{
+    if (!isOpen()) return false;
+
+    RecordHeader header;
+    header.type = qToLittleEndian(static_cast<uint32_t>(type));
+    header.size = qToLittleEndian(static_cast<uint32_t>(payload.size()));
+    header.timeNs = qToLittleEndian(static_cast<int64_t>(timeNs));
+    if (m_file->write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header) ||
+        m_file->write(payload) != payload.size()) {
+        spdlog::error("[SessionFile] 写入失败: {}", m_file->errorString());
+        return false;
+    }
+    m_bytes += sizeof(header) + payload.size();
+    return true;
+}
+
+void SessionFile::Writer::close()
+{
+    if (m_file) {
+        m_file->close();
+        m_file.reset();
+    }
+}
+
+// ========== Reader ==========
+
+SessionFile::Reader::Reader() = default;
+
+SessionFile::Reader::~Reader() = default;
+
+bool SessionFile::Reader::open(const QString& path)
+{
+    close();
+    m_file = std::make_unique<QFile>(path);
+    if (!m_file->open(QIODevice::ReadOnly)) {
+        spdlog::error("[SessionFile] 无法打开录制文件 {}: {}", path, m_file->errorString());
+        m_file.reset();
+        return false;
+    }
+
+    FileHeader header;
+    if (m_file->read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        spdlog::error("[SessionFile] 不是会话录制文件: {}", path);
+        close();
+        return false;
+    }
+    if (qFromLittleEndian(header.version) != kVersion) {
+        spdlog::error("[SessionFile] 不支持的录制文件版本: {}", qFromLittleEndian(header.version));
+        close();
+        return false;
+    }
+
+    const qint64 fileSize = m_file->size();
+    qint64 pos = sizeof(FileHeader);
+    while (pos + static_cast<qint64>(sizeof(RecordHeader)) <= fileSize) {
+        RecordHeader rh;
+        if (!m_file->seek(pos) ||
+            m_file->read(reinterpret_cast<char*>(&rh), sizeof(rh)) != sizeof(rh)) break;
+
+        RecordInfo info;
+        info.type = static_cast<RecordType>(qFromLittleEndian(rh.type));
+        info.size = qFromLittleEndian(rh.size);
+        info.timeNs = qFromLittleEndian(rh.timeNs);
+        info.offset = pos + sizeof(RecordHeader);
+        if (info.size > kMaxPayload || info.offset + info.size > fileSize) break;  // 末尾记录不完整
+
+        m_records.append(info);
+        pos = info.offset + info.size;
+        if (info.type == RecordType::End) {
+            m_complete = true;
+            break;
+        }
+    }
+
+    if (!m_complete) {
+        spdlog::warn("[SessionFile] {} 没有结束标记（录制未正常停止），按已完整写入的 {} 条记录读取",
+                     path, m_records.size());
+    }
+    return true;
+}
+
+void SessionFile::Reader::close()
+{
+    m_file.reset();
+    m_records.clear();
+    m_complete = false;
+}
+
+QByteArray SessionFile::Reader::payload(const RecordInfo& record)
+{
+    if (!m_file || !m_file->seek(record.offset)) return {};
+    return m_file->read(record.size);
+}
+
+QByteArray SessionFile::Reader::payloadHead(const RecordInfo& record, qint64 maxBytes)
+{
+    if (!m_file || !m_file->seek(record.offset)) return {};
+    return m_file->read(std::min<qint64>(record.size, maxBytes));
+}
+
+QCborMap SessionFile::Reader::map(const RecordInfo& record)
+{
+    return QCborValue::fromCbor(payload(record)).toMap();
+}
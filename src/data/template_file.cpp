@@ -0,0 +1,402 @@
+#include "data/template_file.h"
+#include "logger.h"
+#include "utils/benchmark.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDir>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr char kMagic[8] = {'E', 'V', 'T', 'P', 'L', 'B', 'I', 'N'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kPlaneAlign = 64;
+
+enum PlaneKind : uint32_t { PlaneImage = 0, PlaneGray = 1 };
+enum PlaneEncoding : uint32_t { EncodingRaw = 0, EncodingPng = 1 };
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    int32_t matchMethod;
+    uint32_t polygonCount;
+    uint64_t polygonOffset;
+    uint32_t planeCount;
+    uint32_t reserved0;
+    uint64_t planeTableOffset;
+    uint8_t reserved[16];
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader 布局必须固定为 64 字节");
+
+struct PlaneDesc
+{
+    uint32_t kind;
+    uint32_t encoding;
+    int32_t rows;
+    int32_t cols;
+    int32_t type;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+static_assert(sizeof(PlaneDesc) == 40, "PlaneDesc 布局必须固定为 40 字节");
+
+uint64_t alignUp(uint64_t v, uint64_t a) { return (v + a - 1) / a * a; }
+
+bool isPngEncodable(const cv::Mat& m)
+{
+    const int depth = m.depth();
+    const int cn = m.channels();
+    return (depth == CV_8U || depth == CV_16U) && (cn == 1 || cn == 3 || cn == 4);
+}
+
+/// 从连续内存解析二进制模板；alias=true 时 cv::Mat 直接引用该内存
+bool parseBinary(const uchar* base, qint64 fileSize, bool alias, TemplateFile::Content& out)
+{
+    if (fileSize < static_cast<qint64>(sizeof(FileHeader))) return false;
+
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) return false;
+    if (header.version != kVersion || header.headerSize != sizeof(FileHeader)) {
+        spdlog::error("[TemplateFile] 不支持的模板版本: {}", header.version);
+        return false;
+    }
+
+    const uint64_t size = static_cast<uint64_t>(fileSize);
+    auto inRange = [size](uint64_t offset, uint64_t len) {
+        return offset <= size && len <= size - offset;
+    };
+
+    const uint64_t polyBytes = uint64_t(header.polygonCount) * 2 * sizeof(double);
+    const uint64_t tableBytes = uint64_t(header.planeCount) * sizeof(PlaneDesc);
+    if (!inRange(header.polygonOffset, polyBytes) || !inRange(header.planeTableOffset, tableBytes))
+        return false;
+
+    out.matchMethod = header.matchMethod;
+    out.polygonPoints.clear();
+    out.polygonPoints.reserve(static_cast<int>(header.polygonCount));
+    for (uint32_t i = 0; i < header.polygonCount; ++i) {
+        double xy[2];
+        std::memcpy(xy, base + header.polygonOffset + i * sizeof(xy), sizeof(xy));
+        out.polygonPoints.append(QPointF(xy[0], xy[1]));
+    }
+
+    for (uint32_t i = 0; i < header.planeCount; ++i) {
+        PlaneDesc desc;
+        std::memcpy(&desc, base + header.planeTableOffset + i * sizeof(PlaneDesc), sizeof(desc));
+        if (!inRange(desc.offset, desc.size) || desc.rows <= 0 || desc.cols <= 0) return false;
+
+        cv::Mat plane;
+        if (desc.encoding == EncodingRaw) {
+            if (CV_MAT_DEPTH(desc.type) > CV_16F) return false;
+            const uint64_t expected = uint64_t(desc.rows) * uint64_t(desc.cols) * CV_ELEM_SIZE(desc.type);
+            if (expected != desc.size) return false;
+            // 映射为写时复制，const_cast 后即便下游误写也不会落盘
+            plane = cv::Mat(desc.rows, desc.cols, desc.type, const_cast<uchar*>(base + desc.offset));
+            if (!alias) plane = plane.clone();
+        } else if (desc.encoding == EncodingPng) {
+            cv::Mat encoded(1, static_cast<int>(desc.size), CV_8UC1, const_cast<uchar*>(base + desc.offset));
+            plane = cv::imdecode(encoded, cv::IMREAD_UNCHANGED);
+            if (plane.empty() || plane.rows != desc.rows || plane.cols != desc.cols || plane.type() != desc.type)
+                return false;
+        } else {
+            return false;
+        }
+
+        if (desc.kind == PlaneImage) out.image = plane;
+        else if (desc.kind == PlaneGray) out.gray = plane;
+    }
+
+    if (out.image.empty()) return false;
+    if (out.gray.empty()) out.gray = TemplateFile::makeGray(out.image);
+    return true;
+}
+
+} // namespace
+
+// ==================== Mapping ====================
+
+TemplateFile::Mapping::Mapping(const QString& path)
+    : m_path(path)
+    , m_file(std::make_unique<QFile>(path))
+{
+    if (!m_file->open(QIODevice::ReadOnly)) return;
+    m_size = m_file->size();
+    if (m_size <= 0) return;
+    m_data = m_file->map(0, m_size, QFileDevice::MapPrivateOption);
+    if (!m_data) m_size = 0;
+}
+
+TemplateFile::Mapping::~Mapping()
+{
+    if (m_data) m_file->unmap(m_data);
+}
+
+bool TemplateFile::Mapping::maps(const QString& filePath) const
+{
+    return QFileInfo(m_path).absoluteFilePath() == QFileInfo(filePath).absoluteFilePath();
+}
+
+// ==================== 读取 ====================
+
+bool TemplateFile::isBinary(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    char magic[sizeof(kMagic)];
+    return file.read(magic, sizeof(magic)) == sizeof(magic)
+           && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+bool TemplateFile::load(const QString& filePath, Content& out)
+{
+    out = Content();
+    if (isBinary(filePath)) return loadBinary(filePath, out);
+    return loadYaml(filePath, out);
+}
+
+bool TemplateFile::loadBinary(const QString& filePath, Content& out)
+{
+    try {
+        auto mapping = std::make_shared<Mapping>(filePath);
+        if (mapping->isValid()) {
+            if (!parseBinary(mapping->data(), mapping->size(), true, out)) {
+                spdlog::error("[TemplateFile] 模板文件损坏: {}", filePath);
+                out = Content();
+                return false;
+            }
+            out.mapping = mapping;
+            return true;
+        }
+
+        // 无法映射（如部分网络文件系统）时退化为整体读取
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) return false;
+        const QByteArray data = file.readAll();
+        if (!parseBinary(reinterpret_cast<const uchar*>(data.constData()), data.size(), false, out)) {
+            spdlog::error("[TemplateFile] 模板文件损坏: {}", filePath);
+            out = Content();
+            return false;
+        }
+        return true;
+    } catch (const cv::Exception& ex) {
+        spdlog::error("[TemplateFile] 读取模板失败: {}", ex.what());
+        out = Content();
+        return false;
+    }
+}
+
+bool TemplateFile::loadYaml(const QString& filePath, Content& out)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QByteArray data = file.readAll();
+    file.close();
+    if (data.isEmpty()) return false;
+
+    try {
+        cv::FileStorage fs(std::string(data.begin(), data.end()),
+            cv::FileStorage::READ | cv::FileStorage::MEMORY);
+        if (!fs.isOpened()) return false;
+
+        fs["templateImage"] >> out.image;
+        if (out.image.empty()) return false;
+
+        fs["matchMethod"] >> out.matchMethod;
+
+        out.polygonPoints.clear();
+        cv::FileNode pts = fs["polygonPoints"];
+        if (pts.type() == cv::FileNode::SEQ) {
+            for (const auto& pt : pts) {
+                double x = pt["x"];
+                double y = pt["y"];
+                out.polygonPoints.append(QPointF(x, y));
+            }
+        }
+    } catch (const cv::Exception& ex) {
+        spdlog::error("[TemplateFile] 读取 YAML 模板失败: {}", ex.what());
+        return false;
+    }
+
+    out.gray = makeGray(out.image);
+    out.legacyYaml = true;
+    return true;
+}
+
+// ==================== 写出 ====================
+
+bool TemplateFile::save(const QString& filePath, const Content& content, Compression compression)
+{
+    if (content.image.empty()) return false;
+
+    try {
+        const cv::Mat gray = content.gray.empty() ? makeGray(content.image) : content.gray;
+
+        struct PendingPlane
+        {
+            PlaneDesc desc;
+            cv::Mat raw;                // Raw 编码
+            std::vector<uchar> encoded; // Png 编码
+        };
+        std::vector<PendingPlane> planes;
+        auto addPlane = [&](uint32_t kind, const cv::Mat& m) {
+            PendingPlane p{};
+            p.desc.kind = kind;
+            p.desc.rows = m.rows;
+            p.desc.cols = m.cols;
+            p.desc.type = m.type();
+            if (compression == Compression::Png && isPngEncodable(m)
+                && cv::imencode(".png", m, p.encoded)) {
+                p.desc.encoding = EncodingPng;
+                p.desc.size = p.encoded.size();
+            } else {
+                p.desc.encoding = EncodingRaw;
+                p.raw = m.isContinuous() ? m : m.clone();
+                p.desc.size = uint64_t(m.total()) * m.elemSize();
+            }
+            planes.push_back(std::move(p));
+        };
+        addPlane(PlaneImage, content.image);
+        addPlane(PlaneGray, gray);
+
+        FileHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.headerSize = sizeof(FileHeader);
+        header.matchMethod = content.matchMethod;
+        header.polygonCount = static_cast<uint32_t>(content.polygonPoints.size());
+        header.polygonOffset = sizeof(FileHeader);
+        header.planeCount = static_cast<uint32_t>(planes.size());
+        header.planeTableOffset = header.polygonOffset + uint64_t(header.polygonCount) * 2 * sizeof(double);
+
+        uint64_t cursor = header.planeTableOffset + planes.size() * sizeof(PlaneDesc);
+        for (auto& p : planes) {
+            cursor = alignUp(cursor, kPlaneAlign);
+            p.desc.offset = cursor;
+            cursor += p.desc.size;
+        }
+
+        QByteArray buffer(static_cast<qsizetype>(cursor), '\0');
+        uchar* dst = reinterpret_cast<uchar*>(buffer.data());
+        std::memcpy(dst, &header, sizeof(header));
+        for (int i = 0; i < content.polygonPoints.size(); ++i) {
+            const double xy[2] = {content.polygonPoints[i].x(), content.polygonPoints[i].y()};
+            std::memcpy(dst + header.polygonOffset + i * sizeof(xy), xy, sizeof(xy));
+        }
+        for (size_t i = 0; i < planes.size(); ++i) {
+            const auto& p = planes[i];
+            std::memcpy(dst + header.planeTableOffset + i * sizeof(PlaneDesc), &p.desc, sizeof(PlaneDesc));
+            if (p.desc.encoding == EncodingPng)
+                std::memcpy(dst + p.desc.offset, p.encoded.data(), p.encoded.size());
+            else
+                std::memcpy(dst + p.desc.offset, p.raw.data, p.desc.size);
+        }
+
+        // QSaveFile 先写临时文件再重命名，已映射的旧文件内容不受影响
+        QSaveFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            spdlog::error("[TemplateFile] 无法写入模板文件: {}", filePath);
+            return false;
+        }
+        file.write(buffer);
+        if (!file.commit()) {
+            spdlog::error("[TemplateFile] 保存模板文件失败: {}", filePath);
+            return false;
+        }
+        return true;
+    } catch (const cv::Exception& ex) {
+        spdlog::error("[TemplateFile] 保存模板失败: {}", ex.what());
+        return false;
+    }
+}
+
+bool TemplateFile::saveYaml(const QString& filePath, const Content& content)
+{
+    try {
+        cv::FileStorage fs(".tpl",
+            cv::FileStorage::WRITE | cv::FileStorage::MEMORY | cv::FileStorage::FORMAT_YAML);
+
+        fs << "templateImage" << content.image;
+        fs << "matchMethod" << content.matchMethod;
+
+        fs << "polygonPoints" << "[";
+        for (const QPointF& pt : content.polygonPoints) {
+            fs << "{:" << "x" << pt.x() << "y" << pt.y() << "}";
+        }
+        fs << "]";
+
+        std::string text = fs.releaseAndGetString();
+
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly)) return false;
+        file.write(text.data(), static_cast<qint64>(text.size()));
+        return true;
+    } catch (const cv::Exception& ex) {
+        spdlog::error("[TemplateFile] 保存 YAML 模板失败: {}", ex.what());
+        return false;
+    }
+}
+
+cv::Mat TemplateFile::makeGray(const cv::Mat& image)
+{
+    if (image.empty()) return cv::Mat();
+    cv::Mat gray;
+    if (image.channels() == 3)
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    else if (image.channels() == 4)
+        cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
+    else
+        gray = image;
+    return gray;
+}
+
+// ==================== 基准测试 ====================
+
+void TemplateFile::benchmark(const cv::Mat& image, const QString& workDir, int iterations)
+{
+    if (image.empty() || iterations <= 0) return;
+
+    QDir().mkpath(workDir);
+    const QString yamlPath = workDir + "/bench_yaml.tpl";
+    const QString rawPath = workDir + "/bench_raw.tpl";
+    const QString pngPath = workDir + "/bench_png.tpl";
+
+    Content content;
+    content.image = image;
+    content.gray = makeGray(image);
+
+    spdlog::info("[BENCH] TemplateFile 模板 {}x{}x{}", image.cols, image.rows, image.channels());
+
+    benchmarkAvg("TemplateFile::saveYaml", iterations, [&] { saveYaml(yamlPath, content); });
+    benchmarkAvg("TemplateFile::saveRaw", iterations, [&] { save(rawPath, content, Compression::Raw); });
+    benchmarkAvg("TemplateFile::savePng", iterations, [&] { save(pngPath, content, Compression::Png); });
+
+    // 加载后对图像求和，确保映射页面被实际读入，与解析路径公平比较
+    auto loadAndTouch = [](const QString& path) {
+        Content c;
+        if (load(path, c)) (void)cv::sum(c.image);
+    };
+    benchmarkAvg("TemplateFile::loadYaml", iterations, [&] { loadAndTouch(yamlPath); });
+    benchmarkAvg("TemplateFile::loadRaw(mmap)", iterations, [&] { loadAndTouch(rawPath); });
+    benchmarkAvg("TemplateFile::loadPng", iterations, [&] { loadAndTouch(pngPath); });
+    benchmarkAvg("TemplateFile::loadRaw(header only)", iterations, [&] {
+        Content c;
+        load(rawPath, c);
+    });
+
+    spdlog::info("[BENCH] TemplateFile 文件大小: YAML={}KB, Raw={}KB, Png={}KB",
+                 QFileInfo(yamlPath).size() / 1024,
+                 QFileInfo(rawPath).size() / 1024,
+                 QFileInfo(pngPath).size() / 1024);
+
+    QFile::remove(yamlPath);
+    QFile::remove(rawPath);
+    QFile::remove(pngPath);
+}
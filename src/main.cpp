@@ -1,12 +1,28 @@
 #include "mainwindow.h"
 #include "logger.h"
+#include "algorithm/display_renderer.h"
+#include "algorithm/line_match_engine.h"
+#include "algorithm/ort_model_comparison.h"
+#include "algorithm/yolo_postprocess.h"
+#include "core/ocr_step.h"
+#include "core/pipeline_manager.h"
+#include "core/session_recorder.h"
+#include "core/session_replayer.h"
+#include "data/report_codec.h"
+#include "data/template_file.h"
+#include "utils/path_utils.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
 #include <QResource>
 #include <QSplashScreen>
 #include <QPainter>
 #include <QFont>
 #include <QTimer>
+#include <algorithm>
 
 static QPixmap createSplashPixmap()
 {
@@ -83,10 +99,236 @@ static QPixmap createSplashPixmap()
     return pix;
 }
 
+/// 命令行模式在创建 QApplication 之前判定（无界面模式只需 QCoreApplication，可在无显示环境运行）
+static bool hasArgument(int argc, char* argv[], const char* name)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+// EdgeVision --compare-models <图片目录> <参考模型.onnx> <候选模型.onnx...> [--csv 输出] [--threads N]
+static int runModelComparison(const QCoreApplication& app)
+{
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption compareOption("compare-models", "对比模型精度/CPU 延迟的图片目录", "imageDir");
+    const QCommandLineOption csvOption("csv", "结果 CSV 路径", "path");
+    const QCommandLineOption threadsOption("threads", "intra-op 线程数（默认按物理核）", "n", "0");
+    const QCommandLineOption inputOption("input-size", "模型输入边长", "px", "640");
+    const QCommandLineOption confOption("conf", "置信度阈值", "value", "0.5");
+    parser.addOptions({compareOption, csvOption, threadsOption, inputOption, confOption});
+    parser.addPositionalArgument("models", "参考模型在前，其后为待对比模型（FP16 / INT8）");
+    parser.process(app);
+
+    const QStringList models = parser.positionalArguments();
+    if (models.isEmpty()) {
+        spdlog::error("[OrtCompare] 未指定模型");
+        return 2;
+    }
+
+    bool threadsOk = false, inputOk = false, confOk = false;
+    const int threads = parser.value(threadsOption).toInt(&threadsOk);
+    const int inputSize = parser.value(inputOption).toInt(&inputOk);
+    const float conf = parser.value(confOption).toFloat(&confOk);
+    if (!threadsOk || threads < 0 || threads > 256) {
+        spdlog::error("[OrtCompare] --threads 无效: {}（0=自动，或 1~256）", parser.value(threadsOption));
+        return 2;
+    }
+    if (!inputOk || inputSize < 32 || inputSize > 4096 || inputSize % 32 != 0) {
+        spdlog::error("[OrtCompare] --input-size 无效: {}（32~4096 且为 32 的倍数）", parser.value(inputOption));
+        return 2;
+    }
+    if (!confOk || conf <= 0.f || conf >= 1.f) {
+        spdlog::error("[OrtCompare] --conf 无效: {}（取值 0~1）", parser.value(confOption));
+        return 2;
+    }
+
+    OrtCpuConfig cpuConfig;
+    cpuConfig.intraOpThreads = threads;
+    OrtModelComparison::Options options;
+    options.inputWidth = options.inputHeight = inputSize;
+    options.confThreshold = conf;
+
+    const auto reports = OrtModelComparison::run(parser.value(compareOption), models, cpuConfig, options);
+    if (parser.isSet(csvOption))
+        OrtModelComparison::writeCsv(reports, parser.value(csvOption));
+    const bool allLoaded = reports.size() == models.size() &&
+        std::all_of(reports.begin(), reports.end(), [](const OrtModelReport& r) { return r.images > 0; });
+    return allLoaded ? 0 : 1;
+}
+
+// EdgeVision --replay <会话.evs> [--fast] [--report 输出.json]
+static int runSessionReplay(const QCoreApplication& app)
+{
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption replayOption("replay", "回放的会话录制文件", "file");
+    const QCommandLineOption fastOption("fast", "全速回放（默认按录制时的节奏）");
+    const QCommandLineOption reportOption("report", "回放统计 JSON 路径", "path");
+    parser.addOptions({replayOption, fastOption, reportOption});
+    parser.process(app);
+
+    PipelineManager pipeline;
+    SessionReplayer replayer(&pipeline);
+    if (!replayer.open(parser.value(replayOption)) || replayer.frameCount() == 0) {
+        return 1;
+    }
+
+    QObject::connect(&replayer, &SessionReplayer::commandReplayed, [](const QJsonObject& command) {
+        spdlog::info("[SessionReplayer] 指令: {}",
+                     QString::fromUtf8(QJsonDocument(command).toJson(QJsonDocument::Compact)));
+    });
+    QObject::connect(&replayer, &SessionReplayer::replayFinished,
+                     [](const SessionReplayer::Report&) { QCoreApplication::quit(); });
+    replayer.start(parser.isSet(fastOption) ? SessionReplayer::Pace::Fast : SessionReplayer::Pace::Original);
+    QCoreApplication::exec();
+
+    const SessionReplayer::Report& report = replayer.report();
+    if (parser.isSet(reportOption)) {
+        QFile file(parser.value(reportOption));
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(QJsonDocument(report.toJson()).toJson());
+        } else {
+            spdlog::error("[SessionReplayer] 无法写入回放统计 {}: {}", parser.value(reportOption), file.errorString());
+        }
+    }
+    return report.completed > 0 ? 0 : 1;
+}
+
+// EdgeVision --bench [--image 图片] [--iterations N] [--cases logging,yolo,report,template,line,ocr,overlay]
+// 各优化项的新旧实现耗时对比，结果以 [BENCH] 日志输出；template/line/ocr/overlay 需要 --image
+static int runBenchmarks(const QCoreApplication& app)
+{
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption benchOption("bench", "运行性能对比");
+    const QCommandLineOption imageOption("image", "template/line/ocr/overlay 使用的测试图片", "file");
+    const QCommandLineOption iterationsOption("iterations", "迭代次数（默认按各项自身的默认值）", "n");
+    const QCommandLineOption casesOption("cases", "逗号分隔的对比项（默认全部）", "list",
+                                         "logging,yolo,report,template,line,ocr,overlay");
+    parser.addOptions({benchOption, imageOption, iterationsOption, casesOption});
+    parser.process(app);
+
+    static const QStringList kCases = {"logging", "yolo", "report", "template", "line", "ocr", "overlay"};
+    const QStringList cases = parser.value(casesOption).split(',', Qt::SkipEmptyParts);
+    for (const QString& name : cases) {
+        if (!kCases.contains(name)) {
+            spdlog::error("[BENCH] 未知对比项: {}（可选 {}）", name, kCases.join(','));
+            return 2;
+        }
+    }
+
+    int iterations = 0;
+    if (parser.isSet(iterationsOption)) {
+        bool ok = false;
+        iterations = parser.value(iterationsOption).toInt(&ok);
+        if (!ok || iterations <= 0) {
+            spdlog::error("[BENCH] --iterations 无效: {}", parser.value(iterationsOption));
+            return 2;
+        }
+    }
+
+    cv::Mat image;
+    if (parser.isSet(imageOption)) {
+        image = PathUtils::readImageFromFile(parser.value(imageOption), cv::IMREAD_COLOR);
+        if (image.empty()) {
+            spdlog::error("[BENCH] 无法读取图片: {}", parser.value(imageOption));
+            return 2;
+        }
+    }
+    auto needsImage = [&](const QString& name) {
+        if (!image.empty()) return false;
+        spdlog::warn("[BENCH] {} 需要 --image，跳过", name);
+        return true;
+    };
+
+    if (cases.contains("logging")) {
+        iterations > 0 ? benchmarkLogging(iterations) : benchmarkLogging();
+    }
+    if (cases.contains("yolo")) {
+        iterations > 0 ? YoloPostprocess::benchmark(iterations) : YoloPostprocess::benchmark();
+    }
+    if (cases.contains("report")) {
+        DetectionResultReport sample;
+        sample.imageId = "bench_image";
+        sample.imageName = "bench.png";
+        sample.roiId = "roi_1";
+        sample.roiName = "ROI 1";
+        sample.passed = false;
+        sample.failReason = "条码内容不匹配";
+        for (const char* type : {"Blob", "条码", "直线", "OCR"}) {
+            DetectionItemReport item;
+            item.itemName = QString("%1 检测").arg(type);
+            item.detectionType = type;
+            sample.itemResults.append(item);
+        }
+        iterations > 0 ? ReportCodec::benchmark(sample, iterations) : ReportCodec::benchmark(sample);
+    }
+    if (cases.contains("template") && !needsImage("template")) {
+        const QString workDir = QDir::temp().filePath("edgevision_template_bench");
+        iterations > 0 ? TemplateFile::benchmark(image, workDir, iterations) : TemplateFile::benchmark(image, workDir);
+    }
+    if (cases.contains("line") && !needsImage("line")) {
+        // 参考线取图像中部的水平线
+        LineDetectConfig cfg;
+        cfg.enabled = true;
+        cfg.enableReferenceLineMatch = true;
+        cfg.referenceLineStart = cv::Point2f(image.cols * 0.1f, image.rows * 0.5f);
+        cfg.referenceLineEnd = cv::Point2f(image.cols * 0.9f, image.rows * 0.5f);
+        cfg.referenceLineValid = true;
+        const cv::Mat gray = TemplateFile::makeGray(image);
+        iterations > 0 ? LineMatchEngine::benchmark(gray, cfg, iterations) : LineMatchEngine::benchmark(gray, cfg);
+    }
+    if (cases.contains("ocr") && !needsImage("ocr")) {
+        StepOcrRecognition ocr;
+        const OcrConfig cfg;
+        iterations > 0 ? ocr.benchmark(image, cfg, iterations) : ocr.benchmark(image, cfg);
+    }
+    if (cases.contains("overlay") && !needsImage("overlay")) {
+        iterations > 0 ? DisplayRenderer::benchmark(image, iterations) : DisplayRenderer::benchmark(image);
+    }
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
+    // 命令行模型对比模式：不启动界面
+    if (hasArgument(argc, argv, "--compare-models")) {
+        QCoreApplication app(argc, argv);
+        const int ret = runModelComparison(app);
+        shutdownLogging();
+        return ret;
+    }
+
+    // 命令行性能对比模式：不启动界面
+    if (hasArgument(argc, argv, "--bench")) {
+        // overlay 对比的 OCR 烧录用 QPainter 绘字，需要 QGuiApplication（无显示环境加 -platform offscreen）
+        QGuiApplication app(argc, argv);
+        const int ret = runBenchmarks(app);
+        shutdownLogging();
+        return ret;
+    }
+
+    // 命令行会话回放模式：不启动界面
+    if (hasArgument(argc, argv, "--replay")) {
+        QCoreApplication app(argc, argv);
+        const int ret = runSessionReplay(app);
+        shutdownLogging();
+        return ret;
+    }
+
     QApplication a(argc, argv);
 
+    // --record <会话.evs>：录制本次运行的 Pipeline 输入与外部指令（也可由 MQTT record_start 开始）
+    const int recordIndex = a.arguments().indexOf("--record");
+    if (recordIndex >= 0) {
+        const QString next = a.arguments().value(recordIndex + 1);
+        const QString path = next.isEmpty() || next.startsWith('-') ? SessionRecorder::defaultPath() : next;
+        SessionRecorder::instance().start(path);
+    }
+
     // 创建启动闪屏
     QPixmap splashPix = createSplashPixmap();
     QSplashScreen splash(splashPix, Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
@@ -104,5 +346,8 @@ int main(int argc, char *argv[])
     w.show();
     splash.finish(&w);
 
-    return a.exec();
+    const int ret = a.exec();
+    SessionRecorder::instance().stop();
+    shutdownLogging();  // 写完异步日志队列，之后（析构阶段）的日志同步写出
+    return ret;
 }
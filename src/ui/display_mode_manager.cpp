@@ -69,7 +69,9 @@ bool DisplayModeManager::displayCurrentResult()
     cv::Mat displayImage = m_pipelineManager->getLastDisplayWithMode(mode);
     if (!displayImage.empty()) {
         spdlog::debug("[DisplayMode] displayCurrentResult: 使用缓存渲染, mode={} size={}x{}", static_cast<int>(mode), displayImage.cols, displayImage.rows);
-        m_view->setImage(ImageUtils::matToQImage(displayImage));
+        // 叠加类模式共用同一底图，setImageMat 识别后只替换叠加层，不重新上传像素
+        m_view->setImageMat(displayImage);
+        m_view->setOverlay(m_pipelineManager->getLastOverlayWithMode(mode));
     }
     return true;
 }
\ No newline at end of file
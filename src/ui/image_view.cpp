@@ -1,7 +1,11 @@
 ﻿#include "image_view.h"
 #include "logger.h"
+#include "image_utils.h"
 #include "qapplication.h"
 #include <QAction>
+#include <QGraphicsItemGroup>
+#include <QGraphicsSimpleTextItem>
+#include <QFontMetrics>
 #include <algorithm>   // 为 std::clamp
 
 ImageView::ImageView(QWidget *parent)
@@ -39,6 +43,9 @@ void ImageView::setImageInternal(const QImage &img, bool keepZoom)
     m_roiState = RoiState::None;
     m_roiHandle = None;
 
+    // 旧叠加层属于上一帧，由调用方在 setImage 之后重新设置
+    clearOverlay();
+
     // 根据参数决定是否重置缩放
     if (!keepZoom) {
         resetTransform();
@@ -54,15 +61,32 @@ void ImageView::setImageInternal(const QImage &img, bool keepZoom)
 /// 设置图像并重置缩放（自适应窗口）
 void ImageView::setImage(const QImage &img)
 {
+    m_displayedMat.release();
     setImageInternal(img, false);
 }
 
 /// 设置图像并保持当前缩放比例
 void ImageView::setImageKeepZoom(const QImage &img)
 {
+    m_displayedMat.release();
     setImageInternal(img, true);
 }
 
+/// 显示 Mat；同一像素数据时复用已上传的 pixmap
+void ImageView::setImageMat(const cv::Mat &mat, bool keepZoom)
+{
+    if (mat.empty()) return;
+
+    if (!m_displayedMat.empty() && m_displayedMat.data == mat.data &&
+        m_displayedMat.size() == mat.size() && m_displayedMat.type() == mat.type()) {
+        clearOverlay();
+        return;
+    }
+
+    setImageInternal(ImageUtils::matToQImage(mat), keepZoom);
+    m_displayedMat = mat;
+}
+
 void ImageView::setRoiMode(bool enable)
 {
     m_roiState = enable ? RoiState::Drawing : RoiState::None;
@@ -855,6 +879,8 @@ void ImageView::resetZoom()
 
 void ImageView::clear()
 {
+    m_displayedMat.release();
+
     // 清空 pixmap
     m_pixmapItem->setPixmap(QPixmap());
     m_pixmapItem->setPos(0, 0);
@@ -873,6 +899,9 @@ void ImageView::clear()
     
     // 清理参考线
     clearReferenceLine();
+
+    // 清理叠加层
+    clearOverlay();
     
     // 重置缩放
     resetTransform();
@@ -885,6 +914,137 @@ void ImageView::showContextMenu(const QPoint& viewportPos)
     QMenu menu(this);
     QAction* fitAction = menu.addAction(QStringLiteral("适应窗口"));
     connect(fitAction, &QAction::triggered, this, &ImageView::resetZoom);
+
+    // 叠加层开关：只切换图元可见性，不重新渲染底图
+    QMenu* overlayMenu = menu.addMenu(QStringLiteral("叠加显示"));
+    const std::pair<OverlayGroup, QString> groups[] = {
+        {OverlayGroup::Barcode,         QStringLiteral("条码")},
+        {OverlayGroup::Ocr,             QStringLiteral("文字")},
+        {OverlayGroup::Line,            QStringLiteral("直线")},
+        {OverlayGroup::Mask,            QStringLiteral("区域Mask")},
+        {OverlayGroup::ObjectDetection, QStringLiteral("目标检测")},
+        {OverlayGroup::Caliper,         QStringLiteral("卡尺")},
+    };
+    for (const auto& [group, name] : groups) {
+        QAction* action = overlayMenu->addAction(name);
+        action->setCheckable(true);
+        action->setChecked(isOverlayGroupVisible(group));
+        connect(action, &QAction::toggled, this, [this, group = group](bool checked) {
+            setOverlayGroupVisible(group, checked);
+        });
+    }
+
     menu.exec(mapToGlobal(viewportPos));
 }
 
+// =================== 矢量叠加层 ===================
+QGraphicsItemGroup* ImageView::overlayGroup(OverlayGroup group)
+{
+    int idx = static_cast<int>(group);
+    if (idx < 0 || idx >= OVERLAY_GROUP_COUNT) return nullptr;
+
+    if (!m_overlayGroups[idx]) {
+        auto* g = new QGraphicsItemGroup(m_pixmapItem);
+        // Mask 在最下层，框/线/标签在其上，参考线提示(100)始终最上
+        g->setZValue(group == OverlayGroup::Mask ? 10 : 20);
+        g->setVisible(m_overlayVisible[idx]);
+        m_overlayGroups[idx] = g;
+    }
+    return m_overlayGroups[idx];
+}
+
+void ImageView::clearOverlay()
+{
+    for (auto* g : m_overlayGroups) {
+        if (!g) continue;
+        const auto children = g->childItems();
+        for (QGraphicsItem* child : children) {
+            g->removeFromGroup(child);
+            delete child;
+        }
+    }
+}
+
+void ImageView::setOverlay(const OverlayModel& overlay)
+{
+    clearOverlay();
+    if (overlay.isEmpty()) return;
+
+    // Mask 着色层：Indexed8 直接引用 Mask 数据，颜色表 0=透明、非0=着色
+    for (const auto& layer : overlay.masks) {
+        if (layer.mask.empty() || layer.mask.type() != CV_8UC1) continue;
+        cv::Mat m = layer.mask.isContinuous() ? layer.mask : layer.mask.clone();
+        QImage indexed(m.data, m.cols, m.rows, static_cast<int>(m.step), QImage::Format_Indexed8);
+        QVector<QRgb> colorTable(256, layer.color.rgba());
+        colorTable[0] = qRgba(0, 0, 0, 0);
+        indexed.setColorTable(colorTable);
+
+        auto* item = new QGraphicsPixmapItem(QPixmap::fromImage(indexed));
+        overlayGroup(layer.group)->addToGroup(item);
+        item->setPos(0, 0);
+    }
+
+    for (const auto& box : overlay.boxes) {
+        QPen pen(box.color, box.penWidth);
+        pen.setCosmetic(true);
+        auto* item = new QGraphicsRectItem(box.rect);
+        item->setPen(pen);
+        item->setBrush(Qt::NoBrush);
+        overlayGroup(box.group)->addToGroup(item);
+    }
+
+    for (const auto& poly : overlay.polylines) {
+        if (poly.points.size() < 2) continue;
+        QPainterPath path;
+        path.moveTo(poly.points.first());
+        for (int i = 1; i < poly.points.size(); ++i) {
+            path.lineTo(poly.points[i]);
+        }
+        if (poly.closed) path.closeSubpath();
+
+        QPen pen(poly.color, poly.penWidth);
+        pen.setCosmetic(true);
+        auto* item = new QGraphicsPathItem(path);
+        item->setPen(pen);
+        overlayGroup(poly.group)->addToGroup(item);
+    }
+
+    // 标签不随缩放变化（ItemIgnoresTransformations），背景框包围文字
+    QFont font("Microsoft YaHei", 10);
+    QFontMetrics fm(font);
+    for (const auto& label : overlay.labels) {
+        if (label.text.isEmpty()) continue;
+        QRectF textRect = fm.boundingRect(label.text);
+
+        auto* bg = new QGraphicsRectItem(0, -textRect.height() - 4, textRect.width() + 6, textRect.height() + 6);
+        bg->setPen(Qt::NoPen);
+        bg->setBrush(label.background);
+        bg->setFlag(QGraphicsItem::ItemIgnoresTransformations);
+
+        auto* text = new QGraphicsSimpleTextItem(label.text, bg);
+        text->setFont(font);
+        text->setBrush(label.textColor);
+        text->setPos(3, -textRect.height() - 2);
+
+        overlayGroup(label.group)->addToGroup(bg);
+        bg->setPos(label.anchor);
+    }
+}
+
+void ImageView::setOverlayGroupVisible(OverlayGroup group, bool visible)
+{
+    int idx = static_cast<int>(group);
+    if (idx < 0 || idx >= OVERLAY_GROUP_COUNT) return;
+    m_overlayVisible[idx] = visible;
+    if (m_overlayGroups[idx]) {
+        m_overlayGroups[idx]->setVisible(visible);
+    }
+}
+
+bool ImageView::isOverlayGroupVisible(OverlayGroup group) const
+{
+    int idx = static_cast<int>(group);
+    if (idx < 0 || idx >= OVERLAY_GROUP_COUNT) return false;
+    return m_overlayVisible[idx];
+}
+
@@ -8,6 +8,7 @@
 
 // 各模块完整定义
 #include "system_monitor.h"
+#include "core/metrics_http_server.h"
 #include "file_manager.h"
 #include "config_manager.h"
 #include "widgets/image_list_manager.h"
@@ -24,6 +25,11 @@
 #include "ui/cloud_dashboard_manager.h"
 #include "ui/display_mode_manager.h"
 #include "controllers/profile_controller.h"
+#include "core/capture_service.h"
+#include "core/metrics.h"
+#include "core/mat_arena.h"
+#include "core/session_recorder.h"
+#include "utils/thread_tag.h"
 
 // Tab Widget头文件
 #include "widgets/video_tab_widget.h"
@@ -37,10 +43,12 @@
 #include <QThread>
 #include <QDir>
 #include <QTimer>
+#include <QFutureWatcher>
 #include <QFileDialog>
 #include <QInputDialog>
 #include <QLineEdit>
 #include <QGroupBox>
+#include <chrono>
 
 
 MainWindow::MainWindow(QWidget *parent)
@@ -88,8 +96,14 @@ void MainWindow::stopAllAsyncOperations()
         }
     }
 
+    // 关闭常驻采集相机
+    if (m_captureService) {
+        m_captureService->stop();
+    }
+
     // 取消所有待处理的Pipeline请求
     m_pipelineManager->scheduler()->cancelAll();
+    MatArena::trimAll();
 
     // No Logger singleton to disconnect from anymore
 }
@@ -105,6 +119,12 @@ void MainWindow::setupBasicInfrastructure()
     // 系统监控
     m_systemMonitor->setupWithStatusBar(ui->statusbar, AppConstants::SYSTEM_MONITOR_INTERVAL_MS);
 
+    // 本地指标端点（Prometheus 抓取 /metrics）
+    if (AppConstants::METRICS_HTTP_PORT > 0) {
+        m_metricsServer = new MetricsHttpServer(this);
+        m_metricsServer->start(AppConstants::METRICS_HTTP_PORT);
+    }
+
     // Pipeline 耗时标签（StatusBar 永久显示，最左侧）
     m_timingLabel = new QLabel(this);
     m_timingLabel->setTextFormat(Qt::RichText);
@@ -147,6 +167,7 @@ void MainWindow::setupConnections()
         // 清空Pipeline结果，防止旧结果污染新图片显示
         m_pipelineManager->clearLastResult();
         m_pipelineManager->resetPipeline();
+        m_pipelineManager->resetSourceState();
         
         // [FIX] 加载新图片的Pipeline配置（在resetPipeline之后）
         applyImagePipelineConfig(m_roiManager.getCurrentImageId());
@@ -262,6 +283,10 @@ void MainWindow::setupManagers()
 
     // 创建检测方案管理器
     m_profileManager = new ProfileManager(&m_roiManager, m_pipelineManager, this);
+    // 切换方案后 ROI 与图像尺寸随之变化，清除上一方案的跨帧状态和缓冲池
+    connect(m_profileManager, &ProfileManager::profileLoaded, this, [this]() {
+        m_pipelineManager->resetSourceState();
+    });
 
     m_imageListManager = new ImageListManager(m_roiManager, m_fileManager, this, this);
     m_imageListManager->init(ui->listWidget_images, ui->btn_addImage, ui->btn_removeImage);
@@ -368,8 +393,27 @@ void MainWindow::setupControllerConnections()
             if (auto* videoTab = qobject_cast<VideoTabWidget*>(widget)) {
                 connect(videoTab->getVideoManager(), &VideoManager::playbackStateChanged,
                         this, [this](VideoManager::PlaybackState state) {
-                            m_pipelineResultHandler->setVideoMode(state == VideoManager::PlaybackState::Playing);
+                            m_videoPlaying = state == VideoManager::PlaybackState::Playing;
+                            m_pipelineResultHandler->setVideoMode(m_videoPlaying);
+                            // 播放开始/停止都从头建立门控参考帧，避免沿用上一段视频的结果
+                            m_pipelineManager->scheduler()->resetChangeGate();
+                            m_pipelineManager->resetSourceState();
                         });
+                // 视频页要打开的正是常驻采集相机时先让出设备（同一相机不能被打开两次），关闭后恢复
+                VideoManager* vm = videoTab->getVideoManager();
+                connect(vm, &VideoManager::aboutToOpenCamera, this, [this](int cameraIndex) {
+                    if (m_captureService && m_captureService->isRunning() &&
+                        QString::number(cameraIndex) == m_captureService->config().device) {
+                        spdlog::info("[capture] 视频页占用采集相机，暂停常驻采集");
+                        m_captureService->stop();
+                    }
+                });
+                connect(vm, &VideoManager::videoClosed, this, [this]() {
+                    if (m_captureService && !m_captureService->isRunning() && !m_isDestroying &&
+                        m_mqttManager && m_mqttManager->client() && m_mqttManager->client()->config().enabled) {
+                        m_captureService->start(m_captureService->config());
+                    }
+                });
             }
 
             // 5. StepConfigWidget 特殊处理：tabsNeeded 信号
@@ -465,6 +509,7 @@ void MainWindow::setupControllerConnections()
         spdlog::info("[MainWindow] currentImageChanged: 切换到图片 {}", newImageId.toStdString());
 
         m_pipelineManager->clearLastResult();
+        m_pipelineManager->resetSourceState();
         cv::Mat currentImage = m_roiManager.getCurrentImage();
         if (!currentImage.empty()) {
             showImage(currentImage);
@@ -544,14 +589,29 @@ void MainWindow::processAndDisplay()
 
     m_displayModeManager->applyModeForCurrentTab();
 
-    cv::Mat currentImage = m_roiManager.getCurrentImage();
-    if (currentImage.empty()) return;
+    FrameView currentFrame = m_roiManager.getCurrentFrame();
+    if (currentFrame.empty()) return;
 
     ui->statusbar->showMessage("正在处理...");
 
-    // 使用调度器异步执行
+    // 使用调度器异步执行（ROI 以子视图提交，不拷贝像素）
     PipelineConfig configSnapshot = m_pipelineManager->getConfigSnapshot();
-    m_pipelineManager->scheduler()->submit(currentImage, configSnapshot, 0, "MainWindow::processAndDisplay");
+    const QString roiId = m_roiManager.getActiveRoiId();
+    const QString source = liveStreamSource();
+    SessionRecorder& recorder = SessionRecorder::instance();
+    if (recorder.isRecording()) {
+        recorder.recordFrame(m_videoPlaying ? SessionRecorder::Origin::Live : SessionRecorder::Origin::Interactive,
+                             source, currentFrame, configSnapshot,
+                             m_roiManager.getRoiConfig(roiId));
+    }
+    if (m_videoPlaying) {
+        // 实时视频：走流式槽（新帧覆盖未执行的旧帧、不消抖），画面无变化时重发该 ROI 的上次结果
+        m_lastSubmittedRequestId = m_pipelineManager->scheduler()->submitLatest(
+            source, currentFrame, configSnapshot, "MainWindow::processAndDisplay", roiId);
+    } else {
+        m_lastSubmittedRequestId = m_pipelineManager->scheduler()->submit(
+            currentFrame, configSnapshot, 0, "MainWindow::processAndDisplay", roiId);
+    }
 }
 
 void MainWindow::showImage(const cv::Mat &img)
@@ -677,75 +737,26 @@ void MainWindow::setupMqtt()
     });
 
     // Feature 2: 云端指令 → 调用本地功能
-    connect(m_mqttManager, &MqttManager::captureRequested,
-            this, [this]() {
-        m_toast->showMessage("收到云端指令: 采集检测");
-        
-        cv::Mat frame;
-        
-        // 1. 优先从已打开的VideoManager获取新帧
-        VideoTabWidget* videoTab = m_tabManager->getTabAs<VideoTabWidget>("视频");
-        if (videoTab) {
-            VideoManager* vm = videoTab->getVideoManager();
-            if (vm && vm->isOpened()) {
-                frame = vm->getNextFrame();
-            }
-        }
-        
-        // 2. 如果VideoManager未打开或获取失败，自动打开相机捕获一帧
-        if (frame.empty()) {
-            m_toast->showMessage("正在自动打开相机捕获...");
-            
-            try {
-                cv::VideoCapture tempCapture;
-                // 尝试DirectShow后端（Windows兼容性更好）
-                tempCapture.open(1, cv::CAP_DSHOW);  // 使用USB摄像头(索引1)
-                
-                if (!tempCapture.isOpened()) {
-                    tempCapture.open(1);  // 回退到默认后端
-                }
-                
-                if (tempCapture.isOpened()) {
-                    // 等待相机稳定（约300ms）
-                    QThread::msleep(300);
-                    
-                    cv::Mat rawFrame;
-                    if (tempCapture.read(rawFrame)) {
-                        // 相机源左右翻转，提升体验
-                        cv::flip(rawFrame, frame, 1);
-                    }
-                    tempCapture.release();
-                }
-            } catch (const cv::Exception& ex) {
-                spdlog::error("自动打开相机失败: {}", ex.what());
-            }
-        }
-        
-        // 3. 检查是否成功获取帧
-        if (frame.empty()) {
-            m_toast->showMessage("错误：无法获取图像，请手动打开相机");
-            return;
-        }
-        
-        // 4. 将帧存入RoiManager并触发检测
-        m_roiManager.setFullImage(frame);
-        
-        // 为capture采集的图像自动添加全图ROI配置（如果还没有ROI配置）
-        QString currentImageId = m_roiManager.getCurrentImageId();
-        if (!currentImageId.isEmpty() && m_roiManager.getRoiConfigsForImage(currentImageId).isEmpty()) {
-            RoiConfig defaultRoi;
-            defaultRoi.roiId = "capture_default_roi";
-            defaultRoi.roiName = "全图检测区域";
-            defaultRoi.roiRect = QRectF(0, 0, 1, 1);  // 全图（归一化坐标）
-            defaultRoi.pipelineConfig = m_pipelineManager->getConfigSnapshot();
-            defaultRoi.isActive = true;
-            m_roiManager.addRoiConfig(defaultRoi);
-            spdlog::info("[capture] 已为采集的图像添加默认全图ROI配置");
-        }
-        
-        m_toast->showMessage("已采集新帧，正在处理...");
-        requestRefresh();
+    // capture 指令从常驻采集服务取帧：相机在 MQTT 启用时即打开并持续采集，指令到达时不再开相机
+    m_captureService = new CaptureService(this);
+    AppConfig appConfig;
+    ConfigManager::instance().loadConfig(appConfig, ConfigManager::instance().getDefaultConfigPath());
+    if (m_mqttManager->client() && m_mqttManager->client()->config().enabled) {
+        m_captureService->start(appConfig.captureConfig);
+    }
+    connect(m_captureService, &CaptureService::deviceStateChanged,
+            this, [](bool ready, const QString& device) {
+        spdlog::info("[capture] 采集相机 {} {}", device, ready ? "已就绪" : "已断开");
     });
+
+    connect(m_mqttManager, &MqttManager::captureRequested,
+            this, &MainWindow::handleCaptureCommand);
+    connect(m_pipelineManager->scheduler(), &PipelineScheduler::finished,
+            this, &MainWindow::completePendingCaptures);
+    // 有等待结果的指令时定期检查超时，不依赖下一条指令到达
+    m_captureSweepTimer = new QTimer(this);
+    m_captureSweepTimer->setInterval(1000);
+    connect(m_captureSweepTimer, &QTimer::timeout, this, &MainWindow::sweepPendingCaptures);
     connect(m_mqttManager, &MqttManager::startDetectionRequested,
             this, [this]() {
         m_toast->showMessage("收到云端指令: 开始批量检测");
@@ -762,6 +773,186 @@ void MainWindow::setupMqtt()
     });
 }
 
+namespace {
+
+double elapsedSinceMs(qint64 from)
+{
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::duration(CaptureService::now() - from)).count();
+}
+
+} // namespace
+
+QString MainWindow::liveStreamSource() const
+{
+    return m_roiManager.getCurrentImageId() + '/' + m_roiManager.getActiveRoiId();
+}
+
+void MainWindow::handleCaptureCommand(const QString& commandId, qint64 triggeredAt)
+{
+    m_toast->showMessage("收到云端指令: 采集检测");
+
+    // 1. 视频页已打开视频源时沿用其画面
+    VideoTabWidget* videoTab = m_tabManager->getTabAs<VideoTabWidget>("视频");
+    if (videoTab) {
+        VideoManager* vm = videoTab->getVideoManager();
+        if (vm && vm->isOpened()) {
+            const cv::Mat frame = vm->getNextFrame();
+            if (!frame.empty()) {
+                submitCaptureFrame(commandId, triggeredAt, frame, "video", 0);
+                return;
+            }
+        }
+    }
+
+    // 2. 常驻采集服务的最新帧（与帧环共享缓冲，不拷贝）
+    if (m_captureService->isReady()) {
+        const int waitMs = m_captureService->config().freshFrameTimeoutMs;
+        if (waitMs <= 0) {
+            const CaptureService::Frame captured = m_captureService->latest();
+            submitCaptureFrame(commandId, triggeredAt, captured.image, "capture",
+                               captured.ageMs(CaptureService::now()));
+            return;
+        }
+
+        // 等待触发之后采集的新帧：在线程池中等待，GUI 线程不阻塞（服务停止时等待立即结束）
+        auto* watcher = new QFutureWatcher<CaptureService::Frame>(this);
+        connect(watcher, &QFutureWatcher<CaptureService::Frame>::finished, this,
+                [this, watcher, commandId, triggeredAt]() {
+            watcher->deleteLater();
+            if (m_isDestroying) return;
+            const CaptureService::Frame captured = watcher->result();
+            submitCaptureFrame(commandId, triggeredAt, captured.image, "capture",
+                               captured.ageMs(CaptureService::now()));
+        });
+        watcher->setFuture(QtConcurrent::run([service = m_captureService, triggeredAt, waitMs]() {
+            ThreadTag::Scope tag("capture");
+            return service->frameAfter(triggeredAt, waitMs);
+        }));
+        return;
+    }
+
+    submitCaptureFrame(commandId, triggeredAt, cv::Mat(), QString(), 0);
+}
+
+void MainWindow::submitCaptureFrame(const QString& commandId, qint64 triggeredAt, const cv::Mat& frame,
+                                    const QString& source, double frameAgeMs)
+{
+    const double acquireMs = elapsedSinceMs(triggeredAt);
+    if (frame.empty()) {
+        const QString error = m_captureService->isRunning() ? "采集相机尚未就绪" : "无法获取图像，请手动打开相机";
+        m_toast->showMessage("错误：" + error);
+        m_mqttManager->publishCommandResponse("capture", commandId,
+            {{"status", "error"}, {"error", error}, {"acquireMs", acquireMs}});
+        return;
+    }
+
+    // 3. 将帧存入RoiManager并触发检测
+    m_roiManager.setFullImage(frame);
+
+    // 为capture采集的图像自动添加全图ROI配置（如果还没有ROI配置）
+    QString currentImageId = m_roiManager.getCurrentImageId();
+    if (!currentImageId.isEmpty() && m_roiManager.getRoiConfigsForImage(currentImageId).isEmpty()) {
+        RoiConfig defaultRoi;
+        defaultRoi.roiId = "capture_default_roi";
+        defaultRoi.roiName = "全图检测区域";
+        defaultRoi.roiRect = QRectF(0, 0, 1, 1);  // 全图（归一化坐标）
+        defaultRoi.pipelineConfig = m_pipelineManager->getConfigSnapshot();
+        defaultRoi.isActive = true;
+        m_roiManager.addRoiConfig(defaultRoi);
+        spdlog::info("[capture] 已为采集的图像添加默认全图ROI配置");
+    }
+
+    m_lastSubmittedRequestId = -1;
+    requestRefresh();
+    const PendingCapture pending{commandId, triggeredAt, m_lastSubmittedRequestId, acquireMs, frameAgeMs, source};
+
+    if (pending.requestId < 0 && m_videoPlaying) {
+        // 实时视频的流式提交被变化门控跳过（画面与上次执行的帧相同）：
+        // 更新的帧仍在执行时等它的结果，否则直接用该 ROI 的上次结果回答
+        PipelineScheduler* scheduler = m_pipelineManager->scheduler();
+        const QString streamSource = liveStreamSource();
+        const qint64 inflight = scheduler->pendingStreamRequest(streamSource);
+        if (inflight >= 0) {
+            PendingCapture waiting = pending;
+            waiting.requestId = inflight;
+            m_pendingCaptures.append(waiting);
+            m_captureSweepTimer->start();
+            return;
+        }
+        if (const PipelineResult* last = scheduler->lastStreamResult(streamSource)) {
+            publishCaptureResponse(pending, *last, true);
+            return;
+        }
+    }
+
+    if (pending.requestId < 0) {
+        m_mqttManager->publishCommandResponse("capture", commandId,
+            {{"status", "error"}, {"error", "检测未提交"}, {"acquireMs", acquireMs}});
+        return;
+    }
+
+    m_pendingCaptures.append(pending);
+    m_captureSweepTimer->start();
+    m_toast->showMessage("已采集新帧，正在处理...");
+}
+
+void MainWindow::publishCaptureResponse(const PendingCapture& pending, const PipelineResult& result, bool reused)
+{
+    static MetricHistogram& triggerLatency = MetricsRegistry::instance().histogram(
+        "edgevision_capture_trigger_to_result_ms", "MQTT capture 指令从收到到检测结果返回的耗时（ms）");
+
+    const double totalMs = elapsedSinceMs(pending.triggeredAt);
+    triggerLatency.observe(totalMs);
+
+    QJsonObject latency;
+    latency["acquireMs"] = pending.acquireMs;
+    latency["frameAgeMs"] = pending.frameAgeMs;
+    latency["pipelineMs"] = reused ? 0.0 : result.elapsedMs();
+    latency["totalMs"] = totalMs;
+
+    QJsonObject fields;
+    fields["status"] = result.isSuccess() ? "ok" : "error";
+    if (!result.isSuccess()) fields["error"] = result.errorMessage();
+    fields["source"] = pending.source;
+    if (reused) fields["reused"] = true;
+    fields["latency"] = latency;
+    m_mqttManager->publishCommandResponse("capture", pending.commandId, fields);
+    spdlog::info("[capture] 指令完成{}: 取帧 {:.1f} ms（帧龄 {:.1f} ms），触发到结果 {:.1f} ms",
+                 reused ? "（画面无变化，复用上次结果）" : "", pending.acquireMs, pending.frameAgeMs, totalMs);
+}
+
+void MainWindow::completePendingCaptures(const PipelineResult& result)
+{
+    if (m_pendingCaptures.isEmpty()) return;
+
+    // 请求 ID 单调递增：消抖/去重时旧请求被新请求取代，新请求的结果同样回答旧指令
+    for (int i = m_pendingCaptures.size() - 1; i >= 0; --i) {
+        const PendingCapture& pending = m_pendingCaptures[i];
+        if (pending.requestId > result.requestId()) continue;
+
+        publishCaptureResponse(pending, result, false);
+        m_pendingCaptures.removeAt(i);
+    }
+    if (m_pendingCaptures.isEmpty()) m_captureSweepTimer->stop();
+}
+
+void MainWindow::sweepPendingCaptures()
+{
+    // 超过 10 秒仍未等到结果的指令（请求被取消/覆盖）回复超时
+    constexpr double kPendingTimeoutMs = 10000.0;
+    for (int i = m_pendingCaptures.size() - 1; i >= 0; --i) {
+        const PendingCapture& pending = m_pendingCaptures[i];
+        const double totalMs = elapsedSinceMs(pending.triggeredAt);
+        if (totalMs > kPendingTimeoutMs) {
+            m_mqttManager->publishCommandResponse("capture", pending.commandId,
+                {{"status", "timeout"}, {"totalMs", totalMs}});
+            m_pendingCaptures.removeAt(i);
+        }
+    }
+    if (m_pendingCaptures.isEmpty()) m_captureSweepTimer->stop();
+}
+
 // ========== Tab懒加载 ==========
 
 void MainWindow::ensureTabExists(const QString& tabName)
@@ -1,17 +1,26 @@
 ﻿#include "system_monitor.h"
 #include "logger.h"
+#include "core/metrics.h"
+#include "utils/thread_tag.h"
+#include <QtConcurrent/QtConcurrent>
 #include <algorithm>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/core/utils/allocator_stats.hpp>
 
 // ========== 平台相关头文件 ==========
 #ifdef Q_OS_WIN
 #include <windows.h>
 #include <pdh.h>
+#include <psapi.h>
+#include <tlhelp32.h>
 #endif
 
 #ifdef Q_OS_LINUX
 #include <fstream>
 #include <sstream>
 #include <unistd.h>
+#include <malloc.h>
+#include <QDir>
 #endif
 
 SystemMonitor::SystemMonitor(QObject* parent)
@@ -19,6 +28,7 @@ SystemMonitor::SystemMonitor(QObject* parent)
     , m_cpuLabel(nullptr)
     , m_memoryLabel(nullptr)
     , m_updateTimer(new QTimer(this))
+    , m_sampleWatcher(new QFutureWatcher<Sample>(this))
     , m_cpuUsage(0.0)
     , m_memoryUsage(0.0)
     , m_usedMemoryMB(0.0)
@@ -35,6 +45,13 @@ SystemMonitor::SystemMonitor(QObject* parent)
     // 连接定时器
     connect(m_updateTimer, &QTimer::timeout, this, &SystemMonitor::updateSystemInfo);
 
+    // 采样在专属线程执行（Toolhelp 线程快照 / /proc 遍历不占用 GUI 线程）
+    m_samplePool.setMaxThreadCount(1);
+    m_samplePool.setExpiryTimeout(-1);
+    connect(m_sampleWatcher, &QFutureWatcher<Sample>::finished, this, [this]() {
+        applySample(m_sampleWatcher->result());
+    });
+
     // 设置默认更新间隔（1秒）
     m_updateTimer->setInterval(1000);
 
@@ -44,6 +61,7 @@ SystemMonitor::SystemMonitor(QObject* parent)
 SystemMonitor::~SystemMonitor()
 {
     stopMonitoring();
+    m_samplePool.waitForDone();  // 采样线程仍在使用平台资源
     cleanupPlatformResources();
 }
 
@@ -139,41 +157,149 @@ void SystemMonitor::setupWithStatusBar(QStatusBar* statusBar, int intervalMs)
 
 void SystemMonitor::updateSystemInfo()
 {
+    // 上一次采样尚未完成（系统繁忙）时跳过本周期，不堆积
+    if (m_sampleWatcher->isRunning()) return;
+
+    m_sampleWatcher->setFuture(QtConcurrent::run(&m_samplePool, [this]() {
+        ThreadTag::setCurrent("monitor");
+        return collectSample();
+    }));
+}
+
+SystemMonitor::Sample SystemMonitor::collectSample()
+{
+    Sample sample;
+
     // 1️⃣ 获取 CPU 使用率
-    m_cpuUsage = getCpuUsage();
+    sample.cpuUsage = getCpuUsage();
 
     // 2️⃣ 获取内存使用情况
-    m_memoryUsage = getMemoryUsage(m_usedMemoryMB, m_totalMemoryMB);
+    sample.memoryUsage = getMemoryUsage(sample.usedMemoryMB, sample.totalMemoryMB);
 
-    // 3️⃣ 更新 UI 显示
+    // 3️⃣ 获取本进程占用（依赖本周期的整机 CPU 采样）
+    sampleProcessUsage(sample.process);
+
+    return sample;
+}
+
+void SystemMonitor::applySample(const Sample& sample)
+{
+    m_cpuUsage = sample.cpuUsage;
+    m_memoryUsage = sample.memoryUsage;
+    m_usedMemoryMB = sample.usedMemoryMB;
+    m_totalMemoryMB = sample.totalMemoryMB;
+    m_process = sample.process;
+
+    // 4️⃣ 更新 UI 显示
     if (m_cpuLabel) {
         m_cpuLabel->setText(
-            QString("<img src=':/icons/CPU.png' width='16' height='16' style='vertical-align: middle;'> CPU: %1%")
+            QString("<img src=':/icons/CPU.png' width='16' height='16' style='vertical-align: middle;'> CPU: %1% (本进程 %2%)")
                 .arg(m_cpuUsage, 0, 'f', 1)
+                .arg(m_process.cpuPercent, 0, 'f', 1)
         );
     }
 
     if (m_memoryLabel) {
-        // 显示格式：内存: 1234 MB / 8192 MB (15.1%)
+        // 显示格式：内存: 1234 MB / 8192 MB (15.1%) | 本进程 512 MB
         m_memoryLabel->setText(
-            QString("<img src=':/icons/memory.png' width='16' height='16' style='vertical-align: middle;'> 内存: %1 MB / %2 MB (%3%)")
+            QString("<img src=':/icons/memory.png' width='16' height='16' style='vertical-align: middle;'> 内存: %1 MB / %2 MB (%3%) | 本进程 %4 MB")
                 .arg(m_usedMemoryMB, 0, 'f', 0)
                 .arg(m_totalMemoryMB, 0, 'f', 0)
                 .arg(m_memoryUsage, 0, 'f', 1)
+                .arg(m_process.rssMB, 0, 'f', 0)
         );
     }
 
-    // 4️⃣ 发送信号
+    // 5️⃣ 同步到指标注册表，并借本定时器推进滚动速率采样
+    static MetricGauge& cpuGauge = MetricsRegistry::instance().gauge(
+        "edgevision_system_cpu_percent", "整机 CPU 占用率（%）");
+    static MetricGauge& memGauge = MetricsRegistry::instance().gauge(
+        "edgevision_system_memory_used_mb", "整机已用内存（MB）");
+    cpuGauge.set(m_cpuUsage);
+    memGauge.set(m_usedMemoryMB);
+    publishProcessMetrics();
+    MetricsRegistry::instance().sampleRates();
+
+    // 6️⃣ 发送信号
     emit cpuUsageUpdated(m_cpuUsage);
     emit memoryUsageUpdated(m_usedMemoryMB, m_totalMemoryMB, m_memoryUsage);
+    emit processUsageUpdated(m_process);
+}
+
+void SystemMonitor::publishProcessMetrics()
+{
+    // OpenCV 分配器统计与平台无关（cv::Mat 数据走 cv::fastMalloc）
+    cv::utils::AllocatorStatisticsInterface& cvStats = cv::getAllocatorStatistics();
+    m_process.cvAllocMB = cvStats.getCurrentUsage() / (1024.0 * 1024.0);
+    m_process.cvAllocPeakMB = cvStats.getPeakUsage() / (1024.0 * 1024.0);
+
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    static MetricGauge& cpu = registry.gauge("edgevision_process_cpu_percent", "本进程 CPU 占用（占整机的百分比）");
+    static MetricGauge& rss = registry.gauge("edgevision_process_rss_mb", "本进程常驻内存（MB，Windows 为工作集）");
+    static MetricGauge& pss = registry.gauge("edgevision_process_pss_mb", "本进程 PSS（MB，Windows 为私有提交）");
+    static MetricGauge& threads = registry.gauge("edgevision_process_threads", "本进程线程数");
+    static MetricGauge& heap = registry.gauge("edgevision_heap_in_use_mb", "C 运行时堆已分配（MB）");
+    static MetricGauge& cvAlloc = registry.gauge("edgevision_opencv_alloc_mb", "OpenCV 分配器当前占用（MB）");
+    static MetricGauge& cvPeak = registry.gauge("edgevision_opencv_alloc_peak_mb", "OpenCV 分配器峰值占用（MB）");
+    cpu.set(m_process.cpuPercent);
+    rss.set(m_process.rssMB);
+    pss.set(m_process.pssMB);
+    threads.set(m_process.threadCount);
+    heap.set(m_process.heapInUseMB);
+    cvAlloc.set(m_process.cvAllocMB);
+    cvPeak.set(m_process.cvAllocPeakMB);
+
+    // 线程池明细：本周期未出现的池归零，避免残留旧值
+    QSet<QString> seen;
+    for (const ThreadPoolUsage& pool : m_process.pools) {
+        registry.gauge("edgevision_thread_pool_cpu_percent", "各线程池 CPU 占用（占整机的百分比）",
+                       {{"pool", pool.pool}}).set(pool.cpuPercent);
+        registry.gauge("edgevision_thread_pool_threads", "各线程池线程数",
+                       {{"pool", pool.pool}}).set(pool.threads);
+        seen.insert(pool.pool);
+        m_knownPools.insert(pool.pool);
+    }
+    for (const QString& pool : std::as_const(m_knownPools)) {
+        if (seen.contains(pool)) continue;
+        registry.gauge("edgevision_thread_pool_cpu_percent", "各线程池 CPU 占用（占整机的百分比）",
+                       {{"pool", pool}}).set(0.0);
+        registry.gauge("edgevision_thread_pool_threads", "各线程池线程数",
+                       {{"pool", pool}}).set(0);
+    }
 }
 
+namespace {
+
+/// 把线程样本按池汇总，按 CPU 占用降序
+void accumulatePool(QVector<ThreadPoolUsage>& pools, const QString& pool, double cpuPercent)
+{
+    for (ThreadPoolUsage& p : pools) {
+        if (p.pool == pool) {
+            ++p.threads;
+            p.cpuPercent += cpuPercent;
+            return;
+        }
+    }
+    pools.append({pool, 1, cpuPercent});
+}
+
+void sortPools(QVector<ThreadPoolUsage>& pools)
+{
+    std::sort(pools.begin(), pools.end(), [](const ThreadPoolUsage& a, const ThreadPoolUsage& b) {
+        return a.cpuPercent > b.cpuPercent;
+    });
+}
+
+} // namespace
+
 // ========== Windows 平台实现 ==========
 
 #ifdef Q_OS_WIN
 
 void SystemMonitor::initPlatformResources()
 {
+    m_mainThreadId = GetCurrentThreadId();  // 构造于 GUI 线程
+
     PDH_STATUS status = PdhOpenQuery(nullptr, 0, &m_pdhQuery);
     if (status != ERROR_SUCCESS) {
         spdlog::debug("[SystemMonitor] PdhOpenQuery failed: {}", status);
@@ -253,6 +379,97 @@ double SystemMonitor::getMemoryUsage(double& usedMB, double& totalMB)
     return usagePercent;
 }
 
+
+namespace {
+
+unsigned long long fileTimeToUll(const FILETIME& ft)
+{
+    return (static_cast<unsigned long long>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+
+} // namespace
+
+void SystemMonitor::sampleProcessUsage(ProcessUsage& usage)
+{
+    // 内存：工作集 ≈ RSS；私有提交代替 PSS（Windows 没有按比例分摊的口径）
+    PROCESS_MEMORY_COUNTERS_EX pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof(pmc))) {
+        usage.rssMB = pmc.WorkingSetSize / (1024.0 * 1024.0);
+        usage.pssMB = pmc.PrivateUsage / (1024.0 * 1024.0);
+    }
+
+    // MSVC CRT 的 malloc 直接使用进程默认堆
+    HEAP_SUMMARY heapSummary;
+    heapSummary.cb = sizeof(heapSummary);
+    if (HeapSummary(GetProcessHeap(), 0, &heapSummary)) {
+        usage.heapInUseMB = heapSummary.cbAllocated / (1024.0 * 1024.0);
+    }
+
+    // CPU：CPU 时间增量 / (墙钟增量 × 逻辑核数)
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    const unsigned long long wallTime = fileTimeToUll(now);
+    const double capacity = m_lastWallTime > 0
+        ? static_cast<double>(wallTime - m_lastWallTime) * GetActiveProcessorCount(ALL_PROCESSOR_GROUPS)
+        : 0.0;
+    m_lastWallTime = wallTime;
+
+    FILETIME createTime, exitTime, kernelTime, userTime;
+    if (GetProcessTimes(GetCurrentProcess(), &createTime, &exitTime, &kernelTime, &userTime)) {
+        const unsigned long long processTime = fileTimeToUll(kernelTime) + fileTimeToUll(userTime);
+        if (m_lastProcessTime > 0 && capacity > 0 && processTime >= m_lastProcessTime) {
+            usage.cpuPercent = (processTime - m_lastProcessTime) / capacity * 100.0;
+        }
+        m_lastProcessTime = processTime;
+    }
+
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    const DWORD pid = GetCurrentProcessId();
+    QHash<unsigned long, unsigned long long> threadTimes;
+    usage.pools.clear();
+
+    THREADENTRY32 entry;
+    entry.dwSize = sizeof(entry);
+    for (BOOL ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry)) {
+        if (entry.th32OwnerProcessID != pid) continue;
+
+        HANDLE thread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, entry.th32ThreadID);
+        if (!thread) continue;
+
+        QString name;
+        PWSTR description = nullptr;
+        if (SUCCEEDED(GetThreadDescription(thread, &description)) && description) {
+            name = QString::fromWCharArray(description);
+            LocalFree(description);
+        }
+
+        double cpu = 0.0;
+        if (GetThreadTimes(thread, &createTime, &exitTime, &kernelTime, &userTime)) {
+            const unsigned long long time = fileTimeToUll(kernelTime) + fileTimeToUll(userTime);
+            threadTimes.insert(entry.th32ThreadID, time);
+            auto last = m_lastThreadTimes.constFind(entry.th32ThreadID);
+            if (last != m_lastThreadTimes.constEnd() && capacity > 0 && time >= last.value()) {
+                cpu = (time - last.value()) / capacity * 100.0;
+            }
+        }
+        CloseHandle(thread);
+
+        accumulatePool(usage.pools, ThreadTag::poolOf(name, entry.th32ThreadID == m_mainThreadId), cpu);
+    }
+    CloseHandle(snapshot);
+
+    usage.threadCount = 0;
+    for (const ThreadPoolUsage& pool : usage.pools) {
+        usage.threadCount += pool.threads;
+    }
+    m_lastThreadTimes = std::move(threadTimes);
+    sortPools(usage.pools);
+}
+
 #endif  // Q_OS_WIN
 
 // ========== Linux 平台实现 ==========
@@ -318,6 +535,7 @@ double SystemMonitor::getCpuUsage()
     // 更新上次的值
     m_lastTotalTime = totalTime;
     m_lastIdleTime = idleTime;
+    m_lastTotalDelta = totalDelta;
 
     // 计算使用率
     if (totalDelta == 0) {
@@ -382,6 +600,123 @@ double SystemMonitor::getMemoryUsage(double& usedMB, double& totalMB)
     return usagePercent;
 }
 
+
+namespace {
+
+/**
+ * 读取 /proc/.../stat 中的 utime+stime（单位 jiffies）及线程名
+ * comm 可能含空格和括号，因此从最后一个 ')' 之后开始按空格切分；
+ * 其后第一个字段为第 3 字段 state，utime/stime 为第 14/15 字段
+ */
+bool readStatTicks(const std::string& path, unsigned long long& ticks, std::string* comm = nullptr)
+{
+    std::ifstream file(path);
+    std::string line;
+    if (!file.is_open() || !std::getline(file, line)) {
+        return false;
+    }
+
+    const size_t open = line.find('(');
+    const size_t close = line.rfind(')');
+    if (open == std::string::npos || close == std::string::npos || close < open || close + 2 > line.size()) {
+        return false;
+    }
+    if (comm) {
+        *comm = line.substr(open + 1, close - open - 1);
+    }
+
+    std::istringstream ss(line.substr(close + 2));
+    std::string skip;
+    for (int field = 3; field < 14; ++field) {
+        ss >> skip;
+    }
+    unsigned long long utime = 0, stime = 0;
+    ss >> utime >> stime;
+    ticks = utime + stime;
+    return !ss.fail();
+}
+
+/// smaps_rollup（内核 4.14+）一次给出整个进程的 Rss/Pss，比逐段累加 smaps 便宜得多
+bool readSmapsRollup(double& rssMB, double& pssMB)
+{
+    std::ifstream file("/proc/self/smaps_rollup");
+    if (!file.is_open()) {
+        return false;
+    }
+
+    unsigned long long rssKB = 0, pssKB = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        std::string label;
+        unsigned long long value = 0;
+        ss >> label >> value;
+        if (label == "Rss:") rssKB = value;
+        else if (label == "Pss:") pssKB = value;
+    }
+    rssMB = rssKB / 1024.0;
+    pssMB = pssKB / 1024.0;
+    return rssKB > 0;
+}
+
+} // namespace
+
+void SystemMonitor::sampleProcessUsage(ProcessUsage& usage)
+{
+    // 内存：优先 smaps_rollup，旧内核回退到 statm（无 PSS，用 RSS 代替）
+    if (!readSmapsRollup(usage.rssMB, usage.pssMB)) {
+        std::ifstream statm("/proc/self/statm");
+        unsigned long long sizePages = 0, residentPages = 0;
+        if (statm >> sizePages >> residentPages) {
+            usage.rssMB = residentPages * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+            usage.pssMB = usage.rssMB;
+        }
+    }
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 heap = mallinfo2();
+    usage.heapInUseMB = (heap.uordblks + heap.hblkhd) / (1024.0 * 1024.0);
+#endif
+
+    // CPU：进程与线程的 jiffies 增量 / 整机 jiffies 增量（已包含所有核）
+    const double totalDelta = static_cast<double>(m_lastTotalDelta);
+
+    unsigned long long processTicks = 0;
+    if (readStatTicks("/proc/self/stat", processTicks)) {
+        if (m_lastProcessTicks > 0 && totalDelta > 0 && processTicks >= m_lastProcessTicks) {
+            usage.cpuPercent = (processTicks - m_lastProcessTicks) / totalDelta * 100.0;
+        }
+        m_lastProcessTicks = processTicks;
+    }
+
+    const qint64 pid = getpid();
+    const QStringList tids = QDir("/proc/self/task").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    QHash<qint64, unsigned long long> threadTicks;
+    threadTicks.reserve(tids.size());
+    usage.pools.clear();
+
+    for (const QString& tidText : tids) {
+        const qint64 tid = tidText.toLongLong();
+        unsigned long long ticks = 0;
+        std::string comm;
+        if (!readStatTicks("/proc/self/task/" + tidText.toStdString() + "/stat", ticks, &comm)) {
+            continue;   // 线程在枚举后退出
+        }
+        threadTicks.insert(tid, ticks);
+
+        double cpu = 0.0;
+        auto last = m_lastThreadTicks.constFind(tid);
+        if (last != m_lastThreadTicks.constEnd() && totalDelta > 0 && ticks >= last.value()) {
+            cpu = (ticks - last.value()) / totalDelta * 100.0;
+        }
+        accumulatePool(usage.pools, ThreadTag::poolOf(QString::fromStdString(comm), tid == pid), cpu);
+    }
+
+    usage.threadCount = static_cast<int>(threadTicks.size());
+    m_lastThreadTicks = std::move(threadTicks);
+    sortPools(usage.pools);
+}
+
 #endif  // Q_OS_LINUX
 
 // ========== MacOS 平台实现（备用） ==========
@@ -412,4 +747,11 @@ double SystemMonitor::getMemoryUsage(double& usedMB, double& totalMB)
     return 0.0;
 }
 
+
+void SystemMonitor::sampleProcessUsage(ProcessUsage& usage)
+{
+    // macOS 暂未支持进程级统计
+    Q_UNUSED(usage);
+}
+
 #endif  // Q_OS_MAC
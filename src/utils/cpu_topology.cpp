@@ -0,0 +1,166 @@
+#include "utils/cpu_topology.h"
+
+#include <QtGlobal>
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+struct CoreInfo
+{
+    int efficiency = 0;     // 越大越偏性能
+    int firstLogical = 0;
+};
+
+void finalize(CpuTopology& topo, std::vector<CoreInfo> cores, int logical)
+{
+    if (cores.empty()) return;
+
+    int maxEfficiency = 0;
+    int minEfficiency = cores.front().efficiency;
+    for (const CoreInfo& c : cores) {
+        maxEfficiency = std::max(maxEfficiency, c.efficiency);
+        minEfficiency = std::min(minEfficiency, c.efficiency);
+    }
+
+    std::stable_sort(cores.begin(), cores.end(), [](const CoreInfo& a, const CoreInfo& b) {
+        return a.efficiency > b.efficiency;
+    });
+
+    topo.logicalCores = std::max(1, logical);
+    topo.physicalCores = static_cast<int>(cores.size());
+    topo.hybrid = maxEfficiency != minEfficiency;
+    topo.performanceCores = static_cast<int>(std::count_if(cores.begin(), cores.end(),
+        [maxEfficiency](const CoreInfo& c) { return c.efficiency == maxEfficiency; }));
+    topo.primaryLogical.clear();
+    for (const CoreInfo& c : cores)
+        topo.primaryLogical.push_back(c.firstLogical);
+}
+
+#ifdef Q_OS_LINUX
+// 解析 sysfs CPU 列表格式（"0-3,8,10-11"）
+std::vector<int> parseCpuList(const std::string& text)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        const size_t dash = part.find('-');
+        try {
+            const int first = std::stoi(part.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(part.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        } catch (const std::exception&) {
+            // 空行或格式异常，忽略该段
+        }
+    }
+    return cpus;
+}
+
+std::string readFirstLine(const std::string& path)
+{
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+#endif
+
+CpuTopology detect()
+{
+    CpuTopology topo;
+    const int fallback = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    topo.logicalCores = topo.physicalCores = topo.performanceCores = fallback;
+    for (int i = 0; i < fallback; ++i) topo.primaryLogical.push_back(i);
+
+#ifdef Q_OS_WIN
+    DWORD length = 0;
+    GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+    if (length == 0) return topo;
+
+    std::vector<char> buffer(length);
+    auto* base = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+    if (!GetLogicalProcessorInformationEx(RelationProcessorCore, base, &length)) return topo;
+
+    std::vector<CoreInfo> cores;
+    int logical = 0;
+    for (DWORD offset = 0; offset < length;) {
+        auto* info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+        offset += info->Size;
+        const PROCESSOR_RELATIONSHIP& proc = info->Processor;
+        // 只使用第 0 处理器组（≤64 逻辑核），线程绑核也只作用于该组
+        if (proc.GroupCount == 0 || proc.GroupMask[0].Group != 0) continue;
+
+        const KAFFINITY mask = proc.GroupMask[0].Mask;
+        int first = -1;
+        for (int bit = 0; bit < 64; ++bit) {
+            if (mask & (KAFFINITY(1) << bit)) {
+                if (first < 0) first = bit;
+                ++logical;
+            }
+        }
+        if (first >= 0) cores.push_back({static_cast<int>(proc.EfficiencyClass), first});
+    }
+    finalize(topo, std::move(cores), logical);
+#elif defined(Q_OS_LINUX)
+    // Intel 混合架构在 sysfs 中单独列出性能核
+    std::set<int> performance;
+    for (int cpu : parseCpuList(readFirstLine("/sys/devices/cpu_core/cpus")))
+        performance.insert(cpu);
+
+    std::vector<CoreInfo> cores;
+    std::set<int> seen;
+    int logical = 0;
+    for (int cpu = 0; cpu < fallback; ++cpu) {
+        const std::vector<int> siblings = parseCpuList(readFirstLine(
+            "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list"));
+        if (siblings.empty()) return topo;
+        ++logical;
+        const int first = *std::min_element(siblings.begin(), siblings.end());
+        if (!seen.insert(first).second) continue;
+        const bool isPerformance = performance.empty() || performance.count(first) > 0;
+        cores.push_back({isPerformance ? 1 : 0, first});
+    }
+    finalize(topo, std::move(cores), logical);
+#endif
+    return topo;
+}
+
+} // namespace
+
+const CpuTopology& CpuTopology::current()
+{
+    static const CpuTopology topo = detect();
+    return topo;
+}
+
+bool CpuTopology::pinCurrentThread(int logicalCpu)
+{
+    if (logicalCpu < 0) return false;
+#ifdef Q_OS_WIN
+    if (logicalCpu >= 64) return false;
+    return SetThreadAffinityMask(GetCurrentThread(), KAFFINITY(1) << logicalCpu) != 0;
+#elif defined(Q_OS_LINUX)
+    if (logicalCpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(logicalCpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    Q_UNUSED(logicalCpu);
+    return false;
+#endif
+}
@@ -0,0 +1,109 @@
+#include "utils/thread_tag.h"
+
+#include <cstring>
+#include <string>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#endif
+
+namespace {
+
+constexpr char kPrefix[] = "ev-";
+
+/// setCurrent 的缓存标记（避免重复设置线程名）
+thread_local std::string t_current;
+
+void setOsThreadName(const std::string& name)
+{
+#ifdef Q_OS_WIN
+    SetThreadDescription(GetCurrentThread(), QString::fromStdString(name).toStdWString().c_str());
+#elif defined(Q_OS_LINUX)
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#else
+    Q_UNUSED(name);
+#endif
+}
+
+bool getOsThreadName(std::string& name)
+{
+#ifdef Q_OS_WIN
+    PWSTR description = nullptr;
+    if (FAILED(GetThreadDescription(GetCurrentThread(), &description))) return false;
+    name = QString::fromWCharArray(description).toStdString();
+    LocalFree(description);
+    return true;
+#elif defined(Q_OS_LINUX)
+    char buffer[16] = {};
+    if (pthread_getname_np(pthread_self(), buffer, sizeof(buffer)) != 0) return false;
+    name = buffer;
+    return true;
+#else
+    Q_UNUSED(name);
+    return false;
+#endif
+}
+
+} // namespace
+
+namespace ThreadTag {
+
+void setCurrent(const char* pool)
+{
+    if (t_current == pool) return;
+
+    t_current = pool;
+    setOsThreadName(kPrefix + t_current);
+}
+
+Scope::Scope(const char* pool)
+    : m_savedTag(t_current)
+{
+    m_restore = getOsThreadName(m_savedName);
+    setCurrent(pool);
+}
+
+Scope::~Scope()
+{
+    t_current = m_savedTag;
+    if (m_restore) {
+        setOsThreadName(m_savedName);
+    }
+}
+
+QString poolOf(const QString& threadName, bool isMainThread)
+{
+    if (isMainThread) return "main";
+    if (threadName.startsWith(kPrefix)) return threadName.mid(static_cast<int>(std::strlen(kPrefix)));
+    // Qt 以 objectName 命名 QThread；QThreadPool 的空闲线程统一为 "Thread (pooled)"
+    if (threadName.startsWith("MqttReport")) return "mqtt";
+    if (threadName.startsWith("Thread (pooled)")) return "qt_pool";
+    return "other";
+}
+
+ScopedSpawn::ScopedSpawn(const char* pool)
+{
+#ifdef Q_OS_LINUX
+    if (pthread_getname_np(pthread_self(), m_saved, sizeof(m_saved)) == 0) {
+        m_restore = true;
+        setOsThreadName(std::string(kPrefix) + pool);
+    }
+#else
+    Q_UNUSED(pool);
+#endif
+}
+
+ScopedSpawn::~ScopedSpawn()
+{
+#ifdef Q_OS_LINUX
+    if (m_restore) {
+        pthread_setname_np(pthread_self(), m_saved);
+    }
+#endif
+}
+
+} // namespace ThreadTag
@@ -42,6 +42,8 @@ void BarcodeTabWidget::setBarcodeConfig(const BarcodeConfig& config)
     QSignalBlocker blocker1(m_ui->chk_enableBarcode);
     QSignalBlocker blocker2(m_ui->comboBox_codeType);
     QSignalBlocker blocker3(m_ui->spinBox_maxNum);
+    QSignalBlocker blocker4(m_ui->chk_enableLocalization);
+    QSignalBlocker blocker5(m_ui->chk_enableTracking);
 
     m_ui->chk_enableBarcode->setChecked(config.enableBarcode);
 
@@ -59,6 +61,8 @@ void BarcodeTabWidget::setBarcodeConfig(const BarcodeConfig& config)
 
     
     m_ui->spinBox_maxNum->setValue(config.maxNumSymbols);
+    m_ui->chk_enableLocalization->setChecked(config.enableLocalization);
+    m_ui->chk_enableTracking->setChecked(config.enableTracking);
 
     // 手动更新 groupBox 和 Pipeline（使用完整的新配置）
     m_ui->groupBox_settings->setEnabled(config.enableBarcode);
@@ -67,7 +71,8 @@ void BarcodeTabWidget::setBarcodeConfig(const BarcodeConfig& config)
 
 BarcodeConfig BarcodeTabWidget::getBarcodeConfig() const
 {
-    BarcodeConfig config;
+    // 以当前配置为基础，界面未暴露的参数（定位/跟踪细节等）保持不变
+    BarcodeConfig config = m_pipeline ? m_pipeline->config().barcode : BarcodeConfig{};
     config.enableBarcode = m_ui->chk_enableBarcode->isChecked();
     
     // 获取条码类型
@@ -82,6 +87,8 @@ BarcodeConfig BarcodeTabWidget::getBarcodeConfig() const
     }
     
     config.maxNumSymbols = m_ui->spinBox_maxNum->value();
+    config.enableLocalization = m_ui->chk_enableLocalization->isChecked();
+    config.enableTracking = m_ui->chk_enableTracking->isChecked();
     
     return config;
 }
@@ -204,6 +211,8 @@ void BarcodeTabWidget::connectSignals(const SignalContext& ctx,
             this, [this, syncToDetectionItem](int) { syncToDetectionItem(); });
     connect(m_ui->spinBox_maxNum, QOverload<int>::of(&QSpinBox::valueChanged),
             this, [this, syncToDetectionItem](int) { syncToDetectionItem(); });
+    connect(m_ui->chk_enableLocalization, &QCheckBox::toggled, this, syncToDetectionItem);
+    connect(m_ui->chk_enableTracking, &QCheckBox::toggled, this, syncToDetectionItem);
 
     // 条码识别需要用户点击"应用"按钮才执行，不使用自动预览
     connect(this, &BarcodeTabWidget::requestApplyBarcodeSettings,
@@ -311,8 +311,8 @@ void BatchDetectionWidget::processNextImage()
                         roiConfig.roiRect, image.cols, image.rows);
                     if (roiRect.empty()) continue;
 
-                    cv::Mat roiImage = image(roiRect).clone();
-                    PipelineContext ctx = pipelinePtr->execute(roiImage, roiConfig.pipelineConfig);
+                    cv::Mat roiImage = image(roiRect);  // 只读子视图，步骤不改写输入
+                    PipelineContext ctx = pipelinePtr->execute(roiImage, roiConfig.pipelineConfig, roiConfig.roiId);
 
                     // [NOTE] 使用DetectionEvaluator评估该ROI的所有检测项（与auto_detection_controller一致）
                     RoiDetectionResult roiResult = DetectionEvaluator::evaluateRoi(
@@ -5,6 +5,12 @@
 #include "image_view.h"
 #include "controllers/roi_ui_controller.h"
 #include <QMessageBox>
+#include <QGroupBox>
+#include <QFormLayout>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QLabel>
 
 LineDetectTabWidget::LineDetectTabWidget(IPipelineAccess* pipelineAccess,
                                          QWidget* parent)
@@ -30,6 +36,12 @@ void LineDetectTabWidget::updateFromPipeline(const PipelineContext& ctx)
         cfg.lineDetect.distanceThreshold,
         cfg.lineDetect.enableReferenceLineMatch
     );
+
+    if (m_caliperResultLabel && cfg.stepEnabled[static_cast<int>(StepType::Caliper)]) {
+        m_caliperResultLabel->setText(ctx.caliper.message.isEmpty() ? QStringLiteral("等待测量...")
+                                                                    : ctx.caliper.message);
+        m_caliperResultLabel->setStyleSheet(ctx.caliper.pass ? "color: #16A34A;" : "color: #DC2626;");
+    }
 }
 
 void LineDetectTabWidget::initialize()
@@ -101,6 +113,152 @@ void LineDetectTabWidget::initialize()
     m_ui->spin_searchRegionWidth->setValue(100);
     updateReferenceLineStatus();
 
+    setupCaliperGroup();
+}
+
+void LineDetectTabWidget::setupCaliperGroup()
+{
+    auto* group = new QGroupBox(QStringLiteral("卡尺测量（路径使用参考线）"), this);
+    auto* form = new QFormLayout(group);
+
+    m_caliperShapeCombo = new QComboBox(group);
+    m_caliperShapeCombo->addItem(QStringLiteral("直线"), 0);
+    m_caliperShapeCombo->addItem(QStringLiteral("圆弧（起点=圆心）"), 1);
+    form->addRow(QStringLiteral("测量路径:"), m_caliperShapeCombo);
+
+    m_caliperModeCombo = new QComboBox(group);
+    m_caliperModeCombo->addItem(QStringLiteral("单边缘"), 0);
+    m_caliperModeCombo->addItem(QStringLiteral("边缘对（宽度）"), 1);
+    form->addRow(QStringLiteral("测量模式:"), m_caliperModeCombo);
+
+    m_caliperPolarityCombo = new QComboBox(group);
+    m_caliperPolarityCombo->addItem(QStringLiteral("任意"), 0);
+    m_caliperPolarityCombo->addItem(QStringLiteral("暗→亮"), 1);
+    m_caliperPolarityCombo->addItem(QStringLiteral("亮→暗"), 2);
+    form->addRow(QStringLiteral("边缘极性:"), m_caliperPolarityCombo);
+
+    m_caliperCountSpin = new QSpinBox(group);
+    m_caliperCountSpin->setRange(2, 200);
+    m_caliperCountSpin->setValue(20);
+    form->addRow(QStringLiteral("卡尺数量:"), m_caliperCountSpin);
+
+    m_caliperSearchSpin = new QDoubleSpinBox(group);
+    m_caliperSearchSpin->setRange(5.0, 500.0);
+    m_caliperSearchSpin->setValue(40.0);
+    m_caliperSearchSpin->setSuffix(" px");
+    form->addRow(QStringLiteral("搜索长度:"), m_caliperSearchSpin);
+
+    m_caliperProjectionSpin = new QDoubleSpinBox(group);
+    m_caliperProjectionSpin->setRange(1.0, 100.0);
+    m_caliperProjectionSpin->setValue(8.0);
+    m_caliperProjectionSpin->setSuffix(" px");
+    form->addRow(QStringLiteral("投影宽度:"), m_caliperProjectionSpin);
+
+    m_caliperContrastSpin = new QDoubleSpinBox(group);
+    m_caliperContrastSpin->setRange(1.0, 255.0);
+    m_caliperContrastSpin->setValue(15.0);
+    form->addRow(QStringLiteral("最小对比度:"), m_caliperContrastSpin);
+
+    m_caliperPixelSizeSpin = new QDoubleSpinBox(group);
+    m_caliperPixelSizeSpin->setDecimals(4);
+    m_caliperPixelSizeSpin->setRange(0.0001, 10000.0);
+    m_caliperPixelSizeSpin->setValue(1.0);
+    m_caliperPixelSizeSpin->setSuffix(" μm/px");
+    form->addRow(QStringLiteral("像素当量:"), m_caliperPixelSizeSpin);
+
+    m_caliperNominalSpin = new QDoubleSpinBox(group);
+    m_caliperNominalSpin->setDecimals(2);
+    m_caliperNominalSpin->setRange(-1e6, 1e6);
+    m_caliperNominalSpin->setSuffix(" μm");
+    form->addRow(QStringLiteral("名义值:"), m_caliperNominalSpin);
+
+    m_caliperToleranceSpin = new QDoubleSpinBox(group);
+    m_caliperToleranceSpin->setDecimals(2);
+    m_caliperToleranceSpin->setRange(0.0, 1e6);
+    m_caliperToleranceSpin->setSuffix(" μm");
+    m_caliperToleranceSpin->setToolTip(QStringLiteral("0 表示只测量不判定"));
+    form->addRow(QStringLiteral("公差(±):"), m_caliperToleranceSpin);
+
+    m_caliperResultLabel = new QLabel(QStringLiteral("在\"步骤\"页启用卡尺测量后生效"), group);
+    m_caliperResultLabel->setWordWrap(true);
+    form->addRow(m_caliperResultLabel);
+
+    // 放在底部弹簧之前
+    int index = m_ui->mainLayout->count();
+    if (index > 0 && m_ui->mainLayout->itemAt(index - 1)->spacerItem()) --index;
+    m_ui->mainLayout->insertWidget(index, group);
+
+    for (auto* combo : {m_caliperShapeCombo, m_caliperModeCombo, m_caliperPolarityCombo}) {
+        connect(combo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+                this, [this](int) { onCaliperParamChanged(); });
+    }
+    connect(m_caliperCountSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, [this](int) { onCaliperParamChanged(); });
+    for (auto* spin : {m_caliperSearchSpin, m_caliperProjectionSpin, m_caliperContrastSpin,
+                       m_caliperPixelSizeSpin, m_caliperNominalSpin, m_caliperToleranceSpin}) {
+        connect(spin, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+                this, [this](double) { onCaliperParamChanged(); });
+    }
+
+    if (m_pipeline) {
+        setCaliperConfig(m_pipeline->getConfigSnapshot().caliper);
+    }
+}
+
+void LineDetectTabWidget::setCaliperConfig(const CaliperConfig& config)
+{
+    if (!m_caliperShapeCombo) return;
+
+    const QSignalBlocker b1(m_caliperShapeCombo);
+    const QSignalBlocker b2(m_caliperModeCombo);
+    const QSignalBlocker b3(m_caliperPolarityCombo);
+    const QSignalBlocker b4(m_caliperCountSpin);
+    const QSignalBlocker b5(m_caliperSearchSpin);
+    const QSignalBlocker b6(m_caliperProjectionSpin);
+    const QSignalBlocker b7(m_caliperContrastSpin);
+    const QSignalBlocker b8(m_caliperPixelSizeSpin);
+    const QSignalBlocker b9(m_caliperNominalSpin);
+    const QSignalBlocker b10(m_caliperToleranceSpin);
+
+    m_caliperShapeCombo->setCurrentIndex(qMax(0, m_caliperShapeCombo->findData(config.shape)));
+    m_caliperModeCombo->setCurrentIndex(qMax(0, m_caliperModeCombo->findData(config.edgeMode)));
+    m_caliperPolarityCombo->setCurrentIndex(qMax(0, m_caliperPolarityCombo->findData(config.polarity)));
+    m_caliperCountSpin->setValue(config.caliperCount);
+    m_caliperSearchSpin->setValue(config.searchLength);
+    m_caliperProjectionSpin->setValue(config.projectionLength);
+    m_caliperContrastSpin->setValue(config.minContrast);
+    m_caliperPixelSizeSpin->setValue(config.pixelSizeUm);
+    m_caliperNominalSpin->setValue(config.nominalUm);
+    m_caliperToleranceSpin->setValue(config.toleranceUm);
+}
+
+void LineDetectTabWidget::writeCaliperConfig(CaliperConfig& config) const
+{
+    config.shape = m_caliperShapeCombo->currentData().toInt();
+    config.edgeMode = m_caliperModeCombo->currentData().toInt();
+    config.polarity = m_caliperPolarityCombo->currentData().toInt();
+    config.caliperCount = m_caliperCountSpin->value();
+    config.searchLength = m_caliperSearchSpin->value();
+    config.projectionLength = m_caliperProjectionSpin->value();
+    config.minContrast = m_caliperContrastSpin->value();
+    config.pixelSizeUm = m_caliperPixelSizeSpin->value();
+    config.nominalUm = m_caliperNominalSpin->value();
+    config.toleranceUm = m_caliperToleranceSpin->value();
+}
+
+void LineDetectTabWidget::onCaliperParamChanged()
+{
+    if (!m_pipeline) return;
+
+    PipelineConfig cfg = m_pipeline->getConfigSnapshot();
+    writeCaliperConfig(cfg.caliper);
+    m_pipeline->setConfig(cfg);
+
+    if (cfg.stepEnabled[static_cast<int>(StepType::Caliper)] && cfg.lineDetect.referenceLineValid) {
+        if (m_onExecutePipeline) {
+            m_onExecutePipeline();
+        }
+    }
 }
 
 void LineDetectTabWidget::onLineAlgorithmChanged(int value)
@@ -237,6 +395,18 @@ void LineDetectTabWidget::setLineState(const LineDetectState &state)
     m_ui->SpinBox_HoughPMaxLineGap->setValue(state.maxGap);
 }
 
+// ========== IConfigurableTab 接口实现 ==========
+
+void LineDetectTabWidget::saveToConfig(PipelineConfig& config) const
+{
+    if (m_caliperShapeCombo) writeCaliperConfig(config.caliper);
+}
+
+void LineDetectTabWidget::loadFromConfig(const PipelineConfig& config)
+{
+    setCaliperConfig(config.caliper);
+}
+
 void LineDetectTabWidget::setLineConfig(const LineDetectConfig& config)
 {
     // 设置基础直线检测参数
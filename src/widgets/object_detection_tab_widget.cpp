@@ -116,6 +116,9 @@ void ObjectDetectionTabWidget::loadModelAsync()
     m_ui->label_status->setText("状态：正在加载模型...");
     m_ui->btn_apply->setEnabled(false);
 
+    // CPU 执行配置（线程/绑核/图优化缓存/精度）在加载前设置
+    m_ortInference.setCpuConfig(m_pipeline->getConfigSnapshot().objectDetection.ortCpu);
+
     QFuture<QString> future = QtConcurrent::run(
         [this, modelPath, configPath]() -> QString {
             // Step 1: 加载 ONNX Runtime GPU（优先，推理更快）
@@ -162,9 +165,12 @@ void ObjectDetectionTabWidget::loadModelAsync()
                 spdlog::info("[ObjectDetection] OpenCV DNN warmup completed");
             }
 
+            const QString ortBackend = m_ortInference.isUsingGpu()
+                ? QString("ORT GPU")
+                : QString("ORT CPU %1").arg(OrtCpuConfig::precisionName(m_ortInference.modelPrecision()).toUpper());
             QString msg;
-            if (result == "both") msg = "状态：模型加载成功 (ORT GPU + DNN)";
-            else if (result == "ort") msg = "状态：模型加载成功 (ORT GPU)";
+            if (result == "both") msg = QString("状态：模型加载成功 (%1 + DNN)").arg(ortBackend);
+            else if (result == "ort") msg = QString("状态：模型加载成功 (%1)").arg(ortBackend);
             else msg = "状态：模型加载成功 (DNN)";
             
             emit modelLoadFinished(true, msg);
@@ -11,6 +11,37 @@
 #include <QClipboard>
 #include <QApplication>
 #include <QMessageBox>
+#include <QSignalBlocker>
+
+namespace {
+
+/// 固定区域文本格式："x,y,w,h; x,y,w,h"
+QString formatRegions(const QVector<QRect>& regions)
+{
+    QStringList parts;
+    for (const QRect& r : regions) {
+        parts << QString("%1,%2,%3,%4").arg(r.x()).arg(r.y()).arg(r.width()).arg(r.height());
+    }
+    return parts.join("; ");
+}
+
+QVector<QRect> parseRegions(const QString& text)
+{
+    QVector<QRect> regions;
+    for (const QString& part : text.split(';', Qt::SkipEmptyParts)) {
+        const QStringList v = part.split(',');
+        if (v.size() != 4) continue;
+        bool ok[4];
+        const QRect r(v[0].trimmed().toInt(&ok[0]), v[1].trimmed().toInt(&ok[1]),
+                      v[2].trimmed().toInt(&ok[2]), v[3].trimmed().toInt(&ok[3]));
+        if (ok[0] && ok[1] && ok[2] && ok[3] && r.width() > 0 && r.height() > 0) {
+            regions.append(r);
+        }
+    }
+    return regions;
+}
+
+} // namespace
 
 OcrTabWidget::OcrTabWidget(IPipelineAccess* pipelineAccess, QWidget* parent)
     : QWidget(parent)
@@ -39,6 +70,37 @@ void OcrTabWidget::setupUI()
 
     mainLayout->addWidget(langGroup);
 
+    // 识别引擎
+    auto* engineGroup = new QGroupBox("识别引擎");
+    auto* engineLayout = new QFormLayout(engineGroup);
+
+    m_engineModeCombo = new QComboBox();
+    m_engineModeCombo->addItem("全流程（检测+识别）", static_cast<int>(OcrEngineMode::Full));
+    m_engineModeCombo->addItem("固定区域（仅识别）", static_cast<int>(OcrEngineMode::FixedRegions));
+    m_engineModeCombo->setToolTip("文字位置固定时使用固定区域模式，跳过文本检测，多个区域批量识别");
+    engineLayout->addRow("引擎模式:", m_engineModeCombo);
+
+    m_fixedRegionsEdit = new QLineEdit();
+    m_fixedRegionsEdit->setPlaceholderText("x,y,w,h; x,y,w,h（ROI内坐标）");
+    m_useRegionsBtn = new QPushButton("采用识别区域");
+    m_useRegionsBtn->setToolTip("以最近一次识别出的文本框作为固定区域");
+    auto* regionsRow = new QHBoxLayout();
+    regionsRow->addWidget(m_fixedRegionsEdit, 1);
+    regionsRow->addWidget(m_useRegionsBtn);
+    engineLayout->addRow("固定区域:", regionsRow);
+
+    m_enableCacheCheck = new QCheckBox("启用结果缓存");
+    m_enableCacheCheck->setToolTip("文字区域内容未变化时复用上次识别结果，跳过推理");
+    engineLayout->addRow("", m_enableCacheCheck);
+
+    m_cacheDistanceSpin = new QSpinBox();
+    m_cacheDistanceSpin->setRange(0, 256);   // 256 位哈希
+    m_cacheDistanceSpin->setToolTip("区域哈希（256 位）的汉明距离不超过该值视为内容未变化；\n"
+                                    "0 = 完全一致才复用。批号/日期等单字符变化可能只差几位，调大前请确认");
+    engineLayout->addRow("缓存阈值:", m_cacheDistanceSpin);
+
+    mainLayout->addWidget(engineGroup);
+
     // 判定参数
     auto* judgeGroup = new QGroupBox("判定参数");
     auto* judgeLayout = new QFormLayout(judgeGroup);
@@ -114,6 +176,36 @@ void OcrTabWidget::setupUI()
     // 连接信号（切换排列模式时同步配置，不自动触发识别）
     connect(m_pageModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, [this]() { syncConfigToPipeline(); });
+
+    connect(m_engineModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() {
+        updateEngineControls();
+        syncConfigToPipeline();
+    });
+    connect(m_fixedRegionsEdit, &QLineEdit::editingFinished, this, [this]() {
+        // 规范化显示，丢弃无法解析的区域
+        m_fixedRegionsEdit->setText(formatRegions(parseRegions(m_fixedRegionsEdit->text())));
+        syncConfigToPipeline();
+    });
+    connect(m_useRegionsBtn, &QPushButton::clicked, this, [this]() {
+        QVector<QRect> regions;
+        for (const auto& region : m_lastRegions) {
+            regions.append(QRect(region.x, region.y, region.width, region.height));
+        }
+        m_fixedRegionsEdit->setText(formatRegions(regions));
+        syncConfigToPipeline();
+    });
+    connect(m_enableCacheCheck, &QCheckBox::toggled, this, [this]() {
+        updateEngineControls();
+        syncConfigToPipeline();
+    });
+    connect(m_cacheDistanceSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, [this]() { syncConfigToPipeline(); });
+
+    if (m_pipeline) {
+        setOcrConfig(m_pipeline->getConfigSnapshot().ocr);
+    } else {
+        updateEngineControls();
+    }
 }
 
 void OcrTabWidget::onRecognizeClicked()
@@ -157,7 +249,41 @@ void OcrTabWidget::syncConfigToPipeline()
 {
     if (!m_pipeline) return;
 
-    // RapidOCR 配置已简化，无需同步 pageMode
+    // pageMode 仅影响界面提示，RapidOCR 无对应参数
+    PipelineConfig cfg = m_pipeline->getConfigSnapshot();
+    writeOcrConfig(cfg.ocr);
+    m_pipeline->setConfig(cfg);
+}
+
+void OcrTabWidget::writeOcrConfig(OcrConfig& cfg) const
+{
+    cfg.engineMode = static_cast<OcrEngineMode>(m_engineModeCombo->currentData().toInt());
+    cfg.fixedRegions = parseRegions(m_fixedRegionsEdit->text());
+    cfg.enableCache = m_enableCacheCheck->isChecked();
+    cfg.cacheMaxDistance = m_cacheDistanceSpin->value();
+}
+
+void OcrTabWidget::setOcrConfig(const OcrConfig& cfg)
+{
+    const QSignalBlocker b1(m_engineModeCombo);
+    const QSignalBlocker b2(m_fixedRegionsEdit);
+    const QSignalBlocker b3(m_enableCacheCheck);
+    const QSignalBlocker b4(m_cacheDistanceSpin);
+
+    const int index = m_engineModeCombo->findData(static_cast<int>(cfg.engineMode));
+    m_engineModeCombo->setCurrentIndex(index >= 0 ? index : 0);
+    m_fixedRegionsEdit->setText(formatRegions(cfg.fixedRegions));
+    m_enableCacheCheck->setChecked(cfg.enableCache);
+    m_cacheDistanceSpin->setValue(cfg.cacheMaxDistance);
+    updateEngineControls();
+}
+
+void OcrTabWidget::updateEngineControls()
+{
+    const bool fixed = m_engineModeCombo->currentData().toInt() == static_cast<int>(OcrEngineMode::FixedRegions);
+    m_fixedRegionsEdit->setEnabled(fixed);
+    m_useRegionsBtn->setEnabled(fixed);
+    m_cacheDistanceSpin->setEnabled(m_enableCacheCheck->isChecked());
 }
 
 void OcrTabWidget::clearResults()
@@ -172,15 +298,12 @@ void OcrTabWidget::clearResults()
 
 void OcrTabWidget::saveToConfig(PipelineConfig& config) const
 {
-    // RapidOCR 配置已简化，无需保存 pageMode
-    Q_UNUSED(config);
+    writeOcrConfig(config.ocr);
 }
 
 void OcrTabWidget::loadFromConfig(const PipelineConfig& config)
 {
-    const auto& cfg = config.ocr;
-    Q_UNUSED(cfg);
-    // RapidOCR 配置已简化，无需加载 pageMode
+    setOcrConfig(config.ocr);
 }
 
 void OcrTabWidget::connectSignals(const SignalContext& ctx,
@@ -262,6 +385,7 @@ void OcrTabWidget::updateFromPipeline(const PipelineContext& ctx)
 
 void OcrTabWidget::updateRegionsTable(const QVector<OcrRegion>& regions)
 {
+    m_lastRegions = regions;
     m_regionsTable->setRowCount(regions.size());
 
     for (int i = 0; i < regions.size(); ++i) {
@@ -8,6 +8,7 @@
 #include <QVBoxLayout>
 #include <QGroupBox>
 #include <QScrollArea>
+#include <QIcon>
 
 ProfileTabWidget::ProfileTabWidget(ProfileManager* profileManager,
                                    PipelineManager* pipelineManager,
@@ -81,6 +82,12 @@ void ProfileTabWidget::setupConnections()
     connect(m_ui->listWidget_profiles, &QListWidget::currentRowChanged,
             this, &ProfileTabWidget::onProfileSelectionChanged);
 
+    // 方案目录在磁盘上变化（文件监视）时自动刷新列表
+    if (m_profileManager) {
+        connect(m_profileManager, &ProfileManager::profileListChanged,
+                this, [this]() { refreshProfileList(); });
+    }
+
     // 连接步骤复选框
     for (int i = 0; i < PipelineConfig::STEP_COUNT; ++i) {
         if (m_stepCheckboxes[i]) {
@@ -114,6 +121,9 @@ void ProfileTabWidget::refreshProfileList()
             .arg(p.updatedAt.toString("yyyy-MM-dd HH:mm"));
 
         QListWidgetItem* item = new QListWidgetItem(displayText);
+        if (!p.thumbnailPath.isEmpty()) {
+            item->setIcon(QIcon(p.thumbnailPath));
+        }
         item->setData(Qt::UserRole, p.profileId);
         item->setSizeHint(QSize(0, 60));
         m_ui->listWidget_profiles->addItem(item);
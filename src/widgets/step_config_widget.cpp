@@ -29,6 +29,7 @@ const StepConfigWidget::StepEntry StepConfigWidget::kSteps[] = {
     {"算法处理",      {"处理"},        {3},           false, "AL", "形态学操作：开闭运算/膨胀腐蚀", "#FF6D00"},
     {"形状筛选",      {"提取"},        {4},           false, "SF", "面积/圆度/凸性/矩形度筛选", "#E91E63"},
     {"直线检测",      {"直线"},        {5},           false, "LD", "HoughP/LSD/EDline直线检测", "#2196F3"},
+    {"卡尺测量",      {"直线"},        {9},           false, "CP", "沿参考线/圆弧的亚像素边缘测量", "#3F51B5"},
     {"模板匹配",      {"补正"},        {-1},          false, "TM", "模板匹配定位与对齐", "#9C27B0"},
     {"条码识别",      {"条码"},        {6},           false, "BC", "QR Code/条形码识别", "#4CAF50"},
     {"滤波去噪",      {"滤波去噪"},    {7},           false, "FN", "高斯/中值/双边滤波去噪", "#00BCD4"},
@@ -4,8 +4,10 @@
 #include "roi_manager.h"
 #include "image_view.h"
 #include "image_utils.h"
+#include "pipeline_manager.h"
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QSignalBlocker>
 
 VideoTabWidget::VideoTabWidget(QWidget* parent)
     : QWidget(parent)
@@ -27,6 +29,14 @@ VideoTabWidget::VideoTabWidget(QWidget* parent)
     connect(m_videoManager, &VideoManager::errorOccurred,
             this, &VideoTabWidget::onErrorOccurred);
 
+    // 变化门控参数修改后立即写入当前配置（配置指纹变化，下一帧必然重新执行）
+    connect(m_ui->checkBox_gateEnabled, &QCheckBox::toggled, this, [this]() { syncChangeGateToPipeline(); });
+    for (QSpinBox* spin : {m_ui->spinBox_gateGrid, m_ui->spinBox_gatePixel, m_ui->spinBox_gateMaxSkip}) {
+        connect(spin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this]() { syncChangeGateToPipeline(); });
+    }
+    connect(m_ui->doubleSpinBox_gateRatio, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            this, [this]() { syncChangeGateToPipeline(); });
+
     // 初始化相机列表
     updateCameraList();
 
@@ -273,11 +283,55 @@ void VideoTabWidget::updateProgress()
     m_isUpdatingProgress = false;
 }
 
+void VideoTabWidget::writeChangeGateConfig(ChangeGateConfig& cfg) const
+{
+    cfg.enabled = m_ui->checkBox_gateEnabled->isChecked();
+    cfg.gridSize = m_ui->spinBox_gateGrid->value();
+    cfg.pixelThreshold = m_ui->spinBox_gatePixel->value();
+    cfg.minChangedRatio = m_ui->doubleSpinBox_gateRatio->value() / 100.0;
+    cfg.maxSkipFrames = m_ui->spinBox_gateMaxSkip->value();
+}
+
+void VideoTabWidget::setChangeGateConfig(const ChangeGateConfig& cfg)
+{
+    QSignalBlocker blocker1(m_ui->checkBox_gateEnabled);
+    QSignalBlocker blocker2(m_ui->spinBox_gateGrid);
+    QSignalBlocker blocker3(m_ui->spinBox_gatePixel);
+    QSignalBlocker blocker4(m_ui->doubleSpinBox_gateRatio);
+    QSignalBlocker blocker5(m_ui->spinBox_gateMaxSkip);
+
+    m_ui->checkBox_gateEnabled->setChecked(cfg.enabled);
+    m_ui->spinBox_gateGrid->setValue(cfg.gridSize);
+    m_ui->spinBox_gatePixel->setValue(cfg.pixelThreshold);
+    m_ui->doubleSpinBox_gateRatio->setValue(cfg.minChangedRatio * 100.0);
+    m_ui->spinBox_gateMaxSkip->setValue(cfg.maxSkipFrames);
+}
+
+void VideoTabWidget::syncChangeGateToPipeline()
+{
+    if (!m_pipelineManager) return;
+    m_pipelineManager->updateConfig([this](PipelineConfig& cfg) { writeChangeGateConfig(cfg.changeGate); });
+}
+
+void VideoTabWidget::saveToConfig(PipelineConfig& config) const
+{
+    writeChangeGateConfig(config.changeGate);
+}
+
+void VideoTabWidget::loadFromConfig(const PipelineConfig& config)
+{
+    setChangeGateConfig(config.changeGate);
+}
+
 void VideoTabWidget::connectSignals(const SignalContext& ctx,
                                     std::function<void()> onExecutePipeline,
                                     std::function<void()> onConfigSaved)
 {
     Q_UNUSED(onConfigSaved);
+    m_pipelineManager = ctx.pipelineManager;
+    if (m_pipelineManager) {
+        setChangeGateConfig(m_pipelineManager->config().changeGate);
+    }
     connect(this, &VideoTabWidget::videoFrameReady,
             this, [rm = ctx.roiManager, view = ctx.view, onExecutePipeline](const cv::Mat& frame) {
                 if (!frame.empty()) {